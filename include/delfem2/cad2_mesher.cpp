@@ -8,13 +8,18 @@
 
 #include "delfem2/cad2_mesher.h"
 
+#include <algorithm>
 #include <deque>
 #include <climits>
+#include <map>
 
 #include "delfem2/dtri2_v2dtri.h"
 #include "delfem2/geo_polyline.h"
 #include "delfem2/str.h"
 #include "delfem2/cad2.h"
+#include "delfem2/cagedef.h"
+#include "delfem2/msh_reorder.h"
+#include "delfem2/thread.h"
 
 // ------------------------------------------
 
@@ -66,56 +71,83 @@ DFM2_INLINE void GetBound(
   }
 }
 
+/**
+ * @brief triangulate a face with the points on its boundary
+ * @details the mesh is made in the local numbering of the points of the face
+ * @param[out] aVec2 coordinates of the points on the boundary of the face
+ * @param[out] aETri triangles of the face
+ * @param[out] local2global index of the boundary points in the whole mesh
+ */
 DFM2_INLINE void GenMeshCadFace(
   std::vector<CVec2d> &aVec2,
   std::vector<CDynTri> &aETri,
+  std::vector<unsigned int> &local2global,
   unsigned int iface0,
   const CadTopo &topo,
   [[maybe_unused]] const std::vector<CCad2D_VtxGeo> &aVtxGeo,
   [[maybe_unused]] const std::vector<CCad2D_EdgeGeo> &aEdgeGeo,
-  const std::vector<std::vector<std::pair<unsigned int, double> > > &edge_point) {
+  const std::vector<std::vector<std::pair<unsigned int, double> > > &edge_point,
+  const std::vector<CVec2d> &aVec2Global) {
   assert(iface0 < topo.faces.size());
-  std::vector<CDynPntSur> aPo2D;
-  {
-    aPo2D.resize(aVec2.size());
-    for (size_t ixys = 0; ixys < aVec2.size(); ixys++) {
-      aPo2D[ixys].e = UINT_MAX;
-      aPo2D[ixys].d = 0;
-    }
-  }
-  {
-    double bound_2d[4];
-    GetBound(
-      bound_2d,
-      iface0, topo, aEdgeGeo);
-    MakeSuperTriangle(
-      aVec2, aPo2D, aETri,
-      bound_2d);
-  }
-  std::vector<int> aIP;
+  std::map<unsigned int, unsigned int> global2local;
+  local2global.clear();
   { // make list of index of point involved this face
+    auto add_point = [&](unsigned int ip) {
+      if (global2local.find(ip) != global2local.end()) { return; }
+      global2local.insert(std::make_pair(ip, static_cast<unsigned int>(local2global.size())));
+      local2global.push_back(ip);
+    };
     for (size_t iil = 0; iil < topo.faces[iface0].aIL.size(); ++iil) {
       const int il0 = topo.faces[iface0].aIL[iil];
       if (topo.loops[il0].iv != UINT_MAX) {
-        aIP.push_back(topo.loops[il0].iv);
+        add_point(topo.loops[il0].iv);
         continue;
       }
       const std::vector<std::pair<unsigned int, bool> > &aIE = topo.loops[il0].aIE;
       for (const auto &iie: aIE) {
         const int ie = iie.first;
-        aIP.push_back(topo.edges[ie].iv0);
+        add_point(topo.edges[ie].iv0);
         for (const auto &pair: edge_point[ie]) {
-          aIP.push_back(pair.first);
+          add_point(pair.first);
         }
       }
     }
   }
+  auto local = [&](unsigned int ip) { return global2local.find(ip)->second; };
+  const size_t np = local2global.size();
+  aVec2.resize(np);
+  for (unsigned int ip = 0; ip < np; ++ip) { aVec2[ip] = aVec2Global[local2global[ip]]; }
+  std::vector<CDynPntSur> aPo2D(np);
+  for (size_t ixys = 0; ixys < np; ixys++) {
+    aPo2D[ixys].e = UINT_MAX;
+    aPo2D[ixys].d = 0;
+  }
   {
+    double bound_2d[4];
+    GetBound(
+      bound_2d,
+      iface0, topo, aEdgeGeo);
+    MakeSuperTriangle(
+      aVec2, aPo2D, aETri,
+      bound_2d);
+  }
+  { // insert the points in the biased randomized order
+    std::vector<unsigned int> new2old;
+    {
+      std::vector<double> aXY(np * 2);
+      for (size_t ip = 0; ip < np; ++ip) {
+        aXY[ip * 2 + 0] = aVec2[ip].x;
+        aXY[ip * 2 + 1] = aVec2[ip].y;
+      }
+      Permutation_BRIO2(new2old, aXY.data(), np, 0, 1);
+    }
     const double MIN_TRI_AREA = 1.0e-10;
-    for (int ip: aIP) {
+    unsigned int itri_start = UINT_MAX;
+    for (unsigned int ip: new2old) {
       AddPointsMesh(aVec2, aPo2D, aETri,
-                    ip, MIN_TRI_AREA);
+                    ip, MIN_TRI_AREA, itri_start);
       DelaunayAroundPoint(ip, aPo2D, aETri, aVec2);
+      if (aPo2D[ip].e != UINT_MAX) { itri_start = aPo2D[ip].e; }
     }
   }
   {
@@ -125,32 +157,31 @@ DFM2_INLINE void GenMeshCadFace(
       const std::vector<std::pair<unsigned int, bool> > &aIE = topo.loops[il0].aIE;
       for (const auto &iie: aIE) {
         const int ie0 = iie.first;
-        const size_t np = edge_point[ie0].size();
-        const size_t nseg = np + 1;
+        const size_t nep = edge_point[ie0].size();
+        const size_t nseg = nep + 1;
         for (unsigned int iseg = 0; iseg < nseg; ++iseg) {
-          const int ip0 = (iseg == 0) ? topo.edges[ie0].iv0 : edge_point[ie0][iseg - 1].first;
-          const int ip1 = (iseg == nseg - 1) ? topo.edges[ie0].iv1 : edge_point[ie0][iseg].first;
+          const unsigned int ip0 = (iseg == 0) ? topo.edges[ie0].iv0 : edge_point[ie0][iseg - 1].first;
+          const unsigned int ip1 = (iseg == nseg - 1) ? topo.edges[ie0].iv1 : edge_point[ie0][iseg].first;
           EnforceEdge(aPo2D, aETri,
-                      ip0, ip1, aVec2);
+                      local(ip0), local(ip1), aVec2);
         }
       }
     }
   }
   std::vector<int> aFlgTri(aETri.size(), -1);
   {
-    int ip0 = -1, ip1 = -1;
+    unsigned int ip0, ip1;
     {
       const int il0 = topo.faces[iface0].aIL[0];
       const std::vector<std::pair<unsigned int, bool> > &aIE = topo.loops[il0].aIE;
       unsigned int ie0 = aIE[0].first;
-      const size_t np = edge_point[ie0].size();
+      const size_t nep = edge_point[ie0].size();
       ip0 = topo.edges[ie0].iv0;
-      ip1 = (np == 0) ? topo.edges[ie0].iv1 : edge_point[ie0][0].first;
+      ip1 = (nep == 0) ? topo.edges[ie0].iv1 : edge_point[ie0][0].first;
     }
-    assert(ip0 != -1 && ip1 != -1);
     unsigned int itri0_ker = UINT_MAX, iedtri;
     FindEdge_LookAllTriangles(itri0_ker, iedtri,
-                              ip0, ip1, aETri);
+                              local(ip0), local(ip1), aETri);
     assert(itri0_ker < aETri.size());
     FlagConnected(aFlgTri,
                   aETri, itri0_ker, (int) iface0);
@@ -159,33 +190,261 @@ DFM2_INLINE void GenMeshCadFace(
     assert(aFlgTri.size() == aETri.size());
     DeleteTriFlag(aETri, aFlgTri,
                   -1);
-    aPo2D.resize(aPo2D.size() - 3);
     aVec2.resize(aVec2.size() - 3);
   }
 }
 
+/**
+ * @brief triangulate a face and put points inside the face
+ * @details the points inside the face are appended after the boundary points in the local numbering
+ * @param[out] aFlgPnt flag of the points in the local numbering
+ */
+DFM2_INLINE void MeshCadFace(
+  std::vector<CVec2d> &aVec2,
+  std::vector<CDynTri> &aETri,
+  std::vector<unsigned int> &local2global,
+  std::vector<unsigned int> &aFlgPnt,
+  unsigned int iface0,
+  const CCad2D &cad,
+  const std::vector<std::vector<std::pair<unsigned int, double> > > &edge_point,
+  const std::vector<CVec2d> &aVec2Global,
+  const std::vector<unsigned int> &aFlgPntGlobal,
+  double edge_length) {
+  GenMeshCadFace(aVec2, aETri, local2global,
+                 iface0,
+                 cad.topo, cad.aVtx, cad.aEdge, edge_point, aVec2Global);
+  aFlgPnt.resize(local2global.size());
+  for (unsigned int ip = 0; ip < local2global.size(); ++ip) { aFlgPnt[ip] = aFlgPntGlobal[local2global[ip]]; }
+  if (edge_length <= 1.0e-10) { return; }
+  std::vector<CDynPntSur> aPo2D(aVec2.size());
+  for (unsigned int it = 0; it < aETri.size(); ++it) {
+    for (unsigned int inotri = 0; inotri < 3; ++inotri) {
+      aPo2D[aETri[it].v[inotri]].e = it;
+      aPo2D[aETri[it].v[inotri]].d = inotri;
+    }
+  }
+  std::vector<unsigned int> aFlgTri(aETri.size(), iface0);
+  CInputTriangulation_Uniform param(1.0);
+  MeshingInside(
+    aPo2D, aETri, aVec2,
+    aFlgPnt, aFlgTri,
+    local2global.size(),
+    static_cast<unsigned int>(cad.aVtx.size() + cad.aEdge.size()),
+    edge_length, param);
+}
+
+DFM2_INLINE unsigned int NumDivisionEdge(
+  unsigned int ie,
+  const CCad2D &cad,
+  double edge_length,
+  const std::map<unsigned int, unsigned int> &mapIdEd_NDiv) {
+  if (edge_length <= 0) { return 20; }
+  const auto itr = mapIdEd_NDiv.find(ie);
+  if (itr != mapIdEd_NDiv.end()) { return itr->second; }
+  const double len0 = cad.aEdge[ie].ArcLength();
+  return static_cast<unsigned int>(len0 / edge_length + 1);
+}
+
+/**
+ * @brief take out the meshes of the faces from the mesh made by "CMesher_Cad2D"
+ * @details the points on the boundary come first in the local numbering, and the points inside follow in the original order.
+ * @param[out] aaIdPntOld original index of the points inside each face
+ * @param[in,out] aFlgFace faces with "1" are taken out. The flag is set to "0" if a point on the boundary is not in "old2new"
+ * @param old2new index of the points on the vertices and the edges after the renumbering
+ */
+DFM2_INLINE void ExtractFaceMesh(
+  std::vector<std::vector<CVec2d> > &aaVec2,
+  std::vector<std::vector<CDynTri> > &aaTri,
+  std::vector<std::vector<unsigned int> > &aaLocal2Global,
+  std::vector<std::vector<unsigned int> > &aaFlgPnt,
+  std::vector<std::vector<unsigned int> > &aaIdPntOld,
+  std::vector<int> &aFlgFace,
+  const CMeshDynTri2D &dmsh_old,
+  const std::vector<unsigned int> &aFlgTriOld,
+  const std::vector<unsigned int> &aFlgPntOld,
+  const std::vector<unsigned int> &old2new,
+  unsigned int nflgpnt_offset) {
+  const size_t nface = aFlgFace.size();
+  // index of the triangles and the inner points in their faces
+  std::vector<unsigned int> tri2local(aFlgTriOld.size(), UINT_MAX);
+  for (unsigned int it = 0; it < aFlgTriOld.size(); ++it) {
+    const unsigned int ifc = aFlgTriOld[it];
+    if (aFlgFace[ifc] != 1) { continue; }
+    tri2local[it] = static_cast<unsigned int>(aaTri[ifc].size());
+    aaTri[ifc].push_back(dmsh_old.aETri[it]);
+  }
+  std::vector<unsigned int> pnt2local(aFlgPntOld.size(), UINT_MAX);
+  unsigned int nfix = 0;
+  for (unsigned int ip = 0; ip < aFlgPntOld.size(); ++ip) {
+    if (aFlgPntOld[ip] < nflgpnt_offset) {
+      nfix = ip + 1;
+      continue;
+    }
+    const unsigned int ifc = aFlgPntOld[ip] - nflgpnt_offset;
+    if (aFlgFace[ifc] != 1) { continue; }
+    pnt2local[ip] = static_cast<unsigned int>(aaIdPntOld[ifc].size());
+    aaIdPntOld[ifc].push_back(ip);
+  }
+  std::vector<unsigned int> fix2local(nfix, UINT_MAX);
+  for (unsigned int ifc = 0; ifc < nface; ++ifc) {
+    if (aFlgFace[ifc] != 1) { continue; }
+    std::vector<CDynTri> &aTri = aaTri[ifc];
+    std::vector<unsigned int> &local2global = aaLocal2Global[ifc];
+    std::vector<unsigned int> local2old;
+    for (auto &tri: aTri) {
+      for (unsigned int ip0: tri.v) {
+        if (aFlgPntOld[ip0] >= nflgpnt_offset || fix2local[ip0] != UINT_MAX) { continue; }
+        fix2local[ip0] = static_cast<unsigned int>(local2old.size());
+        local2old.push_back(ip0);
+      }
+    }
+    const auto nbound = static_cast<unsigned int>(local2old.size());
+    for (auto &tri: aTri) {
+      for (unsigned int inotri = 0; inotri < 3; ++inotri) {
+        const unsigned int ip0 = tri.v[inotri];
+        tri.v[inotri] = (aFlgPntOld[ip0] < nflgpnt_offset) ? fix2local[ip0] : nbound + pnt2local[ip0];
+        if (tri.s2[inotri] == UINT_MAX) { continue; }
+        assert(aFlgTriOld[tri.s2[inotri]] == ifc);
+        tri.s2[inotri] = tri2local[tri.s2[inotri]];
+      }
+    }
+    local2global.resize(nbound);
+    for (unsigned int ip = 0; ip < nbound; ++ip) {
+      fix2local[local2old[ip]] = UINT_MAX;
+      local2global[ip] = old2new[local2old[ip]];
+      if (local2global[ip] == UINT_MAX) { aFlgFace[ifc] = 0; }
+    }
+    local2old.insert(local2old.end(), aaIdPntOld[ifc].begin(), aaIdPntOld[ifc].end());
+    aaVec2[ifc].resize(local2old.size());
+    aaFlgPnt[ifc].resize(local2old.size());
+    for (unsigned int ip = 0; ip < local2old.size(); ++ip) {
+      aaVec2[ifc][ip] = dmsh_old.aVec2[local2old[ip]];
+      aaFlgPnt[ifc][ip] = aFlgPntOld[local2old[ip]];
+    }
+  }
+}
+
+/**
+ * @brief move the mesh of a face following the displacement of its boundary
+ * @details the points inside are moved with the mean value coordinates of the boundary polygon as in "cad2_mesh_deformation.h".
+ * Only a face with a single loop is handled.
+ * @param[in,out] aVec2 points of the face in the local numbering. The boundary points come first.
+ * @param aVec2Global new coordinates of the points on the boundary
+ * @return false if the face cannot be deformed or a triangle is inverted
+ */
+DFM2_INLINE bool DeformFaceMesh(
+  std::vector<CVec2d> &aVec2,
+  const std::vector<CDynTri> &aETri,
+  const std::vector<unsigned int> &local2global,
+  unsigned int iface0,
+  const CadTopo &topo,
+  const std::vector<std::vector<std::pair<unsigned int, double> > > &edge_point,
+  const std::vector<CVec2d> &aVec2Global) {
+  if (topo.faces[iface0].aIL.size() != 1) { return false; }
+  const unsigned int il0 = topo.faces[iface0].aIL[0];
+  if (topo.loops[il0].iv != UINT_MAX) { return false; }
+  std::map<unsigned int, unsigned int> global2local;
+  for (unsigned int ip = 0; ip < local2global.size(); ++ip) { global2local.insert(std::make_pair(local2global[ip], ip)); }
+  std::vector<unsigned int> aIP_Loop; // boundary polygon in the local numbering
+  for (const auto &[ie, dir]: topo.loops[il0].aIE) {
+    aIP_Loop.push_back(topo.edges[ie].IndexVertex(dir));
+    const std::vector<std::pair<unsigned int, double> > &aPE = edge_point[ie];
+    for (unsigned int iie = 0; iie < aPE.size(); ++iie) {
+      aIP_Loop.push_back(dir ? aPE[iie].first : aPE[aPE.size() - 1 - iie].first);
+    }
+  }
+  for (unsigned int &ip: aIP_Loop) {
+    const auto itr = global2local.find(ip);
+    if (itr == global2local.end()) { return false; }
+    ip = itr->second;
+  }
+  if (aIP_Loop.size() != local2global.size()) { return false; }
+  const size_t nbound = aIP_Loop.size();
+  std::vector<double> aXY(nbound * 2), aDisp(nbound * 2);
+  for (unsigned int iip = 0; iip < nbound; ++iip) {
+    const unsigned int ip = aIP_Loop[iip];
+    const CVec2d &p1 = aVec2Global[local2global[ip]];
+    aXY[iip * 2 + 0] = aVec2[ip].x;
+    aXY[iip * 2 + 1] = aVec2[ip].y;
+    aDisp[iip * 2 + 0] = p1.x - aVec2[ip].x;
+    aDisp[iip * 2 + 1] = p1.y - aVec2[ip].y;
+  }
+  std::vector<double> aW(nbound);
+  for (size_t ip = nbound; ip < aVec2.size(); ++ip) {
+    MeanValueCoordinate_Polygon2<CVec2d>(aW.data(), aVec2[ip].x, aVec2[ip].y, aXY.data(), nbound);
+    double d[2] = {0., 0.};
+    for (unsigned int iip = 0; iip < nbound; ++iip) {
+      d[0] += aW[iip] * aDisp[iip * 2 + 0];
+      d[1] += aW[iip] * aDisp[iip * 2 + 1];
+    }
+    aVec2[ip].p[0] += d[0];
+    aVec2[ip].p[1] += d[1];
+  }
+  for (unsigned int ip = 0; ip < nbound; ++ip) { aVec2[ip] = aVec2Global[local2global[ip]]; }
+  for (const auto &tri: aETri) {
+    if (Area_Tri2(aVec2[tri.v[0]], aVec2[tri.v[1]], aVec2[tri.v[2]]) <= 0.) { return false; }
+  }
+  return true;
+}
+
+/**
+ * @brief put the meshes of the faces together in the order of the faces
+ * @details the points inside the faces are appended to "dmsh.aVec2" and the adjacency to the points is updated
+ */
+DFM2_INLINE void MergeFaceMesh(
+  CMeshDynTri2D &dmsh,
+  std::vector<unsigned int> &aFlgPnt,
+  std::vector<unsigned int> &aFlgTri,
+  std::vector<std::vector<CVec2d> > &aaVec2,
+  std::vector<std::vector<CDynTri> > &aaTri,
+  const std::vector<std::vector<unsigned int> > &aaLocal2Global,
+  const std::vector<std::vector<unsigned int> > &aaFlgPnt) {
+  aFlgTri.clear();
+  dmsh.aETri.clear();
+  for (unsigned int ifc = 0; ifc < aaVec2.size(); ++ifc) {
+    const std::vector<unsigned int> &local2global = aaLocal2Global[ifc];
+    const auto nbound = static_cast<unsigned int>(local2global.size());
+    const auto np0 = static_cast<unsigned int>(dmsh.aVec2.size());
+    for (unsigned int ip = nbound; ip < aaVec2[ifc].size(); ++ip) {
+      dmsh.aVec2.push_back(aaVec2[ifc][ip]);
+      aFlgPnt.push_back(aaFlgPnt[ifc][ip]);
+    }
+    const auto ntri0 = static_cast<unsigned int>(dmsh.aETri.size());
+    for (auto &tri: aaTri[ifc]) {
+      for (unsigned int inotri = 0; inotri < 3; ++inotri) {
+        const unsigned int ip = tri.v[inotri];
+        tri.v[inotri] = (ip < nbound) ? local2global[ip] : np0 + ip - nbound;
+        if (tri.s2[inotri] != UINT_MAX) { tri.s2[inotri] += ntri0; }
+      }
+      dmsh.aETri.push_back(tri);
+    }
+    aFlgTri.resize(dmsh.aETri.size(), ifc);
+  }
+  dmsh.aEPo.resize(dmsh.aVec2.size());
+  for (unsigned int it = 0; it < dmsh.aETri.size(); ++it) {
+    for (unsigned int inotri = 0; inotri < 3; ++inotri) {
+      dmsh.aEPo[dmsh.aETri[it].v[inotri]].e = it;
+      dmsh.aEPo[dmsh.aETri[it].v[inotri]].d = inotri;
+    }
+  }
+}
+
 } // delfem2::cad2
 
 // =========================================================
 
 DFM2_INLINE void delfem2::CMesher_Cad2D::Meshing(
   CMeshDynTri2D &dmsh,
-  const CCad2D &cad) {
+  const CCad2D &cad,
+  unsigned int num_thread) {
   std::vector<std::vector<double> > aaXYW(cad.nEdge());
-  for (unsigned int ie = 0; ie < cad.aEdge.size(); ++ie) {
-    unsigned int ndiv = 1;
-    if (edge_length > 0) {
-      if (this->mapIdEd_NDiv.find(ie) == this->mapIdEd_NDiv.end()) {
-        const double len0 = cad.aEdge[ie].ArcLength();
-        ndiv = static_cast<unsigned int>(len0 / edge_length + 1);
-      } else {
-        ndiv = this->mapIdEd_NDiv.find(ie)->second;
-      }
-    } else {
-      ndiv = 20;
-    }
+  auto mesh_edge = [&](unsigned int ie) {
+    const unsigned int ndiv = cad2_mesher::NumDivisionEdge(ie, cad, edge_length, mapIdEd_NDiv);
     aaXYW[ie] = cad.aEdge[ie].GenMesh(ndiv);
-  }
+  };
+  parallel_for_chunk(cad.aEdge.size(), 1, [&](size_t ie, size_t) {
+    mesh_edge(static_cast<unsigned int>(ie));
+  }, num_thread);
   //
   this->edge_point.resize(cad.aEdge.size());
   aFlgPnt.clear();
@@ -203,43 +462,174 @@ DFM2_INLINE void delfem2::CMesher_Cad2D::Meshing(
       aFlgPnt.push_back(static_cast<unsigned int>(cad.aVtx.size() + ie));
     }
   }
-  //
-  aFlgTri.clear();
-  for (unsigned int ifc = 0; ifc < cad.topo.faces.size(); ++ifc) { // add face to dmsh
-    std::vector<CDynTri> aDTri;
-    cad2_mesher::GenMeshCadFace(dmsh.aVec2, aDTri,
-                                ifc,
-                                cad.topo, cad.aVtx, cad.aEdge, edge_point);
-    const unsigned int ntri0 = static_cast<unsigned int>(dmsh.aETri.size());
-    for (auto &tri: aDTri) {
-      if (tri.s2[0] != UINT_MAX) { tri.s2[0] += ntri0; }
-      if (tri.s2[1] != UINT_MAX) { tri.s2[1] += ntri0; }
-      if (tri.s2[2] != UINT_MAX) { tri.s2[2] += ntri0; }
-      dmsh.aETri.push_back(tri);
+  // mesh each face independently. The faces only share the fixed points on their boundaries.
+  const size_t nface0 = cad.topo.faces.size();
+  std::vector<std::vector<CVec2d> > aaVec2(nface0);
+  std::vector<std::vector<CDynTri> > aaTri(nface0);
+  std::vector<std::vector<unsigned int> > aaLocal2Global(nface0), aaFlgPnt(nface0);
+  auto mesh_face = [&](unsigned int ifc) {
+    cad2_mesher::MeshCadFace(
+      aaVec2[ifc], aaTri[ifc], aaLocal2Global[ifc], aaFlgPnt[ifc],
+      ifc, cad, edge_point, dmsh.aVec2, aFlgPnt, edge_length);
+  };
+  if (num_thread == 1) {
+    for (unsigned int ifc = 0; ifc < nface0; ++ifc) { mesh_face(ifc); }
+  } else {
+    // the larger faces are started earlier for the load balance
+    std::vector<std::pair<double, unsigned int> > aAreaFace(nface0);
+    for (unsigned int ifc = 0; ifc < nface0; ++ifc) {
+      double bound_2d[4];
+      cad2_mesher::GetBound(bound_2d, ifc, cad.topo, cad.aEdge);
+      aAreaFace[ifc] = std::make_pair(-(bound_2d[1] - bound_2d[0]) * (bound_2d[3] - bound_2d[2]), ifc);
     }
-    aFlgTri.resize(dmsh.aETri.size(), ifc);
+    std::sort(aAreaFace.begin(), aAreaFace.end());
+    parallel_for(
+      static_cast<unsigned int>(nface0),
+      [&](unsigned int iifc) { mesh_face(aAreaFace[iifc].second); },
+      num_thread);
   }
-  { // make EPo
-    dmsh.aEPo.resize(dmsh.aVec2.size());
-    for (unsigned int it = 0; it < dmsh.aETri.size(); ++it) {
-      for (unsigned int inotri = 0; inotri < 3; ++inotri) {
-        dmsh.aEPo[dmsh.aETri[it].v[inotri]].e = it;
-        dmsh.aEPo[dmsh.aETri[it].v[inotri]].d = inotri;
+  // merge the faces in the order of the faces. The points inside the faces are numbered after the fixed points.
+  cad2_mesher::MergeFaceMesh(
+    dmsh, aFlgPnt, aFlgTri,
+    aaVec2, aaTri, aaLocal2Global, aaFlgPnt);
+  nvtx = cad.aVtx.size();
+  nedge = cad.aEdge.size();
+  nface = cad.topo.faces.size();
+}
+
+DFM2_INLINE void delfem2::CMesher_Cad2D::Remeshing(
+  std::vector<unsigned int> &new2old,
+  CMeshDynTri2D &dmsh,
+  const CCad2D &cad,
+  const std::vector<unsigned int> &aIdVtx_edited,
+  const std::vector<unsigned int> &aIdEdge_edited,
+  bool is_deform,
+  unsigned int num_thread) {
+  const size_t nvtx0 = cad.aVtx.size();
+  const size_t nedge0 = cad.aEdge.size();
+  const size_t nface0 = cad.topo.faces.size();
+  if (nvtx0 != nvtx || nedge0 != nedge || nface0 != nface || edge_point.size() != nedge0
+    || aFlgPnt.size() != dmsh.aVec2.size() || aFlgTri.size() != dmsh.aETri.size()) {
+    // the topology is changed or the mesh is not made by this mesher
+    Meshing(dmsh, cad, num_thread);
+    new2old.assign(dmsh.aVec2.size(), UINT_MAX);
+    return;
+  }
+  std::vector<int> aFlgEdge(nedge0, 0), aFlgFace(nface0, 0);
+  {
+    std::vector<int> aFlgVtx(nvtx0, 0);
+    for (unsigned int iv: aIdVtx_edited) { if (iv < nvtx0) { aFlgVtx[iv] = 1; }}
+    for (unsigned int ie: aIdEdge_edited) { if (ie < nedge0) { aFlgEdge[ie] = 1; }}
+    for (unsigned int ie = 0; ie < nedge0; ++ie) {
+      if (aFlgVtx[cad.topo.edges[ie].iv0] == 1 || aFlgVtx[cad.topo.edges[ie].iv1] == 1) { aFlgEdge[ie] = 1; }
+    }
+    for (unsigned int ifc = 0; ifc < nface0; ++ifc) {
+      for (unsigned int il: cad.topo.faces[ifc].aIL) {
+        const CadTopo_Loop &loop = cad.topo.loops[il];
+        if (loop.iv != UINT_MAX && aFlgVtx[loop.iv] == 1) { aFlgFace[ifc] = 1; }
+        for (const auto &iie: loop.aIE) {
+          if (aFlgEdge[iie.first] == 1) { aFlgFace[ifc] = 1; }
+        }
       }
     }
   }
-  if (edge_length > 1.0e-10) {
-    CInputTriangulation_Uniform param(1.0);
-    MeshingInside(
-      dmsh.aEPo, dmsh.aETri, dmsh.aVec2,
-      aFlgPnt, aFlgTri,
-      dmsh.aVec2.size(),
-      static_cast<unsigned int>(cad.aVtx.size() + cad.aEdge.size()),
-      edge_length, param);
+  std::vector<std::vector<double> > aaXYW(nedge0);
+  auto mesh_edge = [&](unsigned int ie) {
+    if (aFlgEdge[ie] == 0) { return; }
+    // keep the number of the points on the edge for the deformation
+    const unsigned int ndiv = is_deform ?
+                              static_cast<unsigned int>(edge_point[ie].size() + 1) :
+                              cad2_mesher::NumDivisionEdge(ie, cad, edge_length, mapIdEd_NDiv);
+    aaXYW[ie] = cad.aEdge[ie].GenMesh(ndiv);
+  };
+  parallel_for_chunk(nedge0, 1, [&](size_t ie, size_t) {
+    mesh_edge(static_cast<unsigned int>(ie));
+  }, num_thread);
+  // renumber the fixed points. The points on an edge keep their identity if the number of them does not change.
+  const CMeshDynTri2D dmsh_old = dmsh;
+  const std::vector<unsigned int> aFlgPntOld = aFlgPnt;
+  const std::vector<unsigned int> aFlgTriOld = aFlgTri;
+  std::vector<unsigned int> old2new(dmsh_old.aVec2.size(), UINT_MAX);
+  dmsh.Clear();
+  aFlgPnt.clear();
+  new2old.clear();
+  for (unsigned int iv = 0; iv < nvtx0; ++iv) {
+    dmsh.aVec2.push_back(cad.aVtx[iv].pos);
+    aFlgPnt.push_back(iv);
+    new2old.push_back(iv);
+    old2new[iv] = iv;
   }
-  nvtx = cad.aVtx.size();
-  nedge = cad.aEdge.size();
-  nface = cad.topo.faces.size();
+  for (unsigned int ie = 0; ie < nedge0; ++ie) {
+    const std::vector<std::pair<unsigned int, double> > aPE0 = edge_point[ie];
+    edge_point[ie].clear();
+    if (aFlgEdge[ie] == 0) {
+      for (const auto &pe0: aPE0) {
+        const auto ip = static_cast<unsigned int>(dmsh.aVec2.size());
+        dmsh.aVec2.push_back(dmsh_old.aVec2[pe0.first]);
+        edge_point[ie].push_back(std::make_pair(ip, pe0.second));
+        aFlgPnt.push_back(static_cast<unsigned int>(nvtx0 + ie));
+        new2old.push_back(pe0.first);
+        old2new[pe0.first] = ip;
+      }
+      continue;
+    }
+    const size_t np = aaXYW[ie].size() / 3;
+    for (unsigned int iep = 0; iep < np; ++iep) {
+      const auto ip = static_cast<unsigned int>(dmsh.aVec2.size());
+      dmsh.aVec2.push_back({aaXYW[ie][iep * 3 + 0], aaXYW[ie][iep * 3 + 1]});
+      edge_point[ie].push_back(std::make_pair(ip, aaXYW[ie][iep * 3 + 2]));
+      aFlgPnt.push_back(static_cast<unsigned int>(nvtx0 + ie));
+      if (np == aPE0.size()) {
+        new2old.push_back(aPE0[iep].first);
+        old2new[aPE0[iep].first] = ip;
+      } else {
+        new2old.push_back(UINT_MAX);
+      }
+    }
+  }
+  // the faces without edit are copied, the edited faces are deformed if possible and meshed otherwise.
+  std::vector<std::vector<CVec2d> > aaVec2(nface0);
+  std::vector<std::vector<CDynTri> > aaTri(nface0);
+  std::vector<std::vector<unsigned int> > aaLocal2Global(nface0), aaFlgPnt(nface0), aaIdPntOld(nface0);
+  std::vector<int> aFlgExtract(nface0, 0);
+  for (unsigned int ifc = 0; ifc < nface0; ++ifc) {
+    aFlgExtract[ifc] = (aFlgFace[ifc] == 0 || is_deform) ? 1 : 0;
+  }
+  cad2_mesher::ExtractFaceMesh(
+    aaVec2, aaTri, aaLocal2Global, aaFlgPnt, aaIdPntOld, aFlgExtract,
+    dmsh_old, aFlgTriOld, aFlgPntOld, old2new,
+    static_cast<unsigned int>(nvtx0 + nedge0));
+  auto mesh_face = [&](unsigned int ifc) {
+    if (aFlgExtract[ifc] == 1) {
+      if (aFlgFace[ifc] == 0) { return; }
+      if (cad2_mesher::DeformFaceMesh(
+        aaVec2[ifc], aaTri[ifc], aaLocal2Global[ifc],
+        ifc, cad.topo, edge_point, dmsh.aVec2)) { return; }
+    }
+    aaVec2[ifc].clear();
+    aaTri[ifc].clear();
+    aaIdPntOld[ifc].clear();
+    cad2_mesher::MeshCadFace(
+      aaVec2[ifc], aaTri[ifc], aaLocal2Global[ifc], aaFlgPnt[ifc],
+      ifc, cad, edge_point, dmsh.aVec2, aFlgPnt, edge_length);
+  };
+  parallel_for_chunk(nface0, 1, [&](size_t ifc, size_t) {
+    mesh_face(static_cast<unsigned int>(ifc));
+  }, num_thread);
+  for (unsigned int ifc = 0; ifc < nface0; ++ifc) {
+    const size_t nbound = aaLocal2Global[ifc].size();
+    const size_t nin = aaVec2[ifc].size() - nbound;
+    if (aaIdPntOld[ifc].empty()) {
+      new2old.resize(new2old.size() + nin, UINT_MAX);
+    } else {
+      assert(aaIdPntOld[ifc].size() == nin);
+      new2old.insert(new2old.end(), aaIdPntOld[ifc].begin(), aaIdPntOld[ifc].end());
+    }
+  }
+  cad2_mesher::MergeFaceMesh(
+    dmsh, aFlgPnt, aFlgTri,
+    aaVec2, aaTri, aaLocal2Global, aaFlgPnt);
+  assert(new2old.size() == dmsh.aVec2.size());
 }
 
 DFM2_INLINE std::vector<unsigned int>
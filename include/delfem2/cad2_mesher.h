@@ -29,9 +29,37 @@ class CMesher_Cad2D {
     nedge = 0;
     nface = 0;
   }
+  /**
+   * @details the edges are discretized first, and then the faces are meshed independently.
+   * The points inside the faces are numbered face by face after the points on the vertices and the edges.
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   * The mesh is independent of the number of threads.
+   */
   void Meshing(
       CMeshDynTri2D &dmesh,
-      const CCad2D &cad2d);
+      const CCad2D &cad2d,
+      unsigned int num_thread = 1);
+
+  /**
+   * @brief update the mesh after some of the vertices and the edges of "cad2d" are edited
+   * @details the topology of "cad2d" should be the same as that of the last meshing. Otherwise, the whole mesh is made again.
+   * The edges touching the edited vertices are discretized again, and only the faces around the edited edges are changed.
+   * Such a face is deformed with the mean value coordinates if it has a single loop and no triangle is inverted.
+   * Otherwise the face is meshed again. The other faces are kept as they are.
+   * @param[out] new2old map from the index of a new point to that of the previous mesh. UINT_MAX for the points newly made.
+   * @param[in,out] dmesh the mesh made by the last "Meshing" or "Remeshing"
+   * @param is_deform if true, the edited edges keep the numbers of their points so that the faces can be deformed.
+   * The size of the elements drifts after large edits, so call "Meshing" at the end of the interactive editing.
+   * If false, the edited edges are discretized with "edge_length" and the edited faces are always meshed again.
+   */
+  void Remeshing(
+      std::vector<unsigned int> &new2old,
+      CMeshDynTri2D &dmesh,
+      const CCad2D &cad2d,
+      const std::vector<unsigned int> &aIdVtx_edited,
+      const std::vector<unsigned int> &aIdEdge_edited,
+      bool is_deform = true,
+      unsigned int num_thread = 1);
 
   std::vector<unsigned int> IndPoint_IndEdgeArray(
       const std::vector<int> &aIndEd,
@@ -183,23 +183,24 @@ void MeanValueCoordinate_Polygon2(
     aW[iv1] = l0 / (l0 + l1);
     return;
   }
+  // the vector and the length to a vertex are reused for the two edges around it.
+  // tan(a/2) is computed as sin(a)/(1+cos(a)) to avoid the square roots.
   double sum = 0;
-  for (unsigned int ie = 0; ie < nv; ++ie) {
-    unsigned int iv0 = (ie + 0) % nv;
-    unsigned int iv1 = (ie + 1) % nv;
-    unsigned int iv2 = (ie + 2) % nv;
-    VEC v0(aXY[iv0 * 2 + 0] - px, aXY[iv0 * 2 + 1] - py);
-    VEC v1(aXY[iv1 * 2 + 0] - px, aXY[iv1 * 2 + 1] - py);
-    VEC v2(aXY[iv2 * 2 + 0] - px, aXY[iv2 * 2 + 1] - py);
-    double c01 = (v0.dot(v1)) / (v0.norm() * v1.norm());
-    double s01 = (Cross(v0, v1) > 0) ? 1 : -1;
-    double c12 = (v1.dot(v2)) / (v1.norm() * v2.norm());
-    double s12 = (Cross(v1, v2) > 0) ? 1 : -1;
-    double t01 = s01 * sqrt((1 - c01) / (1 + c01));
-    double t12 = s12 * sqrt((1 - c12) / (1 + c12));
-    double w1 = (t01 + t12) / v1.norm();
+  const VEC v0(aXY[(nv - 1) * 2 + 0] - px, aXY[(nv - 1) * 2 + 1] - py);
+  VEC v1(aXY[0] - px, aXY[1] - py);
+  double l1 = v1.norm();
+  double t01 = Cross(v0, v1) / (v0.norm() * l1 + v0.dot(v1));
+  for (unsigned int iv1 = 0; iv1 < nv; ++iv1) {
+    const unsigned int iv2 = (iv1 + 1) % nv;
+    const VEC v2(aXY[iv2 * 2 + 0] - px, aXY[iv2 * 2 + 1] - py);
+    const double l2 = v2.norm();
+    const double t12 = Cross(v1, v2) / (l1 * l2 + v1.dot(v2));
+    const double w1 = (t01 + t12) / l1;
     aW[iv1] = w1;
     sum += w1;
+    v1 = v2;
+    l1 = l2;
+    t01 = t12;
   }
   for (unsigned int iv = 0; iv < nv; ++iv) {
     aW[iv] /= sum;
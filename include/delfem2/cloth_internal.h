@@ -2,6 +2,7 @@
 #define CLOTH_INTERNAL_H
 
 #include "delfem2/ls_ilu_block_sparse.h"
+#include "delfem2/ls_ilu_block_sparse_lazy.h"
 #include "delfem2/ls_block_sparse.h"
 #include "delfem2/lsitrsol.h"
 #include "delfem2/view_vectorx.h"
@@ -175,12 +176,17 @@ void StepTime_InternalDynamics(
   for(unsigned int i=0;i<nDof;i++){ aUVW[i] = vec_x[i]/dt; }
 }
 
+/**
+ * @brief implicit time integration of the cloth preconditioned by ILU
+ * @details the factorization is reused across the time steps while it works well.
+ * "ilu_A" needs to be initialized with the pattern of "mat_A" and its statistics are in "ilu_A.stat"
+ */
 template <typename T0>
 void StepTime_InternalDynamicsILU(
     std::vector<T0>& aXYZ, // (in,out) deformed vertex positions
     std::vector<double>& aUVW, // (in,out) deformed vertex velocity
     delfem2::CMatrixSparse<double>& mat_A,
-    delfem2::CPreconditionerILU<double>& ilu_A,
+    delfem2::PreconditionerILU_Lazy<double>& ilu_A,
     //
     const std::vector<double>& aXYZ0,// (in) initial vertex positions
     const std::vector<int>& aBCFlag, // (in) boundary condition flag (0:free 1:fixed)
@@ -235,11 +241,10 @@ void StepTime_InternalDynamicsILU(
     if( aBCFlag[i] == 0 ) continue;
     vec_b[i] = 0;
   }
-  ilu_A.CopyValue(mat_A);
-  ilu_A.Decompose();
+  ilu_A.Update(mat_A);  // the factorization is reused while the matrix does not change much
   // solve linear system
-  double conv_ratio = 1.0e-4;
-  int iteration = 100;
+  const double conv_ratio = 1.0e-4;
+  const unsigned int iteration = 100;
   std::vector<double> vec_x(vec_b.size());
   {
     const std::size_t n = vec_b.size();
@@ -248,9 +253,13 @@ void StepTime_InternalDynamicsILU(
     auto vu = dfm2::ViewAsVectorXd(vec_x);
     auto vt = dfm2::ViewAsVectorXd(tmp0);
     auto vs = dfm2::ViewAsVectorXd(tmp1);
-    Solve_PCG(
+    const std::vector<double> conv = Solve_PCG(
         vr, vu, vt, vs,
         conv_ratio, iteration, mat_A, ilu_A);
+    const bool is_converged = conv.size() == 1 || conv.back() < conv_ratio * conv[0];
+    ilu_A.ReportLinearSolve(
+        is_converged ? static_cast<unsigned int>(conv.size() - 1) : iteration,
+        is_converged);
 //    Solve_CG(
 //        vr, vu, vt, vs,
 //        conv_ratio, iteration, mat_A);
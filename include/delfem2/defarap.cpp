@@ -471,9 +471,8 @@ void delfem2::Deformer_Arap::Init(
     LMi.CopyTo(precomp_.data() + ip * 9);
   }
 
-  this->precond_.Clear();
   if (is_preconditioner_) {
-    this->precond_.SetPattern0(sparse_);
+    this->precond_.Initialize(sparse_, 0);
   }
 
 }
@@ -518,14 +517,21 @@ void delfem2::Deformer_Arap::Deform(
   tmp_vec0_.resize(residual_.size());
   tmp_vec1_.resize(residual_.size());
   if (is_preconditioner_) {
-    this->precond_.CopyValue(sparse_);
-    this->precond_.Decompose();
+    const double conv_ratio_tol = 1.0e-7;
+    const unsigned int max_iteration = 300;
+    this->precond_.Update(sparse_);  // the factorization is reused while the matrix does not change much
     convergence_history = Solve_PCG(
         ViewAsVectorXd(residual_),
         ViewAsVectorXd(update_),
         ViewAsVectorXd(tmp_vec0_),
         ViewAsVectorXd(tmp_vec1_),
-        1.0e-7, 300, sparse_, precond_);
+        conv_ratio_tol, max_iteration, sparse_, precond_);
+    // Solve_PCG returns when the ratio falls below the tolerance, otherwise it runs "max_iteration" times
+    // and appends the final residual once more.
+    const bool is_converged = convergence_history.size() == 1
+        || convergence_history.back() < conv_ratio_tol * convergence_history[0];
+    const auto nitr = is_converged ? static_cast<unsigned int>(convergence_history.size() - 1) : max_iteration;
+    this->precond_.ReportLinearSolve(nitr, is_converged);
   } else {
     const std::size_t n = np * 3;
     assert(residual_.size() == n && update_.size() == n);
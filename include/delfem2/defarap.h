@@ -11,6 +11,7 @@
 
 #include "delfem2/dfm2_inline.h"
 #include "delfem2/ls_ilu_block_sparse.h"
+#include "delfem2/ls_ilu_block_sparse_lazy.h"
 
 // ---------------------------
 
@@ -140,6 +141,12 @@ class Deformer_Arap {
       std::vector<double> &vtx_quaternion,
       const std::vector<double> &vtx_xyz_ini,
       const std::vector<int> &aBCFlag);
+  /**
+   * @brief statistics of the factorization of the preconditioner which is reused across "Deform" calls
+   */
+  [[nodiscard]] const PreconditionerILU_Lazy<double>::Statistics &PreconditionerStatistics() const {
+    return precond_.stat;
+  }
  public:
   mutable std::vector<double> convergence_history;
   std::vector<unsigned int> psup_ind, psup;
@@ -150,7 +157,7 @@ class Deformer_Arap {
   std::vector<double> residual_, update_;
   std::vector<double> tmp_vec0_, tmp_vec1_;
   std::vector<unsigned int> tmp_buffer_for_merge_;
-  CPreconditionerILU<double> precond_;
+  PreconditionerILU_Lazy<double> precond_;
 };
 
 /**
@@ -12,8 +12,11 @@
 #include <iostream>
 #include <ctime>
 #include <cstdio>
+#include <cmath>
+#include <algorithm>
 
 #include "delfem2/dtet_v3.h"
+#include "delfem2/msh_reorder.h"
 
 namespace delfem2{
 namespace dtet{
@@ -84,38 +87,239 @@ const unsigned int sup2Noel5[nSupSwap5][nTriInSwap5][3] = {
 };
  */
 
-class CTriNew
-{
-public:
-  CTriNew(unsigned int it_old, unsigned int ift_old){
-    this->itet_old = it_old;
-    this->itfc_old = ift_old;
-    iold = UINT_MAX;
-    itet_new = UINT_MAX;
-    inew_sur[0] = UINT_MAX;
-    inew_sur[1] = UINT_MAX;
-    inew_sur[2] = UINT_MAX;
-  }
-public:
-  unsigned int itet_old; // tet index old
-  unsigned int itfc_old; // tet face index old
-  unsigned int v[3]; // vertex index
-  unsigned int inew_sur[3]; // adjacent index of CNew
-  unsigned int iold; // index of COld
-  unsigned int itet_new; // tet index new
+// ---------------------------------------
+// exact expansion arithmetic for the robust predicates
+// J. R. Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates", 1997
+
+constexpr double kEpsilon = 1.1102230246251565e-16; // 2^-53
+constexpr double kErrBoundOrient3D = (7.0 + 56.0 * kEpsilon) * kEpsilon;
+constexpr double kErrBoundInSphere = (16.0 + 224.0 * kEpsilon) * kEpsilon;
+
+/**
+ * non-overlapping components in the increasing order of the magnitude. The value is the sum of the first "n" components.
+ * The capacity "N" is bounded by the degree of the predicate, so that the expansion lives on the stack
+ */
+template<unsigned int N>
+struct Expansion {
+  double v[N];
+  unsigned int n = 0;
 };
 
-class CTetOld
-{
-public:
-  CTetOld(unsigned int it_old, const CDynTet& stet){
-    this->it_old = it_old;
-    this->stet = stet;
+inline void TwoSum(double a, double b, double &x, double &y) {
+  x = a + b;
+  const double bv = x - a;
+  const double av = x - bv;
+  y = (a - av) + (b - bv);
+}
+
+inline void FastTwoSum(double a, double b, double &x, double &y) {
+  x = a + b;
+  y = b - (x - a);
+}
+
+inline void TwoProduct(double a, double b, double &x, double &y) {
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+inline Expansion<2> ExpansionDiff(double a, double b) {
+  Expansion<2> h;
+  double x, y;
+  TwoSum(a, -b, x, y);
+  if (y != 0.0) { h.v[h.n++] = y; }
+  h.v[h.n++] = x;
+  return h;
+}
+
+inline Expansion<2> ExpansionProduct(double a, double b) {
+  Expansion<2> h;
+  double x, y;
+  TwoProduct(a, b, x, y);
+  if (y != 0.0) { h.v[h.n++] = y; }
+  h.v[h.n++] = x;
+  return h;
+}
+
+/**
+ * sum of the two expansions without the zero components (fast_expansion_sum_zeroelim).
+ * "h" needs the capacity of "ne+nf" and should not overlap with the inputs
+ * @return number of the components of "h"
+ */
+inline unsigned int ExpansionSum(
+    unsigned int ne, const double *e,
+    unsigned int nf, const double *f,
+    double *h) {
+  unsigned int ie = 0, jf = 0, nh = 0;
+  auto next = [&]() {  // merge in the increasing order of the magnitude
+    return (ie == ne || (jf < nf && std::fabs(f[jf]) < std::fabs(e[ie]))) ? f[jf++] : e[ie++];
+  };
+  double q = next();
+  for (unsigned int k = 1; k < ne + nf; ++k) {
+    double qnew, hh;
+    TwoSum(q, next(), qnew, hh);
+    q = qnew;
+    if (hh != 0.0) { h[nh++] = hh; }
   }
-public:
-  CDynTet stet;
-  unsigned int it_old;
-};
+  if (q != 0.0 || nh == 0) { h[nh++] = q; }
+  return nh;
+}
+
+/**
+ * product of the expansion and the scalar without the zero components (scale_expansion_zeroelim).
+ * "h" needs the capacity of "2*ne"
+ * @return number of the components of "h"
+ */
+inline unsigned int ExpansionScale(
+    unsigned int ne, const double *e,
+    double b,
+    double *h) {
+  unsigned int nh = 0;
+  double q, hh;
+  TwoProduct(e[0], b, q, hh);
+  if (hh != 0.0) { h[nh++] = hh; }
+  for (unsigned int i = 1; i < ne; ++i) {
+    double p1, p0, sum;
+    TwoProduct(e[i], b, p1, p0);
+    TwoSum(q, p0, sum, hh);
+    if (hh != 0.0) { h[nh++] = hh; }
+    FastTwoSum(p1, sum, q, hh);
+    if (hh != 0.0) { h[nh++] = hh; }
+  }
+  if (q != 0.0 || nh == 0) { h[nh++] = q; }
+  return nh;
+}
+
+template<unsigned int N, unsigned int M>
+Expansion<N + M> ExpansionSum(const Expansion<N> &e, const Expansion<M> &f) {
+  Expansion<N + M> h;
+  h.n = ExpansionSum(e.n, e.v, f.n, f.v, h.v);
+  return h;
+}
+
+template<unsigned int N>
+Expansion<2 * N> ExpansionScale(const Expansion<N> &e, double b) {
+  Expansion<2 * N> h;
+  h.n = ExpansionScale(e.n, e.v, b, h.v);
+  return h;
+}
+
+template<unsigned int N, unsigned int M>
+Expansion<2 * N * M> ExpansionProduct(const Expansion<N> &e, const Expansion<M> &f) {
+  Expansion<2 * N * M> h;
+  h.n = ExpansionScale(e.n, e.v, f.v[0], h.v);
+  for (unsigned int i = 1; i < f.n; ++i) {
+    double s[2 * N], t[2 * N * M];
+    const unsigned int ns = ExpansionScale(e.n, e.v, f.v[i], s);
+    h.n = ExpansionSum(h.n, h.v, ns, s, t);
+    std::copy(t, t + h.n, h.v);
+  }
+  return h;
+}
+
+template<unsigned int N>
+Expansion<N> ExpansionNegate(Expansion<N> e) {
+  for (unsigned int i = 0; i < e.n; ++i) { e.v[i] = -e.v[i]; }
+  return e;
+}
+
+inline int ExpansionSign(unsigned int ne, const double *e) {
+  const double v = e[ne - 1]; // the component with the largest magnitude
+  return (v > 0.0) ? 1 : ((v < 0.0) ? -1 : 0);
+}
+
+template<unsigned int N>
+int ExpansionSign(const Expansion<N> &e) {
+  return ExpansionSign(e.n, e.v);
+}
+
+//! a*(b*c-d*e) in the exact arithmetic
+inline Expansion<64> ExpansionMinor(
+    const Expansion<2> &a,
+    const Expansion<2> &b, const Expansion<2> &c,
+    const Expansion<2> &d, const Expansion<2> &e) {
+  return ExpansionProduct(
+      a,
+      ExpansionSum(ExpansionProduct(b, c), ExpansionNegate(ExpansionProduct(d, e))));
+}
+
+int Orient3DExact(
+    const CVec3d &p0,
+    const CVec3d &p1,
+    const CVec3d &p2,
+    const CVec3d &p3) {
+  const Expansion<2> ax = ExpansionDiff(p1.x, p0.x), ay = ExpansionDiff(p1.y, p0.y), az = ExpansionDiff(p1.z, p0.z);
+  const Expansion<2> bx = ExpansionDiff(p2.x, p0.x), by = ExpansionDiff(p2.y, p0.y), bz = ExpansionDiff(p2.z, p0.z);
+  const Expansion<2> cx = ExpansionDiff(p3.x, p0.x), cy = ExpansionDiff(p3.y, p0.y), cz = ExpansionDiff(p3.z, p0.z);
+  const Expansion<192> det = ExpansionSum(
+      ExpansionSum(
+          ExpansionMinor(ax, by, cz, bz, cy),
+          ExpansionMinor(ay, bz, cx, bx, cz)),
+      ExpansionMinor(az, bx, cy, by, cx));
+  return ExpansionSign(det);
+}
+
+/**
+ * exact sign of the determinant of Shewchuk's "insphere" (positive if e is inside when a-b-c-d has negative volume).
+ * The 5x5 determinant of the rows (x, y, z, x^2+y^2+z^2, 1) is expanded from the raw coordinates
+ * as in "insphereexact", since the translated coordinates need much longer expansions
+ */
+int InSphereExact(
+    const CVec3d &a,
+    const CVec3d &b,
+    const CVec3d &c,
+    const CVec3d &d,
+    const CVec3d &e) {
+  const CVec3d *p[5] = {&a, &b, &c, &d, &e};
+  auto minor2 = [&p](unsigned int i, unsigned int j) {  // columns x and y of the rows i and j
+    return ExpansionSum(ExpansionProduct(p[i]->x, p[j]->y), ExpansionProduct(-p[j]->x, p[i]->y));
+  };
+  auto minor3 = [&p, &minor2](unsigned int i, unsigned int j, unsigned int k) {  // columns x, y and z
+    return ExpansionSum(
+        ExpansionSum(ExpansionScale(minor2(j, k), p[i]->z), ExpansionScale(minor2(i, k), -p[j]->z)),
+        ExpansionScale(minor2(i, j), p[k]->z));
+  };
+  auto minor4 = [&minor3](unsigned int i, unsigned int j, unsigned int k, unsigned int l) {  // columns x, y, z and 1
+    return ExpansionSum(
+        ExpansionSum(minor3(i, k, l), minor3(i, j, k)),
+        ExpansionNegate(ExpansionSum(minor3(j, k, l), minor3(i, j, l))));
+  };
+  auto lift = [&p](const Expansion<96> &m, unsigned int i) {  // m*(x^2+y^2+z^2) of the row i
+    return ExpansionSum(
+        ExpansionSum(
+            ExpansionScale(ExpansionScale(m, p[i]->x), p[i]->x),
+            ExpansionScale(ExpansionScale(m, p[i]->y), p[i]->y)),
+        ExpansionScale(ExpansionScale(m, p[i]->z), p[i]->z));
+  };
+  // cofactor expansion along the column of x^2+y^2+z^2, accumulated in the two buffers alternately
+  double det[2][5 * 1152];
+  unsigned int ndet = 0;
+  for (unsigned int i = 0; i < 5; ++i) {
+    unsigned int j[4], nj = 0;
+    for (unsigned int k = 0; k < 5; ++k) {
+      if (k != i) { j[nj++] = k; }
+    }
+    const Expansion<96> m = minor4(j[0], j[1], j[2], j[3]);
+    const Expansion<1152> term = lift((i % 2 == 0) ? ExpansionNegate(m) : m, i);
+    if (i == 0) {
+      std::copy(term.v, term.v + term.n, det[0]);
+      ndet = term.n;
+    } else {
+      ndet = ExpansionSum(ndet, det[(i + 1) % 2], term.n, term.v, det[i % 2]);
+    }
+  }
+  return ExpansionSign(ndet, det[0]);
+}
+
+// ---------------------------------------
+
+/**
+ * hash of the undirected edge for the table of the edges on the cavity boundary
+ */
+inline unsigned int HashEdge(unsigned int i0, unsigned int i1) {
+  const unsigned int j0 = (i0 < i1) ? i0 : i1;
+  const unsigned int j1 = (i0 < i1) ? i1 : i0;
+  return (j0 * 0x9E3779B1u) ^ (j1 * 0x85EBCA77u);
+}
 
 /*
 bool Swap3Elared
@@ -1708,6 +1912,73 @@ bool delfem2::IsInsideCircumSphere(
   return sqrad > SquareDistance3(p,c)*4.0;
 }
 
+int delfem2::Orient3D(
+    const CVec3d& p0,
+    const CVec3d& p1,
+    const CVec3d& p2,
+    const CVec3d& p3)
+{
+  namespace lcl = ::delfem2::dtet;
+  const double ax = p1.x-p0.x, ay = p1.y-p0.y, az = p1.z-p0.z;
+  const double bx = p2.x-p0.x, by = p2.y-p0.y, bz = p2.z-p0.z;
+  const double cx = p3.x-p0.x, cy = p3.y-p0.y, cz = p3.z-p0.z;
+  const double det = ax*(by*cz-bz*cy) + ay*(bz*cx-bx*cz) + az*(bx*cy-by*cx);
+  const double permanent =
+      std::fabs(ax)*(std::fabs(by*cz)+std::fabs(bz*cy))
+      + std::fabs(ay)*(std::fabs(bz*cx)+std::fabs(bx*cz))
+      + std::fabs(az)*(std::fabs(bx*cy)+std::fabs(by*cx));
+  const double errbound = lcl::kErrBoundOrient3D * permanent;
+  if( det > errbound ){ return +1; }
+  if( -det > errbound ){ return -1; }
+  return lcl::Orient3DExact(p0,p1,p2,p3);
+}
+
+int delfem2::InSphere(
+    const CVec3d& p0,
+    const CVec3d& p1,
+    const CVec3d& p2,
+    const CVec3d& p3,
+    const CVec3d& p)
+{
+  namespace lcl = ::delfem2::dtet;
+  // Shewchuk's "insphere" is positive for the point inside the tetrahedron with the negative volume
+  const double aex = p0.x-p.x, aey = p0.y-p.y, aez = p0.z-p.z;
+  const double bex = p1.x-p.x, bey = p1.y-p.y, bez = p1.z-p.z;
+  const double cex = p2.x-p.x, cey = p2.y-p.y, cez = p2.z-p.z;
+  const double dex = p3.x-p.x, dey = p3.y-p.y, dez = p3.z-p.z;
+  const double aexbey = aex*bey, bexaey = bex*aey, ab = aexbey - bexaey;
+  const double bexcey = bex*cey, cexbey = cex*bey, bc = bexcey - cexbey;
+  const double cexdey = cex*dey, dexcey = dex*cey, cd = cexdey - dexcey;
+  const double dexaey = dex*aey, aexdey = aex*dey, da = dexaey - aexdey;
+  const double aexcey = aex*cey, cexaey = cex*aey, ac = aexcey - cexaey;
+  const double bexdey = bex*dey, dexbey = dex*bey, bd = bexdey - dexbey;
+  const double abc = aez*bc - bez*ac + cez*ab;
+  const double bcd = bez*cd - cez*bd + dez*bc;
+  const double cda = cez*da + dez*ac + aez*cd;
+  const double dab = dez*ab + aez*bd + bez*da;
+  const double alift = aex*aex + aey*aey + aez*aez;
+  const double blift = bex*bex + bey*bey + bez*bez;
+  const double clift = cex*cex + cey*cey + cez*cez;
+  const double dlift = dex*dex + dey*dey + dez*dez;
+  const double det = (dlift*abc - clift*dab) + (blift*cda - alift*bcd);
+  const double aezp = std::fabs(aez), bezp = std::fabs(bez), cezp = std::fabs(cez), dezp = std::fabs(dez);
+  const double abp = std::fabs(aexbey) + std::fabs(bexaey);
+  const double bcp = std::fabs(bexcey) + std::fabs(cexbey);
+  const double cdp = std::fabs(cexdey) + std::fabs(dexcey);
+  const double dap = std::fabs(dexaey) + std::fabs(aexdey);
+  const double acp = std::fabs(aexcey) + std::fabs(cexaey);
+  const double bdp = std::fabs(bexdey) + std::fabs(dexbey);
+  const double permanent =
+      (cdp*bezp + bdp*cezp + bcp*dezp)*alift
+      + (dap*cezp + acp*dezp + cdp*aezp)*blift
+      + (abp*dezp + bdp*aezp + dap*bezp)*clift
+      + (bcp*aezp + acp*bezp + abp*cezp)*dlift;
+  const double errbound = lcl::kErrBoundInSphere * permanent;
+  if( det > errbound ){ return -1; }
+  if( -det > errbound ){ return +1; }
+  return -lcl::InSphereExact(p0,p1,p2,p3,p);
+}
+
 bool delfem2::CheckTet
  (const std::vector<CDynTet>& aSTet,
   const std::vector<CDynPointTet>& aPo3D)
@@ -1811,183 +2082,153 @@ void delfem2::AddPointTetDelaunay(
     std::vector<CDynPointTet>& aPo3D,
     std::vector<CDynTet>& aSTet,
     std::vector<CVec3d>& aCent,
-    std::vector<int>& tmp_buffer)
+    CDelaunayTetWorkspace& workspace)
 {
+  namespace lcl = ::delfem2::dtet;
   assert( aSTet.size() == aCent.size() );
-  // ----------------------------------------
-  std::vector<dtet::CTriNew> aNew; // faces outside
-  std::vector<dtet::CTetOld> aOld;
-  {
-    tmp_buffer.resize(aSTet.size()*4, -1);
-    const CVec3d& p_ins = aPo3D[ip_ins].p;
-    std::stack< std::pair<unsigned int, unsigned int> > stackFace;
-    stackFace.push(std::make_pair(itet_ins, 0));
-    stackFace.push(std::make_pair(itet_ins, 1));
-    stackFace.push(std::make_pair(itet_ins, 2));
-    stackFace.push(std::make_pair(itet_ins, 3));
-    for (;;){
-      if (stackFace.empty()) break;
-      const unsigned int itet0 = stackFace.top().first;
-      const unsigned int itfc0 = stackFace.top().second;
-      stackFace.pop();
-      unsigned int iold0 = UINT_MAX;
-      {
-        if(      tmp_buffer[itet0*4+0] != -1 ){ iold0 = tmp_buffer[itet0*4+0]; }
-        else if( tmp_buffer[itet0*4+1] != -1 ){ iold0 = tmp_buffer[itet0*4+1]; }
-        else if( tmp_buffer[itet0*4+2] != -1 ){ iold0 = tmp_buffer[itet0*4+2]; }
-        else if( tmp_buffer[itet0*4+3] != -1 ){ iold0 = tmp_buffer[itet0*4+3]; }
-        else{
-          iold0 = static_cast<unsigned int>(aOld.size());
-          aOld.push_back(dtet::CTetOld(itet0,aSTet[itet0]));
-        }
-      }
-      if (tmp_buffer[itet0*4+itfc0]>=0) continue; // already examined
-      tmp_buffer[itet0*4+itfc0] = iold0;
-      //
-      const unsigned int jtet0 = aSTet[itet0].s[itfc0];
-      { // skip triangle jt0 if it is outside
-        bool is_out = false;
-        if (jtet0==UINT_MAX){ is_out = true; }
-        else if ( !IsInsideCircumSphere(p_ins,aSTet[jtet0],aCent[jtet0],aPo3D) ){ is_out = true; }
-        //
-        if (is_out){
-          dtet::CTriNew trinew(itet0, itfc0);
-          trinew.iold = iold0;
-          aNew.push_back(trinew);
-          continue;
-        }
-      }
-      // this is inside
-      int ift1 = noelTetFace[itfc0][0];
-      int ift2 = noelTetFace[itfc0][1];
-      int ift3 = noelTetFace[itfc0][2];
-      int irel0 = GetRelationshipTet( aSTet[itet0].v, aSTet[jtet0].v );
-      assert( irel0 >= 0 && irel0 < 12 );
-      const unsigned int jtf1 = tetRel[irel0][ift1];
-      const unsigned int jtf2 = tetRel[irel0][ift2];
-      const unsigned int jtf3 = tetRel[irel0][ift3];
-      stackFace.push(std::make_pair(jtet0, jtf1));
-      stackFace.push(std::make_pair(jtet0, jtf2));
-      stackFace.push(std::make_pair(jtet0, jtf3));
-    }
-#ifndef NDEBUG
-    { // assertion new is on the boundary
-      for (const auto & tetnew : aNew){
-        int it0 = tetnew.itet_old;
-        int ift0 = tetnew.itfc_old;
-        assert( IsInsideCircumSphere(p_ins,aSTet[it0],aCent[it0],aPo3D) );
-        const int jt0 = aSTet[it0].s[ift0];
-        if (jt0==-1) continue;
-        assert( !IsInsideCircumSphere(p_ins,aSTet[jt0],aCent[jt0],aPo3D) );
-      }
-    }
-#endif
+  assert( itet_ins < aSTet.size() && aSTet[itet_ins].isActive() );
+  if( workspace.tet_stamp.size() < aSTet.size() ){
+    workspace.tet_stamp.resize(aSTet.size(), 0);
+    workspace.tet_iold.resize(aSTet.size(), UINT_MAX);
   }
-  { // put vertex index new
-    for (auto & trinew : aNew){
-      const unsigned int itet0 = trinew.itet_old;
-      const unsigned int itfc0 = trinew.itfc_old;
-      const int ift1 = noelTetFace[itfc0][0];
-      const int ift2 = noelTetFace[itfc0][1];
-      const int ift3 = noelTetFace[itfc0][2];
-      trinew.v[0] = aSTet[itet0].v[ift1];
-      trinew.v[1] = aSTet[itet0].v[ift2];
-      trinew.v[2] = aSTet[itet0].v[ift3];
-    }
+  if( workspace.stamp == UINT_MAX ){ // the stamp overflows
+    std::fill(workspace.tet_stamp.begin(), workspace.tet_stamp.end(), 0);
+    workspace.stamp = 0;
   }
-#ifndef NDEBUG
-  { // assertion old is in, else is out
-    for(unsigned int it=0;it<aSTet.size();++it){
-      if( !aSTet[it].isActive() ) continue;
-      bool is_old = false;
-      for(auto & old : aOld){
-        if( it == old.it_old ){
-          is_old = true;
-          break;
+  const unsigned int stamp = ++workspace.stamp;
+  std::vector<unsigned int>& tet_stamp = workspace.tet_stamp;
+  std::vector<unsigned int>& tet_iold = workspace.tet_iold;
+  std::vector<unsigned int>& stack = workspace.stack;
+  std::vector<CDelaunayTetWorkspace::CTriNew>& aNew = workspace.aNew; // faces outside
+  std::vector<CDelaunayTetWorkspace::CTetOld>& aOld = workspace.aOld;
+  aNew.clear();
+  aOld.clear();
+  stack.clear();
+  const CVec3d& p_ins = aPo3D[ip_ins].p;
+  auto add_old = [&](unsigned int itet){
+    tet_stamp[itet] = stamp;
+    tet_iold[itet] = static_cast<unsigned int>(aOld.size());
+    aOld.push_back({aSTet[itet], itet});
+    stack.push_back(itet);
+  };
+  add_old(itet_ins);
+  for(;;){
+    while( !stack.empty() ){
+      const unsigned int itet0 = stack.back();
+      stack.pop_back();
+      for(unsigned int itfc0=0;itfc0<4;++itfc0){
+        const unsigned int jtet0 = aSTet[itet0].s[itfc0];
+        if( jtet0 != UINT_MAX && tet_stamp[jtet0] != stamp ){ // jtet0 is not examined yet
+          const CDynTet& tet = aSTet[jtet0];
+          if( InSphere(aPo3D[tet.v[0]].p, aPo3D[tet.v[1]].p, aPo3D[tet.v[2]].p, aPo3D[tet.v[3]].p, p_ins) > 0 ){
+            add_old(jtet0);
+            continue;
+          }
+          tet_stamp[jtet0] = stamp;
+          tet_iold[jtet0] = UINT_MAX;
         }
-      }
-      bool res = IsInsideCircumSphere(aPo3D[ip_ins].p, aSTet[it], aCent[it], aPo3D);
-      if( is_old != res ){
-        std::cout << it << " " << TetVolume(aSTet[it],aPo3D) << std::endl;
-        assert(is_old==res);
+        if( jtet0 != UINT_MAX && tet_iold[jtet0] != UINT_MAX ){ continue; } // jtet0 is inside
+        CDelaunayTetWorkspace::CTriNew trinew{};
+        trinew.itet_old = itet0;
+        trinew.itfc_old = itfc0;
+        trinew.iold = tet_iold[itet0];
+        trinew.itet_new = UINT_MAX;
+        for(unsigned int inotri=0;inotri<3;++inotri){
+          trinew.v[inotri] = aSTet[itet0].v[ noelTetFace[itfc0][inotri] ];
+          trinew.inew_sur[inotri] = UINT_MAX;
+        }
+        aNew.push_back(trinew);
       }
     }
+    // The inserted point needs to see all the faces of the cavity boundary from inside.
+    // This fails only for the degenerated (co-spherical) points, and the tetrahedra beyond such faces are added to the cavity.
+    bool is_star = true;
+    for(const auto& trinew : aNew){
+      const unsigned int jtet0 = aSTet[trinew.itet_old].s[trinew.itfc_old];
+      if( jtet0 == UINT_MAX ){ continue; }
+      if( Orient3D(p_ins, aPo3D[trinew.v[0]].p, aPo3D[trinew.v[1]].p, aPo3D[trinew.v[2]].p) > 0 ){ continue; }
+      if( tet_iold[jtet0] == UINT_MAX ){ add_old(jtet0); }
+      is_star = false;
+    }
+    if( is_star ){ break; }
+    aNew.erase(
+        std::remove_if(aNew.begin(), aNew.end(), [&](const CDelaunayTetWorkspace::CTriNew& trinew){
+          const unsigned int jtet0 = aSTet[trinew.itet_old].s[trinew.itfc_old];
+          return jtet0 != UINT_MAX && tet_iold[jtet0] != UINT_MAX; }),
+        aNew.end());
   }
-#endif
-  { // find adjancy of new
-    for (unsigned int itetnew = 0; itetnew<aNew.size(); ++itetnew){
-      for (int iedtri = 0; iedtri<3; ++iedtri){
-        const unsigned int i0 = aNew[itetnew].v[(iedtri+1)%3];
-        const unsigned int i1 = aNew[itetnew].v[(iedtri+2)%3];
-        aNew[itetnew].inew_sur[iedtri] = UINT_MAX;
-        for (unsigned int jtrinew = 0; jtrinew<aNew.size(); ++jtrinew){
-          for (int jedtri = 0; jedtri<3; ++jedtri){
-			if (itetnew == jtrinew && iedtri == jedtri) { continue; }
-            const unsigned int j0 = aNew[jtrinew].v[(jedtri+1)%3];
-            const unsigned int j1 = aNew[jtrinew].v[(jedtri+2)%3];
-            assert(i0!=j0||i1!=j1); // consistent face orientatoin
-            if ( i0==j1 && i1==j0 ){
-              aNew[itetnew].inew_sur[iedtri] = jtrinew;
-              break;
-            }
+  { // find adjancy of new with the hash table of the edges
+    unsigned int ntable = 16;
+    while( ntable < aNew.size()*6 ){ ntable *= 2; }
+    std::vector<unsigned int>& table = workspace.edge_table;
+    table.assign(ntable, UINT_MAX);
+    for (unsigned int inew = 0; inew<aNew.size(); ++inew){
+      for (unsigned int iedtri = 0; iedtri<3; ++iedtri){
+        const unsigned int i0 = aNew[inew].v[(iedtri+1)%3];
+        const unsigned int i1 = aNew[inew].v[(iedtri+2)%3];
+        for(unsigned int ih = lcl::HashEdge(i0,i1) & (ntable-1);;ih=(ih+1)&(ntable-1)){
+          const unsigned int ie = table[ih];
+          if( ie == UINT_MAX ){ // the opposite half is not visited yet
+            table[ih] = inew*3+iedtri;
+            break;
+          }
+          const unsigned int jnew = ie/3;
+          const unsigned int jedtri = ie%3;
+          const unsigned int j0 = aNew[jnew].v[(jedtri+1)%3];
+          const unsigned int j1 = aNew[jnew].v[(jedtri+2)%3];
+          assert(i0!=j0||i1!=j1); // consistent face orientatoin
+          if ( i0==j1 && i1==j0 ){
+            aNew[inew].inew_sur[iedtri] = jnew;
+            aNew[jnew].inew_sur[jedtri] = inew;
+            break;
           }
-          if ( aNew[itetnew].inew_sur[iedtri] != UINT_MAX ){ break; }
         }
-        assert( aNew[itetnew].inew_sur[iedtri] != UINT_MAX );
       }
     }
 #ifndef NDEBUG
-    {// assertion relations between news
-      for (size_t inew=0; inew<aNew.size(); ++inew){
-        for (int iedtri=0; iedtri<3; ++iedtri){
-          const unsigned int iv0 = aNew[inew].v[(iedtri+1)%3];
-          const unsigned int iv1 = aNew[inew].v[(iedtri+2)%3];
-          const unsigned int jtrinew = aNew[inew].inew_sur[iedtri];
-          assert( jtrinew < aNew.size() );
-          int jedtri = 0;
-          for(; jedtri<3; ++jedtri){
-            if(aNew[jtrinew].inew_sur[jedtri]==inew){ break; }
-          }
-          assert( jedtri != 3 );
-          const unsigned int jv0 = aNew[jtrinew].v[(jedtri+1)%3];
-          const unsigned int jv1 = aNew[jtrinew].v[(jedtri+2)%3];
-          assert(iv0==jv1&&iv1==jv0);
-        }
-      }
+    for (const auto& trinew : aNew){
+      assert( trinew.inew_sur[0] < aNew.size() );
+      assert( trinew.inew_sur[1] < aNew.size() );
+      assert( trinew.inew_sur[2] < aNew.size() );
     }
 #endif
   } // end of find adjacency
 
   { // set CNew.itet_new
-    const unsigned int ntet_old = static_cast<unsigned int>(aOld.size());
-    const unsigned int ntet_new = static_cast<unsigned int>(aNew.size());
-    if (ntet_new >= ntet_old) {
-      aSTet.resize(aSTet.size() + ntet_new - ntet_old);
-      aCent.resize(aCent.size() + ntet_new - ntet_old);
-      for (unsigned int it = 0; it < ntet_old; ++it) {
-        aNew[it].itet_new = aOld[it].it_old;
-      }
-      for (unsigned int it = 0; it < ntet_new - ntet_old; ++it) {
-        aNew[it + ntet_old].itet_new = (int) aSTet.size() - (ntet_new - ntet_old) + it;
-      }
+    const size_t ntet_old = aOld.size();
+    const size_t ntet_new = aNew.size();
+    for (unsigned int it = 0; it < ntet_old && it < ntet_new; ++it) {
+      aNew[it].itet_new = aOld[it].it_old;
     }
-    else {
-      //    std::cout<<"ntet_cur:"<<aSTet.size()<<"  ntet_del:"<<ntet_old<<"  ntet_new:"<<ntet_new<<std::endl;
-      for (unsigned int it = 0; it < ntet_new; ++it) {
-        aNew[it].itet_new = aOld[it].it_old;
+    for (size_t it = ntet_old; it < ntet_new; ++it) { // recycle the inactive tetrahedra
+      unsigned int itet = UINT_MAX;
+      while( !workspace.tet_free.empty() ){
+        const unsigned int jtet = workspace.tet_free.back();
+        workspace.tet_free.pop_back();
+        if( jtet < aSTet.size() && !aSTet[jtet].isActive() ){
+          itet = jtet;
+          break;
+        }
       }
-      for (unsigned int it = 0; it < ntet_old - ntet_new; ++it) {
-        unsigned int it0 = aOld[it + ntet_new].it_old;
-        // inactivate unused tetrahedron
-        aSTet[it0].v[0] = UINT_MAX;
-        aSTet[it0].v[1] = UINT_MAX;
-        aSTet[it0].v[2] = UINT_MAX;
-        aSTet[it0].v[3] = UINT_MAX;
-        aSTet[it0].s[0] = UINT_MAX;
-        aSTet[it0].s[1] = UINT_MAX;
-        aSTet[it0].s[2] = UINT_MAX;
-        aSTet[it0].s[3] = UINT_MAX;
+      if( itet == UINT_MAX ){
+        itet = static_cast<unsigned int>(aSTet.size());
+        aSTet.resize(aSTet.size()+1);
+        aCent.resize(aCent.size()+1);
       }
+      aNew[it].itet_new = itet;
+    }
+    for (size_t it = ntet_new; it < ntet_old; ++it) {
+      const unsigned int it0 = aOld[it].it_old;
+      // inactivate unused tetrahedron
+      aSTet[it0].v[0] = UINT_MAX;
+      aSTet[it0].v[1] = UINT_MAX;
+      aSTet[it0].v[2] = UINT_MAX;
+      aSTet[it0].v[3] = UINT_MAX;
+      aSTet[it0].s[0] = UINT_MAX;
+      aSTet[it0].s[1] = UINT_MAX;
+      aSTet[it0].s[2] = UINT_MAX;
+      aSTet[it0].s[3] = UINT_MAX;
+      workspace.tet_free.push_back(it0);
     }
   }
 
@@ -1995,16 +2236,13 @@ void delfem2::AddPointTetDelaunay(
   for (unsigned int inew = 0; inew<aNew.size(); ++inew){
     const unsigned int it_new = aNew[inew].itet_new;
     assert(it_new<aSTet.size());
-    int iold = aNew[inew].iold;
+    const unsigned int iold = aNew[inew].iold;
     const CDynTet& tet_old = aOld[iold].stet;
     const unsigned int ift0 = aNew[inew].itfc_old;
-    const int ift1 = noelTetFace[ift0][0];
-    const int ift2 = noelTetFace[ift0][1];
-    const int ift3 = noelTetFace[ift0][2];
     aSTet[it_new].v[0] = ip_ins;
-    aSTet[it_new].v[1] = tet_old.v[ift1]; assert(tet_old.v[ift1]==aNew[inew].v[0]);
-    aSTet[it_new].v[2] = tet_old.v[ift2]; assert(tet_old.v[ift2]==aNew[inew].v[1]);
-    aSTet[it_new].v[3] = tet_old.v[ift3]; assert(tet_old.v[ift3]==aNew[inew].v[2]);
+    aSTet[it_new].v[1] = aNew[inew].v[0];
+    aSTet[it_new].v[2] = aNew[inew].v[1];
+    aSTet[it_new].v[3] = aNew[inew].v[2];
     { // make relation 0 face
       const unsigned int jt0 = tet_old.s[ift0];
       aSTet[it_new].s[0] = jt0;
@@ -2015,73 +2253,161 @@ void delfem2::AddPointTetDelaunay(
         aSTet[jt0].s[jft0] = it_new;
       }
     }
-    { // make relation 1 face
-      const unsigned int jnew = aNew[inew].inew_sur[0];
-      assert( jnew<aNew.size() );
-      aSTet[it_new].s[1] = aNew[jnew].itet_new;
-    }
-    { // make relation 2 face
-      const unsigned int jnew = aNew[inew].inew_sur[1];
-      assert( jnew<aNew.size() );
-      aSTet[it_new].s[2] = aNew[jnew].itet_new;
-    }
-    { // make relation 2 face
-      const unsigned int jnew = aNew[inew].inew_sur[2];
-      assert( jnew<aNew.size() );
-      aSTet[it_new].s[3] = aNew[jnew].itet_new;
-    }
-#ifndef NDEBUG
-    { // assert volume is positive
-      const unsigned int i0 = aSTet[it_new].v[0];
-      const unsigned int i1 = aSTet[it_new].v[1];
-      const unsigned int i2 = aSTet[it_new].v[2];
-      const unsigned int i3 = aSTet[it_new].v[3];
-      const delfem2::CVec3d& p0 = aPo3D[i0].p;
-      const CVec3d& p1 = aPo3D[i1].p;
-      const CVec3d& p2 = aPo3D[i2].p;
-      const CVec3d& p3 = aPo3D[i3].p;
-      double vol = Volume_Tet(p0, p1, p2, p3);
-      assert(vol>1.0e-10);
-//      std::cout<<"   inew:" << inew << "  it_new:" << it_new<<" "<<vol<<"  "<< i0 << " " << i1<<" "<<i2<< " " << i3<<std::endl;
-    }
-#endif
-    {
-      const unsigned int i0 = aSTet[it_new].v[0];
-      const unsigned int i1 = aSTet[it_new].v[1];
-      const unsigned int i2 = aSTet[it_new].v[2];
-      const unsigned int i3 = aSTet[it_new].v[3];
-      aCent[it_new] = CircumCenter(aPo3D[i0].p,aPo3D[i1].p,aPo3D[i2].p,aPo3D[i3].p);
-    }
+    aSTet[it_new].s[1] = aNew[ aNew[inew].inew_sur[0] ].itet_new;
+    aSTet[it_new].s[2] = aNew[ aNew[inew].inew_sur[1] ].itet_new;
+    aSTet[it_new].s[3] = aNew[ aNew[inew].inew_sur[2] ].itet_new;
+    const CVec3d& p0 = aPo3D[aSTet[it_new].v[0]].p;
+    const CVec3d& p1 = aPo3D[aSTet[it_new].v[1]].p;
+    const CVec3d& p2 = aPo3D[aSTet[it_new].v[2]].p;
+    const CVec3d& p3 = aPo3D[aSTet[it_new].v[3]].p;
+    assert( Orient3D(p0, p1, p2, p3) > 0 );
+    aCent[it_new] = CircumCenter(p0,p1,p2,p3);
   }
 
   for (auto & trinew : aNew){
-    int it_new = trinew.itet_new;
-    for (int ivtet = 0; ivtet<4; ++ivtet){
-      int ip = aSTet[it_new].v[ivtet];
+    const unsigned int it_new = trinew.itet_new;
+    for (unsigned int ivtet = 0; ivtet<4; ++ivtet){
+      const unsigned int ip = aSTet[it_new].v[ivtet];
       aPo3D[ip].e = it_new;
       aPo3D[ip].poel = ivtet;
     }
   }
-  
-#ifndef NDEBUG
-  for(unsigned int ip=0;ip<aPo3D.size();ip++){
-    if( aPo3D[ip].e == UINT_MAX ){ continue; }
-    if( aPo3D[ip].e >= aSTet.size() ){
-      std::cout << aPo3D[ip].e << " " << aSTet.size() << "   " << ip << " " << aPo3D.size() << std::endl;
+}
+
+unsigned int delfem2::LocatePointTet(
+    const CVec3d& p,
+    unsigned int itet_start,
+    const std::vector<CDynPointTet>& aPo3D,
+    const std::vector<CDynTet>& aSTet)
+{
+  // p is on the same side of the face "ifc" as the tetrahedron "itet"
+  auto is_inside_face = [&](unsigned int itet, unsigned int ifc){
+    const CDynTet& tet = aSTet[itet];
+    return Orient3D(
+        p,
+        aPo3D[tet.v[noelTetFace[ifc][0]]].p,
+        aPo3D[tet.v[noelTetFace[ifc][1]]].p,
+        aPo3D[tet.v[noelTetFace[ifc][2]]].p) >= 0;
+  };
+  unsigned int itet = itet_start;
+  if( itet >= aSTet.size() || !aSTet[itet].isActive() ){
+    for(itet=0;itet<aSTet.size();++itet){
+      if( aSTet[itet].isActive() ){ break; }
     }
-    assert( aPo3D[ip].e < aSTet.size() );
-    assert( aPo3D[ip].poel < 4 );
-    assert( aSTet[ aPo3D[ip].e ].v[ aPo3D[ip].poel ] == ip );
+    if( itet == aSTet.size() ){ return UINT_MAX; }
   }
-#endif
-
+  // the visibility walk terminates on the Delaunay tetrahedralization.
+  for(size_t istep=0;istep<aSTet.size();++istep){
+    unsigned int ifc = 0;
+    for(;ifc<4;++ifc){
+      const unsigned int jfc = (ifc+istep)%4; // rotate the first face to be examined
+      if( is_inside_face(itet,jfc) ){ continue; }
+      itet = aSTet[itet].s[jfc];
+      break;
+    }
+    if( ifc == 4 ){ return itet; }
+    if( itet == UINT_MAX ){ return UINT_MAX; }
+  }
+  for(itet=0;itet<aSTet.size();++itet){ // the walk did not terminate (non-Delaunay tetrahedralization)
+    if( !aSTet[itet].isActive() ){ continue; }
+    if( is_inside_face(itet,0) && is_inside_face(itet,1) && is_inside_face(itet,2) && is_inside_face(itet,3) ){ return itet; }
+  }
+  return UINT_MAX;
+}
 
-  for (auto & iold : aOld){
-    const int it0 = iold.it_old;
-    tmp_buffer[it0*4+0] = -1;
-    tmp_buffer[it0*4+1] = -1;
-    tmp_buffer[it0*4+2] = -1;
-    tmp_buffer[it0*4+3] = -1;
+void delfem2::MeshingTetDelaunay(
+    std::vector<CDynPointTet>& aPo3D,
+    std::vector<CDynTet>& aSTet,
+    std::vector<CVec3d>& aCent,
+    const double* xyz,
+    size_t num_point)
+{
+  constexpr double kSizeEnclosingTet = 1.0e+6;
+  aPo3D.clear();
+  aSTet.clear();
+  aCent.clear();
+  if( num_point == 0 ){ return; }
+  const auto np = static_cast<unsigned int>(num_point);
+  aPo3D.reserve(num_point+4);
+  CVec3d bbmin(xyz[0], xyz[1], xyz[2]);
+  CVec3d bbmax = bbmin;
+  for(unsigned int ip=0;ip<np;++ip){
+    aPo3D.emplace_back(xyz[ip*3+0], xyz[ip*3+1], xyz[ip*3+2]);
+    for(unsigned int idim=0;idim<3;++idim){
+      bbmin[idim] = std::min(bbmin[idim], xyz[ip*3+idim]);
+      bbmax[idim] = std::max(bbmax[idim], xyz[ip*3+idim]);
+    }
+  }
+  { // large tetrahedron enclosing the points
+    const CVec3d c = (bbmin + bbmax) * 0.5;
+    double len = std::max(bbmax.x-bbmin.x, std::max(bbmax.y-bbmin.y, bbmax.z-bbmin.z));
+    if( len == 0.0 ){ len = 1.0; }
+    const double r = len * kSizeEnclosingTet;
+    aPo3D.emplace_back(c.x+r, c.y+r, c.z+r);
+    aPo3D.emplace_back(c.x-r, c.y-r, c.z+r);
+    aPo3D.emplace_back(c.x-r, c.y+r, c.z-r);
+    aPo3D.emplace_back(c.x+r, c.y-r, c.z-r);
+    CDynTet tet{};
+    for(unsigned int i=0;i<4;++i){
+      tet.v[i] = np+i;
+      tet.s[i] = UINT_MAX;
+    }
+    assert( Orient3D(aPo3D[np].p, aPo3D[np+1].p, aPo3D[np+2].p, aPo3D[np+3].p) > 0 );
+    aSTet.push_back(tet);
+    aCent.push_back(CircumCenter(aPo3D[np].p, aPo3D[np+1].p, aPo3D[np+2].p, aPo3D[np+3].p));
+    for(unsigned int i=0;i<4;++i){
+      aPo3D[np+i].e = 0;
+      aPo3D[np+i].poel = i;
+    }
+  }
+  {
+    std::vector<unsigned int> new2old;
+    Permutation_BRIO3(new2old, xyz, num_point);
+    CDelaunayTetWorkspace workspace;
+    unsigned int itet_hint = 0;
+    for(unsigned int ip_ins : new2old){
+      const CVec3d& p = aPo3D[ip_ins].p;
+      const unsigned int itet = LocatePointTet(p, itet_hint, aPo3D, aSTet);
+      assert( itet < aSTet.size() );
+      bool is_coincident = false;
+      for(unsigned int ivtx : aSTet[itet].v){
+        const CVec3d& q = aPo3D[ivtx].p;
+        if( q.x == p.x && q.y == p.y && q.z == p.z ){ is_coincident = true; }
+      }
+      if( is_coincident ){ continue; }
+      AddPointTetDelaunay(ip_ins, itet, aPo3D, aSTet, aCent, workspace);
+      itet_hint = aPo3D[ip_ins].e;
+    }
+  }
+  { // remove the tetrahedra touching the enclosing tetrahedron
+    std::vector<unsigned int> old2new(aSTet.size(), UINT_MAX);
+    unsigned int ntet = 0;
+    for(unsigned int it=0;it<aSTet.size();++it){
+      const CDynTet& tet = aSTet[it];
+      if( !tet.isActive() ){ continue; }
+      if( tet.v[0] >= np || tet.v[1] >= np || tet.v[2] >= np || tet.v[3] >= np ){ continue; }
+      old2new[it] = ntet++;
+    }
+    for(unsigned int it=0;it<aSTet.size();++it){
+      const unsigned int jt = old2new[it];
+      if( jt == UINT_MAX ){ continue; }
+      aSTet[jt] = aSTet[it];
+      aCent[jt] = aCent[it];
+      for(unsigned int ifc=0;ifc<4;++ifc){
+        const unsigned int kt = aSTet[jt].s[ifc];
+        aSTet[jt].s[ifc] = (kt == UINT_MAX) ? UINT_MAX : old2new[kt];
+      }
+    }
+    aSTet.resize(ntet);
+    aCent.resize(ntet);
+  }
+  aPo3D.resize(num_point);
+  for(auto& po : aPo3D){ po.e = UINT_MAX; }
+  for(unsigned int it=0;it<aSTet.size();++it){
+    for(unsigned int ino=0;ino<4;++ino){
+      aPo3D[aSTet[it].v[ino]].e = it;
+      aPo3D[aSTet[it].v[ino]].poel = ino;
+    }
   }
 }
 
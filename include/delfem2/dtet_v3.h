@@ -324,6 +324,28 @@ bool IsInsideCircumSphere(
     const delfem2::CVec3d &c,
     const std::vector<CDynPointTet> &aPo3D);
 
+/**
+ * @brief sign of the volume of the tetrahedron p0-p1-p2-p3 (+1, 0 or -1) without the round-off error
+ * @details the floating point determinant is used if it is larger than its error bound (Shewchuk's filter).
+ * Otherwise, the determinant is evaluated with the exact expansion arithmetic.
+ */
+int Orient3D(
+    const CVec3d &p0,
+    const CVec3d &p1,
+    const CVec3d &p2,
+    const CVec3d &p3);
+
+/**
+ * @brief +1 if p is inside the circumsphere of the tetrahedron p0-p1-p2-p3 with positive volume, 0 on the sphere, -1 outside
+ * @details filtered and exact in the same way as "Orient3D"
+ */
+int InSphere(
+    const CVec3d &p0,
+    const CVec3d &p1,
+    const CVec3d &p2,
+    const CVec3d &p3,
+    const CVec3d &p);
+
 /*
 //! ６面体要素構造体
 struct SHex{
@@ -502,8 +524,53 @@ bool AddPointTet_Edge
  */
 
 /**
- * @breaf Add point inside tetrahedra and maintain delaunay
- * @param tmp_buffer should be an array of -1. (if input values are all -1, then output values are -1)
+ * @brief buffers of "AddPointTetDelaunay" reused for the insertion of many points
+ * @details The tetrahedra visited in the cavity search are marked with the stamp of the insertion,
+ * so the marks are never cleared. The tetrahedra deleted by the insertion are kept in "tet_free"
+ * and recycled before the arrays of the tetrahedra are extended.
+ * Call "Clear()" if the tetrahedra are edited by other functions between the insertions.
+ */
+class CDelaunayTetWorkspace {
+ public:
+  //! face on the boundary of the cavity, which makes a new tetrahedron with the inserted point
+  class CTriNew {
+   public:
+    unsigned int itet_old; // tet index old
+    unsigned int itfc_old; // tet face index old
+    unsigned int v[3]; // vertex index
+    unsigned int inew_sur[3]; // adjacent index of CNew
+    unsigned int iold; // index of COld
+    unsigned int itet_new; // tet index new
+  };
+  //! tetrahedron inside the cavity
+  class CTetOld {
+   public:
+    CDynTet stet;
+    unsigned int it_old;
+  };
+ public:
+  void Clear() {
+    stamp = 0;
+    tet_stamp.clear();
+    tet_iold.clear();
+    tet_free.clear();
+  }
+ public:
+  unsigned int stamp = 0;
+  std::vector<unsigned int> tet_stamp; //!< stamp of the insertion which visited the tetrahedron
+  std::vector<unsigned int> tet_iold; //!< index of "aOld" or UINT_MAX if the tetrahedron is outside the cavity
+  std::vector<unsigned int> tet_free; //!< inactive tetrahedra
+  std::vector<unsigned int> stack; //!< tetrahedra inside the cavity to be expanded
+  std::vector<CTriNew> aNew;
+  std::vector<CTetOld> aOld;
+  std::vector<unsigned int> edge_table; //!< hash table of the edges of "aNew" (inew*3+iedtri)
+};
+
+/**
+ * @brief Add point inside tetrahedra and maintain delaunay
+ * @details The tetrahedra whose circumsphere contains the point are replaced by the tetrahedra connecting the point
+ * and the boundary of the cavity. The cost is proportional to the size of the cavity.
+ * @param itet_ins tetrahedron including the point
  */
 void AddPointTetDelaunay(
     unsigned int ip_ins,
@@ -511,7 +578,34 @@ void AddPointTetDelaunay(
     std::vector<CDynPointTet> &aPo3D,
     std::vector<CDynTet> &aSTet,
     std::vector<CVec3d> &aCent,
-    std::vector<int> &tmp_buffer);
+    CDelaunayTetWorkspace &workspace);
+
+/**
+ * @brief find the tetrahedron including the point by the walk from the tetrahedron "itet_start"
+ * @return index of the tetrahedron or UINT_MAX if the point is outside the mesh
+ */
+unsigned int LocatePointTet(
+    const CVec3d &p,
+    unsigned int itet_start,
+    const std::vector<CDynPointTet> &aPo3D,
+    const std::vector<CDynTet> &aSTet);
+
+/**
+ * @brief Delaunay tetrahedralization of the points
+ * @details The points are inserted in the BRIO order into a large tetrahedron enclosing them,
+ * and each point is located by the walk from the tetrahedron of the previously inserted point.
+ * The tetrahedra touching the enclosing tetrahedron are removed at the end.
+ * The coincident points are not inserted and their "e" is UINT_MAX.
+ * @param[out] aPo3D points with the coordinates of "xyz"
+ * @param[out] aSTet tetrahedra without the inactive ones
+ * @param[out] aCent circumcenters of the tetrahedra
+ */
+void MeshingTetDelaunay(
+    std::vector<CDynPointTet> &aPo3D,
+    std::vector<CDynTet> &aSTet,
+    std::vector<CVec3d> &aCent,
+    const double *xyz,
+    size_t num_point);
 
 
 /*
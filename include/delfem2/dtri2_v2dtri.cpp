@@ -8,10 +8,12 @@
 #include "delfem2/dtri2_v2dtri.h"
 
 #include <set>
+#include <cmath>
 #include <algorithm>
 #include <climits>
 
 #include "delfem2/geo_polygon2.h"
+#include "delfem2/msh_reorder.h"
 
 // ===========================================
 // unexposed functions
@@ -40,6 +42,113 @@ DFM2_INLINE bool LaplacianArroundPoint
   return true;
 }
 
+/**
+ * @brief check if the point can be inserted in the triangle or on its edge
+ * @param[out] iedge edge where the point is inserted. UINT_MAX if the point is inside the triangle
+ * @return 0: can not be inserted, 1: can be inserted, 2: the point is on the outer boundary and should not be inserted
+ */
+DFM2_INLINE int CheckInsertion_Tri(
+    unsigned int &iedge,
+    unsigned int itri,
+    const CVec2d &po_add,
+    const std::vector<CDynTri> &aTri,
+    const std::vector<CVec2d> &aVec2,
+    double MIN_TRI_AREA) {
+  iedge = UINT_MAX;
+  int iflg1 = 0, iflg2 = 0;
+  if (Area_Tri2(po_add, aVec2[aTri[itri].v[1]], aVec2[aTri[itri].v[2]]) > MIN_TRI_AREA) {
+    iflg1++;
+    iflg2 += 0;
+  }
+  if (Area_Tri2(po_add, aVec2[aTri[itri].v[2]], aVec2[aTri[itri].v[0]]) > MIN_TRI_AREA) {
+    iflg1++;
+    iflg2 += 1;
+  }
+  if (Area_Tri2(po_add, aVec2[aTri[itri].v[0]], aVec2[aTri[itri].v[1]]) > MIN_TRI_AREA) {
+    iflg1++;
+    iflg2 += 2;
+  }
+  if (iflg1 == 3) { return 1; } // add in triangle
+  if (iflg1 != 2) { return 0; }
+  // add in edge
+  const unsigned int ied0 = 3 - iflg2;
+  const unsigned int ipo_e0 = aTri[itri].v[(ied0 + 1) % 3];
+  const unsigned int ipo_e1 = aTri[itri].v[(ied0 + 2) % 3];
+  const unsigned int itri_s = aTri[itri].s2[ied0];
+  if (itri_s == UINT_MAX) { return 2; }
+  const unsigned int jno0 = FindAdjEdgeIndex(aTri[itri], ied0, aTri);
+  assert(aTri[itri_s].v[(jno0 + 2) % 3] == ipo_e0);
+  assert(aTri[itri_s].v[(jno0 + 1) % 3] == ipo_e1);
+  const unsigned int inoel_d = jno0;
+  assert(aTri[itri_s].s2[inoel_d] == itri);
+  const unsigned int ipo_d = aTri[itri_s].v[inoel_d];
+  assert(Area_Tri2(po_add, aVec2[ipo_e1], aVec2[aTri[itri].v[ied0]]) > MIN_TRI_AREA);
+  assert(Area_Tri2(po_add, aVec2[aTri[itri].v[ied0]], aVec2[ipo_e0]) > MIN_TRI_AREA);
+  if (Area_Tri2(po_add, aVec2[ipo_e0], aVec2[ipo_d]) < MIN_TRI_AREA) { return 0; }
+  if (Area_Tri2(po_add, aVec2[ipo_d], aVec2[ipo_e1]) < MIN_TRI_AREA) { return 0; }
+  const int det_d = DetDelaunay(po_add, aVec2[ipo_e0], aVec2[ipo_e1], aVec2[ipo_d]);
+  if (det_d == 2 || det_d == 1) { return 0; }
+  iedge = ied0;
+  return 1;
+}
+
+/**
+ * @brief triangle whose center is the closest to the point among the samples of the triangles ("jump")
+ * @details about cubic root of the number of triangles are sampled with the uniform stride.
+ * E. P. Mucke, I. Saias, and B. Zhu, "Fast randomized point location without preprocessing in two- and
+ * three-dimensional Delaunay triangulations", Computational Geometry 12, 1999
+ */
+DFM2_INLINE unsigned int JumpTri(
+    const CVec2d &po,
+    const std::vector<CDynTri> &aTri,
+    const std::vector<CVec2d> &aVec2) {
+  const size_t ntri = aTri.size();
+  if (ntri == 0) { return UINT_MAX; }
+  const auto nsample = static_cast<size_t>(std::cbrt(static_cast<double>(ntri))) + 1;
+  const size_t stride = ntri / nsample + 1;
+  unsigned int itri_best = 0;
+  double dist_best = -1.0;
+  for (size_t itri = 0; itri < ntri; itri += stride) {
+    const CVec2d pc = (aVec2[aTri[itri].v[0]] + aVec2[aTri[itri].v[1]] + aVec2[aTri[itri].v[2]]) / 3.0;
+    const double dist = (pc - po).squaredNorm();
+    if (dist_best >= 0.0 && dist >= dist_best) { continue; }
+    dist_best = dist;
+    itri_best = static_cast<unsigned int>(itri);
+  }
+  return itri_best;
+}
+
+/**
+ * @brief walk toward the point across the edges that separate the triangle and the point
+ * @details the first edge to test rotates at each step, so the walk does not cycle in non-Delaunay triangulations.
+ * O. Devillers, S. Pion, and M. Teillaud, "Walking in a triangulation", SoCG 2001
+ * @param aFlagTri flag of the triangles. The edge between the triangles with different flags is constrained (can be nullptr)
+ * @return the triangle where the walk stops. It contains the point unless the walk is blocked by the boundary
+ * or a constrained edge.
+ */
+DFM2_INLINE unsigned int WalkTri(
+    unsigned int itri_start,
+    const CVec2d &po,
+    const std::vector<CDynTri> &aTri,
+    const std::vector<CVec2d> &aVec2,
+    const unsigned int *aFlagTri) {
+  unsigned int itri = itri_start;
+  for (size_t istep = 0; istep < aTri.size(); ++istep) {
+    const CDynTri &tri = aTri[itri];
+    unsigned int itri_next = UINT_MAX;
+    for (unsigned int i = 0; i < 3; ++i) {
+      const unsigned int iedge = (i + istep) % 3;
+      if (Area_Tri2(po, aVec2[tri.v[(iedge + 1) % 3]], aVec2[tri.v[(iedge + 2) % 3]]) >= 0.0) { continue; }
+      itri_next = tri.s2[iedge];
+      break;
+    }
+    if (itri_next == UINT_MAX) { return itri; } // inside or blocked by the boundary
+    if (aFlagTri != nullptr && aFlagTri[itri_next] != aFlagTri[itri]) { return itri; } // blocked by the constrained edge
+    itri = itri_next;
+  }
+  return itri;
+}
+
 DFM2_INLINE bool FindEdgePoint_AcrossEdge(
     unsigned int &itri0,
     unsigned int &inotri0,
@@ -253,20 +362,69 @@ DFM2_INLINE void delfem2::MeshingInside(
   assert(aVec2.size() == aPo2D.size());
   assert(aFlagPnt.size() == aPo2D.size());
   assert(aFlagTri.size() == aTri.size());
+  // triangle is refined if its area is larger than this ratio times the square of the target edge length.
+  // The value gives the same number of points as the former loop relaxing the ratio from 3.0 to 0.65
+  constexpr double kRatioArea = 0.9;
+  // number of the Laplacian smoothing sweeps between the refinement passes
+  constexpr unsigned int kNumSmoothing = 1;
 
-  double ratio = 3.0;
-  for (;;) {
-    int nadd = 0;
-    for (unsigned int itri = 0; itri < aTri.size(); itri++) {
-      const double area = Area_Tri2(aVec2[aTri[itri].v[0]],
-                                   aVec2[aTri[itri].v[1]],
-                                   aVec2[aTri[itri].v[2]]);
-      const double pcnt[2] = {
-          (aVec2[aTri[itri].v[0]].x + aVec2[aTri[itri].v[1]].x + aVec2[aTri[itri].v[2]].x) / 3.0,
-          (aVec2[aTri[itri].v[0]].y + aVec2[aTri[itri].v[1]].y + aVec2[aTri[itri].v[2]].y) / 3.0
-      };
-      double len2 = len * mesh_density.edgeLengthRatio(pcnt[0], pcnt[1]);
-      if (area < len2 * len2 * ratio) { continue; }
+  // area of the triangle normalized by the target area. The triangle is refined if this is larger than one
+  auto normalized_area = [&](unsigned int itri) {
+    const CVec2d &p0 = aVec2[aTri[itri].v[0]];
+    const CVec2d &p1 = aVec2[aTri[itri].v[1]];
+    const CVec2d &p2 = aVec2[aTri[itri].v[2]];
+    const double area = Area_Tri2(p0, p1, p2);
+    const double len2 = len * mesh_density.edgeLengthRatio(
+        (p0.x + p1.x + p2.x) / 3.0,
+        (p0.y + p1.y + p2.y) / 3.0);
+    return area / (len2 * len2 * kRatioArea);
+  };
+
+  // worklist of the triangles to be refined, bucketed by the area in the half octave.
+  // The triangles in the largest bucket are refined first, and the last pushed one is refined first in a bucket,
+  // such that the refinement grades from the large triangles while visiting the neighbouring triangles in a row.
+  // The entry may be outdated as the triangle is modified after it is pushed.
+  std::vector<std::vector<unsigned int> > bucket_tri;
+  unsigned int ibucket_max = 0;
+  auto push_tri = [&](unsigned int itri) {
+    const double key = normalized_area(itri);
+    if (key < 1.0) { return; }
+    const auto ibucket = static_cast<unsigned int>(std::min(std::log2(key) * 2.0, 63.0));
+    if (ibucket >= bucket_tri.size()) { bucket_tri.resize(ibucket + 1); }
+    bucket_tri[ibucket].push_back(itri);
+    ibucket_max = std::max(ibucket_max, ibucket);
+  };
+  auto pop_tri = [&]() {
+    for (;;) {
+      if (ibucket_max < bucket_tri.size() && !bucket_tri[ibucket_max].empty()) {
+        const unsigned int itri = bucket_tri[ibucket_max].back();
+        bucket_tri[ibucket_max].pop_back();
+        return itri;
+      }
+      if (ibucket_max == 0) { return UINT_MAX; }
+      --ibucket_max;
+    }
+  };
+  // push the triangles around the point. These are all the triangles modified by the insertion of the point.
+  auto push_tri_around_point = [&](unsigned int ipo) {
+    unsigned int itri0 = aPo2D[ipo].e;
+    unsigned int ino0 = aPo2D[ipo].d;
+    for (;;) {
+      push_tri(itri0);
+      if (!MoveCCW(itri0, ino0, UINT_MAX, aTri)) { break; }
+      if (itri0 == aPo2D[ipo].e) { return; }
+    }
+    itri0 = aPo2D[ipo].e;
+    ino0 = aPo2D[ipo].d;
+    while (MoveCW(itri0, ino0, UINT_MAX, aTri)) { push_tri(itri0); }
+  };
+
+  for (unsigned int ipass = 0; ipass < kNumSmoothing + 1; ++ipass) {
+    for (unsigned int itri = 0; itri < aTri.size(); ++itri) { push_tri(itri); }
+    for (;;) {
+      const unsigned int itri = pop_tri();
+      if (itri == UINT_MAX) { break; }
+      if (normalized_area(itri) < 1.0) { continue; }
       const auto ipo0 = static_cast<unsigned int>(aPo2D.size());
       aPo2D.resize(aPo2D.size() + 1);
       aVec2.resize(aVec2.size() + 1);
@@ -278,17 +436,15 @@ DFM2_INLINE void delfem2::MeshingInside(
       aFlagTri.push_back(iflgtri);
       aFlagPnt.push_back(iflgtri + nflgpnt_offset);
       DelaunayAroundPoint(ipo0, aPo2D, aTri, aVec2);
-      nadd++;
+      push_tri_around_point(ipo0);
     }
+    if (ipass == kNumSmoothing) { break; }
     for (size_t ip = nPointFix; ip < aVec2.size(); ++ip) {
       dtri2::LaplacianArroundPoint(
           aVec2,
           static_cast<unsigned int>(ip),
           aPo2D, aTri);
     }
-    if (nadd != 0) { ratio *= 0.8; }
-    else { ratio *= 0.5; }
-    if (ratio < 0.65) break;
   }
 
   for (size_t ip = nPointFix; ip < aVec2.size(); ++ip) {
@@ -348,60 +504,43 @@ DFM2_INLINE void delfem2::AddPointsMesh
      std::vector<CDynPntSur> &aPo2D,
      std::vector<CDynTri> &aTri,
      int ipoin,
-     double MIN_TRI_AREA) {
+     double MIN_TRI_AREA,
+     unsigned int itri_start,
+     const unsigned int *aFlagTri) {
+  namespace lcl = ::delfem2::dtri2;
   assert(aPo2D.size() == aVec2.size());
   if (aPo2D[ipoin].e != UINT_MAX) { return; } // already added
   const CVec2d &po_add = aVec2[ipoin];
-  int itri_in = -1;
-  int iedge = -1;
-  int iflg1 = 0, iflg2 = 0;
-  for (unsigned int itri = 0; itri < aTri.size(); itri++) {
-    iflg1 = 0;
-    iflg2 = 0;
-    if (Area_Tri2(po_add, aVec2[aTri[itri].v[1]], aVec2[aTri[itri].v[2]]) > MIN_TRI_AREA) {
-      iflg1++;
-      iflg2 += 0;
-    }
-    if (Area_Tri2(po_add, aVec2[aTri[itri].v[2]], aVec2[aTri[itri].v[0]]) > MIN_TRI_AREA) {
-      iflg1++;
-      iflg2 += 1;
-    }
-    if (Area_Tri2(po_add, aVec2[aTri[itri].v[0]], aVec2[aTri[itri].v[1]]) > MIN_TRI_AREA) {
-      iflg1++;
-      iflg2 += 2;
-    }
-    if (iflg1 == 3) { // add in triangle
+  unsigned int itri_in = UINT_MAX;
+  unsigned int iedge = UINT_MAX;
+  { // jump and walk, then check the triangle and its neighbours
+    if (itri_start >= aTri.size()) { itri_start = lcl::JumpTri(po_add, aTri, aVec2); }
+    const unsigned int itri0 = lcl::WalkTri(itri_start, po_add, aTri, aVec2, aFlagTri);
+    const unsigned int aITri[4] = {itri0, aTri[itri0].s2[0], aTri[itri0].s2[1], aTri[itri0].s2[2]};
+    for (unsigned int itri: aITri) {
+      if (itri == UINT_MAX) { continue; }
+      const int res = lcl::CheckInsertion_Tri(iedge, itri, po_add, aTri, aVec2, MIN_TRI_AREA);
+      if (res == 2) { return; }
+      if (res == 0) { continue; }
       itri_in = itri;
       break;
-    } else if (iflg1 == 2) { // add in edge
-      const int ied0 = 3 - iflg2;
-      const unsigned int ipo_e0 = aTri[itri].v[(ied0 + 1) % 3];
-      const unsigned int ipo_e1 = aTri[itri].v[(ied0 + 2) % 3];
-      const unsigned int itri_s = aTri[itri].s2[ied0];
-      if (itri_s == UINT_MAX) { return; }
-      const unsigned int jno0 = FindAdjEdgeIndex(aTri[itri], ied0, aTri);
-      assert(aTri[itri_s].v[(jno0 + 2) % 3] == ipo_e0);
-      assert(aTri[itri_s].v[(jno0 + 1) % 3] == ipo_e1);
-      const unsigned int inoel_d = jno0;
-      assert(aTri[itri_s].s2[inoel_d] == itri);
-      const unsigned int ipo_d = aTri[itri_s].v[inoel_d];
-      assert(Area_Tri2(po_add, aVec2[ipo_e1], aVec2[aTri[itri].v[ied0]]) > MIN_TRI_AREA);
-      assert(Area_Tri2(po_add, aVec2[aTri[itri].v[ied0]], aVec2[ipo_e0]) > MIN_TRI_AREA);
-      if (Area_Tri2(po_add, aVec2[ipo_e0], aVec2[ipo_d]) < MIN_TRI_AREA) { continue; }
-      if (Area_Tri2(po_add, aVec2[ipo_d], aVec2[ipo_e1]) < MIN_TRI_AREA) { continue; }
-      const int det_d = DetDelaunay(po_add, aVec2[ipo_e0], aVec2[ipo_e1], aVec2[ipo_d]);
-      if (det_d == 2 || det_d == 1) continue;
+    }
+  }
+  if (itri_in == UINT_MAX) { // the walk is blocked by the boundary or a constrained edge. look all the triangles
+    for (unsigned int itri = 0; itri < aTri.size(); itri++) {
+      const int res = lcl::CheckInsertion_Tri(iedge, itri, po_add, aTri, aVec2, MIN_TRI_AREA);
+      if (res == 2) { return; }
+      if (res == 0) { continue; }
       itri_in = itri;
-      iedge = ied0;
       break;
     }
   }
-  if (itri_in == -1) {
-    std::cout << "super triangle failure " << iflg1 << " " << iflg2 << std::endl;
+  if (itri_in == UINT_MAX) {
+    std::cout << "super triangle failure " << std::endl;
     assert(0);
     abort();
   }
-  if (iedge == -1) {
+  if (iedge == UINT_MAX) {
     InsertPoint_Elem(ipoin, itri_in, aPo2D, aTri);
   } else {
     InsertPoint_ElemEdge(ipoin, itri_in, iedge, aPo2D, aTri);
@@ -654,15 +793,29 @@ DFM2_INLINE void delfem2::Meshing_Initialize(
                       bound_2d);
   }
   {
+    // insert the points in the biased randomized order. The walk starts from the point inserted just before.
+    const size_t np = aPo2D.size() - 3;
+    std::vector<unsigned int> new2old;
+    {
+      std::vector<double> aXY(np * 2);
+      for (size_t ip = 0; ip < np; ++ip) {
+        aXY[ip * 2 + 0] = aVec2[ip].x;
+        aXY[ip * 2 + 1] = aVec2[ip].y;
+      }
+      Permutation_BRIO2(new2old, aXY.data(), np);
+    }
     const double MIN_TRI_AREA = 1.0e-10;
-    for (size_t ip = 0; ip < aPo2D.size() - 3; ++ip) {
+    unsigned int ip_prev = UINT_MAX;
+    for (unsigned int ip: new2old) {
+      const unsigned int itri_start = (ip_prev == UINT_MAX) ? UINT_MAX : aPo2D[ip_prev].e;
       AddPointsMesh(
           aVec2, aPo2D, aTri,
-          static_cast<unsigned int>(ip),
-          MIN_TRI_AREA);
+          ip,
+          MIN_TRI_AREA, itri_start);
       DelaunayAroundPoint(
-          static_cast<unsigned int>(ip),
+          ip,
           aPo2D, aTri, aVec2);
+      if (aPo2D[ip].e != UINT_MAX) { ip_prev = ip; }
     }
   }
 }
@@ -1031,7 +1184,8 @@ DFM2_INLINE void delfem2::RefineMesh(
   }
   for (auto &icmd : aCmd.aCmdEdge) {
     const int ip0 = icmd.ipo_new;
-    AddPointsMesh(aVec2, aEPo2, aSTri, ip0, 1.0e-10);
+    // the walk starts from the triangle around the end point of the edge
+    AddPointsMesh(aVec2, aEPo2, aSTri, ip0, 1.0e-10, aEPo2[icmd.ipo0].e);
     DelaunayAroundPoint(ip0, aEPo2, aSTri, aVec2);
   }
 }
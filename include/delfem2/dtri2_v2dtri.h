@@ -15,6 +15,7 @@
 #include <map>
 #include <algorithm>
 #include <stack>
+#include <climits>
 
 #include "delfem2/dfm2_inline.h"
 #include "delfem2/vec2.h"
@@ -105,12 +106,24 @@ DFM2_INLINE void MakeSuperTriangle(
     std::vector<CDynTri> &aTri,
     const double bound_2d[4]);
 
+/**
+ * @brief insert a point in the triangulation without the Delaunay flips
+ * @details the triangle containing the point is found by walking from "itri_start".
+ * The walk is blocked by the edges without an adjacent triangle and the constrained edges,
+ * and all the triangles are checked in that case.
+ * @param itri_start triangle to start the walk (e.g., a triangle around the point inserted just before).
+ * If it is UINT_MAX, the walk starts from the closest one in the sampled triangles.
+ * @param aFlagTri flag of the triangles (e.g., the cad face index). The walk does not cross the edges between
+ * the triangles with different flags. The flags of the new triangles need to be appended by the caller.
+ */
 DFM2_INLINE void AddPointsMesh(
     const std::vector<CVec2d> &aVec2,
     std::vector<CDynPntSur> &aPo2D,
     std::vector<CDynTri> &aTri,
     int ipoin,
-    double MIN_TRI_AREA);
+    double MIN_TRI_AREA,
+    unsigned int itri_start = UINT_MAX,
+    const unsigned int *aFlagTri = nullptr);
 
 DFM2_INLINE void MakeInvMassLumped_Tri(
     std::vector<double> &aInvMassLumped,
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/fem_solid_matrixfree.h"
+
+#include <algorithm>
+
+#include "delfem2/femutil.h"
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::fem_solid_matrixfree {
+
+//! number of elements processed by a task of the thread pool
+constexpr unsigned int kNumElemChunk = 256;
+
+//! number of degrees of freedom processed by a task of the thread pool
+constexpr size_t kNumDofChunk = 1 << 13;
+
+DFM2_INLINE void Inverse_Mat3(
+    double Ainv[9],
+    const double A[9]) {
+  const double det =
+      +A[0] * A[4] * A[8] + A[3] * A[7] * A[2] + A[6] * A[1] * A[5]
+      - A[0] * A[7] * A[5] - A[6] * A[4] * A[2] - A[3] * A[1] * A[8];
+  const double inv_det = 1.0 / det;
+  Ainv[0] = inv_det * (A[4] * A[8] - A[5] * A[7]);
+  Ainv[1] = inv_det * (A[2] * A[7] - A[1] * A[8]);
+  Ainv[2] = inv_det * (A[1] * A[5] - A[2] * A[4]);
+  Ainv[3] = inv_det * (A[5] * A[6] - A[3] * A[8]);
+  Ainv[4] = inv_det * (A[0] * A[8] - A[2] * A[6]);
+  Ainv[5] = inv_det * (A[2] * A[3] - A[0] * A[5]);
+  Ainv[6] = inv_det * (A[3] * A[7] - A[4] * A[6]);
+  Ainv[7] = inv_det * (A[1] * A[6] - A[0] * A[7]);
+  Ainv[8] = inv_det * (A[0] * A[4] - A[1] * A[3]);
+}
+
+}  // namespace delfem2::fem_solid_matrixfree
+
+// ----------------------------------
+
+DFM2_INLINE void delfem2::MatrixFreeSolid_MeshTet3D::Initialize(
+    const double *aXYZ,
+    size_t nXYZ,
+    const unsigned int *aTet,
+    size_t nTet) {
+  num_vtx_ = nXYZ;
+  tet_vtx_.assign(aTet, aTet + nTet * 4);
+  tet_dldx_.resize(nTet * 12);
+  tet_vol_.resize(nTet);
+  for (unsigned int itet = 0; itet < nTet; ++itet) {
+    const unsigned int *aIP = aTet + itet * 4;
+    const double *p0 = aXYZ + aIP[0] * 3;
+    const double *p1 = aXYZ + aIP[1] * 3;
+    const double *p2 = aXYZ + aIP[2] * 3;
+    const double *p3 = aXYZ + aIP[3] * 3;
+    tet_vol_[itet] = femutil::TetVolume3D(p0, p1, p2, p3);
+    double dldx[4][3], const_term[4];
+    TetDlDx(dldx, const_term, p0, p1, p2, p3);
+    for (unsigned int i = 0; i < 12; ++i) { tet_dldx_[itet * 12 + i] = (&dldx[0][0])[i]; }
+  }
+  tet_tangent_.clear();
+  dof_bcflag_.clear();
+  JArray_ElemColoring_MeshElem(
+      color_ind_, color_elem_,
+      aTet, nTet, 4, nXYZ);
+}
+
+DFM2_INLINE void delfem2::MatrixFreeSolid_MeshTet3D::SetTangent(
+    unsigned int itet,
+    const double dPdF[3][3][3][3]) {
+  const size_t ntet = tet_vol_.size();
+  assert(itet < ntet);
+  if (tet_tangent_.size() != ntet * 81) {  // initialize all the elements with the isotropic material
+    tet_tangent_.resize(ntet * 81);
+    double A[3][3][3][3];
+    for (unsigned int a = 0; a < 3; ++a) {
+      for (unsigned int b = 0; b < 3; ++b) {
+        for (unsigned int c = 0; c < 3; ++c) {
+          for (unsigned int d = 0; d < 3; ++d) {
+            A[a][b][c][d] =
+                lambda_ * double(a == b) * double(c == d)
+                    + myu_ * double(a == c) * double(b == d)
+                    + myu_ * double(a == d) * double(b == c);
+          }
+        }
+      }
+    }
+    for (unsigned int jtet = 0; jtet < ntet; ++jtet) {
+      std::copy_n(&A[0][0][0][0], 81, tet_tangent_.data() + jtet * 81);
+    }
+  }
+  std::copy_n(&dPdF[0][0][0][0], 81, tet_tangent_.data() + itet * 81);
+}
+
+DFM2_INLINE void delfem2::MatrixFreeSolid_MeshTet3D::AddElemForce(
+    double f[4][3],
+    unsigned int itet,
+    const double u[4][3]) const {
+  const double *dldx = tet_dldx_.data() + itet * 12;
+  const double vol = tet_vol_[itet];
+  double G[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};  // displacement gradient G[a][B] = du_a/dX_B
+  for (unsigned int ino = 0; ino < 4; ++ino) {
+    for (unsigned int a = 0; a < 3; ++a) {
+      for (unsigned int b = 0; b < 3; ++b) {
+        G[a][b] += u[ino][a] * dldx[ino * 3 + b];
+      }
+    }
+  }
+  double S[3][3];  // stress (linearized 1st Piola-Kirchhoff) times volume
+  if (tet_tangent_.empty()) {
+    const double tr = G[0][0] + G[1][1] + G[2][2];
+    for (unsigned int a = 0; a < 3; ++a) {
+      for (unsigned int b = 0; b < 3; ++b) {
+        S[a][b] = vol * myu_ * (G[a][b] + G[b][a]);
+      }
+      S[a][a] += vol * lambda_ * tr;
+    }
+  } else {
+    const double *A = tet_tangent_.data() + itet * 81;
+    for (unsigned int ab = 0; ab < 9; ++ab) {
+      double s = 0.0;
+      for (unsigned int cd = 0; cd < 9; ++cd) { s += A[ab * 9 + cd] * (&G[0][0])[cd]; }
+      (&S[0][0])[ab] = vol * s;
+    }
+  }
+  for (unsigned int ino = 0; ino < 4; ++ino) {
+    const double *dN = dldx + ino * 3;
+    for (unsigned int a = 0; a < 3; ++a) {
+      f[ino][a] += S[a][0] * dN[0] + S[a][1] * dN[1] + S[a][2] * dN[2];
+    }
+  }
+}
+
+DFM2_INLINE void delfem2::MatrixFreeSolid_MeshTet3D::MatVec(
+    double *y,
+    double alpha,
+    const double *x,
+    double beta) const {
+  namespace lcl = ::delfem2::fem_solid_matrixfree;
+  const size_t nd = ndof();
+  const int *bc = dof_bcflag_.empty() ? nullptr : dof_bcflag_.data();
+  parallel_for_chunk(nd, lcl::kNumDofChunk, [&](size_t i0, size_t i1) {
+    for (size_t i = i0; i < i1; ++i) {
+      y[i] = (bc != nullptr && bc[i] != 0) ? alpha * x[i] + beta * y[i] : beta * y[i];
+    }
+  }, num_thread);
+  auto func_elem = [&](unsigned int icolor_elem) {
+    const unsigned int itet = color_elem_[icolor_elem];
+    const unsigned int *aIP = tet_vtx_.data() + itet * 4;
+    double u[4][3], f[4][3];
+    for (unsigned int ino = 0; ino < 4; ++ino) {
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        const unsigned int idof = aIP[ino] * 3 + idim;
+        u[ino][idim] = (bc != nullptr && bc[idof] != 0) ? 0.0 : x[idof];
+        f[ino][idim] = 0.0;
+      }
+    }
+    this->AddElemForce(f, itet, u);
+    for (unsigned int ino = 0; ino < 4; ++ino) {
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        const unsigned int idof = aIP[ino] * 3 + idim;
+        if (bc != nullptr && bc[idof] != 0) { continue; }
+        y[idof] += alpha * f[ino][idim];
+      }
+    }
+  };
+  for (unsigned int icolor = 0; icolor < ncolor(); ++icolor) {  // the elements of a color do not share vertices
+    const unsigned int ielem0 = color_ind_[icolor];
+    parallel_for_chunk(
+        color_ind_[icolor + 1] - ielem0, lcl::kNumElemChunk,
+        [&](size_t i0, size_t i1) {
+          for (size_t i = i0; i < i1; ++i) { func_elem(static_cast<unsigned int>(ielem0 + i)); }
+        }, num_thread);
+  }
+}
+
+DFM2_INLINE void delfem2::MatrixFreeSolid_MeshTet3D::BlockDiagonal(
+    std::vector<double> &aDia) const {
+  aDia.assign(num_vtx_ * 9, 0.0);
+  const size_t ntet = tet_vol_.size();
+  for (unsigned int itet = 0; itet < ntet; ++itet) {
+    for (unsigned int ino = 0; ino < 4; ++ino) {
+      double *d = aDia.data() + tet_vtx_[itet * 4 + ino] * 9;
+      for (unsigned int c = 0; c < 3; ++c) {  // apply the element matrix to the unit displacement
+        double u[4][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+        double f[4][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+        u[ino][c] = 1.0;
+        this->AddElemForce(f, itet, u);
+        for (unsigned int a = 0; a < 3; ++a) { d[a * 3 + c] += f[ino][a]; }
+      }
+    }
+  }
+  if (dof_bcflag_.empty()) { return; }
+  for (unsigned int ip = 0; ip < num_vtx_; ++ip) {
+    for (unsigned int idim = 0; idim < 3; ++idim) {
+      if (dof_bcflag_[ip * 3 + idim] == 0) { continue; }
+      for (unsigned int jdim = 0; jdim < 3; ++jdim) {
+        aDia[ip * 9 + idim * 3 + jdim] = 0.0;
+        aDia[ip * 9 + jdim * 3 + idim] = 0.0;
+      }
+      aDia[ip * 9 + idim * 3 + idim] = 1.0;
+    }
+  }
+}
+
+// ----------------------------------
+
+DFM2_INLINE void delfem2::PreconditionerBlockJacobi3::Initialize(
+    const std::vector<double> &aDia) {
+  const size_t nblk = aDia.size() / 9;
+  inv_dia.resize(nblk * 9);
+  for (unsigned int iblk = 0; iblk < nblk; ++iblk) {
+    fem_solid_matrixfree::Inverse_Mat3(
+        inv_dia.data() + iblk * 9,
+        aDia.data() + iblk * 9);
+  }
+}
+
+DFM2_INLINE void delfem2::PreconditionerBlockJacobi3::SolvePrecond(
+    double *vec) const {
+  const size_t nblk = inv_dia.size() / 9;
+  for (unsigned int iblk = 0; iblk < nblk; ++iblk) {
+    const double *m = inv_dia.data() + iblk * 9;
+    double *v = vec + iblk * 3;
+    const double v0 = v[0], v1 = v[1], v2 = v[2];
+    v[0] = m[0] * v0 + m[1] * v1 + m[2] * v2;
+    v[1] = m[3] * v0 + m[4] * v1 + m[5] * v2;
+    v[2] = m[6] * v0 + m[7] * v1 + m[8] * v2;
+  }
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file matrix-free (element-by-element) stiffness operator for 3D solid on a linear tetrahedral mesh
+ * @details the operator has the member function "MatVec" so that it can replace the CMatrixSparse in
+ * "Solve_CG" and "Solve_PCG". The global matrix is never assembled.
+ */
+
+#ifndef DFM2_FEM_SOLID_MATRIXFREE_H
+#define DFM2_FEM_SOLID_MATRIXFREE_H
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+/**
+ * @brief stiffness matrix of a tetrahedral mesh evaluated on the fly
+ * @details For each element, the gradient of the shape functions and the volume are cached.
+ * The element stiffness is computed as K_{ij,ac} = vol * dN_i/dX_B * A_{aBcD} * dN_j/dX_D where A is
+ * the 4th order tangent modulus. For the linear isotropic material (default), A is given by
+ * the two Lame parameters and nothing per-element is stored except the shape function gradient (13 doubles/tet).
+ * For a hyperelastic material, the tangent dP/dF at the linearization point can be set per element
+ * (81 additional doubles/tet), which is still smaller than the assembled 3x3 block sparse matrix.
+ * Elements are colored so that the element contributions of the same color are scattered to nodes in parallel.
+ */
+class MatrixFreeSolid_MeshTet3D {
+ public:
+  /**
+   * @param[in] aXYZ coordinates of the rest shape
+   * @param[in] aTet indexes of the four vertices of tetrahedra
+   */
+  void Initialize(
+      const double *aXYZ,
+      size_t nXYZ,
+      const unsigned int *aTet,
+      size_t nTet);
+
+  /**
+   * set linear isotropic material for all the elements. The per-element tangent is cleared.
+   */
+  void SetMaterial_LinearIsotropic(
+      double myu,
+      double lambda) {
+    this->myu_ = myu;
+    this->lambda_ = lambda;
+    tet_tangent_.clear();
+  }
+
+  /**
+   * set the tangent modulus dP/dF (P: first Piola-Kirchhoff stress, F: deformation gradient) of an element
+   * @param[in] dPdF dPdF[a][B][c][D] = d^2 W / (dF_{aB} dF_{cD})
+   */
+  void SetTangent(
+      unsigned int itet,
+      const double dPdF[3][3][3][3]);
+
+  /**
+   * @param[in] dof_bcflag if dof_bcflag[i] != 0, the i-th row and column of the matrix is replaced by the identity
+   */
+  void SetFixedBC(const int *dof_bcflag) {
+    dof_bcflag_.assign(dof_bcflag, dof_bcflag + ndof());
+  }
+
+  /**
+   * @func Matrix vector product as: {y} = alpha * [A]{x} + beta * {y}
+   */
+  void MatVec(
+      double *y,
+      double alpha,
+      const double *x,
+      double beta) const;
+
+  /**
+   * compute 3x3 diagonal blocks of the matrix (9 values per vertex)
+   */
+  void BlockDiagonal(std::vector<double> &aDia) const;
+
+  [[nodiscard]] size_t nblk() const { return num_vtx_; }
+  [[nodiscard]] size_t ndof() const { return num_vtx_ * 3; }
+  [[nodiscard]] size_t ncolor() const { return color_ind_.size() - 1; }
+
+ private:
+  void AddElemForce(
+      double f[4][3],
+      unsigned int itet,
+      const double u[4][3]) const;
+
+ public:
+  //! number of threads. "0" means the number of hardware threads. "1" runs serially.
+  unsigned int num_thread = 0;
+
+ private:
+  size_t num_vtx_ = 0;
+  double myu_ = 1.0;
+  double lambda_ = 0.0;
+  std::vector<unsigned int> tet_vtx_;
+  std::vector<double> tet_dldx_;  // 12 values per element
+  std::vector<double> tet_vol_;
+  std::vector<double> tet_tangent_;  // 81 values per element. empty for the linear isotropic material
+  std::vector<unsigned int> color_ind_, color_elem_;
+  std::vector<int> dof_bcflag_;
+};
+
+/**
+ * @brief block Jacobi preconditioner where each block is 3x3
+ */
+class PreconditionerBlockJacobi3 {
+ public:
+  /**
+   * @param aDia 3x3 diagonal blocks (e.g., computed by MatrixFreeSolid_MeshTet3D::BlockDiagonal)
+   */
+  void Initialize(const std::vector<double> &aDia);
+
+  void SolvePrecond(double *vec) const;
+
+ public:
+  std::vector<double> inv_dia;
+};
+
+/**
+ * @brief polynomial preconditioner using the Chebyshev iteration accelerated by the block Jacobi
+ * @details Fixed number of Chebyshev iterations from zero initial guess is a symmetric linear operator.
+ * Hence it can be used in the Solve_PCG. The eigenvalue bound of the Jacobi preconditioned matrix is estimated
+ * by the power iteration.
+ * @tparam MAT matrix class with member function "MatVec" with  {y} = alpha*[A]{x} + beta*{y}
+ */
+template<class MAT>
+class PreconditionerChebyshev {
+ public:
+  void Initialize(
+      const MAT &mat,
+      const std::vector<double> &aDia,
+      unsigned int degree,
+      unsigned int num_power_iteration = 20,
+      double eig_ratio = 30.0) {
+    pmat_ = &mat;
+    jacobi_.Initialize(aDia);
+    degree_ = degree;
+    const size_t ndof = aDia.size() / 3;  // 3x3 block per vertex
+    r_.resize(ndof);
+    d_.resize(ndof);
+    Ad_.resize(ndof);
+    // estimate the largest eigen value with power iteration
+    std::vector<double> v(ndof);
+    for (unsigned int i = 0; i < ndof; ++i) { v[i] = 1.0 + 0.1 * (i % 7); }
+    double eig_max = 1.0;
+    for (unsigned int itr = 0; itr < num_power_iteration; ++itr) {
+      double sqnorm = 0.0;
+      for (unsigned int i = 0; i < ndof; ++i) { sqnorm += v[i] * v[i]; }
+      const double inv_norm = 1.0 / std::sqrt(sqnorm);
+      for (unsigned int i = 0; i < ndof; ++i) { v[i] *= inv_norm; }
+      mat.MatVec(Ad_.data(), 1.0, v.data(), 0.0);
+      jacobi_.SolvePrecond(Ad_.data());
+      double vAv = 0.0;
+      for (unsigned int i = 0; i < ndof; ++i) { vAv += v[i] * Ad_[i]; }
+      eig_max = vAv;
+      v = Ad_;
+    }
+    eig_max_ = eig_max * 1.1;  // safety factor as the power iteration underestimates the bound
+    eig_min_ = eig_max_ / eig_ratio;
+  }
+
+  /**
+   * {vec} <- P(A){vec} where P(A) approximates the inverse of A
+   */
+  void SolvePrecond(double *vec) const {
+    assert(pmat_ != nullptr);
+    const size_t ndof = r_.size();
+    const double theta = 0.5 * (eig_max_ + eig_min_);
+    const double delta = 0.5 * (eig_max_ - eig_min_);
+    const double sigma = theta / delta;
+    double rho = 1.0 / sigma;
+    for (unsigned int i = 0; i < ndof; ++i) { r_[i] = vec[i]; }  // r = b - A*0
+    for (unsigned int i = 0; i < ndof; ++i) { d_[i] = r_[i]; }
+    jacobi_.SolvePrecond(d_.data());
+    for (unsigned int i = 0; i < ndof; ++i) {
+      d_[i] /= theta;
+      vec[i] = 0.0;
+    }
+    for (unsigned int k = 0; k < degree_; ++k) {
+      for (unsigned int i = 0; i < ndof; ++i) { vec[i] += d_[i]; }
+      if (k + 1 == degree_) { break; }
+      pmat_->MatVec(Ad_.data(), 1.0, d_.data(), 0.0);
+      for (unsigned int i = 0; i < ndof; ++i) { r_[i] -= Ad_[i]; }
+      const double rho1 = 1.0 / (2.0 * sigma - rho);
+      Ad_ = r_;
+      jacobi_.SolvePrecond(Ad_.data());
+      for (unsigned int i = 0; i < ndof; ++i) {
+        d_[i] = rho1 * rho * d_[i] + 2.0 * rho1 / delta * Ad_[i];
+      }
+      rho = rho1;
+    }
+  }
+
+ public:
+  double eig_max_ = 1.0;
+  double eig_min_ = 0.1;
+
+ private:
+  const MAT *pmat_ = nullptr;
+  PreconditionerBlockJacobi3 jacobi_;
+  unsigned int degree_ = 1;
+  mutable std::vector<double> r_, d_, Ad_;
+};
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/fem_solid_matrixfree.cpp"
+#endif
+
+#endif // DFM2_FEM_SOLID_MATRIXFREE_H
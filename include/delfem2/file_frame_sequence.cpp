@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/file_frame_sequence.h"
+
+#include <cstring>
+#include <cmath>
+
+namespace delfem2::file_frame_sequence {
+
+constexpr char kMagic[8] = {'D', 'F', 'M', '2', 'F', 'S', 'E', 'Q'};
+constexpr std::uint32_t kVersion = 1;
+constexpr size_t kSizeHeader = 64;
+
+template<typename T>
+void Append(std::vector<char> &buff, T v) {
+  const size_t n0 = buff.size();
+  buff.resize(n0 + sizeof(T));
+  std::memcpy(buff.data() + n0, &v, sizeof(T));
+}
+
+template<typename T>
+bool Load(T &v, const char *&p, const char *end) {
+  if (static_cast<size_t>(end - p) < sizeof(T)) { return false; }
+  std::memcpy(&v, p, sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+
+DFM2_INLINE void AppendVarint(
+    std::vector<char> &buff,
+    std::int64_t v) {
+  auto u = (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);  // zigzag
+  while (u >= 0x80) {
+    buff.push_back(static_cast<char>((u & 0x7f) | 0x80));
+    u >>= 7;
+  }
+  buff.push_back(static_cast<char>(u));
+}
+
+DFM2_INLINE bool LoadVarint(
+    std::int64_t &v,
+    const char *&p,
+    const char *end) {
+  std::uint64_t u = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7) {
+    if (p >= end) { return false; }
+    const auto c = static_cast<unsigned char>(*(p++));
+    u |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+    if (c < 0x80) {
+      v = static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+DFM2_INLINE std::vector<char> Header(
+    size_t num_vtx,
+    unsigned int ndim,
+    unsigned int nnode_elem,
+    unsigned int key_interval,
+    double quantum,
+    size_t num_elem_vtx,
+    size_t num_frame,
+    size_t ofs_table) {
+  std::vector<char> head(kMagic, kMagic + 8);
+  Append<std::uint32_t>(head, kVersion);
+  Append<std::uint32_t>(head, ndim);
+  Append<std::uint64_t>(head, num_vtx);
+  Append<std::uint32_t>(head, nnode_elem);
+  Append<std::uint32_t>(head, key_interval);
+  Append<double>(head, quantum);
+  Append<std::uint64_t>(head, num_elem_vtx);
+  Append<std::uint64_t>(head, num_frame);
+  Append<std::uint64_t>(head, ofs_table);
+  head.resize(kSizeHeader, 0);
+  return head;
+}
+
+}  // namespace delfem2::file_frame_sequence
+
+// ----------------------------------------------------
+// below: WriterFrameSequence
+
+DFM2_INLINE bool delfem2::WriterFrameSequence::Open(
+    const std::filesystem::path &file_path,
+    size_t num_vtx,
+    unsigned int ndim,
+    const std::vector<unsigned int> &elem_vtx,
+    unsigned int nnode_elem,
+    double quantum,
+    unsigned int key_interval) {
+  namespace lcl = ::delfem2::file_frame_sequence;
+  this->Close();
+  fout_.open(file_path, std::ios::binary);
+  if (fout_.fail()) { return false; }
+  num_vtx_ = num_vtx;
+  ndim_ = ndim;
+  nnode_elem_ = nnode_elem;
+  num_elem_vtx_ = elem_vtx.size();
+  quantum_ = quantum;
+  key_interval_ = (key_interval == 0) ? 1 : key_interval;
+  // the number of frames and the offset of the table are written in "Close"
+  const std::vector<char> head = lcl::Header(
+      num_vtx, ndim, nnode_elem, key_interval_, quantum, elem_vtx.size(), 0, 0);
+  fout_.write(head.data(), static_cast<std::streamsize>(head.size()));
+  fout_.write(
+      reinterpret_cast<const char *>(elem_vtx.data()),
+      static_cast<std::streamsize>(elem_vtx.size() * sizeof(unsigned int)));
+  frame_time_.clear();
+  frame_offset_.clear();
+  frame_size_.clear();
+  quantized_prev_.assign(num_vtx * ndim, 0);
+  is_pending_ = false;
+  is_closing_ = false;
+  thread_ = std::thread(&WriterFrameSequence::Work, this);
+  return true;
+}
+
+DFM2_INLINE void delfem2::WriterFrameSequence::AddFrame(
+    const double *vtx_xyz,
+    double time) {
+  if (!thread_.joinable()) { return; }
+  std::unique_lock<std::mutex> lock(mtx_);
+  cv_.wait(lock, [this] { return !is_pending_; });
+  buff_pending_.assign(vtx_xyz, vtx_xyz + num_vtx_ * ndim_);
+  time_pending_ = time;
+  is_pending_ = true;
+  cv_.notify_all();
+}
+
+DFM2_INLINE void delfem2::WriterFrameSequence::Work() {
+  while (true) {
+    double time;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return is_pending_ || is_closing_; });
+      if (!is_pending_) { return; }  // closing and no frame is left
+      std::swap(buff_pending_, buff_work_);
+      time = time_pending_;
+      is_pending_ = false;
+      cv_.notify_all();
+    }
+    this->WriteFrame(buff_work_, time);
+  }
+}
+
+DFM2_INLINE void delfem2::WriterFrameSequence::WriteFrame(
+    const std::vector<double> &vtx_xyz,
+    double time) {
+  namespace lcl = ::delfem2::file_frame_sequence;
+  const bool is_key = frame_time_.size() % key_interval_ == 0;
+  const double inv_quantum = 1.0 / quantum_;
+  bytes_.clear();
+  for (size_t i = 0; i < vtx_xyz.size(); ++i) {
+    const auto q = static_cast<std::int64_t>(std::llround(vtx_xyz[i] * inv_quantum));
+    lcl::AppendVarint(bytes_, is_key ? q : q - quantized_prev_[i]);
+    quantized_prev_[i] = q;
+  }
+  frame_time_.push_back(time);
+  frame_offset_.push_back(static_cast<std::uint64_t>(fout_.tellp()));
+  frame_size_.push_back(bytes_.size());
+  fout_.write(bytes_.data(), static_cast<std::streamsize>(bytes_.size()));
+}
+
+DFM2_INLINE bool delfem2::WriterFrameSequence::Close() {
+  namespace lcl = ::delfem2::file_frame_sequence;
+  if (!thread_.joinable()) { return false; }
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    is_closing_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  const auto ofs_table = static_cast<std::uint64_t>(fout_.tellp());
+  std::vector<char> table;
+  for (size_t iframe = 0; iframe < frame_time_.size(); ++iframe) {
+    lcl::Append<double>(table, frame_time_[iframe]);
+    lcl::Append<std::uint64_t>(table, frame_offset_[iframe]);
+    lcl::Append<std::uint64_t>(table, frame_size_[iframe]);
+  }
+  fout_.write(table.data(), static_cast<std::streamsize>(table.size()));
+  // rewrite the header with the number of frames and the offset of the table
+  const std::vector<char> head = lcl::Header(
+      num_vtx_, ndim_, nnode_elem_, key_interval_, quantum_, num_elem_vtx_,
+      frame_time_.size(), ofs_table);
+  fout_.seekp(0);
+  fout_.write(head.data(), static_cast<std::streamsize>(head.size()));
+  const bool is_ok = !fout_.fail();
+  fout_.close();
+  return is_ok;
+}
+
+// ----------------------------------------------------
+// below: ReaderFrameSequence
+
+DFM2_INLINE bool delfem2::ReaderFrameSequence::Open(
+    const std::filesystem::path &file_path) {
+  namespace lcl = ::delfem2::file_frame_sequence;
+  elem_vtx_.clear();
+  frame_time_.clear();
+  frame_offset_.clear();
+  frame_size_.clear();
+  iframe_decoded_ = SIZE_MAX;
+  if (!file_.Open(file_path)) { return false; }
+  const char *data = file_.data();
+  const char *end = data + file_.size();
+  if (file_.size() < lcl::kSizeHeader || std::memcmp(data, lcl::kMagic, 8) != 0) { return false; }
+  const char *p = data + 8;
+  std::uint32_t version, ndim, nnode_elem, key_interval;
+  std::uint64_t num_vtx, num_elem_vtx, num_frame, ofs_table;
+  bool is_ok = lcl::Load(version, p, end);
+  is_ok = is_ok && lcl::Load(ndim, p, end);
+  is_ok = is_ok && lcl::Load(num_vtx, p, end);
+  is_ok = is_ok && lcl::Load(nnode_elem, p, end);
+  is_ok = is_ok && lcl::Load(key_interval, p, end);
+  is_ok = is_ok && lcl::Load(quantum_, p, end);
+  is_ok = is_ok && lcl::Load(num_elem_vtx, p, end);
+  is_ok = is_ok && lcl::Load(num_frame, p, end);
+  is_ok = is_ok && lcl::Load(ofs_table, p, end);
+  if (!is_ok) { return false; }
+  if (version != lcl::kVersion || ofs_table == 0 || key_interval == 0) { return false; }
+  num_vtx_ = num_vtx;
+  ndim_ = ndim;
+  nnode_elem_ = nnode_elem;
+  key_interval_ = key_interval;
+  const size_t size = file_.size();
+  if (num_elem_vtx > (size - lcl::kSizeHeader) / sizeof(unsigned int)) { return false; }
+  elem_vtx_.resize(num_elem_vtx);
+  std::memcpy(elem_vtx_.data(), data + lcl::kSizeHeader, num_elem_vtx * sizeof(unsigned int));
+  if (ofs_table > size || num_frame > (size - ofs_table) / 24) { return false; }
+  p = data + ofs_table;
+  frame_time_.resize(num_frame);
+  frame_offset_.resize(num_frame);
+  frame_size_.resize(num_frame);
+  for (size_t iframe = 0; iframe < num_frame; ++iframe) {
+    is_ok = lcl::Load(frame_time_[iframe], p, end);
+    is_ok = is_ok && lcl::Load(frame_offset_[iframe], p, end);
+    is_ok = is_ok && lcl::Load(frame_size_[iframe], p, end);
+    if (!is_ok) { return false; }
+    if (frame_offset_[iframe] > ofs_table || frame_size_[iframe] > ofs_table - frame_offset_[iframe]) { return false; }
+  }
+  // each value of a frame takes at least one byte of varint
+  if (ndim != 0 && num_vtx > SIZE_MAX / ndim) { return false; }
+  for (size_t iframe = 0; iframe < num_frame; ++iframe) {
+    if (num_vtx * ndim > frame_size_[iframe]) { return false; }
+  }
+  return true;
+}
+
+DFM2_INLINE bool delfem2::ReaderFrameSequence::DecodeFrame(
+    size_t iframe) {
+  namespace lcl = ::delfem2::file_frame_sequence;
+  const bool is_key = iframe % key_interval_ == 0;
+  const char *p = file_.data() + frame_offset_[iframe];
+  const char *end = p + frame_size_[iframe];
+  quantized_.resize(num_vtx_ * ndim_, 0);
+  for (auto &q: quantized_) {
+    std::int64_t v;
+    if (!lcl::LoadVarint(v, p, end)) { return false; }
+    q = is_key ? v : q + v;
+  }
+  return true;
+}
+
+DFM2_INLINE bool delfem2::ReaderFrameSequence::ReadFrame(
+    std::vector<double> &vtx_xyz,
+    size_t iframe) {
+  if (iframe >= frame_time_.size()) { return false; }
+  size_t iframe0 = iframe - iframe % key_interval_;  // key frame
+  if (iframe_decoded_ != SIZE_MAX && iframe_decoded_ >= iframe0 && iframe_decoded_ <= iframe) {
+    iframe0 = iframe_decoded_ + 1;  // continue from the cached frame
+  }
+  for (size_t jframe = iframe0; jframe <= iframe; ++jframe) {
+    if (!this->DecodeFrame(jframe)) {
+      iframe_decoded_ = SIZE_MAX;
+      return false;
+    }
+    iframe_decoded_ = jframe;
+  }
+  vtx_xyz.resize(quantized_.size());
+  for (size_t i = 0; i < quantized_.size(); ++i) {
+    vtx_xyz[i] = static_cast<double>(quantized_[i]) * quantum_;
+  }
+  return true;
+}
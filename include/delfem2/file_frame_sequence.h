@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file sequence of frames of a deforming mesh (e.g., output of cloth or hair simulation)
+ * @details The element-vertex connectivity is stored once. The vertex coordinates of each frame are quantized,
+ * delta-encoded against the previous frame and stored as zigzag variable-length integers.
+ * Every "key_interval" frames, a key frame is stored without the delta, so a frame can be decoded from
+ * the preceding key frame. The table of the frames at the end of the file allows random access.
+ * The layout of the file is
+ * - header (64 bytes)
+ * - element-vertex connectivity
+ * - frames
+ * - frame table: time, offset and size of each frame
+ */
+
+#ifndef DFM2_FILE_FRAME_SEQUENCE_H
+#define DFM2_FILE_FRAME_SEQUENCE_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "delfem2/dfm2_inline.h"
+#include "delfem2/file_mapped.h"
+
+namespace delfem2 {
+
+/**
+ * @brief writer of the frame sequence. The frames are encoded and written in a background thread.
+ * @details The calling thread only copies the coordinates to a buffer and returns,
+ * unless the previous frame is still waiting to be written (double buffering).
+ * @code
+ * WriterFrameSequence writer;
+ * writer.Open(path, vtx_xyz.size() / 3, 3, tri_vtx, 3, 1.0e-5);
+ * for (frame...) {
+ *   step();
+ *   writer.AddFrame(vtx_xyz.data(), time);
+ * }
+ * writer.Close();
+ * @endcode
+ */
+class WriterFrameSequence {
+ public:
+  WriterFrameSequence() = default;
+  WriterFrameSequence(const WriterFrameSequence &) = delete;
+  WriterFrameSequence &operator=(const WriterFrameSequence &) = delete;
+  ~WriterFrameSequence() { this->Close(); }
+
+  /**
+   * @brief write the header and the connectivity, then start the background thread
+   * @param num_vtx number of vertices
+   * @param ndim dimension of the coordinates
+   * @param elem_vtx element-vertex connectivity (can be empty for points)
+   * @param nnode_elem number of nodes of an element
+   * @param quantum quantization step of the coordinates. The error of the coordinates is less than half of it.
+   * @param key_interval interval of the key frames
+   * @return false if the file cannot be opened
+   */
+  bool Open(
+      const std::filesystem::path &file_path,
+      size_t num_vtx,
+      unsigned int ndim,
+      const std::vector<unsigned int> &elem_vtx,
+      unsigned int nnode_elem,
+      double quantum,
+      unsigned int key_interval = 30);
+
+  /**
+   * @brief add a frame. The coordinates are copied, so the array can be modified after this returns.
+   * @param vtx_xyz array of coordinates with size of "num_vtx * ndim"
+   */
+  void AddFrame(
+      const double *vtx_xyz,
+      double time);
+
+  /**
+   * @brief wait until all the frames are written, then write the frame table
+   * @return false if any write failed
+   */
+  bool Close();
+
+  [[nodiscard]] bool is_open() const { return thread_.joinable(); }
+
+ private:
+  void Work();
+  void WriteFrame(const std::vector<double> &vtx_xyz, double time);
+
+ private:
+  // below: configuration
+  size_t num_vtx_ = 0;
+  unsigned int ndim_ = 3;
+  unsigned int nnode_elem_ = 0;
+  size_t num_elem_vtx_ = 0;
+  double quantum_ = 1.0;
+  unsigned int key_interval_ = 30;
+
+  // below: shared between the threads
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::vector<double> buff_pending_;
+  double time_pending_ = 0.0;
+  bool is_pending_ = false;
+  bool is_closing_ = false;
+
+  // below: used only in the background thread while it is running
+  std::thread thread_;
+  std::ofstream fout_;
+  std::vector<double> buff_work_;
+  std::vector<std::int64_t> quantized_prev_;
+  std::vector<char> bytes_;
+  std::vector<double> frame_time_;
+  std::vector<std::uint64_t> frame_offset_;
+  std::vector<std::uint64_t> frame_size_;
+};
+
+/**
+ * @brief reader of the frame sequence
+ */
+class ReaderFrameSequence {
+ public:
+  /**
+   * @return false if the file cannot be opened or it is broken (e.g., the writer was not closed)
+   */
+  bool Open(const std::filesystem::path &file_path);
+
+  [[nodiscard]] size_t NumFrame() const { return frame_time_.size(); }
+  [[nodiscard]] size_t NumVertex() const { return num_vtx_; }
+  [[nodiscard]] unsigned int Dimension() const { return ndim_; }
+  [[nodiscard]] unsigned int NumNodeElement() const { return nnode_elem_; }
+  [[nodiscard]] double Time(size_t iframe) const { return frame_time_[iframe]; }
+  [[nodiscard]] const std::vector<unsigned int> &ElementVertex() const { return elem_vtx_; }
+
+  /**
+   * @brief decode the coordinates of a frame.
+   * @details the frames from the preceding key frame are decoded. Playing the frames in order
+   * costs only one frame per call as the last decoded frame is cached.
+   */
+  bool ReadFrame(
+      std::vector<double> &vtx_xyz,
+      size_t iframe);
+
+ private:
+  bool DecodeFrame(size_t iframe);
+
+ private:
+  size_t num_vtx_ = 0;
+  unsigned int ndim_ = 3;
+  unsigned int nnode_elem_ = 0;
+  unsigned int key_interval_ = 1;
+  double quantum_ = 1.0;
+  std::vector<unsigned int> elem_vtx_;
+  std::vector<double> frame_time_;
+  std::vector<std::uint64_t> frame_offset_;
+  std::vector<std::uint64_t> frame_size_;
+  MappedFile file_;
+  std::vector<std::int64_t> quantized_;  // decoded frame
+  size_t iframe_decoded_ = SIZE_MAX;
+};
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/file_frame_sequence.cpp"
+#endif
+
+#endif // DFM2_FILE_FRAME_SEQUENCE_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/file_mapped.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define DFM2_FILE_MAPPED_POSIX
+#endif
+
+DFM2_INLINE bool delfem2::MappedFile::Open(
+    const std::filesystem::path &file_path) {
+  this->Close();
+#ifdef DFM2_FILE_MAPPED_POSIX
+  {
+    const int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) {  // mmap does not accept zero length
+      ::close(fd);
+      is_open_ = true;
+      return true;
+    }
+    void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping is kept after closing the descriptor
+    if (p != MAP_FAILED) {
+      ::madvise(p, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(p);
+      is_mapped_ = true;
+      is_open_ = true;
+      return true;
+    }
+    size_ = 0;
+  }
+#endif
+  std::ifstream fin(file_path, std::ios::binary | std::ios::ate);
+  if (fin.fail()) { return false; }
+  const std::streamsize n = fin.tellg();
+  if (n < 0) { return false; }
+  buffer_.resize((static_cast<size_t>(n) + sizeof(Block) - 1) / sizeof(Block));
+  char *buff = reinterpret_cast<char *>(buffer_.data());
+  fin.seekg(0, std::ios::beg);
+  if (!fin.read(buff, n)) {
+    buffer_.clear();
+    return false;
+  }
+  data_ = buff;
+  size_ = static_cast<size_t>(n);
+  is_open_ = true;
+  return true;
+}
+
+DFM2_INLINE void delfem2::MappedFile::Close() {
+#ifdef DFM2_FILE_MAPPED_POSIX
+  if (is_mapped_) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+#endif
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+  data_ = nullptr;
+  size_ = 0;
+  is_mapped_ = false;
+  is_open_ = false;
+}
+
+#undef DFM2_FILE_MAPPED_POSIX
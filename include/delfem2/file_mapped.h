@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file read-only view of the whole content of a file
+ * @details the file is memory-mapped on POSIX systems. On the other systems, the content is read into a buffer.
+ */
+
+#ifndef DFM2_FILE_MAPPED_H
+#define DFM2_FILE_MAPPED_H
+
+#include <cstddef>
+#include <vector>
+#include <filesystem>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const std::filesystem::path &file_path) { this->Open(file_path); }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { this->Close(); }
+
+  /**
+   * @return false if the file cannot be opened
+   */
+  bool Open(const std::filesystem::path &file_path);
+
+  void Close();
+
+  [[nodiscard]] bool is_open() const { return is_open_; }
+  //! beginning of the content. It is aligned to 64 bytes both in the mapped and the buffered cases
+  [[nodiscard]] const char *data() const { return data_; }
+  [[nodiscard]] size_t size() const { return size_; }
+
+ private:
+  bool is_open_ = false;
+  bool is_mapped_ = false;
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  struct alignas(64) Block {
+    char c[64];
+  };
+  std::vector<Block> buffer_;  // used when the file is not memory-mapped
+};
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/file_mapped.cpp"
+#endif
+
+#endif // DFM2_FILE_MAPPED_H
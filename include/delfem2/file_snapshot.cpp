@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/file_snapshot.h"
+
+#include <cstdint>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include "delfem2/thread.h"
+
+namespace delfem2::file_snapshot {
+
+constexpr char kMagic[8] = {'D', 'F', 'M', '2', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kEndian = 0x01020304;
+constexpr size_t kSizeHeader = 64;
+constexpr size_t kAlign = 64;
+//! number of bytes of a compression block. Blocks are compressed independently in parallel
+constexpr size_t kNumByteBlock = 1 << 20;
+//! minimum length of a match of the LZ codec
+constexpr size_t kMinMatch = 4;
+//! upper bound of the ratio of the decoded size to the encoded size of the LZ codec (a length byte adds at most 255)
+constexpr size_t kMaxRatioLz = 256;
+
+/**
+ * FNV-1a hash. "h" is the hash of the preceding bytes to hash a sequence of buffers
+ */
+DFM2_INLINE std::uint64_t HashFnv1a(
+    const char *p,
+    size_t n,
+    std::uint64_t h = 14695981039346656037ULL) {
+  for (size_t i = 0; i < n; ++i) {
+    h ^= static_cast<unsigned char>(p[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+template<typename T>
+void Append(std::vector<char> &buff, T v) {
+  const size_t n0 = buff.size();
+  buff.resize(n0 + sizeof(T));
+  std::memcpy(buff.data() + n0, &v, sizeof(T));
+}
+
+/**
+ * load a value and advance the pointer. return false if it exceeds "end"
+ */
+template<typename T>
+bool Load(T &v, const char *&p, const char *end) {
+  if (static_cast<size_t>(end - p) < sizeof(T)) { return false; }
+  std::memcpy(&v, p, sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+
+/**
+ * transpose the bytes of the values, so the n-th bytes of the values are contiguous.
+ * This makes the floating point numbers much more compressible.
+ */
+DFM2_INLINE void ShuffleBytes(
+    char *dst,
+    const char *src,
+    size_t num_value,
+    size_t size_value) {
+  for (size_t i = 0; i < num_value; ++i) {
+    for (size_t j = 0; j < size_value; ++j) {
+      dst[j * num_value + i] = src[i * size_value + j];
+    }
+  }
+}
+
+DFM2_INLINE void UnshuffleBytes(
+    char *dst,
+    const char *src,
+    size_t num_value,
+    size_t size_value) {
+  for (size_t j = 0; j < size_value; ++j) {
+    for (size_t i = 0; i < num_value; ++i) {
+      dst[i * size_value + j] = src[j * num_value + i];
+    }
+  }
+}
+
+DFM2_INLINE void AppendLength(
+    std::vector<char> &dst,
+    size_t len) {
+  for (; len >= 255; len -= 255) { dst.push_back(static_cast<char>(255)); }
+  dst.push_back(static_cast<char>(len));
+}
+
+DFM2_INLINE void AppendSequence(
+    std::vector<char> &dst,
+    const char *literal,
+    size_t nliteral,
+    size_t offset,
+    size_t nmatch) {
+  const size_t lm = (nmatch == 0) ? 0 : nmatch - kMinMatch;
+  const auto token = static_cast<unsigned char>((std::min<size_t>(nliteral, 15) << 4) | std::min<size_t>(lm, 15));
+  dst.push_back(static_cast<char>(token));
+  if (nliteral >= 15) { AppendLength(dst, nliteral - 15); }
+  dst.insert(dst.end(), literal, literal + nliteral);
+  if (nmatch == 0) { return; }  // last sequence
+  dst.push_back(static_cast<char>(offset & 0xff));
+  dst.push_back(static_cast<char>(offset >> 8));
+  if (lm >= 15) { AppendLength(dst, lm - 15); }
+}
+
+DFM2_INLINE bool LoadLength(
+    size_t &len,
+    const unsigned char *&p,
+    const unsigned char *end) {
+  while (true) {
+    if (p >= end) { return false; }
+    const unsigned char c = *(p++);
+    len += c;
+    if (c != 255) { return true; }
+  }
+}
+
+/**
+ * store a block of "src" to "dst". The first 8 bytes are the raw and stored size.
+ * The block is stored as is if the compression does not reduce the size.
+ */
+DFM2_INLINE void CompressBlock(
+    std::vector<char> &dst,
+    const char *src,
+    size_t nsrc) {
+  std::vector<char> buff;
+  Compress_Lz(buff, src, nsrc);
+  const bool is_raw = buff.size() >= nsrc;
+  dst.clear();
+  Append<std::uint32_t>(dst, static_cast<std::uint32_t>(nsrc));
+  Append<std::uint32_t>(dst, static_cast<std::uint32_t>(is_raw ? nsrc : buff.size()));
+  if (is_raw) {
+    dst.insert(dst.end(), src, src + nsrc);
+  } else {
+    dst.insert(dst.end(), buff.begin(), buff.end());
+  }
+}
+
+}  // namespace delfem2::file_snapshot
+
+// ----------------------------------------------------
+// below: LZ codec
+
+DFM2_INLINE void delfem2::Compress_Lz(
+    std::vector<char> &dst,
+    const char *src,
+    size_t nsrc) {
+  namespace lcl = ::delfem2::file_snapshot;
+  constexpr unsigned int kNumBitHash = 14;
+  dst.clear();
+  dst.reserve(nsrc / 2 + 16);
+  std::vector<std::uint32_t> table(1u << kNumBitHash, 0);  // 1 + position of the last occurrence
+  auto hash = [](std::uint32_t v) { return (v * 2654435761u) >> (32 - kNumBitHash); };
+  auto load32 = [src](size_t i) {
+    std::uint32_t v;
+    std::memcpy(&v, src + i, 4);
+    return v;
+  };
+  size_t anchor = 0, ip = 0;
+  while (ip + lcl::kMinMatch <= nsrc) {
+    const std::uint32_t seq = load32(ip);
+    const std::uint32_t h = hash(seq);
+    const size_t ref = table[h];
+    table[h] = static_cast<std::uint32_t>(ip + 1);
+    if (ref == 0 || ip + 1 - ref > 65535 || load32(ref - 1) != seq) {
+      ++ip;
+      continue;
+    }
+    const size_t iref = ref - 1;
+    size_t nmatch = lcl::kMinMatch;
+    while (ip + nmatch < nsrc && src[iref + nmatch] == src[ip + nmatch]) { ++nmatch; }
+    lcl::AppendSequence(dst, src + anchor, ip - anchor, ip - iref, nmatch);
+    ip += nmatch;
+    anchor = ip;
+  }
+  lcl::AppendSequence(dst, src + anchor, nsrc - anchor, 0, 0);
+}
+
+DFM2_INLINE bool delfem2::Decompress_Lz(
+    char *dst,
+    size_t ndst,
+    const char *src,
+    size_t nsrc) {
+  namespace lcl = ::delfem2::file_snapshot;
+  const auto *p = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *end = p + nsrc;
+  size_t op = 0;
+  while (p < end) {
+    const unsigned char token = *(p++);
+    size_t nliteral = token >> 4;
+    if (nliteral == 15 && !lcl::LoadLength(nliteral, p, end)) { return false; }
+    if (nliteral > static_cast<size_t>(end - p) || op + nliteral > ndst) { return false; }
+    std::memcpy(dst + op, p, nliteral);
+    p += nliteral;
+    op += nliteral;
+    if (p == end) { break; }  // last sequence
+    if (end - p < 2) { return false; }
+    const size_t offset = p[0] | (static_cast<size_t>(p[1]) << 8);
+    p += 2;
+    size_t nmatch = token & 0x0f;
+    if (nmatch == 15 && !lcl::LoadLength(nmatch, p, end)) { return false; }
+    nmatch += lcl::kMinMatch;
+    if (offset == 0 || offset > op || op + nmatch > ndst) { return false; }
+    for (size_t i = 0; i < nmatch; ++i, ++op) { dst[op] = dst[op - offset]; }  // may overlap
+  }
+  return op == ndst;
+}
+
+// ----------------------------------------------------
+// below: WriterSnapshot
+
+DFM2_INLINE void delfem2::WriterSnapshot::AddSource(
+    const std::string &name,
+    const void *val,
+    SNAPSHOT_TYPE type,
+    std::uint32_t size_value,
+    size_t num_value,
+    bool is_compress) {
+  Source src;
+  src.array.name = name;
+  src.array.type = type;
+  src.array.size_value = size_value;
+  src.array.num_value = num_value;
+  src.array.is_compressed = is_compress ? 1 : 0;
+  src.val = val;
+  sources_.push_back(src);
+}
+
+DFM2_INLINE bool delfem2::WriterSnapshot::Write(
+    const std::filesystem::path &file_path,
+    unsigned int num_thread) const {
+  namespace lcl = ::delfem2::file_snapshot;
+  std::ofstream fout(file_path, std::ios::binary);
+  if (fout.fail()) { return false; }
+  const char zeros[lcl::kAlign] = {};
+  fout.write(zeros, lcl::kSizeHeader);  // header is written at the end
+  std::uint64_t ofs = lcl::kSizeHeader;
+  std::vector<SnapshotArray> arrays;
+  std::vector<char> shuffled;
+  std::vector<std::vector<char>> blocks;
+  for (const auto &src: sources_) {
+    SnapshotArray array = src.array;
+    const size_t nbyte = array.num_value * array.size_value;
+    array.offset = ofs;
+    if (!array.is_compressed) {
+      const char *p = static_cast<const char *>(src.val);
+      array.size_stored = nbyte;
+      array.checksum = lcl::HashFnv1a(p, nbyte);
+      fout.write(p, static_cast<std::streamsize>(nbyte));
+    } else {
+      shuffled.resize(nbyte);
+      lcl::ShuffleBytes(
+          shuffled.data(), static_cast<const char *>(src.val),
+          array.num_value, array.size_value);
+      const size_t nblock = (nbyte + lcl::kNumByteBlock - 1) / lcl::kNumByteBlock;
+      blocks.resize(nblock);
+      parallel_for_chunk(nbyte, lcl::kNumByteBlock, [&](size_t i0, size_t i1) {
+        lcl::CompressBlock(blocks[i0 / lcl::kNumByteBlock], shuffled.data() + i0, i1 - i0);
+      }, num_thread);
+      std::vector<char> head;
+      lcl::Append<std::uint64_t>(head, nblock);
+      std::uint64_t checksum = lcl::HashFnv1a(head.data(), head.size());
+      array.size_stored = head.size();
+      fout.write(head.data(), static_cast<std::streamsize>(head.size()));
+      for (const auto &block: blocks) {
+        checksum = lcl::HashFnv1a(block.data(), block.size(), checksum);
+        array.size_stored += block.size();
+        fout.write(block.data(), static_cast<std::streamsize>(block.size()));
+      }
+      array.checksum = checksum;
+    }
+    ofs += array.size_stored;
+    const size_t npad = (lcl::kAlign - ofs % lcl::kAlign) % lcl::kAlign;
+    fout.write(zeros, static_cast<std::streamsize>(npad));
+    ofs += npad;
+    arrays.push_back(array);
+  }
+  // directory
+  std::vector<char> dir;
+  for (const auto &array: arrays) {
+    lcl::Append<std::uint32_t>(dir, static_cast<std::uint32_t>(array.name.size()));
+    dir.insert(dir.end(), array.name.begin(), array.name.end());
+    lcl::Append<std::uint32_t>(dir, static_cast<std::uint32_t>(array.type));
+    lcl::Append<std::uint32_t>(dir, array.size_value);
+    lcl::Append<std::uint32_t>(dir, array.is_compressed);
+    lcl::Append<std::uint64_t>(dir, array.num_value);
+    lcl::Append<std::uint64_t>(dir, array.offset);
+    lcl::Append<std::uint64_t>(dir, array.size_stored);
+    lcl::Append<std::uint64_t>(dir, array.checksum);
+  }
+  fout.write(dir.data(), static_cast<std::streamsize>(dir.size()));
+  // header
+  std::vector<char> head(lcl::kMagic, lcl::kMagic + 8);
+  lcl::Append<std::uint32_t>(head, lcl::kVersion);
+  lcl::Append<std::uint32_t>(head, lcl::kEndian);
+  lcl::Append<std::uint64_t>(head, arrays.size());
+  lcl::Append<std::uint64_t>(head, ofs);
+  lcl::Append<std::uint64_t>(head, dir.size());
+  lcl::Append<std::uint64_t>(head, lcl::HashFnv1a(dir.data(), dir.size()));
+  head.resize(lcl::kSizeHeader, 0);
+  fout.seekp(0);
+  fout.write(head.data(), static_cast<std::streamsize>(head.size()));
+  return !fout.fail();
+}
+
+// ----------------------------------------------------
+// below: ReaderSnapshot
+
+DFM2_INLINE bool delfem2::ReaderSnapshot::Open(
+    const std::filesystem::path &file_path) {
+  namespace lcl = ::delfem2::file_snapshot;
+  arrays_.clear();
+  cache_.clear();
+  if (!file_.Open(file_path)) { return false; }
+  const char *data = file_.data();
+  const char *end = data + file_.size();
+  if (file_.size() < lcl::kSizeHeader) { return false; }
+  if (std::memcmp(data, lcl::kMagic, 8) != 0) { return false; }
+  const char *p = data + 8;
+  std::uint32_t version, endian;
+  std::uint64_t num_array, ofs_dir, size_dir, checksum_dir;
+  bool is_ok = lcl::Load(version, p, end);
+  is_ok = is_ok && lcl::Load(endian, p, end);
+  is_ok = is_ok && lcl::Load(num_array, p, end);
+  is_ok = is_ok && lcl::Load(ofs_dir, p, end);
+  is_ok = is_ok && lcl::Load(size_dir, p, end);
+  is_ok = is_ok && lcl::Load(checksum_dir, p, end);
+  if (!is_ok) { return false; }
+  if (version != lcl::kVersion || endian != lcl::kEndian) { return false; }
+  if (ofs_dir > file_.size() || size_dir > file_.size() - ofs_dir) { return false; }
+  p = data + ofs_dir;
+  const char *end_dir = p + size_dir;
+  if (lcl::HashFnv1a(p, size_dir) != checksum_dir) { return false; }
+  for (std::uint64_t iarray = 0; iarray < num_array; ++iarray) {
+    SnapshotArray array;
+    std::uint32_t nchar, type;
+    if (!lcl::Load(nchar, p, end_dir) || nchar > static_cast<size_t>(end_dir - p)) { return false; }
+    array.name.assign(p, p + nchar);
+    p += nchar;
+    is_ok = lcl::Load(type, p, end_dir);
+    is_ok = is_ok && lcl::Load(array.size_value, p, end_dir);
+    is_ok = is_ok && lcl::Load(array.is_compressed, p, end_dir);
+    is_ok = is_ok && lcl::Load(array.num_value, p, end_dir);
+    is_ok = is_ok && lcl::Load(array.offset, p, end_dir);
+    is_ok = is_ok && lcl::Load(array.size_stored, p, end_dir);
+    is_ok = is_ok && lcl::Load(array.checksum, p, end_dir);
+    if (!is_ok || array.offset > ofs_dir || array.size_stored > ofs_dir - array.offset) { return false; }
+    // the number of bytes of the values needs to be consistent with the stored bytes
+    if (array.size_value == 0 || array.num_value > SIZE_MAX / array.size_value) { return false; }
+    const std::uint64_t nbyte = array.num_value * array.size_value;
+    if (!array.is_compressed && nbyte != array.size_stored) { return false; }
+    if (array.is_compressed && nbyte / lcl::kMaxRatioLz > array.size_stored) { return false; }
+    array.type = static_cast<SNAPSHOT_TYPE>(type);
+    arrays_.push_back(array);
+  }
+  return true;
+}
+
+DFM2_INLINE const delfem2::SnapshotArray *delfem2::ReaderSnapshot::Find(
+    const std::string &name) const {
+  for (const auto &array: arrays_) {
+    if (array.name == name) { return &array; }
+  }
+  return nullptr;
+}
+
+DFM2_INLINE bool delfem2::ReaderSnapshot::Verify(
+    const std::string &name) const {
+  namespace lcl = ::delfem2::file_snapshot;
+  const SnapshotArray *array = this->Find(name);
+  if (array == nullptr) { return false; }
+  return lcl::HashFnv1a(file_.data() + array->offset, array->size_stored) == array->checksum;
+}
+
+DFM2_INLINE bool delfem2::ReaderSnapshot::Verify() const {
+  for (const auto &array: arrays_) {
+    if (!this->Verify(array.name)) { return false; }
+  }
+  return true;
+}
+
+DFM2_INLINE const void *delfem2::ReaderSnapshot::ViewSource(
+    const std::string &name,
+    SNAPSHOT_TYPE type,
+    std::uint32_t size_value,
+    size_t &num_value) {
+  namespace lcl = ::delfem2::file_snapshot;
+  num_value = 0;
+  const SnapshotArray *array = this->Find(name);
+  if (array == nullptr || array->type != type || array->size_value != size_value) { return nullptr; }
+  const char *data = file_.data() + array->offset;
+  if (!array->is_compressed) {
+    num_value = array->num_value;
+    return data;
+  }
+  {
+    const auto itr = cache_.find(name);
+    if (itr != cache_.end()) {
+      num_value = array->num_value;
+      return itr->second.data();
+    }
+  }
+  const char *p = data;
+  const char *end = data + array->size_stored;
+  std::uint64_t nblock;
+  if (!lcl::Load(nblock, p, end)) { return nullptr; }
+  const size_t nbyte = array->num_value * array->size_value;  // bounded by the stored size in "Open"
+  if (nblock != (nbyte + lcl::kNumByteBlock - 1) / lcl::kNumByteBlock) { return nullptr; }
+  std::vector<char> shuffled(nbyte);
+  size_t ofs = 0;
+  for (std::uint64_t iblock = 0; iblock < nblock; ++iblock) {
+    std::uint32_t nraw, nstored;
+    if (!lcl::Load(nraw, p, end) || !lcl::Load(nstored, p, end)) { return nullptr; }
+    if (p + nstored > end || ofs + nraw > nbyte) { return nullptr; }
+    if (nraw == nstored) {
+      std::memcpy(shuffled.data() + ofs, p, nraw);
+    } else if (!Decompress_Lz(shuffled.data() + ofs, nraw, p, nstored)) {
+      return nullptr;
+    }
+    p += nstored;
+    ofs += nraw;
+  }
+  if (ofs != nbyte) { return nullptr; }
+  std::vector<std::uint64_t> &buff = cache_[name];  // 8-byte aligned storage
+  buff.resize((nbyte + 7) / 8);
+  lcl::UnshuffleBytes(
+      reinterpret_cast<char *>(buff.data()), shuffled.data(),
+      array->num_value, array->size_value);
+  num_value = array->num_value;
+  return buff.data();
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file binary snapshot of named arrays (e.g., positions, velocities, sparse matrix pattern, BVH nodes)
+ * @details The layout of the file is
+ * - header (64 bytes): magic "DFM2SNAP", version, endian marker, offset/size/checksum of the directory
+ * - data of the arrays. Each of them starts at a 64-byte aligned offset
+ * - directory: name, type, number of values, offset, stored size and checksum of each array
+ *
+ * Uncompressed arrays can be viewed in the memory-mapped file without any copy.
+ * Compressed arrays are byte-shuffled, split into blocks of 1MB and compressed with a LZ4-like codec.
+ */
+
+#ifndef DFM2_FILE_SNAPSHOT_H
+#define DFM2_FILE_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <map>
+#include <filesystem>
+#include <type_traits>
+
+#include "delfem2/dfm2_inline.h"
+#include "delfem2/file_mapped.h"
+
+namespace delfem2 {
+
+enum class SNAPSHOT_TYPE : std::uint32_t {
+  BYTE = 0,  //! trivially copyable struct (e.g., BVH node)
+  INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64, FLOAT32, FLOAT64
+};
+
+template<typename T>
+constexpr SNAPSHOT_TYPE SnapshotTypeOf() {
+  if constexpr (std::is_same_v<T, float>) { return SNAPSHOT_TYPE::FLOAT32; }
+  else if constexpr (std::is_same_v<T, double>) { return SNAPSHOT_TYPE::FLOAT64; }
+  else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+    if constexpr (sizeof(T) == 1) { return std::is_signed_v<T> ? SNAPSHOT_TYPE::INT8 : SNAPSHOT_TYPE::UINT8; }
+    if constexpr (sizeof(T) == 2) { return std::is_signed_v<T> ? SNAPSHOT_TYPE::INT16 : SNAPSHOT_TYPE::UINT16; }
+    if constexpr (sizeof(T) == 4) { return std::is_signed_v<T> ? SNAPSHOT_TYPE::INT32 : SNAPSHOT_TYPE::UINT32; }
+    if constexpr (sizeof(T) == 8) { return std::is_signed_v<T> ? SNAPSHOT_TYPE::INT64 : SNAPSHOT_TYPE::UINT64; }
+  }
+  return SNAPSHOT_TYPE::BYTE;
+}
+
+struct SnapshotArray {
+  std::string name;
+  SNAPSHOT_TYPE type = SNAPSHOT_TYPE::BYTE;
+  std::uint32_t size_value = 0;  //! number of bytes of a value
+  std::uint32_t is_compressed = 0;
+  std::uint64_t num_value = 0;
+  std::uint64_t offset = 0;  //! byte offset of the data in the file
+  std::uint64_t size_stored = 0;  //! number of bytes of the data in the file
+  std::uint64_t checksum = 0;  //! FNV-1a hash of the stored bytes
+};
+
+/**
+ * @brief writer of the snapshot file.
+ * @details the arrays are referenced (not copied), so they need to be alive until "Write" is called.
+ * @code
+ * WriterSnapshot snap;
+ * snap.Add("vtx_xyz", vtx_xyz);
+ * snap.Add("vtx_velo", vtx_velo, true);  // compressed
+ * snap.Add("bvh_nodes", bvh_nodes);  // trivially copyable struct
+ * snap.Write(path);
+ * @endcode
+ */
+class WriterSnapshot {
+ public:
+  template<typename T>
+  void Add(
+      const std::string &name,
+      const T *val,
+      size_t num_value,
+      bool is_compress = false) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    this->AddSource(name, val, SnapshotTypeOf<T>(), sizeof(T), num_value, is_compress);
+  }
+
+  template<typename T>
+  void Add(
+      const std::string &name,
+      const std::vector<T> &val,
+      bool is_compress = false) {
+    this->Add(name, val.data(), val.size(), is_compress);
+  }
+
+  /**
+   * @param num_thread number of threads for the compression. "0" means the number of hardware threads.
+   * @return false if the file cannot be written
+   */
+  bool Write(
+      const std::filesystem::path &file_path,
+      unsigned int num_thread = 0) const;
+
+ private:
+  struct Source {
+    SnapshotArray array;
+    const void *val = nullptr;
+  };
+  void AddSource(
+      const std::string &name,
+      const void *val,
+      SNAPSHOT_TYPE type,
+      std::uint32_t size_value,
+      size_t num_value,
+      bool is_compress);
+  std::vector<Source> sources_;
+};
+
+/**
+ * @brief reader of the snapshot file.
+ * @code
+ * ReaderSnapshot snap;
+ * snap.Open(path);
+ * size_t n;
+ * const double* vtx_xyz = snap.View<double>("vtx_xyz", n);  // zero-copy view to the mapped file
+ * snap.Read(vtx_velo, "vtx_velo");  // copy with checksum verification
+ * @endcode
+ */
+class ReaderSnapshot {
+ public:
+  /**
+   * @return false if the file cannot be opened or the header/directory is broken
+   */
+  bool Open(const std::filesystem::path &file_path);
+
+  [[nodiscard]] const std::vector<SnapshotArray> &Arrays() const { return arrays_; }
+  [[nodiscard]] const SnapshotArray *Find(const std::string &name) const;
+
+  /**
+   * @brief view of the values of an array. The checksum is not verified.
+   * @details compressed arrays are decompressed into a cache owned by this class.
+   * @return nullptr if the array does not exist, the type does not match or the data is broken
+   */
+  template<typename T>
+  const T *View(
+      const std::string &name,
+      size_t &num_value) {
+    return static_cast<const T *>(this->ViewSource(name, SnapshotTypeOf<T>(), sizeof(T), num_value));
+  }
+
+  /**
+   * @brief copy the values of an array after verifying its checksum
+   */
+  template<typename T>
+  bool Read(
+      std::vector<T> &val,
+      const std::string &name) {
+    if (!this->Verify(name)) { return false; }
+    size_t num_value;
+    const T *p = this->View<T>(name, num_value);
+    if (p == nullptr) { return false; }
+    val.assign(p, p + num_value);
+    return true;
+  }
+
+  //! verify the checksum of an array
+  bool Verify(const std::string &name) const;
+
+  //! verify the checksums of all the arrays
+  bool Verify() const;
+
+ private:
+  const void *ViewSource(
+      const std::string &name,
+      SNAPSHOT_TYPE type,
+      std::uint32_t size_value,
+      size_t &num_value);
+
+ private:
+  std::vector<SnapshotArray> arrays_;
+  MappedFile file_;
+  std::map<std::string, std::vector<std::uint64_t>> cache_;  // decompressed arrays
+};
+
+/**
+ * @brief compress bytes with a LZ4-like codec (literal runs and matches within 64KB)
+ */
+DFM2_INLINE void Compress_Lz(
+    std::vector<char> &dst,
+    const char *src,
+    size_t nsrc);
+
+/**
+ * @return false if the compressed data is broken or its size does not match "ndst"
+ */
+DFM2_INLINE bool Decompress_Lz(
+    char *dst,
+    size_t ndst,
+    const char *src,
+    size_t nsrc);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/file_snapshot.cpp"
+#endif
+
+#endif // DFM2_FILE_SNAPSHOT_H
@@ -7,8 +7,13 @@
 
 #include "delfem2/gridvoxel.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <queue>
 
+#include "delfem2/thread.h"
 #include "delfem2/vec3.h"
 
 // ---------------
@@ -36,14 +41,14 @@ const delfem2::CVec3d normalHexFace[6] = {
 }
 }
 
-bool delfem2::IsInclude_AABB(const int aabb[8], int igvx, int igvy, int igvz) {
+DFM2_INLINE bool delfem2::IsInclude_AABB(const int aabb[8], int igvx, int igvy, int igvz) {
   if (igvx < aabb[0] || igvx >= aabb[1]) { return false; }
   if (igvy < aabb[2] || igvy >= aabb[3]) { return false; }
   if (igvz < aabb[4] || igvz >= aabb[5]) { return false; }
   return true;
 }
 
-void delfem2::Add_AABB(int aabb[8], int ivx, int ivy, int ivz) {
+DFM2_INLINE void delfem2::Add_AABB(int aabb[8], int ivx, int ivy, int ivz) {
   const int ipx0 = ivx + 0;
   const int ipx1 = ivx + 1;
   const int ipy0 = ivy + 0;
@@ -67,7 +72,7 @@ void delfem2::Add_AABB(int aabb[8], int ivx, int ivy, int ivz) {
   }
 }
 
-void delfem2::MeshQuad3D_VoxelGrid(
+DFM2_INLINE void delfem2::MeshQuad3D_VoxelGrid(
     std::vector<double> &aXYZ,
     std::vector<unsigned int> &aQuad,
     unsigned int ndivx,
@@ -133,7 +138,7 @@ void delfem2::MeshQuad3D_VoxelGrid(
   }
 }
 
-void delfem2::MeshHex3D_VoxelGrid(
+DFM2_INLINE void delfem2::MeshHex3D_VoxelGrid(
     std::vector<double> &aXYZ,
     std::vector<int> &aHex,
     unsigned int ndivx,
@@ -191,7 +196,7 @@ void delfem2::MeshHex3D_VoxelGrid(
   }
 }
 
-void delfem2::MeshTet3D_VoxelGrid(
+DFM2_INLINE void delfem2::MeshTet3D_VoxelGrid(
     std::vector<double> &aXYZ,
     std::vector<int> &aTet,
     unsigned int ndivx,
@@ -270,7 +275,7 @@ void delfem2::MeshTet3D_VoxelGrid(
   }
 }
 
-int delfem2::Adj_Grid (
+DFM2_INLINE int delfem2::Adj_Grid (
     int igridvox, int iface,
     int ndivx, int ndivy, int ndivz) {
   int ivx0 = igridvox / (ndivy * ndivz);
@@ -293,7 +298,7 @@ int delfem2::Adj_Grid (
 // ---------------------------------------------------------------------
 
 
-void delfem2::Grid3Voxel_Dilation(
+DFM2_INLINE void delfem2::Grid3Voxel_Dilation(
     delfem2::CGrid3<int> &grid) {
   const int nx = (int) grid.ndivx;
   const int ny = (int) grid.ndivy;
@@ -325,7 +330,7 @@ void delfem2::Grid3Voxel_Dilation(
   }
 }
 
-void delfem2::Grid3Voxel_Erosion(
+DFM2_INLINE void delfem2::Grid3Voxel_Erosion(
     delfem2::CGrid3<int> &grid) {
   const int nx = (int) grid.ndivx;
   const int ny = (int) grid.ndivy;
@@ -358,7 +363,7 @@ void delfem2::Grid3Voxel_Erosion(
 }
 
 // dijkstra method
-void delfem2::VoxelGeodesic
+DFM2_INLINE void delfem2::VoxelGeodesic
     (std::vector<double> &aDist,
      const std::vector<std::pair<unsigned int, double> > &aIdvoxDist,
      const double el,
@@ -416,12 +421,12 @@ void delfem2::VoxelGeodesic
 namespace delfem2 {
 namespace gridvoxel {
 
-int signum(double x) {
+DFM2_INLINE int signum(double x) {
   return x > 0.0 ? 1 : x < 0.0 ? -1 : 0;
 }
 
 // Find the smallest positive t such that s+t*ds is an integer.
-double intbound(double s, double ds) {
+DFM2_INLINE double intbound(double s, double ds) {
   if (ds < 0) {
     return intbound(-s, -ds);
   } else {
@@ -437,7 +442,7 @@ double intbound(double s, double ds) {
  * Amanatides, John, and Andrew Woo. "A fast voxel traversal algorithm for ray tracing." In Eurographics, vol. 87, no. 3, pp. 3-10. 1987.
  * TODO: zero division might occur when (ps - pe ) is aligned to axis.
  */
-void delfem2::Intersection_VoxelGrid_LinSeg(
+DFM2_INLINE void delfem2::Intersection_VoxelGrid_LinSeg(
     std::vector<unsigned int> &aIndVox,
     const CGrid3<int> &grid,
     const CVec3d &ps,
@@ -504,3 +509,285 @@ void delfem2::Intersection_VoxelGrid_LinSeg(
   }
    */
 }
+
+// ---------------------------------------------
+// voxelization of a triangle mesh
+
+namespace delfem2::gridvoxel {
+
+//! number of the columns of voxels along x and y in a tile. A tile is a task of the thread pool
+constexpr unsigned int kTile = 8;
+
+//! vertices are snapped to the lattice of 1/kSnap of the voxel for the parity test
+constexpr double kSnap = 1024.0;
+
+//! bound of the snapped coordinates such that the orientation does not overflow 64bit integer
+constexpr double kSnapMax = static_cast<double>((std::int64_t(1) << 30) - 1);
+
+//! number of vertices or triangles processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 12;
+
+/**
+ * range of the voxels [i0,i1] whose closed box [i,i+1] overlaps [min,max] and which are in [0,ndiv)
+ * @return false if the range is empty
+ */
+DFM2_INLINE bool RangeVoxel(
+    int &i0, int &i1,
+    double min, double max,
+    unsigned int ndiv) {
+  const double d0 = std::max(std::ceil(min) - 1., 0.);
+  const double d1 = std::min(std::floor(max), ndiv - 1.);
+  if (d0 > d1) { return false; }
+  i0 = static_cast<int>(d0);
+  i1 = static_cast<int>(d1);
+  return true;
+}
+
+/**
+ * @brief overlap of a triangle and the voxel [0,1]^3 with the separating axis test
+ * @details the coordinates of the triangle are relative to the corner of the voxel.
+ * The voxel is slightly inflated so that the round-off error does not miss the touching triangles.
+ * T. Akenine-Moller, "Fast 3D triangle-box overlap testing", Journal of Graphics Tools, 6(1), 2001.
+ */
+DFM2_INLINE bool IsOverlap_TriVoxel(
+    const double q0[3],
+    const double q1[3],
+    const double q2[3]) {
+  constexpr double h = 0.5 + 1.0e-10; // half size of the voxel
+  const double v0[3] = {q0[0] - 0.5, q0[1] - 0.5, q0[2] - 0.5};
+  const double v1[3] = {q1[0] - 0.5, q1[1] - 0.5, q1[2] - 0.5};
+  const double v2[3] = {q2[0] - 0.5, q2[1] - 0.5, q2[2] - 0.5};
+  for (unsigned int i = 0; i < 3; ++i) { // axes of the voxel
+    if (std::min({v0[i], v1[i], v2[i]}) > h) { return false; }
+    if (std::max({v0[i], v1[i], v2[i]}) < -h) { return false; }
+  }
+  const double *v[3] = {v0, v1, v2};
+  for (unsigned int ie = 0; ie < 3; ++ie) { // cross products of the edges and the axes
+    const double *va = v[ie];
+    const double *vb = v[(ie + 1) % 3];
+    const double *vc = v[(ie + 2) % 3];
+    const double e[3] = {vb[0] - va[0], vb[1] - va[1], vb[2] - va[2]};
+    for (unsigned int i = 0; i < 3; ++i) {
+      const unsigned int j = (i + 1) % 3;
+      const unsigned int k = (i + 2) % 3;
+      // axis = e x unit(i), which has the components (0, e[k], -e[j]) in the (i,j,k) order
+      const double pa = e[k] * va[j] - e[j] * va[k]; // same for vb
+      const double pc = e[k] * vc[j] - e[j] * vc[k];
+      const double r = h * (std::fabs(e[k]) + std::fabs(e[j]));
+      if (std::min(pa, pc) > r || std::max(pa, pc) < -r) { return false; }
+    }
+  }
+  { // normal of the triangle
+    const double e0[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]};
+    const double e1[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
+    const double n[3] = {
+        e0[1] * e1[2] - e0[2] * e1[1],
+        e0[2] * e1[0] - e0[0] * e1[2],
+        e0[0] * e1[1] - e0[1] * e1[0]};
+    const double d = n[0] * v0[0] + n[1] * v0[1] + n[2] * v0[2];
+    const double r = h * (std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]));
+    if (std::fabs(d) > r) { return false; }
+  }
+  return true;
+}
+
+/**
+ * @brief sign of the orientation of the 2D points a,b,q without the round-off error
+ * @details the edge is evaluated from the lexicographically smaller end point, so the two triangles sharing
+ * the edge see the exactly opposite signs. The tie is broken by perturbing q by (eps, eps^2) (simulation of simplicity).
+ * "0" is returned only if a and b are the same point.
+ */
+DFM2_INLINE int SignOrient_SoS(
+    const std::int64_t a[2],
+    const std::int64_t b[2],
+    const std::int64_t q[2]) {
+  const bool is_swap = (b[0] < a[0]) || (b[0] == a[0] && b[1] < a[1]);
+  const std::int64_t *lo = is_swap ? b : a;
+  const std::int64_t *hi = is_swap ? a : b;
+  const std::int64_t dx = hi[0] - lo[0];
+  const std::int64_t dy = hi[1] - lo[1];
+  const std::int64_t w = dx * (q[1] - lo[1]) - dy * (q[0] - lo[0]);
+  int sign;
+  if (w != 0) { sign = (w > 0) ? 1 : -1; }
+  else if (dy != 0) { sign = (dy > 0) ? -1 : 1; }
+  else { sign = (dx > 0) ? 1 : 0; }
+  return is_swap ? -sign : sign;
+}
+
+/**
+ * @brief height of the intersection of the triangle and the ray parallel to z-axis
+ * @param[out] z height of the intersection in the local coordinate of the grid
+ * @return false if the ray does not hit the triangle
+ */
+DFM2_INLINE bool HeightHitTri(
+    double &z,
+    const std::int64_t *s0, const std::int64_t *s1, const std::int64_t *s2, // snapped xy
+    double z0, double z1, double z2,
+    const std::int64_t q[2]) {
+  const int o0 = SignOrient_SoS(s1, s2, q);
+  if (o0 == 0) { return false; }
+  if (SignOrient_SoS(s2, s0, q) != o0) { return false; }
+  if (SignOrient_SoS(s0, s1, q) != o0) { return false; }
+  auto area = [q](const std::int64_t *a, const std::int64_t *b) {
+    return static_cast<double>((a[0] - q[0]) * (b[1] - q[1]) - (a[1] - q[1]) * (b[0] - q[0]));
+  };
+  const double w0 = area(s1, s2);
+  const double w1 = area(s2, s0);
+  const double w2 = area(s0, s1);
+  const double sum = w0 + w1 + w2;
+  if (sum == 0.) { return false; }
+  z = (w0 * z0 + w1 * z1 + w2 * z2) / sum;
+  return true;
+}
+
+}
+
+DFM2_INLINE void delfem2::Grid3Voxel_MeshTri3D(
+    CGrid3<int> &grid,
+    const double *vtx_xyz,
+    size_t num_vtx,
+    const unsigned int *tri_vtx,
+    size_t num_tri,
+    bool is_fill_inside,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::gridvoxel;
+  constexpr unsigned int kTile = lcl::kTile;
+  const unsigned int nx = grid.ndivx, ny = grid.ndivy, nz = grid.ndivz;
+  assert(nx < (1u << 20) && ny < (1u << 20));
+  grid.aVal.assign(static_cast<size_t>(nx) * ny * nz, 0);
+  if (nx == 0 || ny == 0 || nz == 0) { return; }
+  // local coordinates of the vertices and their snapped xy
+  std::vector<double> vtx_loc(num_vtx * 3);
+  std::vector<std::int64_t> vtx_snap(num_vtx * 2);
+  {
+    const CMat4d ami = grid.am.Inverse();
+    parallel_for_chunk(
+        num_vtx, lcl::kNumChunk,
+        [&](size_t ivtx0, size_t ivtx1) {
+          for (size_t ivtx = ivtx0; ivtx < ivtx1; ++ivtx) {
+            double *p = vtx_loc.data() + ivtx * 3;
+            Vec3_Mat4Vec3_Affine(p, ami.mat, vtx_xyz + ivtx * 3);
+            for (unsigned int i = 0; i < 2; ++i) {
+              const double s = std::clamp(std::round(p[i] * lcl::kSnap), -lcl::kSnapMax, lcl::kSnapMax);
+              vtx_snap[ivtx * 2 + i] = static_cast<std::int64_t>(s);
+            }
+          }
+        }, num_thread);
+  }
+  // tiles covered by the triangles. xy is enough, as the triangles above or below the grid change the parity
+  const unsigned int ntx = (nx + kTile - 1) / kTile;
+  const unsigned int nty = (ny + kTile - 1) / kTile;
+  std::vector<unsigned int> tri_tile(num_tri * 4);
+  parallel_for_chunk(
+      num_tri, lcl::kNumChunk,
+      [&](size_t itri0, size_t itri1) {
+        for (size_t itri = itri0; itri < itri1; ++itri) {
+          const double *p0 = vtx_loc.data() + tri_vtx[itri * 3 + 0] * 3;
+          const double *p1 = vtx_loc.data() + tri_vtx[itri * 3 + 1] * 3;
+          const double *p2 = vtx_loc.data() + tri_vtx[itri * 3 + 2] * 3;
+          unsigned int *tt = tri_tile.data() + itri * 4;
+          int ix0, ix1, iy0, iy1;
+          if (!lcl::RangeVoxel(ix0, ix1, std::min({p0[0], p1[0], p2[0]}), std::max({p0[0], p1[0], p2[0]}), nx) ||
+              !lcl::RangeVoxel(iy0, iy1, std::min({p0[1], p1[1], p2[1]}), std::max({p0[1], p1[1], p2[1]}), ny)) {
+            tt[0] = 1;
+            tt[1] = 0;
+            tt[2] = 1;
+            tt[3] = 0;
+            continue;
+          }
+          tt[0] = ix0 / kTile;
+          tt[1] = ix1 / kTile;
+          tt[2] = iy0 / kTile;
+          tt[3] = iy1 / kTile;
+        }
+      }, num_thread);
+  // triangles of the tiles in the order of the triangle index (counting sort)
+  const size_t ntile = static_cast<size_t>(ntx) * nty;
+  std::vector<size_t> tile_ind(ntile + 1, 0);
+  for (size_t itri = 0; itri < num_tri; ++itri) {
+    const unsigned int *tt = tri_tile.data() + itri * 4;
+    for (unsigned int itx = tt[0]; itx <= tt[1]; ++itx) {
+      for (unsigned int ity = tt[2]; ity <= tt[3]; ++ity) {
+        tile_ind[itx * nty + ity + 1] += 1;
+      }
+    }
+  }
+  for (size_t itile = 0; itile < ntile; ++itile) { tile_ind[itile + 1] += tile_ind[itile]; }
+  std::vector<unsigned int> tile_tri(tile_ind[ntile]);
+  {
+    std::vector<size_t> head(tile_ind.begin(), tile_ind.end() - 1);
+    for (size_t itri = 0; itri < num_tri; ++itri) {
+      const unsigned int *tt = tri_tile.data() + itri * 4;
+      for (unsigned int itx = tt[0]; itx <= tt[1]; ++itx) {
+        for (unsigned int ity = tt[2]; ity <= tt[3]; ++ity) {
+          tile_tri[head[itx * nty + ity]++] = static_cast<unsigned int>(itri);
+        }
+      }
+    }
+  }
+  // each tile only writes the voxels in its columns
+  auto voxelize_tile = [&](size_t itile) {
+    const unsigned int itx = static_cast<unsigned int>(itile / nty);
+    const unsigned int ity = static_cast<unsigned int>(itile % nty);
+    const int jx0 = itx * kTile, jx1 = std::min((itx + 1) * kTile, nx) - 1;
+    const int jy0 = ity * kTile, jy1 = std::min((ity + 1) * kTile, ny) - 1;
+    for (size_t iit = tile_ind[itile]; iit < tile_ind[itile + 1]; ++iit) { // surface
+      const unsigned int itri = tile_tri[iit];
+      const double *p0 = vtx_loc.data() + tri_vtx[itri * 3 + 0] * 3;
+      const double *p1 = vtx_loc.data() + tri_vtx[itri * 3 + 1] * 3;
+      const double *p2 = vtx_loc.data() + tri_vtx[itri * 3 + 2] * 3;
+      int i0[3], i1[3];
+      if (!lcl::RangeVoxel(i0[0], i1[0], std::min({p0[0], p1[0], p2[0]}), std::max({p0[0], p1[0], p2[0]}), nx) ||
+          !lcl::RangeVoxel(i0[1], i1[1], std::min({p0[1], p1[1], p2[1]}), std::max({p0[1], p1[1], p2[1]}), ny) ||
+          !lcl::RangeVoxel(i0[2], i1[2], std::min({p0[2], p1[2], p2[2]}), std::max({p0[2], p1[2], p2[2]}), nz)) {
+        continue;
+      }
+      i0[0] = std::max(i0[0], jx0);
+      i1[0] = std::min(i1[0], jx1);
+      i0[1] = std::max(i0[1], jy0);
+      i1[1] = std::min(i1[1], jy1);
+      for (int ix = i0[0]; ix <= i1[0]; ++ix) {
+        for (int iy = i0[1]; iy <= i1[1]; ++iy) {
+          int *val = grid.aVal.data() + (static_cast<size_t>(ix) * ny + iy) * nz;
+          for (int iz = i0[2]; iz <= i1[2]; ++iz) {
+            if (val[iz] == 1) { continue; }
+            const double q0[3] = {p0[0] - ix, p0[1] - iy, p0[2] - iz};
+            const double q1[3] = {p1[0] - ix, p1[1] - iy, p1[2] - iz};
+            const double q2[3] = {p2[0] - ix, p2[1] - iy, p2[2] - iz};
+            if (lcl::IsOverlap_TriVoxel(q0, q1, q2)) { val[iz] = 1; }
+          }
+        }
+      }
+    }
+    if (!is_fill_inside) { return; }
+    std::vector<double> aZ;
+    for (int ix = jx0; ix <= jx1; ++ix) { // inside
+      for (int iy = jy0; iy <= jy1; ++iy) {
+        const std::int64_t q[2] = {
+            static_cast<std::int64_t>((ix + 0.5) * lcl::kSnap),
+            static_cast<std::int64_t>((iy + 0.5) * lcl::kSnap)};
+        aZ.clear();
+        for (size_t iit = tile_ind[itile]; iit < tile_ind[itile + 1]; ++iit) {
+          const unsigned int *tri = tri_vtx + tile_tri[iit] * 3;
+          double z;
+          if (!lcl::HeightHitTri(
+              z,
+              vtx_snap.data() + tri[0] * 2, vtx_snap.data() + tri[1] * 2, vtx_snap.data() + tri[2] * 2,
+              vtx_loc[tri[0] * 3 + 2], vtx_loc[tri[1] * 3 + 2], vtx_loc[tri[2] * 3 + 2],
+              q)) { continue; }
+          aZ.push_back(z);
+        }
+        std::sort(aZ.begin(), aZ.end());
+        int *val = grid.aVal.data() + (static_cast<size_t>(ix) * ny + iy) * nz;
+        for (size_t ih = 0; ih + 1 < aZ.size(); ih += 2) {
+          // voxels whose centers are in (aZ[ih], aZ[ih+1])
+          const double d0 = std::max(std::floor(aZ[ih] - 0.5) + 1., 0.);
+          const double d1 = std::min(std::ceil(aZ[ih + 1] - 0.5) - 1., nz - 1.);
+          if (d0 > d1) { continue; }
+          for (int iz = static_cast<int>(d0); iz <= static_cast<int>(d1); ++iz) { val[iz] = 1; }
+        }
+      }
+    }
+  };
+  parallel_for_chunk(ntile, 1, [&](size_t itile, size_t) { voxelize_tile(itile); }, num_thread);
+}
@@ -8,6 +8,7 @@
 #ifndef DFM2_GRIDVOXEL_H
 #define DFM2_GRIDVOXEL_H
 
+#include <cstddef>
 #include <vector>
 
 #include "delfem2/dfm2_inline.h"
@@ -16,20 +17,20 @@
 
 namespace delfem2 {
 
-int Adj_Grid(
+DFM2_INLINE int Adj_Grid(
     int igridvox, int iface,
     int ndivx, int ndivy, int ndivz);
 
-bool IsInclude_AABB(
+DFM2_INLINE bool IsInclude_AABB(
     const int aabb[8], int igvx, int igvy, int igvz);
 
-void Add_AABB(
+DFM2_INLINE void Add_AABB(
     int aabb[8],
     int ivx, int ivy, int ivz);
 
 // -----------------------------------------------
 
-void MeshQuad3D_VoxelGrid(
+DFM2_INLINE void MeshQuad3D_VoxelGrid(
     std::vector<double> &aXYZ,
     std::vector<unsigned int> &aQuad,
     unsigned int ndivx,
@@ -37,7 +38,7 @@ void MeshQuad3D_VoxelGrid(
     unsigned int ndivz,
     const std::vector<int> &aIsVox);
 
-void MeshHex3D_VoxelGrid(
+DFM2_INLINE void MeshHex3D_VoxelGrid(
     std::vector<double> &aXYZ,
     std::vector<int> &aQuad,
     unsigned int ndivx,
@@ -45,7 +46,7 @@ void MeshHex3D_VoxelGrid(
     unsigned int ndivz,
     const std::vector<int> &aIsVox);
 
-void MeshTet3D_VoxelGrid(
+DFM2_INLINE void MeshTet3D_VoxelGrid(
     std::vector<double> &aXYZ,
     std::vector<int> &aTet,
     unsigned int ndivx,
@@ -87,16 +88,16 @@ class CGrid3 {
   CMat4d am; // affine matrix
 };
 
-void Grid3Voxel_Dilation(CGrid3<int> &grid);
+DFM2_INLINE void Grid3Voxel_Dilation(CGrid3<int> &grid);
 
-void Grid3Voxel_Erosion(CGrid3<int> &grid);
+DFM2_INLINE void Grid3Voxel_Erosion(CGrid3<int> &grid);
 
 /**
  * @brief comute voxel geodesic distance from one seed voxel
  * @param aDist (out) geodesic distance at the center of the voxle
  * @param el (in) edge length of the voxel
  */
-void VoxelGeodesic(
+DFM2_INLINE void VoxelGeodesic(
     std::vector<double> &aDist,
     const std::vector<std::pair<unsigned int, double> > &aIdvoxDist,
     double el,
@@ -107,12 +108,38 @@ void VoxelGeodesic(
  * Amanatides, John, and Andrew Woo. "A fast voxel traversal algorithm for ray tracing." In Eurographics, vol. 87, no. 3, pp. 3-10. 1987.
  * TODO: zero division might occur when (ps - pe ) is aligned to axis.
  */
-void Intersection_VoxelGrid_LinSeg(
+DFM2_INLINE void Intersection_VoxelGrid_LinSeg(
     std::vector<unsigned int> &aIndVox,
     const CGrid3<int> &grid,
     const CVec3d &ps,
     const CVec3d &pe);
 
+/**
+ * @brief voxelize a closed triangle mesh
+ * @details The voxels overlapping with a triangle (separating axis test, touching counts as overlapping) and
+ * the voxels whose centers are inside the mesh are set "1", and the others are set "0".
+ * The voxel (ivx,ivy,ivz) occupies [ivx,ivx+1]x[ivy,ivy+1]x[ivz,ivz+1] in the local coordinate of the grid,
+ * which is transformed with "grid.am". The values are stored in the same order as "CGrid3::Set".
+ * The size of the grid needs to be set with "CGrid3::Initialize" beforehand.
+ *
+ * The inside is decided by the parity of the intersections along the z-axis. For this test, the vertices are
+ * snapped to the lattice of 1/1024 of the voxel and the predicates are evaluated exactly with integers with
+ * the simulation of simplicity, so a ray passing through an edge or a vertex is counted exactly once.
+ * The error of the snapping only affects the voxels overlapping with the surface, which are set anyway.
+ * The grid needs to be smaller than 2^20 voxels in each direction.
+ * The grid is processed in parallel by columns of 8x8 voxels, so the result does not depend on the number of threads.
+ * @param is_fill_inside if false, only the voxels overlapping with the surface are set
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ */
+DFM2_INLINE void Grid3Voxel_MeshTri3D(
+    CGrid3<int> &grid,
+    const double *vtx_xyz,
+    size_t num_vtx,
+    const unsigned int *tri_vtx,
+    size_t num_tri,
+    bool is_fill_inside = true,
+    unsigned int num_thread = 0);
+
 
 /*
 void Add(int ivx, int ivy, int ivz){
@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/gridvoxel_sparse.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+#include "delfem2/thread.h"
+
+namespace delfem2::gridvoxel_sparse {
+
+//! number of voxels or points processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 12;
+
+constexpr unsigned int kB = CGrid3Sparse<int>::kBrickSize;
+constexpr unsigned int kH = kB + 2; // brick with the halo of one voxel
+
+const int aFace[6][3] = {
+    {-1, 0, 0},
+    {+1, 0, 0},
+    {0, -1, 0},
+    {0, +1, 0},
+    {0, 0, -1},
+    {0, 0, +1}};
+
+/**
+ * @brief values of the brick and the voxels facing to it
+ * @details halo[(ix+1)*kH*kH+(iy+1)*kH+(iz+1)] is the value of the voxel (ix,iy,iz) in the brick for -1<=ix,iy,iz<=8.
+ * Only the voxels sharing a face with the brick are set in the halo. The voxels outside the grid have the background value.
+ */
+DFM2_INLINE void GatherBrickHalo(
+    int halo[kH * kH * kH],
+    const CGrid3Sparse<int> &grid,
+    unsigned int ibrick) {
+  for (unsigned int i = 0; i < kH * kH * kH; ++i) { halo[i] = grid.background; }
+  const int *val = grid.brick_val.data() + static_cast<size_t>(ibrick) * grid.kBrickVox;
+  for (unsigned int ix = 0; ix < kB; ++ix) {
+    for (unsigned int iy = 0; iy < kB; ++iy) {
+      for (unsigned int iz = 0; iz < kB; ++iz) {
+        halo[(ix + 1) * kH * kH + (iy + 1) * kH + (iz + 1)] = val[(ix * kB + iy) * kB + iz];
+      }
+    }
+  }
+  const unsigned int *bc = grid.brick_coord.data() + ibrick * 3;
+  const unsigned int nb[3] = {grid.nbrickx, grid.nbricky, grid.nbrickz};
+  for (const auto &face: aFace) {
+    int jb[3];
+    for (unsigned int idim = 0; idim < 3; ++idim) { jb[idim] = static_cast<int>(bc[idim]) + face[idim]; }
+    if (jb[0] < 0 || jb[1] < 0 || jb[2] < 0) { continue; }
+    if (jb[0] >= (int) nb[0] || jb[1] >= (int) nb[1] || jb[2] >= (int) nb[2]) { continue; }
+    const unsigned int jbrick = grid.brick_index[grid.IndexBrick(jb[0], jb[1], jb[2])];
+    if (jbrick == UINT_MAX) { continue; }
+    const int *val1 = grid.brick_val.data() + static_cast<size_t>(jbrick) * grid.kBrickVox;
+    // the layer of the neighbouring brick facing to this brick
+    for (unsigned int i = 0; i < kB; ++i) {
+      for (unsigned int j = 0; j < kB; ++j) {
+        unsigned int is[3], ih[3];
+        if (face[0] != 0) {
+          is[0] = (face[0] < 0) ? kB - 1 : 0;
+          is[1] = i;
+          is[2] = j;
+          ih[0] = (face[0] < 0) ? 0 : kB + 1;
+          ih[1] = i + 1;
+          ih[2] = j + 1;
+        } else if (face[1] != 0) {
+          is[0] = i;
+          is[1] = (face[1] < 0) ? kB - 1 : 0;
+          is[2] = j;
+          ih[0] = i + 1;
+          ih[1] = (face[1] < 0) ? 0 : kB + 1;
+          ih[2] = j + 1;
+        } else {
+          is[0] = i;
+          is[1] = j;
+          is[2] = (face[2] < 0) ? kB - 1 : 0;
+          ih[0] = i + 1;
+          ih[1] = j + 1;
+          ih[2] = (face[2] < 0) ? 0 : kB + 1;
+        }
+        halo[(ih[0] * kH + ih[1]) * kH + ih[2]] = val1[(is[0] * kB + is[1]) * kB + is[2]];
+      }
+    }
+  }
+}
+
+/**
+ * @brief apply "func(v0, v_neighbours[6])" to all the voxels inside the grid in the allocated bricks
+ */
+template<typename FUNC>
+void MapBrick6(
+    CGrid3Sparse<int> &grid,
+    unsigned int num_thread,
+    FUNC &&func) {
+  std::vector<int> val_new(grid.brick_val.size());
+  parallel_for_chunk(
+      grid.NumBrick(), 1,
+      [&](size_t ibrick, size_t) {
+        int halo[kH * kH * kH];
+        GatherBrickHalo(halo, grid, static_cast<unsigned int>(ibrick));
+        const unsigned int *bc = grid.brick_coord.data() + ibrick * 3;
+        int *val1 = val_new.data() + ibrick * grid.kBrickVox;
+        for (unsigned int ix = 0; ix < kB; ++ix) {
+          for (unsigned int iy = 0; iy < kB; ++iy) {
+            for (unsigned int iz = 0; iz < kB; ++iz) {
+              const unsigned int ih = ((ix + 1) * kH + (iy + 1)) * kH + (iz + 1);
+              const unsigned int iloc = (ix * kB + iy) * kB + iz;
+              if (!grid.IsInclude(bc[0] * kB + ix, bc[1] * kB + iy, bc[2] * kB + iz)) {
+                val1[iloc] = grid.background;
+                continue;
+              }
+              const int v6[6] = {
+                  halo[ih - kH * kH], halo[ih + kH * kH],
+                  halo[ih - kH], halo[ih + kH],
+                  halo[ih - 1], halo[ih + 1]};
+              val1[iloc] = func(halo[ih], v6);
+            }
+          }
+        }
+      }, num_thread);
+  grid.brick_val.swap(val_new);
+}
+
+/**
+ * @brief visit the cells of the unit lattice crossed by the segment in the order from "ps" to "pe"
+ * @details only the cells in [imin,imax) are visited.
+ * Amanatides, John, and Andrew Woo. "A fast voxel traversal algorithm for ray tracing." In Eurographics, vol. 87, no. 3, pp. 3-10. 1987.
+ */
+template<typename FUNC>
+void TraverseLattice(
+    const double ps[3],
+    const double pe[3],
+    const int imin[3],
+    const int imax[3],
+    FUNC &&func) {
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  const double d[3] = {pe[0] - ps[0], pe[1] - ps[1], pe[2] - ps[2]};
+  double t0 = 0.0, t1 = 1.0;
+  for (unsigned int idim = 0; idim < 3; ++idim) { // clip the segment with the box
+    if (d[idim] == 0.0) {
+      if (ps[idim] < imin[idim] || ps[idim] >= imax[idim]) { return; }
+      continue;
+    }
+    double ta = (imin[idim] - ps[idim]) / d[idim];
+    double tb = (imax[idim] - ps[idim]) / d[idim];
+    if (ta > tb) { std::swap(ta, tb); }
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+  }
+  if (t0 > t1) { return; }
+  int ic[3], step[3];
+  double tmax[3], tdelta[3];
+  for (unsigned int idim = 0; idim < 3; ++idim) {
+    const double p0 = ps[idim] + t0 * d[idim];
+    ic[idim] = std::clamp(static_cast<int>(std::floor(p0)), imin[idim], imax[idim] - 1);
+    if (d[idim] > 0) {
+      step[idim] = 1;
+      tdelta[idim] = 1.0 / d[idim];
+      tmax[idim] = (ic[idim] + 1 - ps[idim]) / d[idim];
+    } else if (d[idim] < 0) {
+      step[idim] = -1;
+      tdelta[idim] = -1.0 / d[idim];
+      tmax[idim] = (ic[idim] - ps[idim]) / d[idim];
+    } else {
+      step[idim] = 0;
+      tdelta[idim] = inf;
+      tmax[idim] = inf;
+    }
+  }
+  while (true) {
+    func(ic);
+    unsigned int m = 0;
+    if (tmax[1] < tmax[m]) { m = 1; }
+    if (tmax[2] < tmax[m]) { m = 2; }
+    if (tmax[m] > t1) { break; }
+    ic[m] += step[m];
+    if (ic[m] < imin[m] || ic[m] >= imax[m]) { break; }
+    tmax[m] += tdelta[m];
+  }
+}
+
+//! corners of the hexahedron in the unit cube in the order of "MeshHex3D_VoxelGrid"
+const unsigned int hexflg[8][3] = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+    {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+
+/**
+ * @brief points of the non-empty voxels and the corners of the hexahedra
+ * @details the lattice point (px,py,pz) belongs to the brick (px/8,py/8,pz/8) of the lattice of the points,
+ * which has one more brick along each axis than the grid of the voxels.
+ * The points are numbered brick by brick.
+ */
+DFM2_INLINE void HexVoxelGridSparse(
+    std::vector<double> &aXYZ,
+    std::vector<unsigned int> &aHex,
+    const CGrid3Sparse<int> &grid,
+    unsigned int num_thread) {
+  constexpr unsigned int nvb = CGrid3Sparse<int>::kBrickVox;
+  constexpr unsigned int kBit = CGrid3Sparse<int>::kBrickBit;
+  std::vector<unsigned int> aIndVox;
+  Grid3Sparse_ActiveVoxels(aIndVox, grid, num_thread);
+  const size_t nvox = aIndVox.size();
+  const unsigned int mb[3] = {grid.nbrickx + 1, grid.nbricky + 1, grid.nbrickz + 1};
+  auto index_brick_point = [&mb](const unsigned int ip[3]) {
+    return ((static_cast<size_t>(ip[0] >> kBit) * mb[1]) + (ip[1] >> kBit)) * mb[2] + (ip[2] >> kBit);
+  };
+  // bricks of the points
+  std::vector<unsigned int> aBrickPoint; // index of the brick in the lattice of the points
+  std::vector<unsigned int> brickpoint2idx(static_cast<size_t>(mb[0]) * mb[1] * mb[2], UINT_MAX);
+  for (unsigned int ibrick = 0; ibrick < grid.NumBrick(); ++ibrick) {
+    const unsigned int *bc = grid.brick_coord.data() + ibrick * 3;
+    for (const auto &c: hexflg) {
+      brickpoint2idx[((static_cast<size_t>(bc[0] + c[0]) * mb[1]) + bc[1] + c[1]) * mb[2] + bc[2] + c[2]] = 0;
+    }
+  }
+  for (size_t ib = 0; ib < brickpoint2idx.size(); ++ib) {
+    if (brickpoint2idx[ib] == UINT_MAX) { continue; }
+    brickpoint2idx[ib] = static_cast<unsigned int>(aBrickPoint.size());
+    aBrickPoint.push_back(static_cast<unsigned int>(ib));
+  }
+  // flag the points used by the voxels
+  std::vector<unsigned int> aIndPoint(aBrickPoint.size() * nvb, 0);
+  for (size_t iivox = 0; iivox < nvox; ++iivox) {
+    unsigned int iv[3];
+    grid.CoordVoxel(iv, aIndVox[iivox]);
+    for (const auto &c: hexflg) {
+      const unsigned int ip[3] = {iv[0] + c[0], iv[1] + c[1], iv[2] + c[2]};
+      aIndPoint[brickpoint2idx[index_brick_point(ip)] * nvb + CGrid3Sparse<int>::IndexLocal(ip[0], ip[1], ip[2])] = 1;
+    }
+  }
+  // number the points brick by brick
+  std::vector<unsigned int> aCount(aBrickPoint.size() + 1, 0);
+  parallel_for_chunk(
+      aBrickPoint.size(), 1,
+      [&](size_t ibp, size_t) {
+        unsigned int icnt = 0;
+        for (unsigned int iloc = 0; iloc < nvb; ++iloc) { icnt += aIndPoint[ibp * nvb + iloc]; }
+        aCount[ibp + 1] = icnt;
+      }, num_thread);
+  for (size_t ibp = 0; ibp < aBrickPoint.size(); ++ibp) { aCount[ibp + 1] += aCount[ibp]; }
+  aXYZ.resize(aCount[aBrickPoint.size()] * 3);
+  parallel_for_chunk(
+      aBrickPoint.size(), 1,
+      [&](size_t ibp, size_t) {
+        const unsigned int ib = aBrickPoint[ibp];
+        const unsigned int bc[3] = {ib / (mb[1] * mb[2]), (ib / mb[2]) % mb[1], ib % mb[2]};
+        unsigned int icnt = aCount[ibp];
+        for (unsigned int iloc = 0; iloc < nvb; ++iloc) {
+          unsigned int &ip = aIndPoint[ibp * nvb + iloc];
+          if (ip == 0) {
+            ip = UINT_MAX;
+            continue;
+          }
+          ip = icnt;
+          aXYZ[icnt * 3 + 0] = (bc[0] << kBit) + (iloc >> (2 * kBit));
+          aXYZ[icnt * 3 + 1] = (bc[1] << kBit) + ((iloc >> kBit) & ((1u << kBit) - 1));
+          aXYZ[icnt * 3 + 2] = (bc[2] << kBit) + (iloc & ((1u << kBit) - 1));
+          ++icnt;
+        }
+      }, num_thread);
+  aHex.resize(nvox * 8);
+  parallel_for_chunk(
+      nvox, kNumChunk,
+      [&](size_t iivox0, size_t iivox1) {
+        for (size_t iivox = iivox0; iivox < iivox1; ++iivox) {
+          unsigned int iv[3];
+          grid.CoordVoxel(iv, aIndVox[iivox]);
+          for (unsigned int inoh = 0; inoh < 8; ++inoh) {
+            const unsigned int ip[3] = {iv[0] + hexflg[inoh][0], iv[1] + hexflg[inoh][1], iv[2] + hexflg[inoh][2]};
+            aHex[iivox * 8 + inoh] =
+                aIndPoint[brickpoint2idx[index_brick_point(ip)] * nvb + CGrid3Sparse<int>::IndexLocal(ip[0], ip[1], ip[2])];
+          }
+        }
+      }, num_thread);
+}
+
+}  // namespace delfem2::gridvoxel_sparse
+
+// ------------------------------------------
+
+template<typename VAL>
+DFM2_INLINE void delfem2::Grid3Sparse_FromDense(
+    CGrid3Sparse<VAL> &sparse,
+    const CGrid3<VAL> &dense,
+    VAL background) {
+  const unsigned int nx = dense.ndivx, ny = dense.ndivy, nz = dense.ndivz;
+  sparse.Initialize(nx, ny, nz, background);
+  sparse.am = dense.am;
+  assert(dense.aVal.size() == static_cast<size_t>(nx) * ny * nz);
+  for (unsigned int ix = 0; ix < nx; ++ix) {
+    for (unsigned int iy = 0; iy < ny; ++iy) {
+      for (unsigned int iz = 0; iz < nz; ++iz) {
+        const VAL v = dense.aVal[(static_cast<size_t>(ix) * ny + iy) * nz + iz];
+        if (v == background) { continue; }
+        sparse.Set(ix, iy, iz, v);
+      }
+    }
+  }
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::Grid3Sparse_FromDense(CGrid3Sparse<double> &, const CGrid3<double> &, double);
+template void delfem2::Grid3Sparse_FromDense(CGrid3Sparse<float> &, const CGrid3<float> &, float);
+template void delfem2::Grid3Sparse_FromDense(CGrid3Sparse<int> &, const CGrid3<int> &, int);
+#endif
+
+template<typename VAL>
+DFM2_INLINE void delfem2::Grid3Sparse_ToDense(
+    CGrid3<VAL> &dense,
+    const CGrid3Sparse<VAL> &sparse) {
+  const unsigned int ny = sparse.ndivy, nz = sparse.ndivz;
+  dense.Initialize(sparse.ndivx, ny, nz, sparse.background);
+  dense.am = sparse.am;
+  for (unsigned int ibrick = 0; ibrick < sparse.NumBrick(); ++ibrick) {
+    for (unsigned int iloc = 0; iloc < sparse.kBrickVox; ++iloc) {
+      const unsigned int ivoxel = ibrick * sparse.kBrickVox + iloc;
+      unsigned int iv[3];
+      sparse.CoordVoxel(iv, ivoxel);
+      if (!sparse.IsInclude(iv[0], iv[1], iv[2])) { continue; }
+      dense.aVal[(static_cast<size_t>(iv[0]) * ny + iv[1]) * nz + iv[2]] = sparse.brick_val[ivoxel];
+    }
+  }
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::Grid3Sparse_ToDense(CGrid3<double> &, const CGrid3Sparse<double> &);
+template void delfem2::Grid3Sparse_ToDense(CGrid3<float> &, const CGrid3Sparse<float> &);
+template void delfem2::Grid3Sparse_ToDense(CGrid3<int> &, const CGrid3Sparse<int> &);
+#endif
+
+template<typename VAL>
+DFM2_INLINE void delfem2::Grid3Sparse_ActiveVoxels(
+    std::vector<unsigned int> &aIndVox,
+    const CGrid3Sparse<VAL> &grid,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::gridvoxel_sparse;
+  constexpr unsigned int nvb = CGrid3Sparse<VAL>::kBrickVox;
+  const size_t nbrick = grid.NumBrick();
+  std::vector<unsigned int> aCount(nbrick + 1, 0);
+  parallel_for_chunk(
+      nbrick, 1,
+      [&](size_t ibrick, size_t) {
+        const VAL *val = grid.brick_val.data() + ibrick * nvb;
+        unsigned int icnt = 0;
+        for (unsigned int iloc = 0; iloc < nvb; ++iloc) { icnt += (val[iloc] != grid.background) ? 1 : 0; }
+        aCount[ibrick + 1] = icnt;
+      }, num_thread);
+  for (size_t ibrick = 0; ibrick < nbrick; ++ibrick) { aCount[ibrick + 1] += aCount[ibrick]; }
+  aIndVox.resize(aCount[nbrick]);
+  parallel_for_chunk(
+      nbrick, 1,
+      [&](size_t ibrick, size_t) {
+        const VAL *val = grid.brick_val.data() + ibrick * nvb;
+        unsigned int icnt = aCount[ibrick];
+        for (unsigned int iloc = 0; iloc < nvb; ++iloc) {
+          if (val[iloc] == grid.background) { continue; }
+          aIndVox[icnt++] = static_cast<unsigned int>(ibrick * nvb + iloc);
+        }
+      }, num_thread);
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::Grid3Sparse_ActiveVoxels(std::vector<unsigned int> &, const CGrid3Sparse<double> &, unsigned int);
+template void delfem2::Grid3Sparse_ActiveVoxels(std::vector<unsigned int> &, const CGrid3Sparse<float> &, unsigned int);
+template void delfem2::Grid3Sparse_ActiveVoxels(std::vector<unsigned int> &, const CGrid3Sparse<int> &, unsigned int);
+#endif
+
+// ---------------------------------------------------------------------
+
+DFM2_INLINE void delfem2::Grid3VoxelSparse_Dilation(
+    CGrid3Sparse<int> &grid,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::gridvoxel_sparse;
+  assert(grid.background == 0);
+  constexpr unsigned int kB = lcl::kB;
+  { // allocate the neighbouring bricks reached by the voxels with "1" on the faces of the bricks
+    const size_t nbrick0 = grid.NumBrick();
+    std::vector<unsigned int> aFlgFace(nbrick0, 0);
+    parallel_for_chunk(
+        nbrick0, 1,
+        [&](size_t ibrick, size_t) {
+          const int *val = grid.brick_val.data() + ibrick * grid.kBrickVox;
+          unsigned int flg = 0;
+          for (unsigned int i = 0; i < kB; ++i) {
+            for (unsigned int j = 0; j < kB; ++j) {
+              if (val[(0 * kB + i) * kB + j] == 1) { flg |= 1u << 0; }
+              if (val[((kB - 1) * kB + i) * kB + j] == 1) { flg |= 1u << 1; }
+              if (val[(i * kB + 0) * kB + j] == 1) { flg |= 1u << 2; }
+              if (val[(i * kB + kB - 1) * kB + j] == 1) { flg |= 1u << 3; }
+              if (val[(i * kB + j) * kB + 0] == 1) { flg |= 1u << 4; }
+              if (val[(i * kB + j) * kB + kB - 1] == 1) { flg |= 1u << 5; }
+            }
+          }
+          aFlgFace[ibrick] = flg;
+        }, num_thread);
+    const int nb[3] = {(int) grid.nbrickx, (int) grid.nbricky, (int) grid.nbrickz};
+    for (unsigned int ibrick = 0; ibrick < nbrick0; ++ibrick) {
+      for (unsigned int iface = 0; iface < 6; ++iface) {
+        if ((aFlgFace[ibrick] & (1u << iface)) == 0) { continue; }
+        int jb[3];
+        for (unsigned int idim = 0; idim < 3; ++idim) {
+          jb[idim] = static_cast<int>(grid.brick_coord[ibrick * 3 + idim]) + lcl::aFace[iface][idim];
+        }
+        if (jb[0] < 0 || jb[1] < 0 || jb[2] < 0 || jb[0] >= nb[0] || jb[1] >= nb[1] || jb[2] >= nb[2]) { continue; }
+        grid.AddBrick(jb[0], jb[1], jb[2]);
+      }
+    }
+  }
+  lcl::MapBrick6(
+      grid, num_thread,
+      [](int v0, const int v6[6]) {
+        if (v0 != 0) { return 1; }
+        for (unsigned int iface = 0; iface < 6; ++iface) {
+          if (v6[iface] == 1) { return 1; }
+        }
+        return 0;
+      });
+}
+
+DFM2_INLINE void delfem2::Grid3VoxelSparse_Erosion(
+    CGrid3Sparse<int> &grid,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::gridvoxel_sparse;
+  assert(grid.background == 0);
+  lcl::MapBrick6(
+      grid, num_thread,
+      [](int v0, const int v6[6]) {
+        if (v0 == 0) { return 0; }
+        for (unsigned int iface = 0; iface < 6; ++iface) {
+          if (v6[iface] == 0) { return 0; }
+        }
+        return v0;
+      });
+  grid.Prune();
+}
+
+// dijkstra method
+DFM2_INLINE void delfem2::VoxelGeodesic_Sparse(
+    std::vector<double> &aDist,
+    const std::vector<std::pair<unsigned int, double> > &aIdvoxDist,
+    const double el,
+    const CGrid3Sparse<int> &grid) {
+  namespace lcl = ::delfem2::gridvoxel_sparse;
+  aDist.assign(grid.brick_val.size(), -1.0);
+  using distIdvox = std::pair<double, unsigned int>;
+  std::priority_queue<distIdvox, std::vector<distIdvox>, std::greater<distIdvox>> aNext;
+  for (const auto &idvox_dist: aIdvoxDist) {
+    const unsigned int ivox0 = idvox_dist.first;
+    const double dist0 = idvox_dist.second;
+    aNext.push(std::make_pair(dist0, ivox0));
+    aDist[ivox0] = dist0;
+  }
+  while (!aNext.empty()) {
+    auto itr = aNext.top();
+    const unsigned int ivox1 = itr.second;
+    const double dist1a = itr.first;
+    aNext.pop();
+    if (dist1a > aDist[ivox1]) { continue; } // already fixed
+    const double dist2 = dist1a + el;
+    unsigned int iv1[3];
+    grid.CoordVoxel(iv1, ivox1);
+    for (const auto &face: lcl::aFace) {
+      const unsigned int ivox2 = grid.IndexVoxel(iv1[0] + face[0], iv1[1] + face[1], iv1[2] + face[2]);
+      if (ivox2 == UINT_MAX) { continue; }
+      if (grid.brick_val[ivox2] == 0) { continue; }
+      if (aDist[ivox2] < 0 || aDist[ivox2] > dist2) {
+        aDist[ivox2] = dist2;
+        aNext.push(std::make_pair(dist2, ivox2));
+      }
+    }
+  }
+}
+
+DFM2_INLINE void delfem2::Intersection_VoxelGridSparse_LinSeg(
+    std::vector<unsigned int> &aIndVox,
+    const CGrid3Sparse<int> &grid,
+    const CVec3d &ps,
+    const CVec3d &pe) {
+  namespace lcl = ::delfem2::gridvoxel_sparse;
+  constexpr unsigned int kB = lcl::kB;
+  aIndVox.clear();
+  const CMat4d ami = grid.am.Inverse();
+  double Ps[3], Pe[3]; // local coordinate
+  Vec3_Mat4Vec3_Affine(Ps, ami.mat, ps.p);
+  Vec3_Mat4Vec3_Affine(Pe, ami.mat, pe.p);
+  const double Psb[3] = {Ps[0] / kB, Ps[1] / kB, Ps[2] / kB}; // coordinate of the brick lattice
+  const double Peb[3] = {Pe[0] / kB, Pe[1] / kB, Pe[2] / kB};
+  const int bmin[3] = {0, 0, 0};
+  const int bmax[3] = {(int) grid.nbrickx, (int) grid.nbricky, (int) grid.nbrickz};
+  lcl::TraverseLattice(
+      Psb, Peb, bmin, bmax,
+      [&](const int ib[3]) {
+        const unsigned int ibrick = grid.brick_index[grid.IndexBrick(ib[0], ib[1], ib[2])];
+        if (ibrick == UINT_MAX) { return; }
+        const int vmin[3] = {
+            static_cast<int>(ib[0] * kB),
+            static_cast<int>(ib[1] * kB),
+            static_cast<int>(ib[2] * kB)};
+        const int vmax[3] = {
+            std::min(vmin[0] + (int) kB, (int) grid.ndivx),
+            std::min(vmin[1] + (int) kB, (int) grid.ndivy),
+            std::min(vmin[2] + (int) kB, (int) grid.ndivz)};
+        lcl::TraverseLattice(
+            Ps, Pe, vmin, vmax,
+            [&](const int iv[3]) {
+              const unsigned int ivoxel = ibrick * grid.kBrickVox + grid.IndexLocal(iv[0], iv[1], iv[2]);
+              if (grid.brick_val[ivoxel] == 0) { return; }
+              aIndVox.push_back(ivoxel);
+            });
+      });
+}
+
+DFM2_INLINE void delfem2::MeshHex3D_VoxelGridSparse(
+    std::vector<double> &aXYZ,
+    std::vector<unsigned int> &aHex,
+    const CGrid3Sparse<int> &grid,
+    unsigned int num_thread) {
+  ::delfem2::gridvoxel_sparse::HexVoxelGridSparse(aXYZ, aHex, grid, num_thread);
+}
+
+DFM2_INLINE void delfem2::MeshTet3D_VoxelGridSparse(
+    std::vector<double> &aXYZ,
+    std::vector<unsigned int> &aTet,
+    const CGrid3Sparse<int> &grid,
+    unsigned int num_thread) {
+  std::vector<unsigned int> aHex;
+  ::delfem2::gridvoxel_sparse::HexVoxelGridSparse(aXYZ, aHex, grid, num_thread);
+  // split of the voxel in "MeshTet3D_VoxelGrid"
+  const unsigned int noelTet[6][4] = {
+      {0, 1, 2, 6}, {0, 1, 6, 5}, {0, 4, 5, 6},
+      {0, 2, 3, 6}, {0, 3, 7, 6}, {0, 4, 6, 7}};
+  const size_t nhex = aHex.size() / 8;
+  aTet.resize(nhex * 24);
+  for (size_t ihex = 0; ihex < nhex; ++ihex) {
+    for (unsigned int itet = 0; itet < 6; ++itet) {
+      for (unsigned int inot = 0; inot < 4; ++inot) {
+        aTet[(ihex * 6 + itet) * 4 + inot] = aHex[ihex * 8 + noelTet[itet][inot]];
+      }
+    }
+  }
+}
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file sparse voxel grid made of 8x8x8 bricks
+ * @details only the bricks having a voxel different from the background value are allocated.
+ * The bricks are found with a table over the coarse grid of the bricks, so the memory is
+ * (number of bricks in the grid) * 4 bytes + (number of allocated bricks) * 512 * sizeof(VAL).
+ * The voxel (ivx,ivy,ivz) is stored at "brick_val[ibrick*512 + (ivx%8)*64 + (ivy%8)*8 + ivz%8]",
+ * and this position is used as the index of the voxel.
+ */
+
+#ifndef DFM2_GRIDVOXEL_SPARSE_H
+#define DFM2_GRIDVOXEL_SPARSE_H
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "delfem2/dfm2_inline.h"
+#include "delfem2/gridvoxel.h"
+#include "delfem2/mat4.h"
+#include "delfem2/vec3.h"
+
+namespace delfem2 {
+
+template<typename VAL>
+class CGrid3Sparse {
+ public:
+  static constexpr unsigned int kBrickBit = 3;
+  static constexpr unsigned int kBrickSize = 1u << kBrickBit; // 8 voxels along an axis
+  static constexpr unsigned int kBrickVox = kBrickSize * kBrickSize * kBrickSize;
+
+  CGrid3Sparse() {
+    ndivx = ndivy = ndivz = 0;
+    nbrickx = nbricky = nbrickz = 0;
+    background = VAL(0);
+  }
+  void Initialize(const unsigned int ndivx0,
+                  const unsigned int ndivy0,
+                  const unsigned int ndivz0,
+                  const VAL v) {
+    ndivx = ndivx0;
+    ndivy = ndivy0;
+    ndivz = ndivz0;
+    nbrickx = (ndivx + kBrickSize - 1) / kBrickSize;
+    nbricky = (ndivy + kBrickSize - 1) / kBrickSize;
+    nbrickz = (ndivz + kBrickSize - 1) / kBrickSize;
+    background = v;
+    brick_index.assign(static_cast<size_t>(nbrickx) * nbricky * nbrickz, UINT_MAX);
+    brick_coord.clear();
+    brick_val.clear();
+  }
+  [[nodiscard]] bool IsInclude(unsigned int ivx, unsigned int ivy, unsigned int ivz) const {
+    if (ivx >= ndivx) { return false; }
+    if (ivy >= ndivy) { return false; }
+    if (ivz >= ndivz) { return false; }
+    return true;
+  }
+  [[nodiscard]] size_t NumBrick() const { return brick_coord.size() / 3; }
+  /**
+   * @return index of the voxel. UINT_MAX if the voxel is outside or its brick is not allocated
+   */
+  [[nodiscard]] unsigned int IndexVoxel(unsigned int ivx, unsigned int ivy, unsigned int ivz) const {
+    if (!this->IsInclude(ivx, ivy, ivz)) { return UINT_MAX; }
+    const unsigned int ibrick = brick_index[IndexBrick(ivx >> kBrickBit, ivy >> kBrickBit, ivz >> kBrickBit)];
+    if (ibrick == UINT_MAX) { return UINT_MAX; }
+    return ibrick * kBrickVox + IndexLocal(ivx, ivy, ivz);
+  }
+  //! coordinate of the voxel from its index
+  void CoordVoxel(unsigned int iv[3], unsigned int ivoxel) const {
+    const unsigned int ibrick = ivoxel / kBrickVox;
+    const unsigned int iloc = ivoxel - ibrick * kBrickVox;
+    iv[0] = brick_coord[ibrick * 3 + 0] * kBrickSize + (iloc >> (2 * kBrickBit));
+    iv[1] = brick_coord[ibrick * 3 + 1] * kBrickSize + ((iloc >> kBrickBit) & (kBrickSize - 1));
+    iv[2] = brick_coord[ibrick * 3 + 2] * kBrickSize + (iloc & (kBrickSize - 1));
+  }
+  [[nodiscard]] VAL Get(unsigned int ivx, unsigned int ivy, unsigned int ivz) const {
+    const unsigned int ivoxel = IndexVoxel(ivx, ivy, ivz);
+    if (ivoxel == UINT_MAX) { return background; }
+    return brick_val[ivoxel];
+  }
+  /**
+   * @details the brick is allocated if "v" is not the background value
+   */
+  void Set(unsigned int ivx, unsigned int ivy, unsigned int ivz, VAL v) {
+    if (!this->IsInclude(ivx, ivy, ivz)) { return; }
+    unsigned int ivoxel = IndexVoxel(ivx, ivy, ivz);
+    if (ivoxel == UINT_MAX) {
+      if (v == background) { return; }
+      const unsigned int ibrick = AddBrick(ivx >> kBrickBit, ivy >> kBrickBit, ivz >> kBrickBit);
+      ivoxel = ibrick * kBrickVox + IndexLocal(ivx, ivy, ivz);
+    }
+    brick_val[ivoxel] = v;
+  }
+  /**
+   * @return index of the brick at the brick coordinate (ibx,iby,ibz). The brick is filled with the background if it is new.
+   */
+  unsigned int AddBrick(unsigned int ibx, unsigned int iby, unsigned int ibz) {
+    assert(ibx < nbrickx && iby < nbricky && ibz < nbrickz);
+    unsigned int &ibrick = brick_index[IndexBrick(ibx, iby, ibz)];
+    if (ibrick != UINT_MAX) { return ibrick; }
+    ibrick = static_cast<unsigned int>(brick_coord.size() / 3);
+    brick_coord.insert(brick_coord.end(), {ibx, iby, ibz});
+    brick_val.resize(brick_val.size() + kBrickVox, background);
+    return ibrick;
+  }
+  //! index of the brick in "brick_index"
+  [[nodiscard]] size_t IndexBrick(unsigned int ibx, unsigned int iby, unsigned int ibz) const {
+    return (static_cast<size_t>(ibx) * nbricky + iby) * nbrickz + ibz;
+  }
+  //! index of the voxel inside its brick
+  [[nodiscard]] static unsigned int IndexLocal(unsigned int ivx, unsigned int ivy, unsigned int ivz) {
+    constexpr unsigned int m = kBrickSize - 1;
+    return ((ivx & m) << (2 * kBrickBit)) + ((ivy & m) << kBrickBit) + (ivz & m);
+  }
+  /**
+   * @brief remove the bricks only with the background value
+   * @details the remaining bricks keep their order, so the indexes of the voxels may change
+   */
+  void Prune() {
+    const size_t nbrick0 = NumBrick();
+    unsigned int nbrick1 = 0;
+    for (unsigned int ibrick0 = 0; ibrick0 < nbrick0; ++ibrick0) {
+      const VAL *val0 = brick_val.data() + static_cast<size_t>(ibrick0) * kBrickVox;
+      bool is_empty = true;
+      for (unsigned int iloc = 0; iloc < kBrickVox; ++iloc) {
+        if (val0[iloc] != background) {
+          is_empty = false;
+          break;
+        }
+      }
+      const unsigned int *bc = brick_coord.data() + ibrick0 * 3;
+      const size_t ib = IndexBrick(bc[0], bc[1], bc[2]);
+      if (is_empty) {
+        brick_index[ib] = UINT_MAX;
+        continue;
+      }
+      brick_index[ib] = nbrick1;
+      if (nbrick1 != ibrick0) {
+        for (unsigned int idim = 0; idim < 3; ++idim) { brick_coord[nbrick1 * 3 + idim] = bc[idim]; }
+        std::copy(val0, val0 + kBrickVox, brick_val.data() + static_cast<size_t>(nbrick1) * kBrickVox);
+      }
+      ++nbrick1;
+    }
+    brick_coord.resize(nbrick1 * 3);
+    brick_val.resize(static_cast<size_t>(nbrick1) * kBrickVox);
+  }
+ public:
+  unsigned int ndivx, ndivy, ndivz;
+  unsigned int nbrickx, nbricky, nbrickz;
+  VAL background;
+  //! index of the allocated brick for each brick of the grid. UINT_MAX if not allocated
+  std::vector<unsigned int> brick_index;
+  //! brick coordinate (ibx,iby,ibz) of the allocated bricks
+  std::vector<unsigned int> brick_coord;
+  //! values of the voxels in the allocated bricks. 512 values per brick
+  std::vector<VAL> brick_val;
+  CMat4d am; // affine matrix
+};
+
+/**
+ * @brief copy the dense grid to the sparse grid
+ * @details the value of the voxel (ivx,ivy,ivz) of the dense grid is "aVal[ivx*ndivy*ndivz+ivy*ndivz+ivz]" as in "CGrid3::Set".
+ * Defined for "double", "float" and "int"
+ */
+template<typename VAL>
+DFM2_INLINE void Grid3Sparse_FromDense(
+    CGrid3Sparse<VAL> &sparse,
+    const CGrid3<VAL> &dense,
+    VAL background);
+
+/**
+ * @brief copy the sparse grid to the dense grid
+ * @details defined for "double", "float" and "int"
+ */
+template<typename VAL>
+DFM2_INLINE void Grid3Sparse_ToDense(
+    CGrid3<VAL> &dense,
+    const CGrid3Sparse<VAL> &sparse);
+
+/**
+ * @brief indexes of the voxels with the value different from the background
+ * @details the voxels are in the order of their indexes. Defined for "double", "float" and "int"
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ */
+template<typename VAL>
+DFM2_INLINE void Grid3Sparse_ActiveVoxels(
+    std::vector<unsigned int> &aIndVox,
+    const CGrid3Sparse<VAL> &grid,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief the empty voxels facing to the voxels with the value "1" get "1"
+ * @details same as "Grid3Voxel_Dilation" for the dense grid. The background value should be "0"
+ */
+DFM2_INLINE void Grid3VoxelSparse_Dilation(
+    CGrid3Sparse<int> &grid,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief the voxels facing to the empty voxels or the boundary of the grid get "0"
+ * @details same as "Grid3Voxel_Erosion" for the dense grid. The background value should be "0".
+ * The bricks becoming empty are removed.
+ */
+DFM2_INLINE void Grid3VoxelSparse_Erosion(
+    CGrid3Sparse<int> &grid,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief voxel geodesic distance from the seed voxels through the non-empty voxels
+ * @param aDist (out) distance of the voxels in the index of the sparse grid. "-1" for the voxels not reached
+ * @param aIdvoxDist index of the seed voxels and their distances
+ * @param el (in) edge length of the voxel
+ */
+DFM2_INLINE void VoxelGeodesic_Sparse(
+    std::vector<double> &aDist,
+    const std::vector<std::pair<unsigned int, double> > &aIdvoxDist,
+    double el,
+    const CGrid3Sparse<int> &grid);
+
+/**
+ * @brief non-empty voxels crossed by the line segment in the order from "ps" to "pe"
+ * @details the bricks are traversed first and only the allocated bricks are traversed voxel by voxel.
+ * Amanatides, John, and Andrew Woo. "A fast voxel traversal algorithm for ray tracing." In Eurographics, vol. 87, no. 3, pp. 3-10. 1987.
+ * @param aIndVox (out) index of the voxels in the sparse grid
+ */
+DFM2_INLINE void Intersection_VoxelGridSparse_LinSeg(
+    std::vector<unsigned int> &aIndVox,
+    const CGrid3Sparse<int> &grid,
+    const CVec3d &ps,
+    const CVec3d &pe);
+
+/**
+ * @brief hexahedra of the non-empty voxels
+ * @details unlike "MeshHex3D_VoxelGrid", only the points used by the hexahedra are made.
+ * The points are numbered brick by brick, and their coordinates are the lattice coordinates not transformed with "grid.am".
+ * The hexahedra are in the order of the voxel indexes. The output does not depend on the number of threads.
+ */
+DFM2_INLINE void MeshHex3D_VoxelGridSparse(
+    std::vector<double> &aXYZ,
+    std::vector<unsigned int> &aHex,
+    const CGrid3Sparse<int> &grid,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief tetrahedra of the non-empty voxels
+ * @details each voxel is split into six tetrahedra as in "MeshTet3D_VoxelGrid". The points are the same as "MeshHex3D_VoxelGridSparse"
+ */
+DFM2_INLINE void MeshTet3D_VoxelGridSparse(
+    std::vector<double> &aXYZ,
+    std::vector<unsigned int> &aTet,
+    const CGrid3Sparse<int> &grid,
+    unsigned int num_thread = 0);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/gridvoxel_sparse.cpp"
+#endif
+
+#endif // DFM2_GRIDVOXEL_SPARSE_H
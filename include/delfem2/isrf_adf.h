@@ -9,6 +9,8 @@
 #ifndef DFM2_ISRF_ADF_H
 #define DFM2_ISRF_ADF_H
 
+#include <cstddef>
+#include <climits>
 #include <vector>
 
 #include "delfem2/dfm2_inline.h"
@@ -21,10 +23,28 @@ namespace delfem2 {
 class Input_AdaptiveDistanceField3 {
  public:
   virtual double sdf(double px, double py, double pz) const = 0;
+
+  /**
+   * @brief signed distances of many points at once
+   * @details The tree is built level by level and all the points of a level are evaluated with this function.
+   * Override it if the distances of many points are computed faster together.
+   * The default calls "sdf" for each point. If num_thread != 1, "sdf" needs to be thread-safe.
+   * @param[out] sdf signed distance of each point
+   * @param[in] xyz coordinates of the points
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   */
+  virtual void sdfs(
+      double *sdf,
+      const double *xyz,
+      size_t num_point,
+      unsigned int num_thread) const;
 };
 
 /**
  * @brief Adaptive distance field
+ * @details The octree is stored in "aNode". The eight children of a node are stored next to each other
+ * in the Morton order (x is the lowest bit), so the path from the root to a leaf is the Morton key of the leaf.
+ * The center and the half width of a node are not stored but computed while traversing from the root.
  */
 class AdaptiveDistanceField3 {
  public:
@@ -32,35 +52,59 @@ class AdaptiveDistanceField3 {
     
     ~AdaptiveDistanceField3() = default;
     
-  void SetUp(const Input_AdaptiveDistanceField3 &ct, double bb[6]);
+  /**
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   * The tree is independent of the number of threads.
+   */
+  void SetUp(
+      const Input_AdaptiveDistanceField3 &ct,
+      double bb[6],
+      unsigned int num_thread = 1);
     
   virtual double Projection(
       double px, double py, double pz,
       double n[3]) const;
+
+  /**
+   * @brief "Projection" of many points in parallel
+   * @param[out] dist penetration depth of each point (inside is positive)
+   * @param[out] nrm outward normal of each point
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   */
+  void Projections(
+      double *dist,
+      double *nrm,
+      const double *xyz,
+      size_t num_point,
+      unsigned int num_thread = 0) const;
     
+  //! iso-surface as a triangle soup (nine values per triangle)
   void BuildIsoSurface_MarchingCube(std::vector<double> &aTri);
+
+  /**
+   * @brief iso-surface with the vertices welded
+   * @details the cells of the marching cubes are the leaves. The vertices on the same edge of the
+   * leaves of the same size are shared. The surface is not connected between the leaves of different sizes.
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   */
+  void BuildIsoSurface_MarchingCube(
+      std::vector<double> &vtx_xyz,
+      std::vector<unsigned int> &tri_vtx,
+      unsigned int num_thread = 0) const;
     
  public:
   class CNode {
    public:
-    CNode();
-    CNode(const CNode &) = default;
-    void SetCornerDist(const Input_AdaptiveDistanceField3 &ct);
-    void MakeChildTree(const Input_AdaptiveDistanceField3 &ct, std::vector<CNode> &aNo, double min_hw, double max_hw);
-    double FindDistNormal
-        (double px, double py, double pz,
-         double n[3],
-         const std::vector<CNode> &aNo) const;
-    void GenerateIsoSurface
-        (std::vector<double> &aTri,
-         const std::vector<CNode> &aNo) const;
-   public:
-    double cent_[3];
-    double hw_;
-    int ichilds_[8];
-    double dists_[8];
+    //! index of the first of the eight children. UINT_MAX for the leaf
+    unsigned int ichild_ = UINT_MAX;
+    //! distances at the corners in the order of the hexahedron
+    float dists_[8] = {0, 0, 0, 0, 0, 0, 0, 0};
   };
  public:
+  //! center of the root node
+  double cent_[3] = {0, 0, 0};
+  //! half width of the root node
+  double hw_ = 0;
   std::vector<CNode> aNode;
   double dist_min, dist_max;
 };
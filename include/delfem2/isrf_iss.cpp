@@ -10,97 +10,36 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/thread.h"
 
 namespace delfem2::iss {
 
-DFM2_INLINE void makeElemSurroundingPoint(
-    std::vector<int> &elsup_ind,
-    std::vector<int> &elsup,
-    //
-    const std::vector<unsigned int> &aElem,
-    int nPoEl,
-    int nPo) {
-  const int nElem = (int) aElem.size() / nPoEl;
-  elsup_ind.assign(nPo + 1, 0);
-  for (int ielem = 0; ielem < nElem; ielem++) {
-    for (int inoel = 0; inoel < nPoEl; inoel++) {
-      int ino1 = aElem[ielem * nPoEl + inoel];
-      if (ino1 == -1) { break; }
-      elsup_ind[ino1 + 1] += 1;
-    }
-  }
-  for (int ino = 0; ino < nPo; ++ino) {
-    elsup_ind[ino + 1] += elsup_ind[ino];
-  }
-  int nelsup = elsup_ind[nPo];
-  elsup.resize(nelsup);
-  for (int ielem = 0; ielem < nElem; ielem++) {
-    for (int inoel = 0; inoel < nPoEl; inoel++) {
-      int ino1 = aElem[ielem * nPoEl + inoel];
-      if (ino1 == -1) { break; }
-      int ind1 = elsup_ind[ino1];
-      elsup[ind1] = ielem;
-      elsup_ind[ino1] += 1;
-    }
-  }
-  for (int ino = nPo; ino >= 1; ino--) {
-    elsup_ind[ino] = elsup_ind[ino - 1];
-  }
-  elsup_ind[0] = 0;
-}
+//! number of lattice points, tetrahedra or cells processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 12;
 
-DFM2_INLINE void makeOneRingNeighborhood(
-    std::vector<int> &psup_ind,
-    std::vector<int> &psup,
-    //
-    const std::vector<unsigned int> &aElem,
-    const std::vector<int> &elsup_ind,
-    const std::vector<int> &elsup,
-    int nnoel,
-    int nnode) {
-  std::vector<int> aflg(nnode, -1);
-  psup_ind.assign(nnode + 1, 0);
-  for (int inode = 0; inode < nnode; inode++) {
-    aflg[inode] = inode;
-    for (int ielsup = elsup_ind[inode]; ielsup < elsup_ind[inode + 1]; ielsup++) {
-      int jelem = elsup[ielsup];
-      for (int jnoel = 0; jnoel < nnoel; jnoel++) {
-        int jnode = aElem[jelem * nnoel + jnoel];
-        if (aflg[jnode] != inode) {
-          aflg[jnode] = inode;
-          psup_ind[inode + 1]++;
-        }
-      }
-    }
-  }
-  for (int ino = 0; ino < nnode; ino++) {
-    psup_ind[ino + 1] += psup_ind[ino];
-  }
-  const int npsup = psup_ind[nnode];
-  psup.resize(npsup);
-  for (int ino = 0; ino < nnode; ino++) { aflg[ino] = -1; }
-  for (int inode = 0; inode < nnode; inode++) {
-    aflg[inode] = inode;
-    for (int ielsup = elsup_ind[inode]; ielsup < elsup_ind[inode + 1]; ielsup++) {
-      int jelem = elsup[ielsup];
-      for (int jnoel = 0; jnoel < nnoel; jnoel++) {
-        int jnode = aElem[jelem * nnoel + jnoel];
-        if (aflg[jnode] != inode) {
-          aflg[jnode] = inode;
-          const int ind = psup_ind[inode];
-          psup[ind] = jnode;
-          psup_ind[inode]++;
-        }
-      }
-    }
-  }
-  for (int inode = nnode; inode > 0; inode--) {
-    psup_ind[inode] = psup_ind[inode - 1];
-  }
-  psup_ind[0] = 0;
+/**
+ * signed distance of the lattice points [ip0, aPoint.size()) with one call of "SignedDistances"
+ */
+DFM2_INLINE void EvaluateSignedDistance(
+    std::vector<CPointLattice> &aPoint,
+    size_t ip0,
+    const CInput_IsosurfaceStuffing &input,
+    unsigned int num_thread) {
+  const size_t np = aPoint.size() - ip0;
+  if (np == 0) { return; }
+  std::vector<double> aXYZ(np * 3), aSDF(np);
+  for (size_t ip = 0; ip < np; ++ip) {
+    aXYZ[ip * 3 + 0] = aPoint[ip0 + ip].pos[0];
+    aXYZ[ip * 3 + 1] = aPoint[ip0 + ip].pos[1];
+    aXYZ[ip * 3 + 2] = aPoint[ip0 + ip].pos[2];
+  }
+  input.SignedDistances(aSDF.data(), aXYZ.data(), np, num_thread);
+  for (size_t ip = 0; ip < np; ++ip) { aPoint[ip0 + ip].sdf = aSDF[ip]; }
 }
 
-
 // ---------------------------------------------------------
 
 DFM2_INLINE int GetCutNode(
@@ -925,7 +864,8 @@ DFM2_INLINE void makeLatticeCoasestLevel(
     const CInput_IsosurfaceStuffing &input,
     double elen,
     int ndiv,
-    const double org[3]) {
+    const double org[3],
+    unsigned int num_thread) {
   aPoint.clear();
   aPoint.resize((ndiv + 1) * (ndiv + 1) * (ndiv + 1) + ndiv * ndiv * ndiv);
   for (int iz = 0; iz < ndiv + 1; ++iz) {
@@ -935,8 +875,7 @@ DFM2_INLINE void makeLatticeCoasestLevel(
         double cx = ix * elen + org[0];
         double cy = iy * elen + org[1];
         double cz = iz * elen + org[2];
-        double sdf = input.SignedDistance(cx, cy, cz);
-        aPoint[icrnr0] = CPointLattice(cx, cy, cz, sdf);
+        aPoint[icrnr0] = CPointLattice(cx, cy, cz, 0.0);
       }
     }
   }
@@ -947,11 +886,11 @@ DFM2_INLINE void makeLatticeCoasestLevel(
         double cx = (ix + 0.5) * elen + org[0];
         double cy = (iy + 0.5) * elen + org[1];
         double cz = (iz + 0.5) * elen + org[2];
-        double sdf = input.SignedDistance(cx, cy, cz);
-        aPoint[ip0] = CPointLattice(cx, cy, cz, sdf);
+        aPoint[ip0] = CPointLattice(cx, cy, cz, 0.0);
       }
     }
   }
+  EvaluateSignedDistance(aPoint, 0, input, num_thread);
   aCell.clear();
   aCell.reserve(ndiv * ndiv * ndiv * 2);
   for (int iz = 0; iz < ndiv; ++iz) {
@@ -991,7 +930,6 @@ DFM2_INLINE void makeLatticeCoasestLevel(
 DFM2_INLINE void makeChild(
     std::vector<CCell> &aCell,
     std::vector<CPointLattice> &aPoint,
-    const CInput_IsosurfaceStuffing &input,
     unsigned int icell,
     int ichild) {
   assert(icell < aCell.size());
@@ -1019,7 +957,7 @@ DFM2_INLINE void makeChild(
   CCell cc(size0 * 0.5, ilevel0 + 1, icell, ichild);
   {
     cc.aIP[26] = (int) aPoint.size();
-    CPointLattice p(ccx, ccy, ccz, input.SignedDistance(ccx, ccy, ccz));
+    CPointLattice p(ccx, ccy, ccz, 0.0); // the distance is evaluated later
     aPoint.push_back(p);
   }
   aCell.push_back(cc);
@@ -1029,7 +967,6 @@ DFM2_INLINE void makeChild(
 DFM2_INLINE void makeChild_Face(
     std::vector<CCell> &aCell,
     std::vector<CPointLattice> &aPoint,
-    const CInput_IsosurfaceStuffing &input,
     int icell,
     int iface) {
   assert(icell >= 0 && icell < (int) aCell.size());
@@ -1043,13 +980,12 @@ DFM2_INLINE void makeChild_Face(
   for (int ifc = 0; ifc < 4; ++ifc) { // face child
     int ichild = faceHex[iface][ifc];
     if (aCell[icell].aIC_Cld[ichild] != -1) continue;
-    makeChild(aCell, aPoint, input, icell, ichild);
+    makeChild(aCell, aPoint, icell, ichild);
   }
 }
 
 DFM2_INLINE void Continuation(
-    std::vector<CPointLattice> &aPoint, std::vector<CCell> &aCell,
-    const CInput_IsosurfaceStuffing &input) {
+    std::vector<CPointLattice> &aPoint, std::vector<CCell> &aCell) {
   const int faceHex[6][4] = {
       {0, 4, 6, 2},
       {1, 3, 7, 5},
@@ -1103,8 +1039,8 @@ DFM2_INLINE void Continuation(
           if (aCell[icell].aIC_Adj[jface] < 0) { // find&make this cell
             const int jch = adjChildInside[ich][jface]; // inside neighbor
             const int jpca = aCell[ipc].aIC_Adj[jface]; // outside neighbor
-            if (jch >= 0) { makeChild(aCell, aPoint, input, ipc, jch); }
-            else if (jpca >= 0) { makeChild_Face(aCell, aPoint, input, jpca, oppFace[jface]); }
+            if (jch >= 0) { makeChild(aCell, aPoint, ipc, jch); }
+            else if (jpca >= 0) { makeChild_Face(aCell, aPoint, jpca, oppFace[jface]); }
           }
         }
         {
@@ -1112,8 +1048,8 @@ DFM2_INLINE void Continuation(
           if (aCell[icell].aIC_Adj[kface] < 0) { // find&make this cell
             const int kch = adjChildInside[ich][kface]; // inside neighbor
             const int kpca = aCell[ipc].aIC_Adj[kface]; // outside neighbor
-            if (kch >= 0) { makeChild(aCell, aPoint, input, ipc, kch); }
-            else if (kpca >= 0) { makeChild_Face(aCell, aPoint, input, kpca, oppFace[kface]); }
+            if (kch >= 0) { makeChild(aCell, aPoint, ipc, kch); }
+            else if (kpca >= 0) { makeChild_Face(aCell, aPoint, kpca, oppFace[kface]); }
           }
         }
       }
@@ -1142,21 +1078,21 @@ DFM2_INLINE void Continuation(
 #endif
         }
         if (lch >= 0) { // diagonal child
-          makeChild(aCell, aPoint, input, ipc, lch);
+          makeChild(aCell, aPoint, ipc, lch);
         }
         {
           const int jpca = aCell[ipc].aIC_Adj[jface];
           const int ljkpca = (jpca >= 0) ? aCell[jpca].aIC_Adj[kface] : -1;
           if (ljkpca >= 0) {
-            makeChild_Face(aCell, aPoint, input, ljkpca, oppFace[kface]);
-            makeChild_Face(aCell, aPoint, input, ljkpca, oppFace[jface]);
+            makeChild_Face(aCell, aPoint, ljkpca, oppFace[kface]);
+            makeChild_Face(aCell, aPoint, ljkpca, oppFace[jface]);
           }
           ////
           const int kpca = aCell[ipc].aIC_Adj[kface];
           const int lkjpca = (kpca >= 0) ? aCell[kpca].aIC_Adj[jface] : -1;
           if (lkjpca >= 0) {
-            makeChild_Face(aCell, aPoint, input, lkjpca, oppFace[kface]);
-            makeChild_Face(aCell, aPoint, input, lkjpca, oppFace[jface]);
+            makeChild_Face(aCell, aPoint, lkjpca, oppFace[kface]);
+            makeChild_Face(aCell, aPoint, lkjpca, oppFace[jface]);
           }
         }
       }
@@ -1174,7 +1110,7 @@ DFM2_INLINE void Continuation(
             if (jc_ch0 < 0) { continue; }
 //            if( aCell[jc_ch0].isHavingChild_Face(jface) ){
             if (aCell[jc_ch0].isHavingChild()) { // why not above?
-              makeChild_Face(aCell, aPoint, input, icell, iface);
+              makeChild_Face(aCell, aPoint, icell, iface);
               break;
             }
           }
@@ -1184,7 +1120,7 @@ DFM2_INLINE void Continuation(
             if (ic_ch0 < 0) { continue; }
 //            if( aCell[ic_ch0].isHavingChild_Face(iface) ){
             if (aCell[ic_ch0].isHavingChild()) { // why not above?
-              makeChild_Face(aCell, aPoint, input, jca0, jface);
+              makeChild_Face(aCell, aPoint, jca0, jface);
               break;
             }
           }
@@ -1304,9 +1240,7 @@ void CheckContinuation(const std::vector<CCell>& aCell)
 
 DFM2_INLINE void addEdgeFacePoints(
     std::vector<CPointLattice> &aPoint,
-    std::vector<CCell> &aCell,
-    //
-    const CInput_IsosurfaceStuffing &input) {
+    std::vector<CCell> &aCell) {
   std::vector<int> orderCell;
   orderCell.reserve(aCell.size());
   {
@@ -1398,7 +1332,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0];
         const double y0 = aPoint[c.aIP[26]].pos[1] - c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2] - c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[8] = ip0;
         if (icay >= 0) { aCell[icay].aIP[9] = ip0; }
         if (icaz >= 0) { aCell[icaz].aIP[10] = ip0; }
@@ -1433,7 +1367,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0];
         const double y0 = aPoint[c.aIP[26]].pos[1] + c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2] - c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[9] = ip0;
         if (icaY >= 0) { aCell[icaY].aIP[8] = ip0; }
         if (icaz >= 0) { aCell[icaz].aIP[11] = ip0; }
@@ -1468,7 +1402,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0];
         const double y0 = aPoint[c.aIP[26]].pos[1] - c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2] + c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[10] = ip0;
         if (icay >= 0) { aCell[icay].aIP[11] = ip0; }
         if (icaZ >= 0) { aCell[icaZ].aIP[8] = ip0; }
@@ -1503,7 +1437,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0];
         const double y0 = aPoint[c.aIP[26]].pos[1] + c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2] + c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[11] = ip0;
         if (icaY >= 0) { aCell[icaY].aIP[10] = ip0; }
         if (icaZ >= 0) { aCell[icaZ].aIP[9] = ip0; }
@@ -1541,7 +1475,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] - c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1];
         const double z0 = aPoint[c.aIP[26]].pos[2] - c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[12] = ip0;
         if (icax >= 0) { aCell[icax].aIP[13] = ip0; }
         if (icaz >= 0) { aCell[icaz].aIP[14] = ip0; }
@@ -1576,7 +1510,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] + c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1];
         const double z0 = aPoint[c.aIP[26]].pos[2] - c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[13] = ip0;
         if (icaX >= 0) { aCell[icaX].aIP[12] = ip0; }
         if (icaz >= 0) { aCell[icaz].aIP[15] = ip0; }
@@ -1611,7 +1545,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] - c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1];
         const double z0 = aPoint[c.aIP[26]].pos[2] + c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[14] = ip0;
         if (icax >= 0) { aCell[icax].aIP[15] = ip0; }
         if (icaZ >= 0) { aCell[icaZ].aIP[12] = ip0; }
@@ -1646,7 +1580,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] + c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1];
         const double z0 = aPoint[c.aIP[26]].pos[2] + c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[15] = ip0;
         if (icaX >= 0) { aCell[icaX].aIP[14] = ip0; }
         if (icaZ >= 0) { aCell[icaZ].aIP[13] = ip0; }
@@ -1682,7 +1616,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] - c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1] - c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[16] = ip0;
         if (icax >= 0) { aCell[icax].aIP[17] = ip0; }
         if (icay >= 0) { aCell[icay].aIP[18] = ip0; }
@@ -1717,7 +1651,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] + c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1] - c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[17] = ip0;
         if (icaX >= 0) { aCell[icaX].aIP[16] = ip0; }
         if (icay >= 0) { aCell[icay].aIP[19] = ip0; }
@@ -1752,7 +1686,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] - c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1] + c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[18] = ip0;
         if (icax >= 0) { aCell[icax].aIP[19] = ip0; }
         if (icaY >= 0) { aCell[icaY].aIP[16] = ip0; }
@@ -1788,7 +1722,7 @@ DFM2_INLINE void addEdgeFacePoints(
         const double x0 = aPoint[c.aIP[26]].pos[0] + c.size * 0.5;
         const double y0 = aPoint[c.aIP[26]].pos[1] + c.size * 0.5;
         const double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[19] = ip0;
         if (icaX >= 0) { aCell[icaX].aIP[18] = ip0; }
         if (icaY >= 0) { aCell[icaY].aIP[17] = ip0; }
@@ -1819,7 +1753,7 @@ DFM2_INLINE void addEdgeFacePoints(
         double x0 = aPoint[c.aIP[26]].pos[0] - c.size * 0.5;
         double y0 = aPoint[c.aIP[26]].pos[1];
         double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[20] = ip0;
         if (icax >= 0) { aCell[icax].aIP[21] = ip0; }
         if (icc0 >= 0) { aCell[icc0].aIP[6] = ip0; }
@@ -1847,7 +1781,7 @@ DFM2_INLINE void addEdgeFacePoints(
         double x0 = aPoint[c.aIP[26]].pos[0] + c.size * 0.5;
         double y0 = aPoint[c.aIP[26]].pos[1];
         double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[21] = ip0;
         if (icaX >= 0) { aCell[icaX].aIP[20] = ip0; }
         if (icc1 >= 0) { aCell[icc1].aIP[7] = ip0; }
@@ -1875,7 +1809,7 @@ DFM2_INLINE void addEdgeFacePoints(
         double x0 = aPoint[c.aIP[26]].pos[0];
         double y0 = aPoint[c.aIP[26]].pos[1] - c.size * 0.5;
         double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[22] = ip0;
         if (icay >= 0) { aCell[icay].aIP[23] = ip0; }
         if (icc0 >= 0) { aCell[icc0].aIP[5] = ip0; }
@@ -1903,7 +1837,7 @@ DFM2_INLINE void addEdgeFacePoints(
         double x0 = aPoint[c.aIP[26]].pos[0];
         double y0 = aPoint[c.aIP[26]].pos[1] + c.size * 0.5;
         double z0 = aPoint[c.aIP[26]].pos[2];
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[23] = ip0;
         if (icaY >= 0) { aCell[icaY].aIP[22] = ip0; }
         if (icc2 >= 0) { aCell[icc2].aIP[7] = ip0; }
@@ -1930,7 +1864,7 @@ DFM2_INLINE void addEdgeFacePoints(
         double x0 = aPoint[c.aIP[26]].pos[0];
         double y0 = aPoint[c.aIP[26]].pos[1];
         double z0 = aPoint[c.aIP[26]].pos[2] - c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[24] = ip0;
         if (icaz >= 0) { aCell[icaz].aIP[25] = ip0; }
         if (icc0 >= 0) { aCell[icc0].aIP[3] = ip0; }
@@ -1957,7 +1891,7 @@ DFM2_INLINE void addEdgeFacePoints(
         double x0 = aPoint[c.aIP[26]].pos[0];
         double y0 = aPoint[c.aIP[26]].pos[1];
         double z0 = aPoint[c.aIP[26]].pos[2] + c.size * 0.5;
-        aPoint.emplace_back(x0, y0, z0, input.SignedDistance(x0, y0, z0));
+        aPoint.emplace_back(x0, y0, z0, 0.0); // the distance is evaluated later
         c.aIP[25] = ip0;
         if (icaZ >= 0) { aCell[icaZ].aIP[24] = ip0; }
         if (icc4 >= 0) { aCell[icc4].aIP[7] = ip0; }
@@ -1975,8 +1909,8 @@ DFM2_INLINE void addEdgeFacePoints(
 
 DFM2_INLINE void makeTetLattice(
     std::vector<unsigned int> &aTet,
-    const std::vector<CCell> &aCell) {
-  aTet.clear();
+    const std::vector<CCell> &aCell,
+    unsigned int num_thread) {
   const int faceHex[6][4] = {
       {0, 4, 6, 2},
       {1, 3, 7, 5},
@@ -2000,7 +1934,8 @@ DFM2_INLINE void makeTetLattice(
       {18, 11, 19, 9},
       {12, 9, 13, 8},
       {10, 15, 11, 14}};
-  for (int ic = 0; ic < (int) aCell.size(); ++ic) {
+  // call add_tet(ip0, ip1, ip2, ip3) for each tetrahedron in the cell "ic"
+  auto tet_cell = [&](int ic, auto &&add_tet) {
     const CCell &c = aCell[ic];
     const int ip_c = c.aIP[26]; // center
     for (int iface = 0; iface < 6; ++iface) {
@@ -2017,23 +1952,11 @@ DFM2_INLINE void makeTetLattice(
             iptn = halfPyramidPtn[c.iparent_pos][iface];
           }
           if (iptn == 0) { // connect 0-2
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_f0);
-            aTet.push_back(ip_f1);
-            aTet.push_back(ip_f2); // half pyramid
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_f2);
-            aTet.push_back(ip_f3);
-            aTet.push_back(ip_f0); // half pyramid
+            add_tet(ip_c, ip_f0, ip_f1, ip_f2); // half pyramid
+            add_tet(ip_c, ip_f2, ip_f3, ip_f0); // half pyramid
           } else { // connect 1-3
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_f0);
-            aTet.push_back(ip_f1);
-            aTet.push_back(ip_f3); // half pyramid
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_f1);
-            aTet.push_back(ip_f2);
-            aTet.push_back(ip_f3); // half pyramid
+            add_tet(ip_c, ip_f0, ip_f1, ip_f3); // half pyramid
+            add_tet(ip_c, ip_f1, ip_f2, ip_f3); // half pyramid
           }
           continue;
         }
@@ -2049,19 +1972,10 @@ DFM2_INLINE void makeTetLattice(
           int ip_em = c.aIP[edgePointFace[iface][ieface]];
           int ip_e1 = c.aIP[faceHex[iface][(ieface + 1) % 4]];
           if (ip_em == -1) {
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_ca);
-            aTet.push_back(ip_e0);
-            aTet.push_back(ip_e1); // bcc
+            add_tet(ip_c, ip_ca, ip_e0, ip_e1); // bcc
           } else {
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_ca);
-            aTet.push_back(ip_e0);
-            aTet.push_back(ip_em); // bcc bisect
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_ca);
-            aTet.push_back(ip_em);
-            aTet.push_back(ip_e1); // bcc bisect
+            add_tet(ip_c, ip_ca, ip_e0, ip_em); // bcc bisect
+            add_tet(ip_c, ip_ca, ip_em, ip_e1); // bcc bisect
           }
         }
       } else { // ip_d != -1
@@ -2073,46 +1987,62 @@ DFM2_INLINE void makeTetLattice(
           int ip_em = c.aIP[ihpm];
           int ip_e1 = c.aIP[ihp1];
           if (ip_em < 0) {
-            aTet.push_back(ip_c);
-            aTet.push_back(ip_d);
-            aTet.push_back(ip_e0);
-            aTet.push_back(ip_e1); // bisect
+            add_tet(ip_c, ip_d, ip_e0, ip_e1); // bisect
           } else {
             if (c.aIC_Cld[ihp0] < 0) {
-              aTet.push_back(ip_c);
-              aTet.push_back(ip_d);
-              aTet.push_back(ip_e0);
-              aTet.push_back(ip_em); // quadrisect
+              add_tet(ip_c, ip_d, ip_e0, ip_em); // quadrisect
             }
             if (c.aIC_Cld[ihp1] < 0) {
-              aTet.push_back(ip_c);
-              aTet.push_back(ip_d);
-              aTet.push_back(ip_em);
-              aTet.push_back(ip_e1); // quadrisect
+              add_tet(ip_c, ip_d, ip_em, ip_e1); // quadrisect
             }
           }
         }
       }
     }
-  }
+  };
+  // count the tetrahedra of each cell, and then fill them in the order of the cells
+  const size_t ncell = aCell.size();
+  std::vector<unsigned int> cell2tet(ncell + 1, 0);
+  parallel_for_chunk(ncell, kNumChunk, [&](size_t ic0, size_t ic1) {
+    for (size_t ic = ic0; ic < ic1; ++ic) {
+      tet_cell(static_cast<int>(ic), [&](int, int, int, int) { cell2tet[ic + 1] += 1; });
+    }
+  }, num_thread);
+  for (size_t ic = 0; ic < ncell; ++ic) { cell2tet[ic + 1] += cell2tet[ic]; }
+  aTet.resize(cell2tet[ncell] * 4);
+  parallel_for_chunk(ncell, kNumChunk, [&](size_t ic0, size_t ic1) {
+    for (size_t ic = ic0; ic < ic1; ++ic) {
+      unsigned int itet = cell2tet[ic];
+      tet_cell(static_cast<int>(ic), [&](int ip0, int ip1, int ip2, int ip3) {
+        aTet[itet * 4 + 0] = ip0;
+        aTet[itet * 4 + 1] = ip1;
+        aTet[itet * 4 + 2] = ip2;
+        aTet[itet * 4 + 3] = ip3;
+        ++itet;
+      });
+    }
+  }, num_thread);
 }
 
 DFM2_INLINE void WarpLattice(
     std::vector<CPointLattice> &aPointLattice,
-    const std::vector<int> &psup_ind,
-    const std::vector<int> &psup) {
-  for (unsigned int ip = 0; ip < aPointLattice.size(); ++ip) {
-    if (aPointLattice[ip].sdf < 0) { aPointLattice[ip].iflg = 1; }  // outside
-    else { aPointLattice[ip].iflg = 2; } // inside
-  }
-  // warp background mesh
-  for (int ip = 0; ip < (int) aPointLattice.size(); ++ip) { // lattice points
+    const std::vector<unsigned int> &psup_ind,
+    const std::vector<unsigned int> &psup,
+    unsigned int num_thread) {
+  const size_t np = aPointLattice.size();
+  parallel_for_chunk(np, kNumChunk, [&](size_t ip0, size_t ip1) {
+    for (size_t ip = ip0; ip < ip1; ++ip) {
+      if (aPointLattice[ip].sdf < 0) { aPointLattice[ip].iflg = 1; }  // outside
+      else { aPointLattice[ip].iflg = 2; } // inside
+    }
+  }, num_thread);
+  // the closest cut point on the edges around "ip" ignoring the points already warped
+  auto closest_cut = [&](double min_cut[3], unsigned int ip) -> bool {
     double min_len = -1.0;
     double min_dist = -1.0;
-    double min_cut[3] = {0.0, 0.0, 0.0};
-    for (int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
-      const int jp = psup[ipsup];
-      assert(jp >= 0 && jp < (int) aPointLattice.size());
+    for (unsigned int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
+      const unsigned int jp = psup[ipsup];
+      assert(jp < aPointLattice.size());
       if (aPointLattice[ip].iflg == aPointLattice[jp].iflg) continue;
       if (aPointLattice[ip].iflg == 0) continue;
       if (aPointLattice[jp].iflg == 0) continue;
@@ -2137,12 +2067,33 @@ DFM2_INLINE void WarpLattice(
         min_len = len;
       }
     }
-    if (min_dist < 0) continue;
-    if (min_len < 0) continue;
-    if (min_dist > min_len * 0.3) continue;
-    aPointLattice[ip].pos[0] = min_cut[0];
-    aPointLattice[ip].pos[1] = min_cut[1];
-    aPointLattice[ip].pos[2] = min_cut[2];
+    if (min_dist < 0) return false;
+    if (min_len < 0) return false;
+    if (min_dist > min_len * 0.3) return false;
+    return true;
+  };
+  // The points are warped one by one, and a point next to a warped point is not warped toward it.
+  // The candidates are computed in parallel before any warping, and they are re-computed only for the points
+  // next to the point warped before.
+  std::vector<double> aCut(np * 3);
+  std::vector<char> aIsWarp(np);
+  parallel_for_chunk(np, kNumChunk, [&](size_t ip0, size_t ip1) {
+    for (size_t ip = ip0; ip < ip1; ++ip) {
+      aIsWarp[ip] = closest_cut(aCut.data() + ip * 3, static_cast<unsigned int>(ip));
+    }
+  }, num_thread);
+  // warp background mesh
+  for (unsigned int ip = 0; ip < np; ++ip) { // lattice points
+    bool is_affected = false;
+    for (unsigned int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
+      const unsigned int jp = psup[ipsup];
+      if (jp < ip && aPointLattice[jp].iflg == 0) { is_affected = true; }
+    }
+    if (is_affected) { aIsWarp[ip] = closest_cut(aCut.data() + ip * 3, ip); }
+    if (!aIsWarp[ip]) { continue; }
+    aPointLattice[ip].pos[0] = aCut[ip * 3 + 0];
+    aPointLattice[ip].pos[1] = aCut[ip * 3 + 1];
+    aPointLattice[ip].pos[2] = aCut[ip * 3 + 2];
     aPointLattice[ip].iflg = 0;
   }
 }
@@ -2153,8 +2104,9 @@ DFM2_INLINE void MakeCutPoint(
     std::vector<int> &lat2cut_ind,
     std::vector<int> &lat2cut,
     const std::vector<CPointLattice> &aPointLattice,
-    const std::vector<int> &psup_ind,
-    const std::vector<int> &psup) {
+    const std::vector<unsigned int> &psup_ind,
+    const std::vector<unsigned int> &psup,
+    unsigned int num_thread) {
   const int nno_lat = (int) aPointLattice.size();
   aXYZ.clear();
   aXYZ.reserve(nno_lat * 6);
@@ -2169,67 +2121,77 @@ DFM2_INLINE void MakeCutPoint(
     aXYZ.push_back(aPointLattice[ino].pos[2]);
     nno_out_lat++;
   }
-  ////
+  auto is_cut = [&aPointLattice](unsigned int ino0, unsigned int ino1) {
+    if (aPointLattice[ino0].iflg == aPointLattice[ino1].iflg) return false;
+    if (aPointLattice[ino0].iflg == 0) return false;
+    if (aPointLattice[ino1].iflg == 0) return false;
+    return true;
+  };
+  // number of the edges cut around each lattice point and number of the cut points made by each lattice point
   lat2cut_ind.assign(nno_lat + 1, 0);
-  for (int ino0 = 0; ino0 < nno_lat; ++ino0) {
-    for (int ipsup = psup_ind[ino0]; ipsup < psup_ind[ino0 + 1]; ++ipsup) {
-      const int ino1 = psup[ipsup];
-      if (aPointLattice[ino0].iflg == aPointLattice[ino1].iflg) continue;
-      if (aPointLattice[ino0].iflg == 0) continue;
-      if (aPointLattice[ino1].iflg == 0) continue;
-      lat2cut_ind[ino0 + 1]++; // register cut point
-    }
-  }
-  //
-  for (int ino = 0; ino < nno_lat; ++ino) { lat2cut_ind[ino + 1] += lat2cut_ind[ino]; }
-  int icut_cur = nno_out_lat;
-  int nno_cut = lat2cut_ind[nno_lat] / 2;
-  aXYZ.resize(aXYZ.size() + nno_cut * 3);
-  lat2cut.resize(nno_cut * 4, -1);
-  for (int ino0 = 0; ino0 < nno_lat; ++ino0) {
-    for (int ipsup = psup_ind[ino0]; ipsup < psup_ind[ino0 + 1]; ++ipsup) {
-      const int ino1 = psup[ipsup];
-      if (aPointLattice[ino0].iflg == aPointLattice[ino1].iflg) continue;
-      if (aPointLattice[ino0].iflg == 0) continue;
-      if (aPointLattice[ino1].iflg == 0) continue;
-      const int ilat2cut0 = lat2cut_ind[ino0];
-      lat2cut[ilat2cut0 * 2 + 0] = ino1; // oposite side
-      if (ino0 > ino1) {
-        lat2cut_ind[ino0]++;
-        continue;
+  std::vector<int> lat2newcut(nno_lat + 1, 0);
+  parallel_for_chunk(nno_lat, kNumChunk, [&](size_t ino0, size_t ino1) {
+    for (auto ino = static_cast<unsigned int>(ino0); ino < ino1; ++ino) {
+      for (unsigned int ipsup = psup_ind[ino]; ipsup < psup_ind[ino + 1]; ++ipsup) {
+        const unsigned int jno = psup[ipsup];
+        if (!is_cut(ino, jno)) continue;
+        lat2cut_ind[ino + 1]++; // register cut point
+        if (ino < jno) { lat2newcut[ino + 1]++; }
       }
-      const double sdf0 = aPointLattice[ino0].sdf;
-      const double sdf1 = aPointLattice[ino1].sdf;
-      const double ratio0 = sdf1 / (sdf1 - sdf0);
-      aXYZ[icut_cur * 3 + 0] = aPointLattice[ino0].pos[0] * ratio0 + aPointLattice[ino1].pos[0] * (1 - ratio0);
-      aXYZ[icut_cur * 3 + 1] = aPointLattice[ino0].pos[1] * ratio0 + aPointLattice[ino1].pos[1] * (1 - ratio0);
-      aXYZ[icut_cur * 3 + 2] = aPointLattice[ino0].pos[2] * ratio0 + aPointLattice[ino1].pos[2] * (1 - ratio0);
-      lat2cut[ilat2cut0 * 2 + 1] = icut_cur; // cut
-      icut_cur++;
-      lat2cut_ind[ino0]++;
     }
+  }, num_thread);
+  for (int ino = 0; ino < nno_lat; ++ino) {
+    lat2cut_ind[ino + 1] += lat2cut_ind[ino];
+    lat2newcut[ino + 1] += lat2newcut[ino];
   }
-  assert(icut_cur == nno_cut + nno_out_lat);
-  for (int ino = nno_lat; ino >= 1; ino--) { lat2cut_ind[ino] = lat2cut_ind[ino - 1]; }
-  lat2cut_ind[0] = 0;
-  ////
-  for (int ino0 = 0; ino0 < nno_lat; ++ino0) {
-    for (int ind0 = lat2cut_ind[ino0]; ind0 < lat2cut_ind[ino0 + 1]; ++ind0) {
-      int ino1 = lat2cut[ind0 * 2 + 0];
-      if (ino0 < ino1) {
-        assert(lat2cut[ind0 * 2 + 1] != -1);
-        continue;
-      }
-      for (int ind1 = lat2cut_ind[ino1]; ind1 < lat2cut_ind[ino1 + 1]; ind1++) {
-        int ino2 = lat2cut[ind1 * 2 + 0];
-        if (ino2 != ino0) { continue; }
-        assert(lat2cut[ind1 * 2 + 1] != -1);
-        lat2cut[ind0 * 2 + 1] = lat2cut[ind1 * 2 + 1];
-        assert(lat2cut[ind0 * 2 + 1] != -1);
-        break;
+  const int nno_cut = lat2cut_ind[nno_lat] / 2;
+  assert(nno_cut == lat2newcut[nno_lat]);
+  aXYZ.resize(aXYZ.size() + nno_cut * 3);
+  lat2cut.assign(nno_cut * 4, -1);
+  parallel_for_chunk(nno_lat, kNumChunk, [&](size_t ino0, size_t ino1) {
+    for (auto ino = static_cast<unsigned int>(ino0); ino < ino1; ++ino) {
+      int ilat2cut0 = lat2cut_ind[ino];
+      int icut_cur = nno_out_lat + lat2newcut[ino];
+      for (unsigned int ipsup = psup_ind[ino]; ipsup < psup_ind[ino + 1]; ++ipsup) {
+        const unsigned int jno = psup[ipsup];
+        if (!is_cut(ino, jno)) continue;
+        lat2cut[ilat2cut0 * 2 + 0] = static_cast<int>(jno); // oposite side
+        if (ino > jno) {
+          ilat2cut0++;
+          continue;
+        }
+        const double sdf0 = aPointLattice[ino].sdf;
+        const double sdf1 = aPointLattice[jno].sdf;
+        const double ratio0 = sdf1 / (sdf1 - sdf0);
+        aXYZ[icut_cur * 3 + 0] = aPointLattice[ino].pos[0] * ratio0 + aPointLattice[jno].pos[0] * (1 - ratio0);
+        aXYZ[icut_cur * 3 + 1] = aPointLattice[ino].pos[1] * ratio0 + aPointLattice[jno].pos[1] * (1 - ratio0);
+        aXYZ[icut_cur * 3 + 2] = aPointLattice[ino].pos[2] * ratio0 + aPointLattice[jno].pos[2] * (1 - ratio0);
+        lat2cut[ilat2cut0 * 2 + 1] = icut_cur; // cut
+        icut_cur++;
+        ilat2cut0++;
+      }
+    }
+  }, num_thread);
+  // the cut point of the edge is made by the lattice point with the smaller index
+  parallel_for_chunk(nno_lat, kNumChunk, [&](size_t ino_begin, size_t ino_end) {
+    for (auto ino0 = static_cast<int>(ino_begin); ino0 < (int) ino_end; ++ino0) {
+      for (int ind0 = lat2cut_ind[ino0]; ind0 < lat2cut_ind[ino0 + 1]; ++ind0) {
+        int ino1 = lat2cut[ind0 * 2 + 0];
+        if (ino0 < ino1) {
+          assert(lat2cut[ind0 * 2 + 1] != -1);
+          continue;
+        }
+        for (int ind1 = lat2cut_ind[ino1]; ind1 < lat2cut_ind[ino1 + 1]; ind1++) {
+          int ino2 = lat2cut[ind1 * 2 + 0];
+          if (ino2 != ino0) { continue; }
+          assert(lat2cut[ind1 * 2 + 1] != -1);
+          lat2cut[ind0 * 2 + 1] = lat2cut[ind1 * 2 + 1];
+          assert(lat2cut[ind0 * 2 + 1] != -1);
+          break;
+        }
       }
     }
-  }
+  }, num_thread);
 }
 
 DFM2_INLINE void cutoutTetFromLattice(
@@ -2238,10 +2200,11 @@ DFM2_INLINE void cutoutTetFromLattice(
     const std::vector<unsigned int> &aTetLattice,
     const std::vector<int> &mapLat2Out,
     const std::vector<int> &lat2cut_ind,
-    const std::vector<int> &lat2cut) {
-  aTet.clear();
-  aTet.reserve(aTetLattice.size());
-  for (unsigned int it = 0; it < aTetLattice.size() / 4; it++) {
+    const std::vector<int> &lat2cut,
+    unsigned int num_thread) {
+  const size_t ntet_lat = aTetLattice.size() / 4;
+  // call func(tet, ntet) with the tetrahedra clamped from the lattice tetrahedron "it"
+  auto clamp_tet = [&](size_t it, auto &&func) {
     const int iln0 = aTetLattice[it * 4 + 0];
     const int iln1 = aTetLattice[it * 4 + 1];
     const int iln2 = aTetLattice[it * 4 + 2];
@@ -2261,17 +2224,62 @@ DFM2_INLINE void cutoutTetFromLattice(
     int tet[3][4];
     unsigned int ntet;
     GetClampTet(tet, ntet, iflg, on);
-    for (unsigned int itet = 0; itet < ntet; itet++) {
-      aTet.push_back(tet[itet][0]);
-      aTet.push_back(tet[itet][1]);
-      aTet.push_back(tet[itet][2]);
-      aTet.push_back(tet[itet][3]);
+    func(tet, ntet);
+  };
+  std::vector<unsigned int> lat2tet(ntet_lat + 1, 0);
+  parallel_for_chunk(ntet_lat, kNumChunk, [&](size_t it0, size_t it1) {
+    for (size_t it = it0; it < it1; ++it) {
+      clamp_tet(it, [&](int (*)[4], unsigned int ntet) { lat2tet[it + 1] = ntet; });
+    }
+  }, num_thread);
+  for (size_t it = 0; it < ntet_lat; ++it) { lat2tet[it + 1] += lat2tet[it]; }
+  aTet.resize(lat2tet[ntet_lat] * 4);
+  parallel_for_chunk(ntet_lat, kNumChunk, [&](size_t it0, size_t it1) {
+    for (size_t it = it0; it < it1; ++it) {
+      clamp_tet(it, [&](int (*tet)[4], unsigned int ntet) {
+        for (unsigned int itet = 0; itet < ntet; itet++) {
+          const unsigned int jtet = lat2tet[it] + itet;
+          aTet[jtet * 4 + 0] = tet[itet][0];
+          aTet[jtet * 4 + 1] = tet[itet][1];
+          aTet[jtet * 4 + 2] = tet[itet][2];
+          aTet[jtet * 4 + 3] = tet[itet][3];
+        }
+      });
     }
-  }
+  }, num_thread);
 }
 
 } // namespace delfem2
 
+DFM2_INLINE void delfem2::CInput_IsosurfaceStuffing::SignedDistances(
+    double *sdf,
+    const double *xyz,
+    size_t num_point,
+    unsigned int num_thread) const {
+  parallel_for_chunk(num_point, iss::kNumChunk, [&](size_t ip0, size_t ip1) {
+    for (size_t ip = ip0; ip < ip1; ++ip) {
+      sdf[ip] = this->SignedDistance(xyz[ip * 3 + 0], xyz[ip * 3 + 1], xyz[ip * 3 + 2]);
+    }
+  }, num_thread);
+}
+
+DFM2_INLINE void delfem2::CInput_IsosurfaceStuffing::Levels(
+    int *ilevel_vol,
+    int *ilevel_srf,
+    int *nlayer,
+    double *sdf,
+    const double *xyz,
+    size_t num_point,
+    unsigned int num_thread) const {
+  parallel_for_chunk(num_point, iss::kNumChunk, [&](size_t ip0, size_t ip1) {
+    for (size_t ip = ip0; ip < ip1; ++ip) {
+      this->Level(
+          ilevel_vol[ip], ilevel_srf[ip], nlayer[ip], sdf[ip],
+          xyz[ip * 3 + 0], xyz[ip * 3 + 1], xyz[ip * 3 + 2]);
+    }
+  }, num_thread);
+}
+
 /**
  * @brief internal function for debug
  */
@@ -2279,63 +2287,92 @@ DFM2_INLINE void delfem2::makeBackgroundLattice
     (std::vector<CPointLattice> &aPointLattice,
      std::vector<unsigned int> &aTetLattice,
      const CInput_IsosurfaceStuffing &input,
-     double elen, int ndiv, const double org[3]) {
+     double elen, int ndiv, const double org[3],
+     unsigned int num_thread) {
   std::vector<iss::CCell> aCell;
   iss::makeLatticeCoasestLevel(aPointLattice, aCell,
-                               input, elen, ndiv, org);
-  for (int icell = 0; icell < (int) aCell.size(); ++icell) {
-    int icntr0 = aCell[icell].aIP[26];
-    double size_parent = aCell[icell].size;
-    double sdf_parent = aPointLattice[icntr0].sdf;
-    if (-sdf_parent
-        > size_parent * 1.5) { continue; } // this cell is completely outside the region no need to look into children
-    double cx = aPointLattice[icntr0].pos[0];
-    double cy = aPointLattice[icntr0].pos[1];
-    double cz = aPointLattice[icntr0].pos[2];
-    const int ilevel_parent = aCell[icell].ilevel;
-    for (int ichild = 0; ichild < 8; ++ichild) {
-      const double ccx = cx + iss::aCellPointDirection[ichild][0] * size_parent * 0.25;
-      const double ccy = cy + iss::aCellPointDirection[ichild][1] * size_parent * 0.25;
-      const double ccz = cz + iss::aCellPointDirection[ichild][2] * size_parent * 0.25;
-      double sdf0;
-      int level_vol_goal, level_srf, nlayer;
-      input.Level(level_vol_goal, level_srf, nlayer, sdf0,
-                  ccx, ccy, ccz);
-      int level_srf_goal = 0;
-      if (level_srf > -0.1) {
-        double elen_srf = elen / pow(2, level_srf);
-        double dist = sdf0 - elen_srf * nlayer;
-        if (dist < elen_srf) {
-          level_srf_goal = level_srf;
-        } else {
-          level_srf_goal = static_cast<int>(level_srf - log2(dist / elen_srf));
+                               input, elen, ndiv, org, num_thread);
+  // The cells are refined level by level. The centers of the children in a level are evaluated at once.
+  std::vector<unsigned int> aCellRefine;
+  std::vector<double> aXYZ;
+  std::vector<int> aLevelVol, aLevelSrf, aNLayer;
+  std::vector<double> aSDF;
+  for (size_t icell_begin = 0; icell_begin < aCell.size();) {
+    const size_t icell_end = aCell.size();
+    aCellRefine.clear();
+    aXYZ.clear();
+    for (size_t icell = icell_begin; icell < icell_end; ++icell) {
+      int icntr0 = aCell[icell].aIP[26];
+      double size_parent = aCell[icell].size;
+      double sdf_parent = aPointLattice[icntr0].sdf;
+      if (-sdf_parent
+          > size_parent * 1.5) { continue; } // this cell is completely outside the region no need to look into children
+      aCellRefine.push_back(static_cast<unsigned int>(icell));
+      for (int ichild = 0; ichild < 8; ++ichild) {
+        for (int idim = 0; idim < 3; ++idim) {
+          aXYZ.push_back(aPointLattice[icntr0].pos[idim] + iss::aCellPointDirection[ichild][idim] * size_parent * 0.25);
         }
       }
+    }
+    const size_t nchild = aCellRefine.size() * 8;
+    aLevelVol.resize(nchild);
+    aLevelSrf.resize(nchild);
+    aNLayer.resize(nchild);
+    aSDF.resize(nchild);
+    input.Levels(
+        aLevelVol.data(), aLevelSrf.data(), aNLayer.data(), aSDF.data(),
+        aXYZ.data(), nchild, num_thread);
+    for (unsigned int iicell = 0; iicell < aCellRefine.size(); ++iicell) {
+      const unsigned int icell = aCellRefine[iicell];
+      double size_parent = aCell[icell].size;
+      const int ilevel_parent = aCell[icell].ilevel;
+      for (int ichild = 0; ichild < 8; ++ichild) {
+        const unsigned int jchild = iicell * 8 + ichild;
+        const double ccx = aXYZ[jchild * 3 + 0];
+        const double ccy = aXYZ[jchild * 3 + 1];
+        const double ccz = aXYZ[jchild * 3 + 2];
+        const double sdf0 = aSDF[jchild];
+        const int level_vol_goal = aLevelVol[jchild];
+        const int level_srf = aLevelSrf[jchild];
+        const int nlayer = aNLayer[jchild];
+        int level_srf_goal = 0;
+        if (level_srf > -0.1) {
+          double elen_srf = elen / pow(2, level_srf);
+          double dist = sdf0 - elen_srf * nlayer;
+          if (dist < elen_srf) {
+            level_srf_goal = level_srf;
+          } else {
+            level_srf_goal = static_cast<int>(level_srf - log2(dist / elen_srf));
+          }
+        }
 //      =
-      if (level_vol_goal >= (ilevel_parent + 1) ||
+        if (level_vol_goal >= (ilevel_parent + 1) ||
 //         (level_srf_goal >= (ilevel_parent+1) && level_srf > level_srf_goal) )
-          level_srf_goal >= (ilevel_parent + 1)) {
-        aCell[icell].aIC_Cld[ichild] = (int) aCell.size();
-        iss::CCell cc(size_parent * 0.5, ilevel_parent + 1, icell, ichild);
-        {
-          cc.aIP[26] = (int) aPointLattice.size();
-          CPointLattice p(ccx, ccy, ccz, sdf0);
-          aPointLattice.push_back(p);
+            level_srf_goal >= (ilevel_parent + 1)) {
+          aCell[icell].aIC_Cld[ichild] = (int) aCell.size();
+          iss::CCell cc(size_parent * 0.5, ilevel_parent + 1, icell, ichild);
+          {
+            cc.aIP[26] = (int) aPointLattice.size();
+            CPointLattice p(ccx, ccy, ccz, sdf0);
+            aPointLattice.push_back(p);
+          }
+          aCell.push_back(cc);
+        } else {
+          aCell[icell].aIC_Cld[ichild] = -1;
         }
-        aCell.push_back(cc);
-      } else {
-        aCell[icell].aIC_Cld[ichild] = -1;
       }
+      aCell[icell].setChildAdjRelation(aCell); // make relation ship inside children
     }
-    aCell[icell].setChildAdjRelation(aCell); // make relation ship inside children
+    icell_begin = icell_end;
   }
-  Continuation(aPointLattice, aCell,
-               input);
+  const size_t np_refine = aPointLattice.size();
+  Continuation(aPointLattice, aCell);
 //  CheckContinuation(aCell);
-  addEdgeFacePoints(aPointLattice, aCell,
-                    input);
+  addEdgeFacePoints(aPointLattice, aCell);
+  // the points added for the continuation and the edges/faces are evaluated at once
+  iss::EvaluateSignedDistance(aPointLattice, np_refine, input, num_thread);
   makeTetLattice(aTetLattice,
-                 aCell);
+                 aCell, num_thread);
 }
 
 DFM2_INLINE bool delfem2::IsoSurfaceStuffing(
@@ -2345,7 +2382,8 @@ DFM2_INLINE bool delfem2::IsoSurfaceStuffing(
     const CInput_IsosurfaceStuffing &input,
     double elen_in,
     double width,
-    const double center[3]) {
+    const double center[3],
+    unsigned int num_thread) {
   if (elen_in <= 0) return false;
 
   int ndiv = (int) (width / elen_in);
@@ -2355,25 +2393,23 @@ DFM2_INLINE bool delfem2::IsoSurfaceStuffing(
 
   std::vector<CPointLattice> aPointLattice;
   std::vector<unsigned int> aTetLattice;
-  makeBackgroundLattice(aPointLattice, aTetLattice, input, elen, ndiv, org);
+  makeBackgroundLattice(aPointLattice, aTetLattice, input, elen, ndiv, org, num_thread);
 
   std::vector<int> mapLat2Out;
   std::vector<int> lat2cut_ind, lat2cut;
   {
-    std::vector<int> psup_ind, psup;
-    {
-      std::vector<int> elsup_ind, elsup;
-      iss::makeElemSurroundingPoint(elsup_ind, elsup, aTetLattice, 4, (int) aPointLattice.size());
-      iss::makeOneRingNeighborhood(psup_ind, psup, aTetLattice, elsup_ind, elsup, 4, (int) aPointLattice.size());
-    }
+    std::vector<unsigned int> psup_ind, psup;
+    JArray_PSuP_MeshElem(
+        psup_ind, psup,
+        aTetLattice.data(), aTetLattice.size() / 4, 4, aPointLattice.size(), num_thread);
     iss::WarpLattice(aPointLattice,
-                     psup_ind, psup);
+                     psup_ind, psup, num_thread);
     iss::MakeCutPoint(aXYZ, mapLat2Out, lat2cut_ind, lat2cut,
-                      aPointLattice, psup_ind, psup);
+                      aPointLattice, psup_ind, psup, num_thread);
   }
 
   iss::cutoutTetFromLattice(aTet,
-                            aPointLattice, aTetLattice, mapLat2Out, lat2cut_ind, lat2cut);
+                            aPointLattice, aTetLattice, mapLat2Out, lat2cut_ind, lat2cut, num_thread);
 
   {
     aIsOnSurfXYZ.assign((int) aXYZ.size() / 3, 1);
@@ -8,6 +8,7 @@
 #ifndef DFM2_ISRF_ISS_H
 #define DFM2_ISRF_ISS_H
 
+#include <cstddef>
 #include <vector>
 
 #include "delfem2/dfm2_inline.h"
@@ -27,8 +28,41 @@ public:
     ilevel_srf = -1;
     nlayer = 1;
   }
+
+  /**
+   * @brief signed distances of many points at once
+   * @details The lattice points are evaluated with this function. Override it if the distances
+   * of many points are computed faster together (e.g., the distance from a mesh).
+   * The default calls "SignedDistance" for each point. If num_thread != 1, the points are evaluated in parallel
+   * and "SignedDistance" needs to be thread-safe.
+   * @param[out] sdf signed distance of each point
+   * @param[in] xyz coordinates of the points
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   */
+  virtual void SignedDistances(
+      double* sdf,
+      const double* xyz,
+      size_t num_point,
+      unsigned int num_thread) const;
+
+  /**
+   * @brief "Level" of many points at once
+   * @details the default calls "Level" for each point in the same way as "SignedDistances"
+   */
+  virtual void Levels(
+      int* ilevel_vol,
+      int* ilevel_srf,
+      int* nlayer,
+      double* sdf,
+      const double* xyz,
+      size_t num_point,
+      unsigned int num_thread) const;
 };
 
+/**
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ * The output is independent of the number of threads.
+ */
 DFM2_INLINE bool IsoSurfaceStuffing
  (std::vector<double>& aXYZ,
   std::vector<unsigned int>& aTet,
@@ -37,7 +71,8 @@ DFM2_INLINE bool IsoSurfaceStuffing
   const CInput_IsosurfaceStuffing& input,
   double elen_in,
   double width,
-  const double center[3]);
+  const double center[3],
+  unsigned int num_thread = 1);
 
 class CPointLattice
 {
@@ -66,7 +101,8 @@ void makeBackgroundLattice(
     const CInput_IsosurfaceStuffing& input,
     double elen,
     int  ndiv,
-    const double org[3]);
+    const double org[3],
+    unsigned int num_thread = 1);
 
 }
 
@@ -0,0 +1,594 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/isrf_marchingcube.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "delfem2/mat4.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::marchingcube {
+
+//! number of cells or vertices processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 12;
+
+//! corners of the hexahedron in the unit cube
+const unsigned int hexflg[8][3] = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+    {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+
+//! corners at the both ends of the edges of the hexahedron
+const unsigned int edge2corner[12][2] = {
+    {0, 1}, {1, 2}, {2, 3}, {3, 0},
+    {4, 5}, {5, 6}, {6, 7}, {7, 4},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+/**
+ * edges of the triangles for each pattern of the corners outside.
+ * Paul Bourke, "Polygonising a scalar field", 1994
+ */
+const int triTable[256][16] =
+    {
+        {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 8, 3, 9, 8, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 2, 10, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 8, 3, 2, 10, 8, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+        {3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 11, 2, 8, 11, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 9, 0, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 11, 2, 1, 9, 11, 9, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+        {3, 10, 1, 11, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 10, 1, 0, 8, 10, 8, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+        {3, 9, 0, 3, 11, 9, 11, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+        {9, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 3, 0, 7, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 1, 9, 4, 7, 1, 7, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 4, 7, 3, 0, 4, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1},
+        {9, 2, 10, 9, 0, 2, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+        {2, 10, 9, 2, 9, 7, 2, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+        {8, 4, 7, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 4, 7, 11, 2, 4, 2, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+        {9, 0, 1, 8, 4, 7, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+        {4, 7, 11, 9, 4, 11, 9, 11, 2, 9, 2, 1, -1, -1, -1, -1},
+        {3, 10, 1, 3, 11, 10, 7, 8, 4, -1, -1, -1, -1, -1, -1, -1},
+        {1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
+        {4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+        {4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+        {5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+        {2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
+        {9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+        {0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+        {2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
+        {10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
+        {5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+        {5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+        {9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+        {0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+        {1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
+        {10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
+        {8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
+        {2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+        {7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+        {2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
+        {11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
+        {5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
+        {11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
+        {11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+        {1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
+        {9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+        {5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
+        {2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+        {5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
+        {6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+        {3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
+        {6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+        {5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
+        {1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+        {10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+        {6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
+        {8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
+        {7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
+        {3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+        {5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+        {0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
+        {9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
+        {8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+        {5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
+        {0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
+        {6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
+        {10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
+        {10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+        {8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+        {1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
+        {0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+        {10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
+        {3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+        {6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
+        {9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
+        {8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
+        {3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+        {6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+        {0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
+        {10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
+        {10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+        {2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
+        {7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+        {7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+        {2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
+        {1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
+        {11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
+        {8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
+        {0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
+        {7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+        {10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+        {2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+        {6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
+        {7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+        {2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
+        {1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
+        {10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+        {10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
+        {0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
+        {7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+        {6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+        {8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
+        {6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
+        {4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
+        {10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
+        {8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+        {0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
+        {1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+        {8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
+        {10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+        {4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
+        {10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+        {5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+        {11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
+        {9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+        {6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
+        {7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
+        {3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
+        {7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
+        {3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
+        {6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
+        {9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
+        {1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
+        {4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
+        {7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
+        {6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+        {3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
+        {0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
+        {6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
+        {0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
+        {11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
+        {6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
+        {5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
+        {9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+        {1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
+        {1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
+        {10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
+        {0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
+        {5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+        {10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
+        {11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
+        {9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
+        {7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
+        {2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+        {8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
+        {9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
+        {9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
+        {1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+        {9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+        {9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+        {5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
+        {0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
+        {10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
+        {2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
+        {0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
+        {0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
+        {9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
+        {5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+        {3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
+        {5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
+        {8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
+        {9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
+        {1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
+        {3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
+        {4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
+        {9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
+        {11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+        {11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
+        {2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
+        {9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
+        {3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
+        {1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
+        {4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+        {3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
+        {0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+        {9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
+        {1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}
+    };
+
+/**
+ * vertex of a triangle before welding. The vertex is on the lattice edge between the lattice points "key0" and "key1"
+ */
+struct CEdgeVtx {
+  std::uint64_t key0, key1;
+  unsigned int islot;
+  bool operator<(const CEdgeVtx &rhs) const {
+    if (key0 != rhs.key0) { return key0 < rhs.key0; }
+    if (key1 != rhs.key1) { return key1 < rhs.key1; }
+    return islot < rhs.islot;
+  }
+};
+
+DFM2_INLINE std::uint64_t HashEdge(std::uint64_t key0, std::uint64_t key1) {
+  std::uint64_t h = key0 * 0x9E3779B97F4A7C15ULL + key1;
+  h ^= h >> 31;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 29;
+  return h;
+}
+
+/**
+ * @brief marching cubes with the pattern of each cell given
+ * @param cell_pattern bit flags of the corners below the iso value
+ */
+DFM2_INLINE void MarchingCube_Pattern(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const std::vector<unsigned char> &cell_pattern,
+    const std::function<void(size_t icell, double val[8], double xyz[24], std::uint64_t key[8])> &cell_corner,
+    double iso,
+    unsigned int num_thread) {
+  // cells crossing the iso-surface
+  std::vector<size_t> aCell;
+  {
+    const size_t nchunk = (cell_pattern.size() + kNumChunk - 1) / kNumChunk;
+    std::vector<size_t> chunk2cell(nchunk + 1, 0);
+    auto is_cross = [&](size_t ic) { return cell_pattern[ic] != 0 && cell_pattern[ic] != 255; };
+    parallel_for_chunk(nchunk, kNumChunk, [&](size_t ik0, size_t ik1) {
+      for (size_t ik = ik0; ik < ik1; ++ik) {
+        const size_t ic1 = std::min(cell_pattern.size(), (ik + 1) * kNumChunk);
+        for (size_t ic = ik * kNumChunk; ic < ic1; ++ic) { chunk2cell[ik + 1] += is_cross(ic) ? 1 : 0; }
+      }
+    }, num_thread);
+    for (size_t ik = 0; ik < nchunk; ++ik) { chunk2cell[ik + 1] += chunk2cell[ik]; }
+    aCell.resize(chunk2cell[nchunk]);
+    parallel_for_chunk(nchunk, kNumChunk, [&](size_t ik0, size_t ik1) {
+      for (size_t ik = ik0; ik < ik1; ++ik) {
+        const size_t ic1 = std::min(cell_pattern.size(), (ik + 1) * kNumChunk);
+        size_t jc = chunk2cell[ik];
+        for (size_t ic = ik * kNumChunk; ic < ic1; ++ic) {
+          if (is_cross(ic)) { aCell[jc++] = ic; }
+        }
+      }
+    }, num_thread);
+  }
+  const size_t num_cell = aCell.size();
+  std::vector<unsigned int> cell2tri(num_cell + 1, 0);
+  parallel_for_chunk(num_cell, kNumChunk, [&](size_t ic0, size_t ic1) {
+    for (size_t ic = ic0; ic < ic1; ++ic) {
+      unsigned int ntri = 0;
+      while (triTable[cell_pattern[aCell[ic]]][ntri * 3] != -1) { ++ntri; }
+      cell2tri[ic + 1] = ntri;
+    }
+  }, num_thread);
+  for (size_t ic = 0; ic < num_cell; ++ic) { cell2tri[ic + 1] += cell2tri[ic]; }
+  // vertices of the triangles before welding
+  const size_t nslot = cell2tri[num_cell] * 3;
+  std::vector<CEdgeVtx> slot2edge(nslot);
+  std::vector<double> slot2xyz(nslot * 3);
+  parallel_for_chunk(num_cell, kNumChunk, [&](size_t ic0, size_t ic1) {
+    double val[8], xyz[24];
+    std::uint64_t key[8];
+    for (size_t ic = ic0; ic < ic1; ++ic) {
+      cell_corner(aCell[ic], val, xyz, key);
+      const int *aEdge = triTable[cell_pattern[aCell[ic]]];
+      for (unsigned int k = 0; k < (cell2tri[ic + 1] - cell2tri[ic]) * 3; ++k) {
+        const unsigned int islot = cell2tri[ic] * 3 + k;
+        unsigned int i0 = edge2corner[aEdge[k]][0];
+        unsigned int i1 = edge2corner[aEdge[k]][1];
+        if (key[i0] > key[i1]) { std::swap(i0, i1); } // the same position for the cells sharing the edge
+        const double r = (iso - val[i0]) / (val[i1] - val[i0]);
+        for (unsigned int idim = 0; idim < 3; ++idim) {
+          slot2xyz[islot * 3 + idim] = xyz[i0 * 3 + idim] + r * (xyz[i1 * 3 + idim] - xyz[i0 * 3 + idim]);
+        }
+        slot2edge[islot] = {key[i0], key[i1], islot};
+      }
+    }
+  }, num_thread);
+  // weld the vertices on the same edge. The vertices are distributed to buckets by the hash of the edge.
+  size_t nbucket = 1;
+  while (nbucket * 16 < nslot && nbucket < (size_t(1) << 30)) { nbucket *= 2; }
+  std::vector<unsigned int> bucket_ind(nbucket + 1, 0);
+  std::vector<unsigned int> slot2bucket(nslot);
+  parallel_for_chunk(nslot, kNumChunk, [&](size_t is0, size_t is1) {
+    for (size_t islot = is0; islot < is1; ++islot) {
+      const std::uint64_t h = HashEdge(slot2edge[islot].key0, slot2edge[islot].key1);
+      slot2bucket[islot] = static_cast<unsigned int>((h >> 32) & (nbucket - 1));
+    }
+  }, num_thread);
+  for (size_t islot = 0; islot < nslot; ++islot) { bucket_ind[slot2bucket[islot] + 1] += 1; }
+  for (size_t ib = 0; ib < nbucket; ++ib) { bucket_ind[ib + 1] += bucket_ind[ib]; }
+  std::vector<CEdgeVtx> bucket_edge(nslot);
+  {
+    std::vector<unsigned int> ind = bucket_ind;
+    for (size_t islot = 0; islot < nslot; ++islot) {
+      bucket_edge[ind[slot2bucket[islot]]++] = slot2edge[islot];
+    }
+  }
+  std::vector<unsigned int> slot2rep(nslot); // first vertex on the same edge
+  parallel_for_chunk(nbucket, kNumChunk, [&](size_t ib0, size_t ib1) {
+    for (size_t ib = ib0; ib < ib1; ++ib) {
+      const auto itr0 = bucket_edge.begin() + bucket_ind[ib];
+      const auto itr1 = bucket_edge.begin() + bucket_ind[ib + 1];
+      std::sort(itr0, itr1);
+      unsigned int irep = UINT_MAX;
+      for (auto itr = itr0; itr != itr1; ++itr) {
+        if (itr == itr0 || itr->key0 != (itr - 1)->key0 || itr->key1 != (itr - 1)->key1) {
+          irep = itr->islot;
+        }
+        slot2rep[itr->islot] = irep;
+      }
+    }
+  }, num_thread);
+  // the vertices are numbered in the order of their first appearance
+  tri_vtx.resize(nslot);
+  unsigned int nvtx = 0;
+  for (size_t islot = 0; islot < nslot; ++islot) {
+    const unsigned int irep = slot2rep[islot];
+    tri_vtx[islot] = (irep == islot) ? nvtx++ : tri_vtx[irep];
+  }
+  vtx_xyz.resize(nvtx * 3);
+  parallel_for_chunk(nslot, kNumChunk, [&](size_t is0, size_t is1) {
+    for (size_t islot = is0; islot < is1; ++islot) {
+      if (slot2rep[islot] != islot) { continue; }
+      const unsigned int ivtx = tri_vtx[islot];
+      vtx_xyz[ivtx * 3 + 0] = slot2xyz[islot * 3 + 0];
+      vtx_xyz[ivtx * 3 + 1] = slot2xyz[islot * 3 + 1];
+      vtx_xyz[ivtx * 3 + 2] = slot2xyz[islot * 3 + 2];
+    }
+  }, num_thread);
+}
+
+template<typename VAL, typename FUNC_POS>
+void MarchingCube_Grid(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const VAL *grid_val,
+    unsigned int npx,
+    unsigned int npy,
+    unsigned int npz,
+    double iso,
+    FUNC_POS &&pos_func,
+    unsigned int num_thread) {
+  if (npx < 2 || npy < 2 || npz < 2) {
+    vtx_xyz.clear();
+    tri_vtx.clear();
+    return;
+  }
+  const size_t ncy = npy - 1, ncz = npz - 1;
+  const size_t ncell = (npx - 1) * ncy * ncz;
+  std::vector<unsigned char> cell_pattern(ncell);
+  { // pattern of the cells computed for each row along z
+    const size_t sx = size_t(npy) * npz, sy = npz;
+    const size_t aOffset[8] = {0, sx, sx + sy, sy, 1, sx + 1, sx + sy + 1, sy + 1};
+    parallel_for_chunk((npx - 1) * ncy, kNumChunk, [&](size_t ir0, size_t ir1) {
+      for (size_t ir = ir0; ir < ir1; ++ir) {
+        const size_t ix = ir / ncy, iy = ir % ncy;
+        const VAL *pv = grid_val + ix * sx + iy * sy;
+        unsigned char *pp = cell_pattern.data() + ir * ncz;
+        // the corners 4-7 of a cell are the corners 0-3 of the next cell
+        unsigned int ipattern0 = 0;
+        for (unsigned int i = 0; i < 4; ++i) {
+          if (static_cast<double>(pv[aOffset[i]]) < iso) { ipattern0 |= (1u << i); }
+        }
+        for (size_t iz = 0; iz < ncz; ++iz) {
+          unsigned int ipattern1 = 0;
+          for (unsigned int i = 0; i < 4; ++i) {
+            if (static_cast<double>(pv[iz + aOffset[i + 4]]) < iso) { ipattern1 |= (1u << i); }
+          }
+          pp[iz] = static_cast<unsigned char>(ipattern0 | (ipattern1 << 4));
+          ipattern0 = ipattern1;
+        }
+      }
+    }, num_thread);
+  }
+  MarchingCube_Pattern(
+      vtx_xyz, tri_vtx,
+      cell_pattern,
+      [&](size_t icell, double val[8], double xyz[24], std::uint64_t key[8]) {
+        const size_t ix = icell / (ncy * ncz);
+        const size_t iy = (icell / ncz) % ncy;
+        const size_t iz = icell % ncz;
+        for (unsigned int i = 0; i < 8; ++i) {
+          const size_t jx = ix + hexflg[i][0], jy = iy + hexflg[i][1], jz = iz + hexflg[i][2];
+          const size_t ip = (jx * npy + jy) * npz + jz;
+          val[i] = static_cast<double>(grid_val[ip]);
+          if (xyz == nullptr) { continue; }
+          key[i] = ip;
+          pos_func(xyz + i * 3, jx, jy, jz);
+        }
+      },
+      iso, num_thread);
+}
+
+}  // namespace delfem2::marchingcube
+
+// ---------------------------------------
+
+DFM2_INLINE void delfem2::MeshTri3D_MarchingCube(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    size_t num_cell,
+    const std::function<void(size_t icell, double val[8], double xyz[24], std::uint64_t key[8])> &cell_corner,
+    double iso,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::marchingcube;
+  std::vector<unsigned char> cell_pattern(num_cell);
+  parallel_for_chunk(num_cell, lcl::kNumChunk, [&](size_t ic0, size_t ic1) {
+    double val[8];
+    for (size_t ic = ic0; ic < ic1; ++ic) {
+      cell_corner(ic, val, nullptr, nullptr);
+      unsigned int ipattern = 0;
+      for (unsigned int i = 0; i < 8; ++i) {
+        if (val[i] < iso) { ipattern |= (1u << i); }
+      }
+      cell_pattern[ic] = static_cast<unsigned char>(ipattern);
+    }
+  }, num_thread);
+  lcl::MarchingCube_Pattern(
+      vtx_xyz, tri_vtx,
+      cell_pattern, cell_corner, iso, num_thread);
+}
+
+template<typename VAL>
+DFM2_INLINE void delfem2::MeshTri3D_MarchingCube_Grid(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const VAL *grid_val,
+    unsigned int npx,
+    unsigned int npy,
+    unsigned int npz,
+    double iso,
+    const double org[3],
+    double elen,
+    unsigned int num_thread) {
+  marchingcube::MarchingCube_Grid(
+      vtx_xyz, tri_vtx,
+      grid_val, npx, npy, npz, iso,
+      [org, elen](double p[3], size_t jx, size_t jy, size_t jz) {
+        p[0] = org[0] + elen * static_cast<double>(jx);
+        p[1] = org[1] + elen * static_cast<double>(jy);
+        p[2] = org[2] + elen * static_cast<double>(jz);
+      },
+      num_thread);
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::MeshTri3D_MarchingCube_Grid(
+    std::vector<double> &, std::vector<unsigned int> &,
+    const double *, unsigned int, unsigned int, unsigned int, double, const double[3], double, unsigned int);
+template void delfem2::MeshTri3D_MarchingCube_Grid(
+    std::vector<double> &, std::vector<unsigned int> &,
+    const float *, unsigned int, unsigned int, unsigned int, double, const double[3], double, unsigned int);
+template void delfem2::MeshTri3D_MarchingCube_Grid(
+    std::vector<double> &, std::vector<unsigned int> &,
+    const int *, unsigned int, unsigned int, unsigned int, double, const double[3], double, unsigned int);
+#endif
+
+template<typename VAL>
+DFM2_INLINE void delfem2::MeshTri3D_MarchingCube_VoxelGrid(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const CGrid3<VAL> &grid,
+    double iso,
+    unsigned int num_thread) {
+  const double *am = grid.am.mat;
+  marchingcube::MarchingCube_Grid(
+      vtx_xyz, tri_vtx,
+      grid.aVal.data(), grid.ndivx, grid.ndivy, grid.ndivz, iso,
+      [am](double p[3], size_t jx, size_t jy, size_t jz) {
+        const double q[3] = {
+            static_cast<double>(jx) + 0.5,
+            static_cast<double>(jy) + 0.5,
+            static_cast<double>(jz) + 0.5};
+        Vec3_Mat4Vec3_Affine(p, am, q);
+      },
+      num_thread);
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::MeshTri3D_MarchingCube_VoxelGrid(
+    std::vector<double> &, std::vector<unsigned int> &,
+    const CGrid3<double> &, double, unsigned int);
+template void delfem2::MeshTri3D_MarchingCube_VoxelGrid(
+    std::vector<double> &, std::vector<unsigned int> &,
+    const CGrid3<float> &, double, unsigned int);
+template void delfem2::MeshTri3D_MarchingCube_VoxelGrid(
+    std::vector<double> &, std::vector<unsigned int> &,
+    const CGrid3<int> &, double, unsigned int);
+#endif
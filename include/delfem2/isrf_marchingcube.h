@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file marching cubes producing a welded triangle mesh
+ * @details The vertices on the same lattice edge are shared by the triangles of the cells around the edge,
+ * so the output can be directly passed to e.g., "Normal_MeshTri3D" or the BVH construction.
+ * The region where the value is larger than the iso value is inside,
+ * and the triangles are oriented counter-clockwise seen from the outside.
+ */
+
+#ifndef DFM2_ISRF_MARCHINGCUBE_H
+#define DFM2_ISRF_MARCHINGCUBE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "delfem2/dfm2_inline.h"
+#include "delfem2/gridvoxel.h"
+
+namespace delfem2 {
+
+/**
+ * @brief marching cubes over arbitrary hexahedral cells
+ * @details the cells are processed in parallel. The vertices are numbered in the order of
+ * their first appearance in the triangles, so the output does not depend on the number of threads.
+ * @param num_cell number of cells
+ * @param cell_corner function(icell, val, xyz, key) giving the values, the coordinates and
+ * the keys of the eight corners of the cell "icell" in the order of the hexahedron.
+ * The corners with the same key are the same lattice point. Two cells share the vertex on an edge
+ * if the keys of the both ends of the edge are the same. "xyz" and "key" are nullptr when only the values are needed.
+ * It is called from multiple threads.
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ */
+DFM2_INLINE void MeshTri3D_MarchingCube(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    size_t num_cell,
+    const std::function<void(size_t icell, double val[8], double xyz[24], std::uint64_t key[8])> &cell_corner,
+    double iso,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief marching cubes of the values at the grid points
+ * @param grid_val values at the npx*npy*npz points. The value of the point (ix,iy,iz) is grid_val[ix*npy*npz+iy*npz+iz]
+ * @param org coordinate of the point (0,0,0)
+ * @param elen distance between the points
+ * @details defined for "double", "float" and "int"
+ */
+template<typename VAL>
+DFM2_INLINE void MeshTri3D_MarchingCube_Grid(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const VAL *grid_val,
+    unsigned int npx,
+    unsigned int npy,
+    unsigned int npz,
+    double iso,
+    const double org[3],
+    double elen,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief marching cubes of the values at the centers of the voxels
+ * @details the center of the voxel (ivx,ivy,ivz) is at (ivx+0.5,ivy+0.5,ivz+0.5) in the local coordinate of the grid,
+ * which is transformed with "grid.am". The surface is open where it touches the boundary of the grid.
+ * Defined for "double", "float" and "int"
+ */
+template<typename VAL>
+DFM2_INLINE void MeshTri3D_MarchingCube_VoxelGrid(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const CGrid3<VAL> &grid,
+    double iso,
+    unsigned int num_thread = 0);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/isrf_marchingcube.cpp"
+#endif
+
+#endif // DFM2_ISRF_MARCHINGCUBE_H
@@ -11,6 +11,18 @@
 #include <cassert>
 #include <iostream>
 #include <climits>
+#include <algorithm>
+
+#include "delfem2/thread.h"
+
+namespace delfem2::jagarray {
+
+//! minimum number of rows processed by a thread
+constexpr size_t kNumRowBlock = 1 << 12;
+
+}  // namespace delfem2::jagarray
+
+// ---------------------------------------------
 
 // in the edge ip -> jp, it holds (ip < jp)
 DFM2_INLINE void delfem2::JArrayEdgeUnidir_PointSurPoint(
@@ -71,8 +83,21 @@ DFM2_INLINE void delfem2::JArray_Print(
 
 DFM2_INLINE void delfem2::JArray_Sort(
     const std::vector<unsigned int> &index,
-    std::vector<unsigned int> &array) {
+    std::vector<unsigned int> &array,
+    unsigned int num_thread) {
   if (index.empty()) return;
+  if (num_thread != 1) {
+    // transpose of the transpose has sorted rows
+    const unsigned int ncol = array.empty() ? 0 : *std::max_element(array.begin(), array.end()) + 1;
+    std::vector<unsigned int> index_t, array_t, index1;
+    JArray_Transpose(
+        index_t, array_t,
+        index.data(), index.size() - 1, array.data(), ncol, num_thread);
+    JArray_Transpose(
+        index1, array,
+        index_t.data(), ncol, array_t.data(), index.size() - 1, num_thread);
+    return;
+  }
   const int size = (int) index.size() - 1;
   for (int ipoin = 0; ipoin < size; ipoin++) {
     const unsigned int is = index[ipoin];
@@ -121,48 +146,84 @@ DFM2_INLINE void delfem2::JArray_AddDiagonal(
     const unsigned int *psup_ind0,
     size_t npsup_ind0,
     const unsigned int *psup0,
-    [[maybe_unused]] size_t npsup0) {
+    [[maybe_unused]] size_t npsup0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::jagarray;
   assert(npsup_ind0>0);
   const size_t np = npsup_ind0 - 1;
-  std::vector<unsigned int> tmp(np, UINT_MAX);
+  auto has_diagonal = [&](unsigned int ip) {
+    const unsigned int *row_end = psup0 + psup_ind0[ip + 1];
+    return std::find(psup0 + psup_ind0[ip], row_end, ip) != row_end;
+  };
+  const unsigned int nblock = num_block_for_thread(np, lcl::kNumRowBlock, num_thread);
   psup_ind1.assign(np + 1, 0);
-  for (unsigned int ip = 0; ip < np; ++ip) {
-    for (std::size_t ipsup = psup_ind0[ip]; ipsup < psup_ind0[ip + 1]; ++ipsup) {
-      const unsigned int jp = psup0[ipsup];
-      assert(tmp[jp] != ip);
-      tmp[jp] = ip;
-      psup_ind1[ip + 1] += 1;
-    }
-    if (tmp[ip] != ip) {
-      tmp[ip] = ip;
-      psup_ind1[ip + 1] += 1;
+  parallel_for_block(np, nblock, [&](unsigned int, size_t ip0, size_t ip1) {
+    for (auto ip = static_cast<unsigned int>(ip0); ip < ip1; ++ip) {
+      psup_ind1[ip + 1] = psup_ind0[ip + 1] - psup_ind0[ip] + (has_diagonal(ip) ? 0 : 1);
     }
-  }
+  });
   for (unsigned int ip = 0; ip < np; ++ip) {
     psup_ind1[ip + 1] += psup_ind1[ip];
   }
-  const unsigned int npsup = psup_ind1[np];
-  psup1.resize(npsup);
-  tmp.assign(np, UINT_MAX);
-  for (unsigned int ip = 0; ip < np; ++ip) {
-    for (std::size_t ipsup = psup_ind0[ip]; ipsup < psup_ind0[ip + 1]; ++ipsup) {
-      const unsigned int jp = psup0[ipsup];
-      assert(tmp[jp] != ip);
-      tmp[jp] = ip;
-      unsigned int iclstr = psup_ind1[ip];
-      psup1[iclstr] = jp;
-      psup_ind1[ip] += 1;
+  psup1.resize(psup_ind1[np]);
+  parallel_for_block(np, nblock, [&](unsigned int, size_t ip0, size_t ip1) {
+    for (auto ip = static_cast<unsigned int>(ip0); ip < ip1; ++ip) {
+      const unsigned int *row_begin = psup0 + psup_ind0[ip];
+      const unsigned int *row_end = psup0 + psup_ind0[ip + 1];
+      std::copy(row_begin, row_end, psup1.begin() + psup_ind1[ip]);
+      if (psup_ind1[ip + 1] - psup_ind1[ip] != psup_ind0[ip + 1] - psup_ind0[ip]) {
+        psup1[psup_ind1[ip + 1] - 1] = ip;
+      }
     }
-    if (tmp[ip] != ip) {
-      unsigned int iclstr = psup_ind1[ip];
-      psup1[iclstr] = ip;
-      psup_ind1[ip] += 1;
+  });
+}
+
+DFM2_INLINE void delfem2::JArray_Transpose(
+    std::vector<unsigned int> &index1,
+    std::vector<unsigned int> &array1,
+    const unsigned int *index0,
+    size_t num_row0,
+    const unsigned int *array0,
+    size_t num_col0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::jagarray;
+  const unsigned int nblock = num_block_for_thread(num_row0, lcl::kNumRowBlock, num_thread);
+  // count[iblock * num_col0 + icol]: number of the value "icol" in the block
+  std::vector<unsigned int> count(nblock * num_col0, 0);
+  parallel_for_block(num_row0, nblock, [&](unsigned int ib, size_t ir0, size_t ir1) {
+    unsigned int *cnt = count.data() + ib * num_col0;
+    for (unsigned int i = index0[ir0]; i < index0[ir1]; ++i) {
+      assert(array0[i] < num_col0);
+      cnt[array0[i]] += 1;
     }
+  });
+  // exclusive prefix sum over the blocks gives the offset of each block in a row of the output
+  index1.assign(num_col0 + 1, 0);
+  parallel_for_block(num_col0, nblock, [&](unsigned int, size_t ic0, size_t ic1) {
+    for (size_t ic = ic0; ic < ic1; ++ic) {
+      unsigned int sum = 0;
+      for (unsigned int ib = 0; ib < nblock; ++ib) {
+        const unsigned int cnt = count[ib * num_col0 + ic];
+        count[ib * num_col0 + ic] = sum;
+        sum += cnt;
+      }
+      index1[ic + 1] = sum;
+    }
+  });
+  for (size_t ic = 0; ic < num_col0; ++ic) {
+    index1[ic + 1] += index1[ic];
   }
-  for (int ip = static_cast<int>(np) - 1; ip >= 0; --ip) {
-    psup_ind1[ip + 1] = psup_ind1[ip];
-  }
-  psup_ind1[0] = 0;
+  array1.resize(index1[num_col0]);
+  parallel_for_block(num_row0, nblock, [&](unsigned int ib, size_t ir0, size_t ir1) {
+    unsigned int *ofs = count.data() + ib * num_col0;
+    for (auto ir = static_cast<unsigned int>(ir0); ir < ir1; ++ir) {
+      for (unsigned int i = index0[ir]; i < index0[ir + 1]; ++i) {
+        const unsigned int ic = array0[i];
+        array1[index1[ic] + ofs[ic]] = ir;
+        ofs[ic] += 1;
+      }
+    }
+  });
 }
 
 // -------------------------------------------
@@ -28,22 +28,50 @@ namespace delfem2 {
 // ---------------------------------------------
 // function related to jagged array
 
+/**
+ * @brief sort the values in each row of a jagged array in ascending order
+ * @param num_thread number of threads. "1" sorts each row in place,
+ * otherwise the rows are sorted by transposing twice with counting sorts in parallel.
+ * "0" means the number of hardware threads.
+ */
 DFM2_INLINE void JArray_Sort(
     const std::vector<unsigned int> &index,
-    std::vector<unsigned int> &array);
+    std::vector<unsigned int> &array,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE void JArray_Sort(
     const unsigned int *index,
     unsigned int size,
     unsigned int *array);
 
+/**
+ * @brief add the row index to each row if the row does not have it
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ */
 DFM2_INLINE void JArray_AddDiagonal(
     std::vector<unsigned int> &psup_ind1,
     std::vector<unsigned int> &psup1,
     const unsigned int *psup_ind0,
     size_t npsup_ind0,
     const unsigned int *psup0,
-    size_t npsup0);
+    size_t npsup0,
+    unsigned int num_thread = 1);
+
+/**
+ * @brief transpose of a jagged array (row "i" of the output lists the rows of the input having the value "i")
+ * @details computed by a two-pass counting sort where each thread counts the values in a contiguous range of rows.
+ * The values in each row of the output are sorted in ascending order, and the output is independent of the number of threads.
+ * @param num_col0 the values in the input are less than this number
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ */
+DFM2_INLINE void JArray_Transpose(
+    std::vector<unsigned int> &index1,
+    std::vector<unsigned int> &array1,
+    const unsigned int *index0,
+    size_t num_row0,
+    const unsigned int *array0,
+    size_t num_col0,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE void JArray_Print(
     const std::vector<int> &index,
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef DFM2_LS_ILU_BLOCK_SPARSE_LAZY_H
+#define DFM2_LS_ILU_BLOCK_SPARSE_LAZY_H
+
+#include <vector>
+#include <cmath>
+#include <climits>
+#include <complex>
+
+#include "delfem2/ls_ilu_block_sparse.h"
+#include "delfem2/ls_block_sparse.h"
+
+namespace delfem2 {
+
+/**
+ * @brief ILU preconditioner which keeps using the stale factorization while it works well
+ * @details The matrix is factorized again in "Update" only if
+ *  - the iteration count of the linear solver grows more than "threshold_iteration_ratio" times
+ *    the count just after the last factorization, or the solver did not converge,
+ *  - the relative change of the matrix in Frobenius norm from the factorized one exceeds "threshold_matrix_change",
+ *  - or the factorization has been reused "max_reuse" times.
+ * The iteration count needs to be passed through "ReportLinearSolve" after each solve.
+ * usage:
+ * @code
+ * prec.Update(mat);
+ * conv = Solve_PCG(..., tol, max_nitr, mat, prec);
+ * const bool is_converged = conv.size() == 1 || conv.back() < tol * conv[0];
+ * prec.ReportLinearSolve(is_converged ? conv.size() - 1 : max_nitr, is_converged);
+ * @endcode
+ */
+template<typename T>
+class PreconditionerILU_Lazy {
+ public:
+  struct Statistics {
+    unsigned int num_update = 0;
+    unsigned int num_factorization = 0;
+    //! factorizations triggered by the degradation of the convergence
+    unsigned int num_factorization_by_iteration = 0;
+    //! factorizations triggered by the change of the matrix
+    unsigned int num_factorization_by_change = 0;
+    //! factorizations triggered by "max_reuse"
+    unsigned int num_factorization_by_age = 0;
+    unsigned int num_linear_solve = 0;
+    unsigned long long num_linear_iteration = 0;
+  };
+
+  /**
+   * @brief symbolic factorization
+   */
+  void Initialize(const CMatrixSparse<T> &m, int fill_level = 0) {
+    ilu.Initialize_ILUk(m, fill_level);
+    val_crs_factorized_.clear();
+    val_dia_factorized_.clear();
+    num_itr_factorized_ = UINT_MAX;
+    num_reuse_ = 0;
+    is_degraded_ = false;
+    stat = Statistics();
+  }
+
+  /**
+   * @brief factorize the matrix if the stale factorization should not be used anymore
+   * @return true if the matrix is factorized
+   */
+  bool Update(const CMatrixSparse<T> &m) {
+    stat.num_update++;
+    bool is_factorize = false;
+    if (val_dia_factorized_.empty()) {  // first call
+      is_factorize = true;
+    } else if (is_degraded_) {
+      is_factorize = true;
+      stat.num_factorization_by_iteration++;
+    } else if (num_reuse_ >= max_reuse) {
+      is_factorize = true;
+      stat.num_factorization_by_age++;
+    } else if (this->RelativeChange(m) > threshold_matrix_change) {
+      is_factorize = true;
+      stat.num_factorization_by_change++;
+    }
+    if (!is_factorize) {
+      num_reuse_++;
+      return false;
+    }
+    ilu.CopyValue(m);
+    ilu.Decompose();
+    val_crs_factorized_ = m.val_crs_;
+    val_dia_factorized_ = m.val_dia_;
+    num_itr_factorized_ = UINT_MAX;
+    num_reuse_ = 0;
+    is_degraded_ = false;
+    stat.num_factorization++;
+    return true;
+  }
+
+  /**
+   * @brief tell the result of the linear solver preconditioned with the current factorization
+   * @param num_iteration number of iterations of the linear solver
+   * @param is_converged the solver achieved the tolerance or not
+   */
+  void ReportLinearSolve(unsigned int num_iteration, bool is_converged) {
+    stat.num_linear_solve++;
+    stat.num_linear_iteration += num_iteration;
+    if (num_itr_factorized_ == UINT_MAX) {  // first solve after the factorization is the reference
+      num_itr_factorized_ = num_iteration;
+    }
+    const double itr_ref = (num_itr_factorized_ > 0) ? num_itr_factorized_ : 1;
+    if (!is_converged || num_iteration > threshold_iteration_ratio * itr_ref) {
+      is_degraded_ = true;
+    }
+  }
+
+  void SolvePrecond(T *vec) const { ilu.SolvePrecond(vec); }
+
+  /**
+   * @brief relative difference between the input matrix and the factorized matrix in Frobenius norm
+   */
+  [[nodiscard]] double RelativeChange(const CMatrixSparse<T> &m) const {
+    assert(m.val_crs_.size() == val_crs_factorized_.size());
+    assert(m.val_dia_.size() == val_dia_factorized_.size());
+    double sqnorm_diff = 0.0, sqnorm = 0.0;
+    for (unsigned int i = 0; i < m.val_crs_.size(); ++i) {
+      sqnorm_diff += std::norm(m.val_crs_[i] - val_crs_factorized_[i]);
+      sqnorm += std::norm(val_crs_factorized_[i]);
+    }
+    for (unsigned int i = 0; i < m.val_dia_.size(); ++i) {
+      sqnorm_diff += std::norm(m.val_dia_[i] - val_dia_factorized_[i]);
+      sqnorm += std::norm(val_dia_factorized_[i]);
+    }
+    if (sqnorm < 1.0e-60) { return (sqnorm_diff < 1.0e-60) ? 0.0 : 1.0e+30; }
+    return std::sqrt(sqnorm_diff / sqnorm);
+  }
+
+ public:
+  double threshold_iteration_ratio = 1.5;
+  double threshold_matrix_change = 0.2;
+  unsigned int max_reuse = UINT_MAX;
+  Statistics stat;
+  CPreconditionerILU<T> ilu;
+
+ private:
+  std::vector<T> val_crs_factorized_;
+  std::vector<T> val_dia_factorized_;
+  unsigned int num_itr_factorized_ = UINT_MAX;
+  unsigned int num_reuse_ = 0;
+  bool is_degraded_ = false;
+};
+
+}
+
+#endif // DFM2_LS_ILU_BLOCK_SPARSE_LAZY_H
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file Newton's method for minimizing an energy whose Hessian is a block sparse matrix
+ * @details the sparsity pattern and the symbolic ILU(0) factorization are computed once and reused
+ * across the Newton iterations. The linear systems are solved inexactly with the forcing terms of
+ * Eisenstat & Walker, "Choosing the Forcing Terms in an Inexact Newton Method" (1996), and the step
+ * length is determined by the backtracking line search with the Armijo condition.
+ */
+
+#ifndef DFM2_LS_SOLVER_BLOCK_SPARSE_NEWTON_H_
+#define DFM2_LS_SOLVER_BLOCK_SPARSE_NEWTON_H_
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#include "delfem2/ls_ilu_block_sparse.h"
+#include "delfem2/ls_block_sparse.h"
+#include "delfem2/view_vectorx.h"
+#include "delfem2/lsitrsol.h"
+#include "delfem2/vecxitrsol.h"
+
+namespace delfem2 {
+
+/**
+ * @brief information of a Newton iteration passed to the callback
+ */
+struct NewtonSolverIterationInfo {
+  unsigned int iteration = 0;
+  //! energy at the beginning of the iteration
+  double energy = 0.0;
+  //! norm of the gradient (fixed DoFs are excluded) at the beginning of the iteration
+  double norm_gradient = 0.0;
+  //! relative tolerance of the linear solver
+  double forcing_term = 0.0;
+  unsigned int num_linear_iteration = 0;
+  //! relative residual achieved by the linear solver
+  double linear_residual_ratio = 0.0;
+  //! the search direction is replaced by the negative gradient because it was not a descent direction
+  bool is_gradient_descent = false;
+  //! step length along the search direction. 0 if the line search failed
+  double step_length = 0.0;
+  unsigned int num_line_search = 0;
+  //! energy after the update
+  double energy_new = 0.0;
+  //! wall clock time in seconds for the assembly of the Hessian and the gradient
+  double time_assemble = 0.0;
+  //! wall clock time in seconds for the factorization and the linear solver
+  double time_linear_solve = 0.0;
+  //! wall clock time in seconds for the line search
+  double time_line_search = 0.0;
+};
+
+/**
+ * @brief Newton's method with the block sparse Hessian, ILU(0) preconditioned CG and the line search
+ * @details usage:
+ * @code
+ * NewtonSolver_BlockSparse solver;
+ * solver.Initialize(np, 3, psup_ind, psup);
+ * solver.dof_bcflag = aBCFlag;
+ * solver.Solve(aXYZ, func_energy, func_assemble);
+ * @endcode
+ */
+class NewtonSolver_BlockSparse {
+ public:
+  enum class FORCING_TERM {
+    CONSTANT,  //!< the relative tolerance of the linear solver is always "forcing_term_max"
+    EISENSTAT_WALKER  //!< eta_k = gamma * (|g_k|/|g_{k-1}|)^alpha (choice 2 of Eisenstat & Walker)
+  };
+
+  void Initialize(
+      unsigned int nblk, unsigned int ndim,
+      const std::vector<unsigned int> &psup_ind,
+      const std::vector<unsigned int> &psup) {
+    matrix.Initialize(nblk, ndim, true);
+    matrix.SetPattern(
+        psup_ind.data(), psup_ind.size(),
+        psup.data(), psup.size());
+    dof_bcflag.assign(ndof(), 0);
+    ilu_sparse.Initialize_ILUk(matrix, 0);
+  }
+
+  [[nodiscard]] size_t nblk() const { return matrix.nrowblk_; }
+  [[nodiscard]] size_t ndim() const { return matrix.nrowdim_; }
+  [[nodiscard]] size_t ndof() const { return nblk() * ndim(); }
+
+  /**
+   * @brief minimize the energy starting from "x"
+   * @tparam FUNC_ENERGY callable "double (const double* x)" returning the energy
+   * @tparam FUNC_ASSEMBLE callable "double (CMatrixSparse<double>& hessian, double* gradient, const double* x)"
+   * which adds the hessian and the gradient to the zero-cleared arguments and returns the energy
+   * @param[in,out] x DoFs. The values at the fixed DoFs are kept
+   * @return true if the norm of the gradient becomes smaller than the tolerance
+   */
+  template<class FUNC_ENERGY, class FUNC_ASSEMBLE>
+  bool Solve(
+      std::vector<double> &x,
+      FUNC_ENERGY &&func_energy,
+      FUNC_ASSEMBLE &&func_assemble) {
+    using clock = std::chrono::steady_clock;
+    const size_t n = ndof();
+    assert(x.size() == n);
+    assert(dof_bcflag.size() == n);
+    history.clear();
+    vec_g.resize(n);
+    vec_r.resize(n);
+    vec_d.resize(n);
+    vec_x1.resize(n);
+    tmp0.resize(n);
+    tmp1.resize(n);
+    double norm_g0 = -1.0, norm_g_prev = -1.0, eta_prev = forcing_term_max;
+    for (unsigned int itr = 0; itr < max_iteration; ++itr) {
+      NewtonSolverIterationInfo info;
+      info.iteration = itr;
+      { // assemble
+        const auto t0 = clock::now();
+        matrix.setZero();
+        vec_g.assign(n, 0.0);
+        info.energy = func_assemble(matrix, vec_g.data(), x.data());
+        if (hessian_shift != 0.0) { matrix.AddDia(hessian_shift); }
+        matrix.SetFixedBC(dof_bcflag.data());
+        setRHS_Zero(vec_g, dof_bcflag, 0);
+        info.norm_gradient = std::sqrt(Dot(vec_g, vec_g));
+        info.time_assemble = std::chrono::duration<double>(clock::now() - t0).count();
+      }
+      if (norm_g0 < 0) { norm_g0 = info.norm_gradient; }
+      if (info.norm_gradient <= tolerance_gradient_absolute
+          || info.norm_gradient <= tolerance_gradient_relative * norm_g0) {
+        info.energy_new = info.energy;
+        this->AddHistory(info);
+        return true;
+      }
+      { // forcing term
+        double eta = forcing_term_max;
+        if (forcing_type == FORCING_TERM::EISENSTAT_WALKER && norm_g_prev > 0) {
+          const double r = info.norm_gradient / norm_g_prev;
+          eta = forcing_gamma * std::pow(r, forcing_alpha);
+          const double eta_safe = forcing_gamma * std::pow(eta_prev, forcing_alpha);
+          if (eta_safe > 0.1) { eta = std::max(eta, eta_safe); }  // avoid too rapid decrease
+          eta = std::clamp(eta, forcing_term_min, forcing_term_max);
+        }
+        info.forcing_term = eta;
+        eta_prev = eta;
+        norm_g_prev = info.norm_gradient;
+      }
+      { // solve [H]{d} = -{g}
+        const auto t0 = clock::now();
+        for (unsigned int i = 0; i < n; ++i) { vec_r[i] = -vec_g[i]; }
+        if (use_preconditioner) {
+          ilu_sparse.CopyValue(matrix);
+          ilu_sparse.Decompose();
+          // the history of "Solve_PCG" starts with the initial residual norm
+          const std::vector<double> conv = Solve_PCG(
+              ViewAsVectorXd(vec_r), ViewAsVectorXd(vec_d),
+              ViewAsVectorXd(tmp0), ViewAsVectorXd(tmp1),
+              info.forcing_term, max_linear_iteration, matrix, ilu_sparse);
+          info.num_linear_iteration = std::min(
+              static_cast<unsigned int>(conv.size()) - 1, max_linear_iteration);
+          info.linear_residual_ratio = (conv[0] > 0) ? conv.back() / conv[0] : 0.0;
+        } else {
+          // the history of "Solve_CG" has the ratio of each iteration. It is empty if the residual is zero
+          const std::vector<double> conv = Solve_CG(
+              ViewAsVectorXd(vec_r), ViewAsVectorXd(vec_d),
+              ViewAsVectorXd(tmp0), ViewAsVectorXd(tmp1),
+              info.forcing_term, max_linear_iteration, matrix);
+          info.num_linear_iteration = static_cast<unsigned int>(conv.size());
+          info.linear_residual_ratio = conv.empty() ? 0.0 : conv.back();
+        }
+        info.time_linear_solve = std::chrono::duration<double>(clock::now() - t0).count();
+      }
+      { // line search
+        const auto t0 = clock::now();
+        double slope = Dot(vec_g, vec_d);
+        if (!std::isfinite(slope) || slope >= 0) {  // the hessian is not positive definite
+          for (unsigned int i = 0; i < n; ++i) { vec_d[i] = -vec_g[i]; }
+          slope = -info.norm_gradient * info.norm_gradient;
+          info.is_gradient_descent = true;
+        }
+        double step = 1.0;
+        info.energy_new = info.energy;
+        for (unsigned int ils = 0; ils < max_line_search; ++ils) {
+          info.num_line_search = ils + 1;
+          for (unsigned int i = 0; i < n; ++i) { vec_x1[i] = x[i] + step * vec_d[i]; }
+          const double energy1 = func_energy(vec_x1.data());
+          if (std::isfinite(energy1) && energy1 <= info.energy + armijo_coefficient * step * slope) {
+            info.step_length = step;
+            info.energy_new = energy1;
+            x.swap(vec_x1);
+            break;
+          }
+          step *= line_search_shrink;
+        }
+        info.time_line_search = std::chrono::duration<double>(clock::now() - t0).count();
+      }
+      this->AddHistory(info);
+      if (info.step_length == 0.0) { return false; }  // no descent is possible
+    }
+    return false;
+  }
+
+ private:
+  void AddHistory(const NewtonSolverIterationInfo &info) {
+    history.push_back(info);
+    if (callback) { callback(info); }
+  }
+
+ public:
+  unsigned int max_iteration = 50;
+  //! converged if |g| < tolerance_gradient_absolute
+  double tolerance_gradient_absolute = 1.0e-10;
+  //! converged if |g| < tolerance_gradient_relative * |g_0|
+  double tolerance_gradient_relative = 1.0e-8;
+  FORCING_TERM forcing_type = FORCING_TERM::EISENSTAT_WALKER;
+  double forcing_term_max = 0.5;
+  double forcing_term_min = 1.0e-8;
+  double forcing_gamma = 0.9;
+  double forcing_alpha = 2.0;
+  unsigned int max_linear_iteration = 1000;
+  //! use the ILU(0) preconditioner. The factorization is updated in every iteration
+  bool use_preconditioner = true;
+  //! value added to the diagonal of the hessian (Levenberg-Marquardt-like regularization)
+  double hessian_shift = 0.0;
+  //! coefficient of the sufficient decrease condition of the line search
+  double armijo_coefficient = 1.0e-4;
+  double line_search_shrink = 0.5;
+  unsigned int max_line_search = 30;
+  //! called at the end of each iteration. This can be empty.
+  std::function<void(const NewtonSolverIterationInfo &)> callback;
+
+  std::vector<NewtonSolverIterationInfo> history;
+  std::vector<int> dof_bcflag;
+  CMatrixSparse<double> matrix;
+  CPreconditionerILU<double> ilu_sparse;
+
+ private:
+  std::vector<double> vec_g, vec_r, vec_d, vec_x1;
+  std::vector<double> tmp0, tmp1;
+};
+
+}
+
+#endif //DFM2_LS_SOLVER_BLOCK_SPARSE_NEWTON_H_
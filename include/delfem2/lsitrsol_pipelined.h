@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file pipelined preconditioned conjugate gradient method
+ * @details P. Ghysels and W. Vanroose, "Hiding global synchronization latency in the preconditioned
+ * Conjugate Gradient algorithm" (2014). Three reductions of an iteration are computed together with the
+ * vector updates, so an iteration is the preconditioner, the MatVec and one fused pass over the vectors.
+ */
+
+#ifndef DFM2_LSITRSOL_PIPELINED_H
+#define DFM2_LSITRSOL_PIPELINED_H
+
+#include <vector>
+#include <cmath>
+#include <cassert>
+
+#include "delfem2/vecx_fused.h"
+
+namespace delfem2 {
+
+/**
+ * @brief solve linear system using the pipelined preconditioned conjugate gradient method
+ * @param[in,out] r_vec in: right hand side, out: residual (computed by recurrence)
+ * @param[out] x_vec solution
+ * @param[in] mat a class with member function "MatVec" with {y} = alpha*[A]{x} + beta*{y}
+ * @param[in] prec a class with member function "SolvePrecond" which overwrites the input vector
+ * @param[in] num_thread number of threads for the vector kernels. "0" means the number of hardware threads.
+ * @return history of the norm of residual. The first one is the norm of the right hand side
+ */
+template<class MAT, class PREC>
+std::vector<double> Solve_PCG_Pipelined(
+    std::vector<double> &r_vec,
+    std::vector<double> &x_vec,
+    double conv_ratio_tol,
+    unsigned int max_nitr,
+    const MAT &mat,
+    const PREC &prec,
+    unsigned int num_thread = 1) {
+  const size_t n = r_vec.size();
+  std::vector<double> aResHistry;
+  x_vec.assign(n, 0.0);
+  std::vector<double> u_vec = r_vec, w_vec(n, 0.0), m_vec(n), n_vec(n, 0.0);
+  std::vector<double> z_vec(n, 0.0), q_vec(n, 0.0), s_vec(n, 0.0), p_vec(n, 0.0);
+  prec.SolvePrecond(u_vec.data());  // {u} = [M]{r}
+  mat.MatVec(w_vec.data(), 1.0, u_vec.data(), 0.0);  // {w} = [A]{u}
+  double dot[3];
+  PipelinedCG_Dot(
+      dot, m_vec.data(),
+      r_vec.data(), u_vec.data(), w_vec.data(), n, num_thread);
+  const double sqnorm_res0 = dot[2];
+  aResHistry.push_back(std::sqrt(sqnorm_res0));
+  if (sqnorm_res0 < 1.0e-30) { return aResHistry; }
+  const double inv_sqnorm_res0 = 1.0 / sqnorm_res0;
+  double gamma = dot[0], delta = dot[1];
+  double gamma_old = 1.0, alpha_old = 1.0;
+  for (unsigned int iitr = 0; iitr < max_nitr; iitr++) {
+    prec.SolvePrecond(m_vec.data());  // {m} = [M]{w}
+    mat.MatVec(n_vec.data(), 1.0, m_vec.data(), 0.0);  // {n} = [A]{m}
+    double alpha, beta;
+    if (iitr == 0) {
+      beta = 0.0;
+      alpha = gamma / delta;
+    } else {
+      beta = gamma / gamma_old;
+      alpha = gamma / (delta - beta * gamma / alpha_old);
+    }
+    PipelinedCG_Update(
+        dot,
+        x_vec.data(), r_vec.data(), u_vec.data(), w_vec.data(), m_vec.data(),
+        z_vec.data(), q_vec.data(), s_vec.data(), p_vec.data(), n_vec.data(),
+        alpha, beta, n, num_thread);
+    gamma_old = gamma;
+    alpha_old = alpha;
+    gamma = dot[0];
+    delta = dot[1];
+    aResHistry.push_back(std::sqrt(dot[2]));
+    const double conv_ratio = std::sqrt(dot[2] * inv_sqnorm_res0);
+    if (conv_ratio < conv_ratio_tol) { return aResHistry; }
+  }
+  return aResHistry;
+}
+
+} // namespace delfem2
+
+#endif // DFM2_LSITRSOL_PIPELINED_H
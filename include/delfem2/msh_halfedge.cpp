@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/msh_halfedge.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::msh_halfedge {
+
+//! number of half-edges or vertices processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 14;
+
+template<typename T>
+DFM2_INLINE void UnitNormalAreaTri3(
+    T n[3],
+    T &a,
+    const T v1[3],
+    const T v2[3],
+    const T v3[3]) {
+  n[0] = (v2[1] - v1[1]) * (v3[2] - v1[2]) - (v3[1] - v1[1]) * (v2[2] - v1[2]);
+  n[1] = (v2[2] - v1[2]) * (v3[0] - v1[0]) - (v3[2] - v1[2]) * (v2[0] - v1[0]);
+  n[2] = (v2[0] - v1[0]) * (v3[1] - v1[1]) - (v3[0] - v1[0]) * (v2[1] - v1[1]);
+  a = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) / 2;
+  const T invlen = 1 / (a * 2);
+  n[0] *= invlen;
+  n[1] *= invlen;
+  n[2] *= invlen;
+}
+
+}  // namespace delfem2::msh_halfedge
+
+// ------------------------------------------
+
+DFM2_INLINE void delfem2::HalfEdgeMeshTri::Initialize(
+    const unsigned int *tri_vtx,
+    size_t num_tri,
+    size_t num_vtx,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_halfedge;
+  const size_t nhe = num_tri * 3;
+  tri_vtx_.assign(tri_vtx, tri_vtx + nhe);
+  // half-edges going out from each vertex as a jagged array
+  std::vector<unsigned int> vtx_outhe_ind, vtx_outhe;
+  {
+    std::vector<unsigned int> he_origin(nhe);
+    parallel_for_chunk(nhe, lcl::kNumChunk, [&](size_t ihe0, size_t ihe1) {
+      for (auto ihe = static_cast<unsigned int>(ihe0); ihe < ihe1; ++ihe) {
+        he_origin[ihe] = tri_vtx_[Next(ihe)];
+      }
+    }, num_thread);
+    JArray_ElSuP_MeshElem(
+        vtx_outhe_ind, vtx_outhe,
+        he_origin.data(), nhe, 1, num_vtx, num_thread);
+  }
+  he_twin_.resize(nhe);
+  parallel_for_chunk(nhe, lcl::kNumChunk, [&](size_t ihe0, size_t ihe1) {
+    for (auto ihe = static_cast<unsigned int>(ihe0); ihe < ihe1; ++ihe) {
+      const unsigned int iv0 = Origin(ihe);
+      const unsigned int iv1 = Target(ihe);
+      he_twin_[ihe] = UINT_MAX;
+      for (unsigned int i = vtx_outhe_ind[iv1]; i < vtx_outhe_ind[iv1 + 1]; ++i) {
+        const unsigned int jhe = vtx_outhe[i];
+        if (Target(jhe) == iv0) {
+          he_twin_[ihe] = jhe;
+          break;
+        }
+      }
+    }
+  }, num_thread);
+  vtx_he_.resize(num_vtx);
+  parallel_for_chunk(num_vtx, lcl::kNumChunk, [&](size_t iv0, size_t iv1) {
+    for (size_t iv = iv0; iv < iv1; ++iv) {
+      const unsigned int *begin = vtx_outhe.data() + vtx_outhe_ind[iv];
+      const unsigned int *end = vtx_outhe.data() + vtx_outhe_ind[iv + 1];
+      if (begin == end) {
+        vtx_he_[iv] = UINT_MAX;
+        continue;
+      }
+      const unsigned int *itr = std::find_if(begin, end, [&](unsigned int jhe) { return he_twin_[jhe] == UINT_MAX; });
+      vtx_he_[iv] = (itr != end) ? *itr : *begin;
+    }
+  }, num_thread);
+}
+
+DFM2_INLINE void delfem2::ElSuEl_HalfEdgeMeshTri(
+    std::vector<unsigned int> &tri_adjtri,
+    const HalfEdgeMeshTri &mesh) {
+  const size_t nhe = mesh.NumHalfEdge();
+  tri_adjtri.resize(nhe);
+  for (unsigned int ihe = 0; ihe < nhe; ++ihe) {
+    const unsigned int jhe = mesh.Twin(ihe);
+    tri_adjtri[ihe] = (jhe == UINT_MAX) ? UINT_MAX : HalfEdgeMeshTri::Face(jhe);
+  }
+}
+
+DFM2_INLINE void delfem2::JArray_PSuP_HalfEdgeMeshTri(
+    std::vector<unsigned int> &psup_ind,
+    std::vector<unsigned int> &psup,
+    const HalfEdgeMeshTri &mesh,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_halfedge;
+  const size_t nvtx = mesh.NumVtx();
+  // call func(ivtx) for each point around "ivtx"
+  auto visit_one_ring = [&mesh](unsigned int ivtx, auto &&func) {
+    mesh.ForEachHalfEdgeAroundVtx(ivtx, [&](unsigned int ihe) {
+      func(mesh.Target(ihe));
+      const unsigned int ihe_prev = HalfEdgeMeshTri::Prev(ihe);
+      if (mesh.Twin(ihe_prev) == UINT_MAX) { func(mesh.Origin(ihe_prev)); }
+    });
+  };
+  psup_ind.assign(nvtx + 1, 0);
+  parallel_for_chunk(nvtx, lcl::kNumChunk, [&](size_t iv0, size_t iv1) {
+    for (auto iv = static_cast<unsigned int>(iv0); iv < iv1; ++iv) {
+      visit_one_ring(iv, [&](unsigned int) { psup_ind[iv + 1] += 1; });
+    }
+  }, num_thread);
+  for (unsigned int iv = 0; iv < nvtx; ++iv) {
+    psup_ind[iv + 1] += psup_ind[iv];
+  }
+  psup.resize(psup_ind[nvtx]);
+  parallel_for_chunk(nvtx, lcl::kNumChunk, [&](size_t iv0, size_t iv1) {
+    for (auto iv = static_cast<unsigned int>(iv0); iv < iv1; ++iv) {
+      unsigned int ipsup = psup_ind[iv];
+      visit_one_ring(iv, [&](unsigned int jv) { psup[ipsup++] = jv; });
+      assert(ipsup == psup_ind[iv + 1]);
+    }
+  }, num_thread);
+}
+
+template<typename REAL>
+DFM2_INLINE void delfem2::Normal_HalfEdgeMeshTri3(
+    REAL *vtx_normal,
+    const REAL *vtx_xyz,
+    const HalfEdgeMeshTri &mesh,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_halfedge;
+  const std::vector<unsigned int> &tri_vtx = mesh.TriVtx();
+  parallel_for_chunk(mesh.NumVtx(), lcl::kNumChunk, [&](size_t iv0, size_t iv1) {
+    for (auto iv = static_cast<unsigned int>(iv0); iv < iv1; ++iv) {
+      REAL n[3] = {0, 0, 0};
+      mesh.ForEachHalfEdgeAroundVtx(iv, [&](unsigned int ihe) {
+        const unsigned int itri = HalfEdgeMeshTri::Face(ihe);
+        REAL un[3], area;
+        lcl::UnitNormalAreaTri3(
+            un, area,
+            vtx_xyz + tri_vtx[itri * 3 + 0] * 3,
+            vtx_xyz + tri_vtx[itri * 3 + 1] * 3,
+            vtx_xyz + tri_vtx[itri * 3 + 2] * 3);
+        n[0] += un[0];
+        n[1] += un[1];
+        n[2] += un[2];
+      });
+      const REAL invlen = 1 / std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      vtx_normal[iv * 3 + 0] = n[0] * invlen;
+      vtx_normal[iv * 3 + 1] = n[1] * invlen;
+      vtx_normal[iv * 3 + 2] = n[2] * invlen;
+    }
+  }, num_thread);
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::Normal_HalfEdgeMeshTri3(
+    float *,
+    const float *,
+    const HalfEdgeMeshTri &,
+    unsigned int);
+template void delfem2::Normal_HalfEdgeMeshTri3(
+    double *,
+    const double *,
+    const HalfEdgeMeshTri &,
+    unsigned int);
+#endif
+
+DFM2_INLINE void delfem2::LaplacianSmoothing_HalfEdgeMeshTri3(
+    std::vector<double> &vtx_xyz,
+    const HalfEdgeMeshTri &mesh) {
+  namespace lcl = ::delfem2::msh_halfedge;
+  const std::vector<unsigned int> &tri_vtx = mesh.TriVtx();
+  for (unsigned int iv = 0; iv < mesh.NumVtx(); ++iv) {
+    double sum_area = 0.0;
+    double pcnt[3] = {0, 0, 0};
+    mesh.ForEachHalfEdgeAroundVtx(iv, [&](unsigned int ihe) {
+      const unsigned int itri = HalfEdgeMeshTri::Face(ihe);
+      const double *p0 = vtx_xyz.data() + tri_vtx[itri * 3 + 0] * 3;
+      const double *p1 = vtx_xyz.data() + tri_vtx[itri * 3 + 1] * 3;
+      const double *p2 = vtx_xyz.data() + tri_vtx[itri * 3 + 2] * 3;
+      double un[3], area;
+      lcl::UnitNormalAreaTri3(un, area, p0, p1, p2);
+      sum_area += area;
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        pcnt[idim] += area * (p0[idim] + p1[idim] + p2[idim]) / 3.0;
+      }
+    });
+    if (sum_area == 0.0) { continue; }
+    vtx_xyz[iv * 3 + 0] = pcnt[0] / sum_area;
+    vtx_xyz[iv * 3 + 1] = pcnt[1] / sum_area;
+    vtx_xyz[iv * 3 + 2] = pcnt[2] / sum_area;
+  }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file index-based half-edge structure of a triangle mesh
+ * @details The half-edge "itri*3+i" is the edge of the triangle "itri" opposite to its i-th corner,
+ * which is the same convention as the edge of "ElSuEl_MeshElem" for triangles.
+ * Only the twin of each half-edge and one outgoing half-edge of each vertex are stored,
+ * as the next/previous half-edges and the vertices are computed from the index.
+ * The mesh is assumed to be edge-manifold and consistently oriented.
+ */
+
+#ifndef DFM2_MSH_HALFEDGE_H
+#define DFM2_MSH_HALFEDGE_H
+
+#include <cstddef>
+#include <vector>
+#include <climits>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+class HalfEdgeMeshTri {
+ public:
+  /**
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   * The structure is independent of the number of threads.
+   */
+  void Initialize(
+      const unsigned int *tri_vtx,
+      size_t num_tri,
+      size_t num_vtx,
+      unsigned int num_thread = 0);
+
+  [[nodiscard]] size_t NumTri() const { return tri_vtx_.size() / 3; }
+  [[nodiscard]] size_t NumVtx() const { return vtx_he_.size(); }
+  [[nodiscard]] size_t NumHalfEdge() const { return tri_vtx_.size(); }
+  [[nodiscard]] const std::vector<unsigned int> &TriVtx() const { return tri_vtx_; }
+
+  [[nodiscard]] static unsigned int Next(unsigned int ihe) { return (ihe % 3 == 2) ? ihe - 2 : ihe + 1; }
+  [[nodiscard]] static unsigned int Prev(unsigned int ihe) { return (ihe % 3 == 0) ? ihe + 2 : ihe - 1; }
+  [[nodiscard]] static unsigned int Face(unsigned int ihe) { return ihe / 3; }
+
+  //! half-edge in the opposite direction in the adjacent triangle. UINT_MAX on the boundary
+  [[nodiscard]] unsigned int Twin(unsigned int ihe) const { return he_twin_[ihe]; }
+
+  [[nodiscard]] unsigned int Origin(unsigned int ihe) const { return tri_vtx_[Next(ihe)]; }
+  [[nodiscard]] unsigned int Target(unsigned int ihe) const { return tri_vtx_[Prev(ihe)]; }
+  //! corner of the triangle opposite to the half-edge
+  [[nodiscard]] unsigned int Opposite(unsigned int ihe) const { return tri_vtx_[ihe]; }
+
+  /**
+   * @brief outgoing half-edge of a vertex. UINT_MAX if the vertex is not used by any triangle
+   * @details the half-edge on the boundary is chosen for the boundary vertex
+   */
+  [[nodiscard]] unsigned int OutgoingHalfEdge(unsigned int ivtx) const { return vtx_he_[ivtx]; }
+
+  [[nodiscard]] bool IsBoundaryVtx(unsigned int ivtx) const {
+    return vtx_he_[ivtx] != UINT_MAX && he_twin_[vtx_he_[ivtx]] == UINT_MAX;
+  }
+
+  /**
+   * @brief call func(ihe) for each half-edge going out from a vertex in the counter-clockwise order
+   * @details for a boundary vertex, the last neighbouring vertex is "Origin(Prev(ihe))" of the last half-edge
+   */
+  template<typename FUNC>
+  void ForEachHalfEdgeAroundVtx(
+      unsigned int ivtx,
+      FUNC &&func) const {
+    const unsigned int ihe0 = vtx_he_[ivtx];
+    if (ihe0 == UINT_MAX) { return; }
+    unsigned int ihe = ihe0;
+    do {
+      func(ihe);
+      ihe = he_twin_[Prev(ihe)];
+    } while (ihe != UINT_MAX && ihe != ihe0);
+  }
+
+ private:
+  std::vector<unsigned int> tri_vtx_;
+  std::vector<unsigned int> he_twin_;
+  std::vector<unsigned int> vtx_he_;
+};
+
+/**
+ * @brief adjacent triangles in the layout of "ElSuEl_MeshElem" (UINT_MAX on the boundary)
+ */
+DFM2_INLINE void ElSuEl_HalfEdgeMeshTri(
+    std::vector<unsigned int> &tri_adjtri,
+    const HalfEdgeMeshTri &mesh);
+
+/**
+ * @brief points surrounding point in the counter-clockwise order
+ * @details the jagged array can be passed to the Dijkstra and the exponential map routines
+ */
+DFM2_INLINE void JArray_PSuP_HalfEdgeMeshTri(
+    std::vector<unsigned int> &psup_ind,
+    std::vector<unsigned int> &psup,
+    const HalfEdgeMeshTri &mesh,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief normal at the vertex as the average of the unit normals of the triangles around the vertex
+ * @details same as "Normal_MeshTri3D" but computed for each vertex in parallel. Defined for "float" and "double"
+ */
+template<typename REAL>
+DFM2_INLINE void Normal_HalfEdgeMeshTri3(
+    REAL *vtx_normal,
+    const REAL *vtx_xyz,
+    const HalfEdgeMeshTri &mesh,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief move each vertex to the area-weighted average of the centers of the triangles around it
+ * @details same as "LaplacianSmoothing" in mshmisc.h. The vertices are updated one by one in place.
+ */
+DFM2_INLINE void LaplacianSmoothing_HalfEdgeMeshTri3(
+    std::vector<double> &vtx_xyz,
+    const HalfEdgeMeshTri &mesh);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/msh_halfedge.cpp"
+#endif
+
+#endif // DFM2_MSH_HALFEDGE_H
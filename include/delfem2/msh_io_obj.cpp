@@ -15,8 +15,13 @@
 #include <cassert>
 #include <string>
 #include <cstring>
+#include <climits>
+#include <algorithm>
 
 #include "delfem2/msh_affine_transformation.h"
+#include "delfem2/file_mapped.h"
+#include "delfem2/str.h"
+#include "delfem2/thread.h"
 
 namespace delfem2::msh_ioobj {
 
@@ -58,6 +63,135 @@ DFM2_INLINE void ParseVtxObj_(
   }
 }
 
+//! size of a chunk of the file parsed by a task of the thread pool
+constexpr size_t kNumByteChunk = 1 << 20;
+
+//! marker of the missing index in "ChunkObj"
+constexpr long long kIndexMissing = LLONG_MAX;
+
+/**
+ * vertices and elements in a chunk of the obj file. The indices are zero-based.
+ * The indices listed in "rel_xyz" etc. are relative to the first vertex of the chunk,
+ * since negative indices in the file refer to the vertices defined before.
+ */
+struct ChunkObj {
+  std::vector<double> vtx_xyz, vtx_tex, vtx_nrm;
+  std::vector<unsigned int> elem_nnode;
+  std::vector<long long> elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm;
+  std::vector<size_t> rel_xyz, rel_tex, rel_nrm;
+};
+
+/**
+ * convert the index in the file (one-based or negative) to the zero-based index in the chunk
+ */
+DFM2_INLINE void AddIndexObj(
+    std::vector<long long> &aIndex,
+    std::vector<size_t> &aRel,
+    long long i,
+    size_t nvtx_chunk) {
+  if (i > 0) {
+    aIndex.push_back(i - 1);
+  } else if (i < 0) {
+    aRel.push_back(aIndex.size());
+    aIndex.push_back(static_cast<long long>(nvtx_chunk) + i);
+  } else {
+    aIndex.push_back(kIndexMissing);
+  }
+}
+
+DFM2_INLINE const char *ParseNumbers(
+    std::vector<double> &aVal,
+    unsigned int nval,
+    const char *p,
+    const char *end) {
+  for (unsigned int ival = 0; ival < nval; ++ival) {
+    double v = 0.0;
+    p = ParseNumber_Double(v, p, end);
+    aVal.push_back(v);
+  }
+  return p;
+}
+
+DFM2_INLINE void ParseChunkObj(
+    ChunkObj &chunk,
+    const char *p,
+    const char *end) {
+  const auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+  while (p < end) {
+    const auto *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (eol == nullptr) { eol = end; }
+    while (p < eol && is_space(*p)) { ++p; }
+    if (eol - p >= 2 && p[0] == 'v' && is_space(p[1])) {
+      ParseNumbers(chunk.vtx_xyz, 3, p + 2, eol);
+    } else if (eol - p >= 3 && p[0] == 'v' && p[1] == 't' && is_space(p[2])) {
+      ParseNumbers(chunk.vtx_tex, 2, p + 3, eol);
+    } else if (eol - p >= 3 && p[0] == 'v' && p[1] == 'n' && is_space(p[2])) {
+      ParseNumbers(chunk.vtx_nrm, 3, p + 3, eol);
+    } else if (eol - p >= 2 && p[0] == 'f' && is_space(p[1])) {
+      unsigned int nnode = 0;
+      p += 2;
+      while (true) {
+        long long ixyz = 0, itex = 0, inrm = 0;
+        const char *q = ParseNumber_Int(ixyz, p, eol);
+        if (q == p) { break; }
+        p = q;
+        if (p < eol && *p == '/') {
+          p = ParseNumber_Int(itex, p + 1, eol);
+          if (p < eol && *p == '/') {
+            p = ParseNumber_Int(inrm, p + 1, eol);
+          }
+        }
+        AddIndexObj(chunk.elem_vtx_xyz, chunk.rel_xyz, ixyz, chunk.vtx_xyz.size() / 3);
+        AddIndexObj(chunk.elem_vtx_tex, chunk.rel_tex, itex, chunk.vtx_tex.size() / 2);
+        AddIndexObj(chunk.elem_vtx_nrm, chunk.rel_nrm, inrm, chunk.vtx_nrm.size() / 3);
+        nnode++;
+      }
+      if (nnode > 0) { chunk.elem_nnode.push_back(nnode); }
+    }
+    p = eol + 1;
+  }
+}
+
+DFM2_INLINE void CopyIndexObj(
+    unsigned int *out,
+    const std::vector<long long> &aIndex,
+    const std::vector<size_t> &aRel,
+    size_t offset_vtx) {
+  for (size_t i = 0; i < aIndex.size(); ++i) {
+    out[i] = (aIndex[i] == kIndexMissing) ? UINT_MAX : static_cast<unsigned int>(aIndex[i]);
+  }
+  for (size_t i: aRel) {
+    out[i] = static_cast<unsigned int>(aIndex[i] + static_cast<long long>(offset_vtx));
+  }
+}
+
+/**
+ * read polygon mesh and returns the first "nnode" vertices of the elements which have at least "nnode" vertices
+ */
+DFM2_INLINE bool ReadObj_ElemFirstNodes(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &elem_vtx,
+    unsigned int nnode,
+    const std::filesystem::path &file_path) {
+  std::vector<double> vtx_tex, vtx_nrm;
+  std::vector<unsigned int> elem_vtx_index, elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm;
+  if (!Read_WavefrontObj_Parallel(
+      vtx_xyz, vtx_tex, vtx_nrm,
+      elem_vtx_index, elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm,
+      file_path)) {
+    return false;
+  }
+  elem_vtx.clear();
+  elem_vtx.reserve((elem_vtx_index.size() - 1) * nnode);
+  for (unsigned int ielem = 0; ielem < elem_vtx_index.size() - 1; ++ielem) {
+    if (elem_vtx_index[ielem + 1] - elem_vtx_index[ielem] < nnode) { continue; }
+    for (unsigned int inode = 0; inode < nnode; ++inode) {
+      elem_vtx.push_back(elem_vtx_xyz[elem_vtx_index[ielem] + inode]);
+    }
+  }
+  return true;
+}
+
 }
 
 template <typename REAL, typename INT>
@@ -256,44 +390,8 @@ DFM2_INLINE void delfem2::Read_Obj(
     std::vector<double> &vtx_xyz,
     std::vector<unsigned int> &tri_vtx,
     const std::filesystem::path &file_path) {
-  std::ifstream fin;
-  fin.open(file_path);
-  if (fin.fail()) {
+  if (!msh_ioobj::ReadObj_ElemFirstNodes(vtx_xyz, tri_vtx, 3, file_path)) {
     std::cout << "File Read Fail" << std::endl;
-    return;
-  }
-  vtx_xyz.clear();
-  tri_vtx.clear();
-  vtx_xyz.reserve(256 * 16);
-  tri_vtx.reserve(256 * 16);
-  const int BUFF_SIZE = 256;
-  char buff[BUFF_SIZE];
-  while (fin.getline(buff, BUFF_SIZE)) {
-    if (buff[0] == '#') { continue; }
-    if (buff[0] == 'v' && buff[1] == ' ') {
-      char str[256];
-      double x, y, z;
-      {
-        std::istringstream is(buff);
-        is >> str >> x >> y >> z;
-//        sscanf(buff, "%s %lf %lf %lf", str, &x, &y, &z);
-      }
-      vtx_xyz.push_back(x);
-      vtx_xyz.push_back(y);
-      vtx_xyz.push_back(z);
-    }
-    if (buff[0] == 'f') {
-      char str[256];
-      int i0, i1, i2;
-      {
-        std::istringstream is(buff);
-        is >> str >> i0 >> i1 >> i2;
-//       sscanf(buff, "%s %d %d %d", str, &i0, &i1, &i2);
-      }
-      tri_vtx.push_back(i0 - 1);
-      tri_vtx.push_back(i1 - 1);
-      tri_vtx.push_back(i2 - 1);
-    }
   }
 }
 
@@ -301,41 +399,8 @@ DFM2_INLINE void delfem2::Read_Obj_MeshQuad3(
     std::vector<double> &vtx_xyz,
     std::vector<unsigned int> &quad_vtx,
     const std::filesystem::path &file_path) {
-  std::ifstream fin;
-  fin.open(file_path.c_str());
-  if (fin.fail()) {
+  if (!msh_ioobj::ReadObj_ElemFirstNodes(vtx_xyz, quad_vtx, 4, file_path)) {
     std::cout << "File Read Fail" << std::endl;
-    return;
-  }
-  vtx_xyz.clear();
-  quad_vtx.clear();
-  vtx_xyz.reserve(256 * 16);
-  quad_vtx.reserve(256 * 16);
-  const int BUFF_SIZE = 256;
-  char buff[BUFF_SIZE];
-  while (fin.getline(buff, BUFF_SIZE)) {
-    if (buff[0] == '#') { continue; }
-    if (buff[0] == 'v' && buff[1] == ' ') {
-      char str[256];
-      double x, y, z;
-      std::istringstream is(buff);
-      is >> str >> x >> y >> z;
-//      sscanf(buff, "%s %lf %lf %lf", str, &x, &y, &z);
-      vtx_xyz.push_back(x);
-      vtx_xyz.push_back(y);
-      vtx_xyz.push_back(z);
-    }
-    if (buff[0] == 'f') {
-      char str[256];
-      int i0, i1, i2, i3;
-      std::istringstream is(buff);
-      is >> str >> i0 >> i1 >> i2 >> i3;
-//      sscanf(buff, "%s %d %d %d %d", str, &i0, &i1, &i2, &i3);
-      quad_vtx.push_back(i0 - 1);
-      quad_vtx.push_back(i1 - 1);
-      quad_vtx.push_back(i2 - 1);
-      quad_vtx.push_back(i3 - 1);
-    }
   }
 }
 
@@ -343,50 +408,8 @@ DFM2_INLINE void delfem2::Read_Obj2(
     const std::string &fname,
     std::vector<double> &aXYZ,
     std::vector<unsigned int> &aTri) {
-  std::ifstream fin;
-  fin.open(fname.c_str());
-  if (fin.fail()) {
+  if (!msh_ioobj::ReadObj_ElemFirstNodes(aXYZ, aTri, 3, fname)) {
     std::cout << "File Read Fail" << std::endl;
-    return;
-  }
-  aXYZ.clear();
-  aTri.clear();
-  aXYZ.reserve(256 * 16);
-  aTri.reserve(256 * 16);
-  const int BUFF_SIZE = 256;
-  char buff[BUFF_SIZE];
-  while (fin.getline(buff, BUFF_SIZE)) {
-    if (buff[0] == '#') { continue; }
-    if (buff[0] == 'v' && buff[1] == ' ') {
-      char str[256];
-      double x, y, z;
-      std::istringstream is(buff);
-      is >> str >> x >> y >> z;
-//      sscanf(buff, "%s %lf %lf %lf", str, &x, &y, &z);
-      aXYZ.push_back(x);
-      aXYZ.push_back(y);
-      aXYZ.push_back(z);
-    }
-    if (buff[0] == 'f') {
-      char str[256], str0[256], str1[256], str2[256];
-      {
-        std::istringstream is(buff);
-        is >> str >> str0 >> str1 >> str2;
-//        sscanf(buff, "%s %s %s %s", str, str0, str1, str2);
-      }
-      for (unsigned int i = 0; i < strlen(str0); ++i) { if (str0[i] == '/') { str0[i] = '\0'; }}
-      for (unsigned int i = 0; i < strlen(str1); ++i) { if (str1[i] == '/') { str1[i] = '\0'; }}
-      for (unsigned int i = 0; i < strlen(str2); ++i) { if (str2[i] == '/') { str2[i] = '\0'; }}
-      const int i0 = std::stoi(str0);
-      const int i1 = std::stoi(str1);
-      const int i2 = std::stoi(str2);
-//      sscanf(str0,"%d",&i0);
-//      sscanf(str1,"%d",&i1);
-//      sscanf(str2,"%d",&i2);
-      aTri.push_back(i0 - 1);
-      aTri.push_back(i1 - 1);
-      aTri.push_back(i2 - 1);
-    }
   }
 }
 
@@ -395,70 +418,25 @@ void delfem2::Read_Obj3(
     std::vector<REAL> &vtx_xyz,
     std::vector<unsigned int> &tri_vtx,
     const std::filesystem::path &file_path) {
-  std::ifstream fin;
-  fin.open(file_path);
-  if (fin.fail()) {
+  std::vector<double> aXYZ, vtx_tex, vtx_nrm;
+  std::vector<unsigned int> elem_vtx_index, elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm;
+  if (!Read_WavefrontObj_Parallel(
+      aXYZ, vtx_tex, vtx_nrm,
+      elem_vtx_index, elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm,
+      file_path)) {
     std::cout << "File Read Fail" << std::endl;
     return;
   }
-  vtx_xyz.clear();
+  vtx_xyz.assign(aXYZ.begin(), aXYZ.end());
   tri_vtx.clear();
-  vtx_xyz.reserve(256 * 16);
-  tri_vtx.reserve(256 * 16);
-  const int BUFF_SIZE = 256;
-  char buff[BUFF_SIZE];
-  while (fin.getline(buff, BUFF_SIZE)) {
-    if (buff[0] == '#') { continue; }
-    if (buff[0] == 'v' && buff[1] == ' ') {
-      char str[256];
-      REAL x, y, z;
-      std::istringstream is(buff);
-      is >> str >> x >> y >> z;
-//      sscanf(buff, "%s %lf %lf %lf", str, &x, &y, &z);
-      vtx_xyz.push_back(x);
-      vtx_xyz.push_back(y);
-      vtx_xyz.push_back(z);
+  for (unsigned int ielem = 0; ielem < elem_vtx_index.size() - 1; ++ielem) {
+    const unsigned int *aI = elem_vtx_xyz.data() + elem_vtx_index[ielem];
+    const unsigned int nnode = elem_vtx_index[ielem + 1] - elem_vtx_index[ielem];
+    if (nnode == 3) {
+      tri_vtx.insert(tri_vtx.end(), {aI[0], aI[1], aI[2]});
     }
-    if (buff[0] == 'f') {
-      std::vector<std::string> vec_str;
-      {
-        std::istringstream iss(buff);
-        std::string s;
-        bool is_init = true;
-        while (iss >> s) {
-          if (is_init) {
-            is_init = false;
-            continue;
-          }
-          vec_str.push_back(s);
-        }
-      }
-      std::vector<int> aI;
-      aI.reserve(4);
-      for (auto str : vec_str) {
-        for (size_t i=0;i<str.size();++i) {
-          if (str[i] == '/') {
-            str[i] = '\0';
-            break;
-          }
-        }
-        int i0 = std::stoi(str);
-        aI.push_back(i0-1);
-      }
-      if (aI.size() == 3) {
-        tri_vtx.push_back(aI[0]);
-        tri_vtx.push_back(aI[1]);
-        tri_vtx.push_back(aI[2]);
-      }
-      if (aI.size() == 4) {
-        tri_vtx.push_back(aI[0]);
-        tri_vtx.push_back(aI[1]);
-        tri_vtx.push_back(aI[2]);
-        //
-        tri_vtx.push_back(aI[0]);
-        tri_vtx.push_back(aI[2]);
-        tri_vtx.push_back(aI[3]);
-      }
+    if (nnode == 4) {
+      tri_vtx.insert(tri_vtx.end(), {aI[0], aI[1], aI[2], aI[0], aI[2], aI[3]});
     }
   }
 }
@@ -473,6 +451,84 @@ template void delfem2::Read_Obj3(
     const std::filesystem::path &file_path);
 #endif
 
+DFM2_INLINE bool delfem2::Read_WavefrontObj_Parallel(
+    std::vector<double> &vtx_xyz,
+    std::vector<double> &vtx_tex,
+    std::vector<double> &vtx_nrm,
+    std::vector<unsigned int> &elem_vtx_index,
+    std::vector<unsigned int> &elem_vtx_xyz,
+    std::vector<unsigned int> &elem_vtx_tex,
+    std::vector<unsigned int> &elem_vtx_nrm,
+    const std::filesystem::path &file_path,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_ioobj;
+  MappedFile file;
+  if (!file.Open(file_path)) { return false; }
+  const char *data = file.data();
+  const size_t nbyte = file.size();
+  // split the file at the line breaks
+  std::vector<size_t> chunk_begin(1, 0);
+  for (size_t ibyte = lcl::kNumByteChunk; ibyte < nbyte; ibyte += lcl::kNumByteChunk) {
+    const auto *eol = static_cast<const char *>(std::memchr(data + ibyte, '\n', nbyte - ibyte));
+    if (eol == nullptr) { break; }
+    const size_t ibyte1 = eol - data + 1;
+    if (ibyte1 <= chunk_begin.back()) { continue; }
+    if (ibyte1 >= nbyte) { break; }
+    chunk_begin.push_back(ibyte1);
+    ibyte = ibyte1;
+  }
+  chunk_begin.push_back(nbyte);
+  const size_t nchunk = chunk_begin.size() - 1;
+  std::vector<lcl::ChunkObj> aChunk(nchunk);
+  parallel_for_chunk(
+      nchunk, 1,
+      [&](size_t ichunk, size_t) {
+        lcl::ParseChunkObj(
+            aChunk[ichunk],
+            data + chunk_begin[ichunk],
+            data + chunk_begin[ichunk + 1]);
+      }, num_thread);
+  // prefix sums of the numbers of vertices and elements
+  std::vector<size_t> ofs_xyz(nchunk + 1, 0), ofs_tex(nchunk + 1, 0), ofs_nrm(nchunk + 1, 0);
+  std::vector<size_t> ofs_elem(nchunk + 1, 0), ofs_node(nchunk + 1, 0);
+  for (size_t ichunk = 0; ichunk < nchunk; ++ichunk) {
+    const lcl::ChunkObj &c = aChunk[ichunk];
+    ofs_xyz[ichunk + 1] = ofs_xyz[ichunk] + c.vtx_xyz.size() / 3;
+    ofs_tex[ichunk + 1] = ofs_tex[ichunk] + c.vtx_tex.size() / 2;
+    ofs_nrm[ichunk + 1] = ofs_nrm[ichunk] + c.vtx_nrm.size() / 3;
+    ofs_elem[ichunk + 1] = ofs_elem[ichunk] + c.elem_nnode.size();
+    ofs_node[ichunk + 1] = ofs_node[ichunk] + c.elem_vtx_xyz.size();
+  }
+  vtx_xyz.resize(ofs_xyz[nchunk] * 3);
+  vtx_tex.resize(ofs_tex[nchunk] * 2);
+  vtx_nrm.resize(ofs_nrm[nchunk] * 3);
+  elem_vtx_index.resize(ofs_elem[nchunk] + 1);
+  elem_vtx_index[0] = 0;
+  elem_vtx_xyz.resize(ofs_node[nchunk]);
+  elem_vtx_tex.resize(ofs_node[nchunk]);
+  elem_vtx_nrm.resize(ofs_node[nchunk]);
+  parallel_for_chunk(
+      nchunk, 1,
+      [&](size_t ichunk, size_t) {
+        const lcl::ChunkObj &c = aChunk[ichunk];
+        std::copy(c.vtx_xyz.begin(), c.vtx_xyz.end(), vtx_xyz.begin() + ofs_xyz[ichunk] * 3);
+        std::copy(c.vtx_tex.begin(), c.vtx_tex.end(), vtx_tex.begin() + ofs_tex[ichunk] * 2);
+        std::copy(c.vtx_nrm.begin(), c.vtx_nrm.end(), vtx_nrm.begin() + ofs_nrm[ichunk] * 3);
+        auto inode = static_cast<unsigned int>(ofs_node[ichunk]);
+        for (size_t ielem = 0; ielem < c.elem_nnode.size(); ++ielem) {
+          inode += c.elem_nnode[ielem];
+          elem_vtx_index[ofs_elem[ichunk] + ielem + 1] = inode;
+        }
+        unsigned int *pnode = elem_vtx_xyz.data() + ofs_node[ichunk];
+        lcl::CopyIndexObj(pnode, c.elem_vtx_xyz, c.rel_xyz, ofs_xyz[ichunk]);
+        pnode = elem_vtx_tex.data() + ofs_node[ichunk];
+        lcl::CopyIndexObj(pnode, c.elem_vtx_tex, c.rel_tex, ofs_tex[ichunk]);
+        pnode = elem_vtx_nrm.data() + ofs_node[ichunk];
+        lcl::CopyIndexObj(pnode, c.elem_vtx_nrm, c.rel_nrm, ofs_nrm[ichunk]);
+      }, num_thread);
+  return true;
+}
+
 // ==========================
 
 template<typename T>
@@ -508,11 +564,11 @@ DFM2_INLINE bool delfem2::Read_WavefrontObjWithMaterialMixedElem(
   group_elem_index.clear();
   group_elem_index.push_back(0);
   //
-  const int BUFF_SIZE = 256;
-  char buff[BUFF_SIZE];
   fname_mtl.clear();
   std::string current_material_name;
-  while (fin.getline(buff, BUFF_SIZE)) {
+  std::string line;
+  while (std::getline(fin, line)) {
+    const char *buff = line.c_str();
     if (buff[0] == '#') { continue; }
     if (buff[0] == 'm') {
       std::stringstream ss(buff);
@@ -104,6 +104,35 @@ void Read_Obj3(
     std::vector<unsigned int> &tri_vtx,
     const std::filesystem::path &file_path);
 
+/**
+ * @brief read vertices and polygons of obj file with multiple threads
+ * @details The file is memory-mapped and split into chunks at line breaks. The chunks are parsed in parallel and
+ * merged with the prefix sums of the numbers of vertices and elements. Faces can be written with "v", "v/vt",
+ * "v//vn" or "v/vt/vn" and the indices can be negative (relative to the end of the vertex list).
+ * The missing indices of texture or normal are UINT_MAX. Lines of any length are accepted and
+ * lines other than "v", "vt", "vn" and "f" are ignored. The normals are not normalized.
+ * @param[out] vtx_xyz vertex coordinates (x,y,z)
+ * @param[out] vtx_tex texture coordinates (u,v)
+ * @param[out] vtx_nrm normals (x,y,z)
+ * @param[out] elem_vtx_index jagged array index for elem-vtx array
+ * @param[out] elem_vtx_xyz
+ * @param[out] elem_vtx_tex
+ * @param[out] elem_vtx_nrm
+ * @param[in] file_path input file path
+ * @param[in] num_thread number of threads. "0" means the number of hardware threads. "1" runs serially.
+ * @return return false if failed to open the file
+ */
+DFM2_INLINE bool Read_WavefrontObj_Parallel(
+    std::vector<double> &vtx_xyz,
+    std::vector<double> &vtx_tex,
+    std::vector<double> &vtx_nrm,
+    std::vector<unsigned int> &elem_vtx_index,
+    std::vector<unsigned int> &elem_vtx_xyz,
+    std::vector<unsigned int> &elem_vtx_tex,
+    std::vector<unsigned int> &elem_vtx_nrm,
+    const std::filesystem::path &file_path,
+    unsigned int num_thread = 0);
+
 // --------------------------
 // below: obj with surface attributes
 
@@ -12,6 +12,239 @@
 #include <sstream>
 #include <vector>
 #include <cstring>
+#include <cstdint>
+#include <climits>
+#include <cassert>
+#include <type_traits>
+
+#include "delfem2/str.h"
+
+namespace delfem2::msh_io_ply {
+
+DFM2_INLINE unsigned int SizeOfType(PLY_TYPE type) {
+  switch (type) {
+    case PLY_TYPE::INT8:
+    case PLY_TYPE::UINT8: return 1;
+    case PLY_TYPE::INT16:
+    case PLY_TYPE::UINT16: return 2;
+    case PLY_TYPE::INT32:
+    case PLY_TYPE::UINT32:
+    case PLY_TYPE::FLOAT32: return 4;
+    case PLY_TYPE::FLOAT64: return 8;
+  }
+  return 0;
+}
+
+DFM2_INLINE bool TypeFromString(PLY_TYPE &type, const std::string &str) {
+  if (str == "char" || str == "int8") { type = PLY_TYPE::INT8; }
+  else if (str == "uchar" || str == "uint8") { type = PLY_TYPE::UINT8; }
+  else if (str == "short" || str == "int16") { type = PLY_TYPE::INT16; }
+  else if (str == "ushort" || str == "uint16") { type = PLY_TYPE::UINT16; }
+  else if (str == "int" || str == "int32") { type = PLY_TYPE::INT32; }
+  else if (str == "uint" || str == "uint32") { type = PLY_TYPE::UINT32; }
+  else if (str == "float" || str == "float32") { type = PLY_TYPE::FLOAT32; }
+  else if (str == "double" || str == "float64") { type = PLY_TYPE::FLOAT64; }
+  else { return false; }
+  return true;
+}
+
+DFM2_INLINE const char *StringFromType(PLY_TYPE type) {
+  switch (type) {
+    case PLY_TYPE::INT8: return "char";
+    case PLY_TYPE::UINT8: return "uchar";
+    case PLY_TYPE::INT16: return "short";
+    case PLY_TYPE::UINT16: return "ushort";
+    case PLY_TYPE::INT32: return "int";
+    case PLY_TYPE::UINT32: return "uint";
+    case PLY_TYPE::FLOAT32: return "float";
+    case PLY_TYPE::FLOAT64: return "double";
+  }
+  return "";
+}
+
+DFM2_INLINE bool IsLittleEndianMachine() {
+  const std::uint16_t v = 1;
+  unsigned char c;
+  std::memcpy(&c, &v, 1);
+  return c == 1;
+}
+
+template<typename T>
+T LoadValue(const char *p, bool is_swap) {
+  T v;
+  if (!is_swap) {
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+  }
+  char buff[sizeof(T)];
+  for (unsigned int i = 0; i < sizeof(T); ++i) { buff[i] = p[sizeof(T) - 1 - i]; }
+  std::memcpy(&v, buff, sizeof(T));
+  return v;
+}
+
+/**
+ * value of a binary number in the file
+ */
+DFM2_INLINE double LoadBinary(const char *p, PLY_TYPE type, bool is_swap) {
+  switch (type) {
+    case PLY_TYPE::INT8: return LoadValue<std::int8_t>(p, false);
+    case PLY_TYPE::UINT8: return LoadValue<std::uint8_t>(p, false);
+    case PLY_TYPE::INT16: return LoadValue<std::int16_t>(p, is_swap);
+    case PLY_TYPE::UINT16: return LoadValue<std::uint16_t>(p, is_swap);
+    case PLY_TYPE::INT32: return LoadValue<std::int32_t>(p, is_swap);
+    case PLY_TYPE::UINT32: return LoadValue<std::uint32_t>(p, is_swap);
+    case PLY_TYPE::FLOAT32: return LoadValue<float>(p, is_swap);
+    case PLY_TYPE::FLOAT64: return LoadValue<double>(p, is_swap);
+  }
+  return 0.0;
+}
+
+template<typename T>
+void StoreValue(char *p, T v, bool is_swap) {
+  std::memcpy(p, &v, sizeof(T));
+  if (!is_swap) { return; }
+  for (unsigned int i = 0; i < sizeof(T) / 2; ++i) { std::swap(p[i], p[sizeof(T) - 1 - i]); }
+}
+
+DFM2_INLINE void StoreBinary(char *p, PLY_TYPE type, double v, bool is_swap) {
+  switch (type) {
+    case PLY_TYPE::INT8: StoreValue(p, static_cast<std::int8_t>(v), false); return;
+    case PLY_TYPE::UINT8: StoreValue(p, static_cast<std::uint8_t>(v), false); return;
+    case PLY_TYPE::INT16: StoreValue(p, static_cast<std::int16_t>(v), is_swap); return;
+    case PLY_TYPE::UINT16: StoreValue(p, static_cast<std::uint16_t>(v), is_swap); return;
+    case PLY_TYPE::INT32: StoreValue(p, static_cast<std::int32_t>(v), is_swap); return;
+    case PLY_TYPE::UINT32: StoreValue(p, static_cast<std::uint32_t>(v), is_swap); return;
+    case PLY_TYPE::FLOAT32: StoreValue(p, static_cast<float>(v), is_swap); return;
+    case PLY_TYPE::FLOAT64: StoreValue(p, v, is_swap); return;
+  }
+}
+
+DFM2_INLINE bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * parse a number in ascii format. Line breaks are treated as spaces.
+ * @return nullptr if there is no token left
+ */
+DFM2_INLINE const char *ParseAscii(double &v, const char *p, const char *end) {
+  while (p < end && IsSpace(*p)) { ++p; }
+  if (p == end) { return nullptr; }
+  const char *q = ParseNumber_Double(v, p, end);
+  if (q == p) {  // not a number. skip the token
+    v = 0.0;
+    while (q < end && !IsSpace(*q)) { ++q; }
+  }
+  return q;
+}
+
+/**
+ * visit the rows of an element in binary format.
+ * "func(irow, iprop, nval, pval)" is called for each property where "pval" points the first value
+ * and "nval" is the number of the values (1 for a scalar property).
+ * @return pointer to the end of the element. nullptr if the element does not fit in [p, end)
+ */
+template<typename FUNC>
+const char *VisitElementBinary(
+    const char *p,
+    const char *end,
+    const PlyElement &elem,
+    bool is_swap,
+    FUNC &&func) {
+  for (size_t irow = 0; irow < elem.count; ++irow) {
+    for (unsigned int iprop = 0; iprop < elem.properties.size(); ++iprop) {
+      const PlyProperty &prop = elem.properties[iprop];
+      const size_t nbyte = SizeOfType(prop.type);
+      if (!prop.is_list) {
+        if (nbyte > static_cast<size_t>(end - p)) { return nullptr; }
+        func(irow, iprop, 1, p);
+        p += nbyte;
+        continue;
+      }
+      const size_t nbyte_count = SizeOfType(prop.type_count);
+      if (nbyte_count > static_cast<size_t>(end - p)) { return nullptr; }
+      const double count = LoadBinary(p, prop.type_count, is_swap);
+      p += nbyte_count;
+      if (!(count >= 0.0) || count > static_cast<double>(end - p) / nbyte) { return nullptr; }
+      const auto nval = static_cast<unsigned int>(count);
+      func(irow, iprop, nval, p);
+      p += nval * nbyte;
+    }
+  }
+  return p;
+}
+
+/**
+ * parse all the numbers of an element in ascii format including the sizes of the lists
+ * @return pointer to the end of the element. nullptr if the text ends before the element or a list size is broken
+ */
+DFM2_INLINE const char *ParseElementAscii(
+    std::vector<double> &aVal,
+    const char *p,
+    const char *end,
+    const PlyElement &elem) {
+  aVal.clear();
+  for (size_t irow = 0; irow < elem.count; ++irow) {
+    for (const auto &prop: elem.properties) {
+      size_t nval = 1;
+      if (prop.is_list) {
+        double v;
+        p = ParseAscii(v, p, end);
+        if (p == nullptr || !(v >= 0.0) || v > static_cast<double>(end - p)) { return nullptr; }
+        nval = static_cast<size_t>(v);
+        aVal.push_back(v);
+      }
+      for (size_t ival = 0; ival < nval; ++ival) {
+        double v;
+        p = ParseAscii(v, p, end);
+        if (p == nullptr) { return nullptr; }
+        aVal.push_back(v);
+      }
+    }
+  }
+  return p;
+}
+
+/**
+ * visit the rows of an element parsed by "ParseElementAscii".
+ * "func(irow, iprop, nval, aVal)" is called for each property with the parsed values.
+ */
+template<typename FUNC>
+void VisitElementAscii(
+    const double *v,
+    const PlyElement &elem,
+    FUNC &&func) {
+  for (size_t irow = 0; irow < elem.count; ++irow) {
+    for (unsigned int iprop = 0; iprop < elem.properties.size(); ++iprop) {
+      unsigned int nval = 1;
+      if (elem.properties[iprop].is_list) {
+        nval = static_cast<unsigned int>(*v);
+        ++v;
+      }
+      func(irow, iprop, nval, v);
+      v += nval;
+    }
+  }
+}
+
+/**
+ * value of the source array of the writer
+ */
+DFM2_INLINE double LoadSource(const void *val, PLY_TYPE type, size_t i) {
+  switch (type) {
+    case PLY_TYPE::INT8: return static_cast<const std::int8_t *>(val)[i];
+    case PLY_TYPE::UINT8: return static_cast<const std::uint8_t *>(val)[i];
+    case PLY_TYPE::INT16: return static_cast<const std::int16_t *>(val)[i];
+    case PLY_TYPE::UINT16: return static_cast<const std::uint16_t *>(val)[i];
+    case PLY_TYPE::INT32: return static_cast<const std::int32_t *>(val)[i];
+    case PLY_TYPE::UINT32: return static_cast<const std::uint32_t *>(val)[i];
+    case PLY_TYPE::FLOAT32: return static_cast<const float *>(val)[i];
+    case PLY_TYPE::FLOAT64: return static_cast<const double *>(val)[i];
+  }
+  return 0.0;
+}
+
+}  // namespace delfem2::msh_io_ply
 
 // ----------------------------------------------------
 
@@ -19,62 +252,26 @@ DFM2_INLINE void delfem2::Read_Ply(
     std::vector<double> &aXYZ,
     std::vector<unsigned int> &aTri,
     const std::filesystem::path &file_path) {
-  std::ifstream fin;
-  fin.open(file_path.c_str());
-  if (fin.fail()) {
+  ReaderPly ply;
+  if (!ply.Open(file_path)) {
     std::cout << "Fail Read Fail" << std::endl;
     return;
   }
-  const unsigned int nbuff = 256;
-  char buff[nbuff], buff1[nbuff], buff2[nbuff];
-  std::string str1, str2;
-  fin.getline(buff, nbuff);  // ply
-  fin.getline(buff, nbuff);  // format asi 1.0
-  for (;;) {
-    fin.getline(buff, nbuff);
-    if (strncmp(buff, "comment ", 8) != 0) { break; }
+  ply.ReadProperties(aXYZ, "vertex", {"x", "y", "z"});
+  std::vector<unsigned int> elem_vtx_index, elem_vtx;
+  if (!ply.ReadPropertyList(elem_vtx_index, elem_vtx, "face", "vertex_indices")) {
+    ply.ReadPropertyList(elem_vtx_index, elem_vtx, "face", "vertex_index");
   }
-  // ----
-  int nno;
-  {
-    std::istringstream is(buff);
-    is >> buff1 >> buff2 >> nno;
-//    sscanf(buff, "%s %s %d", buff1, buff2, &nno);
+  aTri.clear();
+  if (elem_vtx_index.empty()) { return; }
+  aTri.reserve((elem_vtx_index.size() - 1) * 3);
+  for (unsigned int ielem = 0; ielem < elem_vtx_index.size() - 1; ++ielem) {
+    const unsigned int *aI = elem_vtx.data() + elem_vtx_index[ielem];
+    const unsigned int nnode = elem_vtx_index[ielem + 1] - elem_vtx_index[ielem];
+    for (unsigned int inode = 1; inode + 1 < nnode; ++inode) {
+      aTri.insert(aTri.end(), {aI[0], aI[inode], aI[inode + 1]});
+    }
   }
-  // ----
-  for (;;) {
-    fin.getline(buff, nbuff);
-    if (strncmp(buff, "property ", 9) != 0) { break; }
-  }
-  int ntri;
-  {
-    std::istringstream is(buff);
-    is >> buff1 >> buff2 >> ntri;
-//    sscanf(buff, "%s %s %d", buff1, buff2, &ntri);
-  }
-  aTri.resize(ntri * 3);
-  // ----
-  fin.getline(buff, nbuff);  // property list int int vertex_indices
-  fin.getline(buff, nbuff);  // end header
-  // ----
-  aXYZ.resize(nno * 3);
-  for (int ino = 0; ino < nno; ++ino) {
-    double x, y, z;
-    fin >> x >> y >> z;
-    //    std::cout << ino << " " << x << " " << y << " " << z << std::endl;
-    aXYZ[ino * 3 + 0] = x;
-    aXYZ[ino * 3 + 1] = y;
-    aXYZ[ino * 3 + 2] = z;
-  }
-  for (int itri = 0; itri < ntri; ++itri) {
-    int itmp, i1, i2, i3;
-    fin >> itmp >> i1 >> i2 >> i3;
-    aTri[itri * 3 + 0] = i1;
-    aTri[itri * 3 + 1] = i2;
-    aTri[itri * 3 + 2] = i3;
-    //    std::cout << itri << " " << itmp << " " << i1 << " " << i2 << " " << i3 << std::endl;
-  }
-  //  if( is_norm_ ){ this->MakeNormal(); }
 }
 
 void delfem2::Write_Ply(
@@ -146,63 +343,395 @@ DFM2_INLINE void delfem2::Read_Ply(
     int &ntri_,
     unsigned int *&aTri_) {
   std::cout << "File load " << fname << std::endl;
-  std::ifstream fin;
-  fin.open(fname.c_str());
-  if (fin.fail()) {
-    std::cout << "Fail Read Fail" << std::endl;
-    return;
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTri;
+  Read_Ply(aXYZ, aTri, fname);
+  nnode_ = static_cast<int>(aXYZ.size() / 3);
+  ntri_ = static_cast<int>(aTri.size() / 3);
+  std::cout << "Nnode " << nnode_ << std::endl;
+  std::cout << "NTri " << ntri_ << std::endl;
+  pXYZs_ = new double[aXYZ.size()];
+  std::copy(aXYZ.begin(), aXYZ.end(), pXYZs_);
+  aTri_ = new unsigned int[aTri.size()];
+  std::copy(aTri.begin(), aTri.end(), aTri_);
+}
+
+// ----------------------------------------------------
+// below: ReaderPly
+
+DFM2_INLINE bool delfem2::ReaderPly::Open(
+    const std::filesystem::path &file_path) {
+  namespace lcl = ::delfem2::msh_io_ply;
+  elements_.clear();
+  elem_ofs_.clear();
+  elem_ascii_.clear();
+  comments.clear();
+  if (!file_.Open(file_path)) { return false; }
+  const char *data = file_.data();
+  const char *end = data + file_.size();
+  const char *p = data;
+  bool is_format_found = false;
+  for (unsigned int iline = 0;; ++iline) {  // parse header
+    const auto *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (eol == nullptr) { return false; }
+    std::string line(p, eol);
+    p = eol + 1;
+    if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+    std::istringstream iss(line);
+    std::string keyword;
+    iss >> keyword;
+    if (iline == 0) {
+      if (keyword != "ply") { return false; }
+      continue;
+    }
+    if (keyword == "end_header") { break; }
+    if (keyword == "format") {
+      std::string str_format;
+      iss >> str_format;
+      if (str_format == "ascii") { format_ = PLY_FORMAT::ASCII; }
+      else if (str_format == "binary_little_endian") { format_ = PLY_FORMAT::BINARY_LITTLE_ENDIAN; }
+      else if (str_format == "binary_big_endian") { format_ = PLY_FORMAT::BINARY_BIG_ENDIAN; }
+      else { return false; }
+      is_format_found = true;
+    } else if (keyword == "comment" || keyword == "obj_info") {
+      comments.push_back(line.size() > keyword.size() + 1 ? line.substr(keyword.size() + 1) : "");
+    } else if (keyword == "element") {
+      PlyElement elem;
+      if (!(iss >> elem.name >> elem.count)) { return false; }
+      elements_.push_back(elem);
+    } else if (keyword == "property") {
+      if (elements_.empty()) { return false; }
+      PlyProperty prop;
+      std::string str_type;
+      iss >> str_type;
+      if (str_type == "list") {
+        std::string str_type_count;
+        iss >> str_type_count >> str_type;
+        if (!lcl::TypeFromString(prop.type_count, str_type_count)) { return false; }
+        prop.is_list = true;
+      }
+      if (!lcl::TypeFromString(prop.type, str_type)) { return false; }
+      if (!(iss >> prop.name)) { return false; }
+      elements_.back().properties.push_back(prop);
+    }
   }
-  const unsigned int nbuff = 256;
-  char buff[nbuff];
-  //  char buff1[nbuff], buff2[nbuff];
-  std::string sbuff1, sbuff2;
-  std::string str1, str2;
-  fin.getline(buff, nbuff);  // ply
-  fin.getline(buff, nbuff);  // format asi 1.0
-  for (;;) {
-    fin.getline(buff, nbuff);
-    if (strncmp(buff, "comment ", 8) != 0) { break; }
-  }
-  /////
-  { // read number of points
-    //    sscanf(buff, "%s %s %d", buff1, buff2, &nnode_);
-    std::stringstream ss(buff);
-    ss >> sbuff1 >> sbuff2 >> nnode_;
-    std::cout << "Nnode " << nnode_ << std::endl;
-  }
-  ////
-  for (;;) {
-    fin.getline(buff, nbuff);
-    if (strncmp(buff, "property ", 9) != 0) { break; }
-  }
-  { // read number of triangles
-    //    sscanf(buff, "%s %s %d", buff1, buff2, &ntri_);
-    std::stringstream ss(buff);
-    ss >> sbuff1 >> sbuff2 >> ntri_;
-    std::cout << "NTri " << ntri_ << std::endl;
-  }
-  /////
-  fin.getline(buff, nbuff);  // property list int int vertex_indices
-  fin.getline(buff, nbuff);  // end header
-  ////
-  pXYZs_ = new double[nnode_ * 3];
-  for (int ino = 0; ino < (int) nnode_; ++ino) {
-    double x, y, z;
-    fin >> x >> y >> z;
-    //    std::cout << ino << " " << x << " " << y << " " << z << std::endl;
-    pXYZs_[ino * 3 + 0] = x;
-    pXYZs_[ino * 3 + 1] = y;
-    pXYZs_[ino * 3 + 2] = z;
-  }
-  aTri_ = new unsigned int[ntri_ * 3];
-  for (int itri = 0; itri < (int) ntri_; ++itri) {
-    int itmp, i1, i2, i3;
-    fin >> itmp >> i1 >> i2 >> i3;
-    aTri_[itri * 3 + 0] = i1;
-    aTri_[itri * 3 + 1] = i2;
-    aTri_[itri * 3 + 2] = i3;
-    //    std::cout << itri << " " << itmp << " " << i1 << " " << i2 << " " << i3 << std::endl;
-  }
-  //  if( is_norm_ ){ this->MakeNormal(); }
+  if (!is_format_found) { return false; }
+  // locate the data of the elements
+  const bool is_swap = (format_ == PLY_FORMAT::BINARY_LITTLE_ENDIAN) != lcl::IsLittleEndianMachine();
+  for (const auto &elem: elements_) {
+    elem_ofs_.push_back(p - data);
+    if (format_ == PLY_FORMAT::ASCII) {  // the text is parsed only here and the values are kept
+      elem_ascii_.emplace_back();
+      p = lcl::ParseElementAscii(elem_ascii_.back(), p, end, elem);
+      if (p == nullptr) { return false; }
+      continue;
+    }
+    bool is_fixed_stride = true;
+    size_t stride = 0;
+    for (const auto &prop: elem.properties) {
+      is_fixed_stride = is_fixed_stride && !prop.is_list;
+      stride += lcl::SizeOfType(prop.type);
+    }
+    if (is_fixed_stride) {
+      if (stride != 0 && elem.count > static_cast<size_t>(end - p) / stride) { return false; }
+      p += elem.count * stride;
+    } else {
+      p = lcl::VisitElementBinary(
+          p, end, elem, is_swap,
+          [](size_t, unsigned int, unsigned int, const char *) {});
+      if (p == nullptr) { return false; }
+    }
+  }
+  return true;
+}
+
+DFM2_INLINE const delfem2::PlyElement *delfem2::ReaderPly::FindElement(
+    const std::string &name_element) const {
+  for (const auto &elem: elements_) {
+    if (elem.name == name_element) { return &elem; }
+  }
+  return nullptr;
+}
+
+DFM2_INLINE bool delfem2::ReaderPly::HasProperty(
+    const std::string &name_element,
+    const std::string &name_property) const {
+  const PlyElement *elem = this->FindElement(name_element);
+  if (elem == nullptr) { return false; }
+  for (const auto &prop: elem->properties) {
+    if (prop.name == name_property) { return true; }
+  }
+  return false;
 }
 
+template<typename T>
+bool delfem2::ReaderPly::ReadProperties(
+    std::vector<T> &aVal,
+    const std::string &name_element,
+    const std::vector<std::string> &aNameProperty) const {
+  namespace lcl = ::delfem2::msh_io_ply;
+  const PlyElement *elem = this->FindElement(name_element);
+  if (elem == nullptr) { return false; }
+  const size_t nval = aNameProperty.size();
+  // column of the output array for each property. UINT_MAX if not requested
+  std::vector<unsigned int> prop2col(elem->properties.size(), UINT_MAX);
+  for (unsigned int ival = 0; ival < nval; ++ival) {
+    bool is_found = false;
+    for (unsigned int iprop = 0; iprop < elem->properties.size(); ++iprop) {
+      if (elem->properties[iprop].name != aNameProperty[ival]) { continue; }
+      if (elem->properties[iprop].is_list) { return false; }
+      prop2col[iprop] = ival;
+      is_found = true;
+    }
+    if (!is_found) { return false; }
+  }
+  aVal.resize(elem->count * nval);
+  const size_t ielem = elem - elements_.data();
+  const char *data = file_.data() + elem_ofs_[ielem];
+  const char *end = file_.data() + file_.size();
+  if (format_ == PLY_FORMAT::ASCII) {
+    lcl::VisitElementAscii(
+        elem_ascii_[ielem].data(), *elem,
+        [&aVal, &prop2col, nval](size_t irow, unsigned int iprop, unsigned int, const double *v) {
+          if (prop2col[iprop] == UINT_MAX) { return; }
+          aVal[irow * nval + prop2col[iprop]] = static_cast<T>(v[0]);
+        });
+    return true;
+  }
+  const bool is_swap = (format_ == PLY_FORMAT::BINARY_LITTLE_ENDIAN) != lcl::IsLittleEndianMachine();
+  bool is_fixed_stride = true;
+  size_t stride = 0;
+  std::vector<size_t> prop_ofs;  // byte offset of each property in a row
+  for (const auto &prop: elem->properties) {
+    prop_ofs.push_back(stride);
+    is_fixed_stride = is_fixed_stride && !prop.is_list;
+    stride += lcl::SizeOfType(prop.type);
+  }
+  if (!is_fixed_stride) {
+    const char *p_end = lcl::VisitElementBinary(
+        data, end, *elem, is_swap,
+        [&](size_t irow, unsigned int iprop, unsigned int, const char *p) {
+          if (prop2col[iprop] == UINT_MAX) { return; }
+          aVal[irow * nval + prop2col[iprop]] =
+              static_cast<T>(lcl::LoadBinary(p, elem->properties[iprop].type, is_swap));
+        });
+    return p_end != nullptr;
+  }
+  if (stride != 0 && elem->count > static_cast<size_t>(end - data) / stride) { return false; }
+  // fixed stride: the values are loaded directly from the rows
+  for (unsigned int iprop = 0; iprop < elem->properties.size(); ++iprop) {
+    const unsigned int icol = prop2col[iprop];
+    if (icol == UINT_MAX) { continue; }
+    const PLY_TYPE type = elem->properties[iprop].type;
+    const char *p = data + prop_ofs[iprop];
+    T *q = aVal.data() + icol;
+    const bool is_same_type =
+        (type == PLY_TYPE::FLOAT32 && std::is_same_v<T, float>)
+            || (type == PLY_TYPE::FLOAT64 && std::is_same_v<T, double>);
+    if (is_same_type && !is_swap) {
+      for (size_t irow = 0; irow < elem->count; ++irow) {
+        std::memcpy(q + irow * nval, p + irow * stride, sizeof(T));
+      }
+    } else {
+      for (size_t irow = 0; irow < elem->count; ++irow) {
+        q[irow * nval] = static_cast<T>(lcl::LoadBinary(p + irow * stride, type, is_swap));
+      }
+    }
+  }
+  return true;
+}
+#ifdef DFM2_STATIC_LIBRARY
+template bool delfem2::ReaderPly::ReadProperties(
+    std::vector<double> &, const std::string &, const std::vector<std::string> &) const;
+template bool delfem2::ReaderPly::ReadProperties(
+    std::vector<float> &, const std::string &, const std::vector<std::string> &) const;
+template bool delfem2::ReaderPly::ReadProperties(
+    std::vector<int> &, const std::string &, const std::vector<std::string> &) const;
+template bool delfem2::ReaderPly::ReadProperties(
+    std::vector<unsigned int> &, const std::string &, const std::vector<std::string> &) const;
+template bool delfem2::ReaderPly::ReadProperties(
+    std::vector<unsigned char> &, const std::string &, const std::vector<std::string> &) const;
+#endif
+
+DFM2_INLINE bool delfem2::ReaderPly::ReadPropertyList(
+    std::vector<unsigned int> &index,
+    std::vector<unsigned int> &value,
+    const std::string &name_element,
+    const std::string &name_property) const {
+  namespace lcl = ::delfem2::msh_io_ply;
+  const PlyElement *elem = this->FindElement(name_element);
+  if (elem == nullptr) { return false; }
+  unsigned int iprop_list = UINT_MAX;
+  for (unsigned int iprop = 0; iprop < elem->properties.size(); ++iprop) {
+    if (elem->properties[iprop].name != name_property) { continue; }
+    if (!elem->properties[iprop].is_list) { return false; }
+    iprop_list = iprop;
+  }
+  if (iprop_list == UINT_MAX) { return false; }
+  index.assign(1, 0);
+  index.reserve(elem->count + 1);
+  value.clear();
+  const size_t ielem = elem - elements_.data();
+  if (format_ == PLY_FORMAT::ASCII) {
+    lcl::VisitElementAscii(
+        elem_ascii_[ielem].data(), *elem,
+        [&](size_t, unsigned int iprop, unsigned int nval, const double *v) {
+          if (iprop != iprop_list) { return; }
+          for (unsigned int ival = 0; ival < nval; ++ival) { value.push_back(static_cast<unsigned int>(v[ival])); }
+          index.push_back(static_cast<unsigned int>(value.size()));
+        });
+    return true;
+  }
+  const bool is_swap = (format_ == PLY_FORMAT::BINARY_LITTLE_ENDIAN) != lcl::IsLittleEndianMachine();
+  const PLY_TYPE type = elem->properties[iprop_list].type;
+  const unsigned int nbyte = lcl::SizeOfType(type);
+  const char *p_end = lcl::VisitElementBinary(
+      file_.data() + elem_ofs_[ielem], file_.data() + file_.size(), *elem, is_swap,
+      [&](size_t, unsigned int iprop, unsigned int nval, const char *p) {
+        if (iprop != iprop_list) { return; }
+        for (unsigned int ival = 0; ival < nval; ++ival) {
+          value.push_back(static_cast<unsigned int>(lcl::LoadBinary(p + ival * nbyte, type, is_swap)));
+        }
+        index.push_back(static_cast<unsigned int>(value.size()));
+      });
+  return p_end != nullptr;
+}
+
+// ----------------------------------------------------
+// below: WriterPly
+
+DFM2_INLINE void delfem2::WriterPly::AddElement(
+    const std::string &name,
+    size_t count) {
+  ElementSource elem;
+  elem.name = name;
+  elem.count = count;
+  elements_.push_back(elem);
+}
+
+DFM2_INLINE void delfem2::WriterPly::AddPropertySource(
+    const std::string &name,
+    PLY_TYPE type,
+    const void *val,
+    PLY_TYPE type_src,
+    unsigned int stride) {
+  assert(!elements_.empty());
+  Source src;
+  src.prop.name = name;
+  src.prop.type = type;
+  src.val = val;
+  src.type_src = type_src;
+  src.stride = stride;
+  elements_.back().props.push_back(src);
+}
+
+DFM2_INLINE void delfem2::WriterPly::AddPropertyList(
+    const std::string &name,
+    PLY_TYPE type_count,
+    PLY_TYPE type,
+    unsigned int nnode,
+    const unsigned int *value) {
+  this->AddPropertySource(name, type, value, PLY_TYPE::UINT32, 1);
+  Source &src = elements_.back().props.back();
+  src.prop.is_list = true;
+  src.prop.type_count = type_count;
+  src.nnode = nnode;
+}
+
+DFM2_INLINE void delfem2::WriterPly::AddPropertyList(
+    const std::string &name,
+    PLY_TYPE type_count,
+    PLY_TYPE type,
+    const unsigned int *index,
+    const unsigned int *value) {
+  this->AddPropertySource(name, type, value, PLY_TYPE::UINT32, 1);
+  Source &src = elements_.back().props.back();
+  src.prop.is_list = true;
+  src.prop.type_count = type_count;
+  src.index = index;
+}
+
+DFM2_INLINE bool delfem2::WriterPly::Write(
+    const std::filesystem::path &file_path,
+    PLY_FORMAT format) const {
+  namespace lcl = ::delfem2::msh_io_ply;
+  std::ofstream fout(file_path, std::ios::binary);
+  if (fout.fail()) { return false; }
+  fout << "ply\n";
+  if (format == PLY_FORMAT::ASCII) { fout << "format ascii 1.0\n"; }
+  if (format == PLY_FORMAT::BINARY_LITTLE_ENDIAN) { fout << "format binary_little_endian 1.0\n"; }
+  if (format == PLY_FORMAT::BINARY_BIG_ENDIAN) { fout << "format binary_big_endian 1.0\n"; }
+  for (const auto &comment: comments) { fout << "comment " << comment << "\n"; }
+  for (const auto &elem: elements_) {
+    fout << "element " << elem.name << " " << elem.count << "\n";
+    for (const auto &src: elem.props) {
+      if (src.prop.is_list) {
+        fout << "property list " << lcl::StringFromType(src.prop.type_count) << " ";
+      } else {
+        fout << "property ";
+      }
+      fout << lcl::StringFromType(src.prop.type) << " " << src.prop.name << "\n";
+    }
+  }
+  fout << "end_header\n";
+  const bool is_swap = (format == PLY_FORMAT::BINARY_LITTLE_ENDIAN) != lcl::IsLittleEndianMachine();
+  std::vector<char> buff;
+  std::ostringstream oss;
+  oss.precision(17);
+  for (const auto &elem: elements_) {
+    buff.clear();
+    oss.str("");
+    for (size_t irow = 0; irow < elem.count; ++irow) {
+      for (const auto &src: elem.props) {
+        size_t ival0 = irow * src.stride, nval = 1;
+        if (src.prop.is_list) {
+          ival0 = (src.index != nullptr) ? src.index[irow] : irow * src.nnode;
+          nval = (src.index != nullptr) ? src.index[irow + 1] - src.index[irow] : src.nnode;
+        }
+        if (format == PLY_FORMAT::ASCII) {
+          if (src.prop.is_list) { oss << nval << " "; }
+          for (size_t ival = ival0; ival < ival0 + nval; ++ival) {
+            const double v = lcl::LoadSource(src.val, src.type_src, ival);
+            if (src.prop.type == PLY_TYPE::FLOAT32) { oss << static_cast<float>(v) << " "; }
+            else if (src.prop.type == PLY_TYPE::FLOAT64) { oss << v << " "; }
+            else { oss << static_cast<long long>(v) << " "; }
+          }
+          continue;
+        }
+        const unsigned int nbyte = lcl::SizeOfType(src.prop.type);
+        if (src.prop.is_list) {
+          const unsigned int nbyte_count = lcl::SizeOfType(src.prop.type_count);
+          buff.resize(buff.size() + nbyte_count);
+          lcl::StoreBinary(buff.data() + buff.size() - nbyte_count, src.prop.type_count, double(nval), is_swap);
+        }
+        for (size_t ival = ival0; ival < ival0 + nval; ++ival) {
+          buff.resize(buff.size() + nbyte);
+          const double v = lcl::LoadSource(src.val, src.type_src, ival);
+          lcl::StoreBinary(buff.data() + buff.size() - nbyte, src.prop.type, v, is_swap);
+        }
+      }
+      if (format == PLY_FORMAT::ASCII) { oss << "\n"; }
+    }
+    if (format == PLY_FORMAT::ASCII) {
+      fout << oss.str();
+    } else {
+      fout.write(buff.data(), static_cast<std::streamsize>(buff.size()));
+    }
+  }
+  return !fout.fail();
+}
+
+DFM2_INLINE bool delfem2::Write_Ply(
+    const std::filesystem::path &file_path,
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &tri_vtx,
+    PLY_FORMAT format) {
+  WriterPly ply;
+  ply.AddElement("vertex", vtx_xyz.size() / 3);
+  ply.AddProperty("x", PLY_TYPE::FLOAT64, vtx_xyz.data() + 0, 3);
+  ply.AddProperty("y", PLY_TYPE::FLOAT64, vtx_xyz.data() + 1, 3);
+  ply.AddProperty("z", PLY_TYPE::FLOAT64, vtx_xyz.data() + 2, 3);
+  ply.AddElement("face", tri_vtx.size() / 3);
+  ply.AddPropertyList("vertex_indices", PLY_TYPE::UINT8, PLY_TYPE::INT32, 3, tri_vtx.data());
+  return ply.Write(file_path, format);
+}
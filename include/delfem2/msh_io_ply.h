@@ -18,6 +18,7 @@
 #include <filesystem>
 
 #include "delfem2/dfm2_inline.h"
+#include "delfem2/file_mapped.h"
 
 namespace delfem2 {
 
@@ -38,11 +39,194 @@ DFM2_INLINE void Read_Ply(
     int &ntri_,
     unsigned int *&aTri_);
 
+/**
+ * @brief read vertex coordinates and faces of ascii or binary PLY file
+ * @details polygonal faces are split into triangles as a fan
+ */
 DFM2_INLINE void Read_Ply(
     std::vector<double> &aXYZ,
     std::vector<unsigned int> &aTri,
     const std::filesystem::path &file_path);
 
+// ---------------------------------------
+// below: general PLY engine
+
+enum class PLY_FORMAT {
+  ASCII,
+  BINARY_LITTLE_ENDIAN,
+  BINARY_BIG_ENDIAN
+};
+
+enum class PLY_TYPE {
+  INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64
+};
+
+struct PlyProperty {
+  std::string name;
+  //! type of the value. type of the entries for a list property
+  PLY_TYPE type = PLY_TYPE::FLOAT32;
+  bool is_list = false;
+  //! type of the number of entries of a list property
+  PLY_TYPE type_count = PLY_TYPE::UINT8;
+};
+
+struct PlyElement {
+  std::string name;
+  size_t count = 0;
+  std::vector<PlyProperty> properties;
+};
+
+/**
+ * @brief reader of PLY file with arbitrary elements and properties
+ * @details The file is memory-mapped. For the binary formats, the values of elements without list properties
+ * are loaded directly from the fixed-stride rows without any parsing.
+ * @code
+ * ReaderPly ply;
+ * ply.Open(path);
+ * ply.ReadProperties(vtx_xyz, "vertex", {"x", "y", "z"});
+ * ply.ReadProperties(vtx_nrm, "vertex", {"nx", "ny", "nz"});
+ * ply.ReadPropertyList(elem_vtx_index, elem_vtx, "face", "vertex_indices");
+ * @endcode
+ */
+class ReaderPly {
+ public:
+  /**
+   * @brief parse the header and locate the data of each element. The values in ascii format are parsed here at once
+   * @return false if the file cannot be opened, its header is broken or the data is truncated
+   */
+  bool Open(const std::filesystem::path &file_path);
+
+  [[nodiscard]] PLY_FORMAT Format() const { return format_; }
+  [[nodiscard]] const std::vector<PlyElement> &Elements() const { return elements_; }
+  [[nodiscard]] const PlyElement *FindElement(const std::string &name_element) const;
+  [[nodiscard]] bool HasProperty(
+      const std::string &name_element,
+      const std::string &name_property) const;
+
+  /**
+   * @brief read scalar properties of an element as an interleaved array (e.g., x,y,z,x,y,z,...)
+   * @return false if the element or any of the properties does not exist
+   */
+  template<typename T>
+  bool ReadProperties(
+      std::vector<T> &aVal,
+      const std::string &name_element,
+      const std::vector<std::string> &aNameProperty) const;
+
+  /**
+   * @brief read a list property of an element as a jagged array
+   * @return false if the element or the list property does not exist
+   */
+  bool ReadPropertyList(
+      std::vector<unsigned int> &index,
+      std::vector<unsigned int> &value,
+      const std::string &name_element,
+      const std::string &name_property) const;
+
+ public:
+  std::vector<std::string> comments;
+
+ private:
+  PLY_FORMAT format_ = PLY_FORMAT::ASCII;
+  std::vector<PlyElement> elements_;
+  std::vector<size_t> elem_ofs_;  // byte offset of the data of each element in the file
+  std::vector<std::vector<double>> elem_ascii_;  // values of each element parsed in "Open" (ascii format only)
+  MappedFile file_;
+};
+
+/**
+ * @brief writer of PLY file
+ * @details the arrays are referenced (not copied), so they need to be alive until "Write" is called.
+ * @code
+ * WriterPly ply;
+ * ply.AddElement("vertex", np);
+ * ply.AddProperty("x", PLY_TYPE::FLOAT32, vtx_xyz.data() + 0, 3);
+ * ply.AddProperty("y", PLY_TYPE::FLOAT32, vtx_xyz.data() + 1, 3);
+ * ply.AddProperty("z", PLY_TYPE::FLOAT32, vtx_xyz.data() + 2, 3);
+ * ply.AddElement("face", ntri);
+ * ply.AddPropertyList("vertex_indices", PLY_TYPE::UINT8, PLY_TYPE::INT32, 3, tri_vtx.data());
+ * ply.Write(path, PLY_FORMAT::BINARY_LITTLE_ENDIAN);
+ * @endcode
+ */
+class WriterPly {
+ public:
+  void AddElement(const std::string &name, size_t count);
+
+  /**
+   * @brief add a scalar property to the last element. The value of the i-th row is val[i*stride]
+   */
+  void AddProperty(const std::string &name, PLY_TYPE type, const double *val, unsigned int stride) {
+    this->AddPropertySource(name, type, val, PLY_TYPE::FLOAT64, stride);
+  }
+  void AddProperty(const std::string &name, PLY_TYPE type, const float *val, unsigned int stride) {
+    this->AddPropertySource(name, type, val, PLY_TYPE::FLOAT32, stride);
+  }
+  void AddProperty(const std::string &name, PLY_TYPE type, const int *val, unsigned int stride) {
+    this->AddPropertySource(name, type, val, PLY_TYPE::INT32, stride);
+  }
+  void AddProperty(const std::string &name, PLY_TYPE type, const unsigned int *val, unsigned int stride) {
+    this->AddPropertySource(name, type, val, PLY_TYPE::UINT32, stride);
+  }
+  void AddProperty(const std::string &name, PLY_TYPE type, const unsigned char *val, unsigned int stride) {
+    this->AddPropertySource(name, type, val, PLY_TYPE::UINT8, stride);
+  }
+
+  /**
+   * @brief add a list property to the last element where all the rows have "nnode" entries
+   */
+  void AddPropertyList(
+      const std::string &name,
+      PLY_TYPE type_count,
+      PLY_TYPE type,
+      unsigned int nnode,
+      const unsigned int *value);
+
+  /**
+   * @brief add a list property to the last element given as a jagged array
+   */
+  void AddPropertyList(
+      const std::string &name,
+      PLY_TYPE type_count,
+      PLY_TYPE type,
+      const unsigned int *index,
+      const unsigned int *value);
+
+  bool Write(
+      const std::filesystem::path &file_path,
+      PLY_FORMAT format) const;
+
+ public:
+  std::vector<std::string> comments;
+
+ private:
+  struct Source {
+    PlyProperty prop;
+    const void *val = nullptr;
+    PLY_TYPE type_src = PLY_TYPE::FLOAT64;
+    unsigned int stride = 1;
+    const unsigned int *index = nullptr;  // jagged array index for a list property
+    unsigned int nnode = 0;  // number of entries for a list property if "index" is nullptr
+  };
+  struct ElementSource {
+    std::string name;
+    size_t count = 0;
+    std::vector<Source> props;
+  };
+  void AddPropertySource(
+      const std::string &name, PLY_TYPE type,
+      const void *val, PLY_TYPE type_src, unsigned int stride);
+  std::vector<ElementSource> elements_;
+};
+
+/**
+ * @brief write a triangle mesh in the ascii or binary PLY format
+ */
+DFM2_INLINE bool Write_Ply(
+    const std::filesystem::path &file_path,
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &tri_vtx,
+    PLY_FORMAT format);
+
 } // namespace delfem2
 
 #ifndef DFM2_STATIC_LIBRARY
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/msh_io_stl.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <string_view>
+#include <algorithm>
+
+#include "delfem2/file_mapped.h"
+#include "delfem2/msh_weld.h"
+#include "delfem2/str.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::msh_io_stl {
+
+constexpr size_t kSizeHeader = 84;  // 80 bytes of comment and the number of triangles
+constexpr size_t kSizeTri = 50;  // normal, three corners and attribute
+//! number of triangles decoded by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 14;
+
+DFM2_INLINE void ReadBinary(
+    std::vector<double> &tri_xyz,
+    const char *data,
+    size_t ntri,
+    unsigned int num_thread) {
+  tri_xyz.resize(ntri * 9);
+  parallel_for_chunk(ntri, kNumChunk, [&](size_t it0, size_t it1) {
+    for (size_t it = it0; it < it1; ++it) {
+      float xyz[9];
+      std::memcpy(xyz, data + kSizeHeader + it * kSizeTri + 12, 36);  // skip normal
+      for (unsigned int i = 0; i < 9; ++i) { tri_xyz[it * 9 + i] = xyz[i]; }
+    }
+  }, num_thread);
+}
+
+DFM2_INLINE bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * whitespace-delimited token starting from p. The token is empty at the end of the data
+ */
+DFM2_INLINE std::string_view NextToken(
+    const char *&p,
+    const char *end) {
+  while (p != end && IsSpace(*p)) { ++p; }
+  const char *q = p;
+  while (q != end && !IsSpace(*q)) { ++q; }
+  const std::string_view token(p, q - p);
+  p = q;
+  return token;
+}
+
+DFM2_INLINE const char *SkipLine(const char *p, const char *end) {
+  while (p != end && *p != '\n') { ++p; }
+  return p;
+}
+
+/**
+ * the file is ascii if it starts with "solid" and the first token after the name of the solid is "facet" or "endsolid".
+ * A binary file may also start with "solid" in its comment.
+ */
+DFM2_INLINE bool IsAscii(
+    const char *data,
+    size_t size) {
+  const char *p = data;
+  const char *end = data + size;
+  if (NextToken(p, end) != "solid") { return false; }
+  p = SkipLine(p, end);
+  const std::string_view token = NextToken(p, end);
+  return token == "facet" || token == "endsolid";
+}
+
+/**
+ * read the three numbers after each "vertex" token in the "outer loop" of the facets.
+ * The names after "solid" and "endsolid" are skipped.
+ */
+DFM2_INLINE bool ReadAscii(
+    std::vector<double> &tri_xyz,
+    const char *data,
+    size_t size) {
+  const char *p = data;
+  const char *end = data + size;
+  tri_xyz.clear();
+  bool is_loop = false;
+  for (;;) {
+    const std::string_view token = NextToken(p, end);
+    if (token.empty()) { break; }
+    if (token == "solid" || token == "endsolid") {
+      p = SkipLine(p, end);
+    } else if (token == "loop") {
+      is_loop = true;
+    } else if (token == "endloop") {
+      is_loop = false;
+    } else if (token == "vertex" && is_loop) {
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        double v;
+        const char *q = ParseNumber_Double(v, p, end);
+        if (q == p) { return false; }
+        tri_xyz.push_back(v);
+        p = q;
+      }
+    }
+  }
+  return !tri_xyz.empty() && tri_xyz.size() % 9 == 0;
+}
+
+}  // namespace delfem2::msh_io_stl
+
+// ----------------------------------
+
+DFM2_INLINE bool delfem2::Read_STL_TriangleSoup(
+    std::vector<double> &tri_xyz,
+    const std::filesystem::path &file_path,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_io_stl;
+  tri_xyz.clear();
+  MappedFile file;
+  if (!file.Open(file_path)) { return false; }
+  const char *data = file.data();
+  const size_t size = file.size();
+  if (lcl::IsAscii(data, size)) {
+    return lcl::ReadAscii(tri_xyz, data, size);
+  }
+  if (size < lcl::kSizeHeader) { return false; }
+  std::uint32_t ntri;
+  std::memcpy(&ntri, data + 80, 4);
+  if (ntri == 0) { return false; }
+  // trailing bytes after the triangles are allowed
+  if (size < lcl::kSizeHeader + static_cast<size_t>(ntri) * lcl::kSizeTri) { return false; }
+  lcl::ReadBinary(tri_xyz, data, ntri, num_thread);
+  return true;
+}
+
+DFM2_INLINE bool delfem2::Read_STL(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const std::filesystem::path &file_path,
+    double epsilon,
+    unsigned int num_thread) {
+  std::vector<double> tri_xyz;
+  if (!Read_STL_TriangleSoup(tri_xyz, file_path, num_thread)) { return false; }
+  WeldPoints3(
+      tri_vtx, vtx_xyz,
+      tri_xyz.data(), tri_xyz.size() / 3, epsilon, num_thread);
+  return true;
+}
+
+DFM2_INLINE bool delfem2::Write_STL_Binary(
+    const std::filesystem::path &file_path,
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &tri_vtx) {
+  namespace lcl = ::delfem2::msh_io_stl;
+  std::ofstream fout(file_path, std::ios::binary);
+  if (fout.fail()) { return false; }
+  const size_t ntri = tri_vtx.size() / 3;
+  std::vector<char> buff(lcl::kSizeHeader + ntri * lcl::kSizeTri, 0);
+  const char comment[] = "binary STL written by delfem2";
+  std::memcpy(buff.data(), comment, sizeof(comment));
+  const auto ntri32 = static_cast<std::uint32_t>(ntri);
+  std::memcpy(buff.data() + 80, &ntri32, 4);
+  for (size_t it = 0; it < ntri; ++it) {
+    const double *p0 = vtx_xyz.data() + tri_vtx[it * 3 + 0] * 3;
+    const double *p1 = vtx_xyz.data() + tri_vtx[it * 3 + 1] * 3;
+    const double *p2 = vtx_xyz.data() + tri_vtx[it * 3 + 2] * 3;
+    const double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    const double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    double n[3] = {
+        e1[1] * e2[2] - e1[2] * e2[1],
+        e1[2] * e2[0] - e1[0] * e2[2],
+        e1[0] * e2[1] - e1[1] * e2[0]};
+    const double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    const double invlen = (len > 0.0) ? 1.0 / len : 0.0;
+    const float val[12] = {
+        float(n[0] * invlen), float(n[1] * invlen), float(n[2] * invlen),
+        float(p0[0]), float(p0[1]), float(p0[2]),
+        float(p1[0]), float(p1[1]), float(p1[2]),
+        float(p2[0]), float(p2[1]), float(p2[2])};
+    std::memcpy(buff.data() + lcl::kSizeHeader + it * lcl::kSizeTri, val, 48);
+  }
+  fout.write(buff.data(), static_cast<std::streamsize>(buff.size()));
+  return !fout.fail();
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file read/write STL file (both binary and ascii)
+ */
+
+#ifndef DFM2_MSH_IO_STL_H
+#define DFM2_MSH_IO_STL_H
+
+#include <vector>
+#include <filesystem>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+/**
+ * @brief read triangles of binary or ascii STL file without welding the vertices
+ * @details the file is memory-mapped. The file is ascii if it starts with "solid" followed by "facet" or "endsolid"
+ * in the next line. Otherwise, it is binary and the bytes after the triangles are ignored.
+ * @param[out] tri_xyz coordinates of the three corners of the triangles (9 values per triangle)
+ * @param num_thread number of threads to decode binary file. "0" means the number of hardware threads.
+ * @return false if the file cannot be opened or it is broken, or it has no triangles
+ */
+DFM2_INLINE bool Read_STL_TriangleSoup(
+    std::vector<double> &tri_xyz,
+    const std::filesystem::path &file_path,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief read STL file as an indexed triangle mesh
+ * @details the corners of the triangles closer than "epsilon" are welded
+ * @param epsilon tolerance of welding. Zero means the corners with the same coordinates are welded.
+ */
+DFM2_INLINE bool Read_STL(
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &tri_vtx,
+    const std::filesystem::path &file_path,
+    double epsilon = 0.0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief write triangle mesh in the binary STL format
+ */
+DFM2_INLINE bool Write_STL_Binary(
+    const std::filesystem::path &file_path,
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &tri_vtx);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/msh_io_stl.cpp"
+#endif
+
+#endif // DFM2_MSH_IO_STL_H
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/msh_io_vtk.h"
+
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "delfem2/thread.h"
+
+namespace delfem2::msh_io_vtk {
+
+DFM2_INLINE bool IsLittleEndianMachine() {
+  const std::uint16_t v = 1;
+  unsigned char c;
+  std::memcpy(&c, &v, 1);
+  return c == 1;
+}
+
+/**
+ * append values in big endian as the legacy VTK binary format requires
+ */
+template<typename T>
+void AppendBigEndian(std::vector<char> &buff, T v) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &v, sizeof(T));
+  if (IsLittleEndianMachine()) { std::reverse(bytes, bytes + sizeof(T)); }
+  buff.insert(buff.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * "SCALARS", "VECTORS" or "FIELD" section of the legacy format
+ */
+DFM2_INLINE void AppendLegacyData(
+    std::vector<char> &buff,
+    const std::string &name,
+    const double *val,
+    unsigned int ncomp,
+    size_t num) {
+  std::ostringstream oss;
+  if (ncomp == 3) {
+    oss << "VECTORS " << name << " double\n";
+  } else if (ncomp <= 4) {
+    oss << "SCALARS " << name << " double " << ncomp << "\nLOOKUP_TABLE default\n";
+  } else {
+    oss << "FIELD FieldData 1\n" << name << " " << ncomp << " " << num << " double\n";
+  }
+  const std::string str = oss.str();
+  buff.insert(buff.end(), str.begin(), str.end());
+  for (size_t i = 0; i < num * ncomp; ++i) { AppendBigEndian<double>(buff, val[i]); }
+  buff.push_back('\n');
+}
+
+/**
+ * byte range referenced by an array of the appended data
+ */
+struct Segment {
+  const char *p;
+  size_t n;
+};
+
+}  // namespace delfem2::msh_io_vtk
+
+// ----------------------------------------------------
+
+DFM2_INLINE unsigned int delfem2::NumNodeVtkCell(unsigned int vtk_elem_type) {
+  switch (vtk_elem_type) {
+    case 1: return 1;  // vertex
+    case 3: return 2;  // line
+    case 5: return 3;  // triangle
+    case 9: return 4;  // quad
+    case 10: return 4;  // tetrahedron
+    case 12: return 8;  // hexahedron
+    case 13: return 6;  // wedge
+    case 14: return 5;  // pyramid
+    case 22: return 6;  // quadratic triangle
+    case 24: return 10;  // quadratic tetrahedron
+    default: return 0;
+  }
+}
+
+DFM2_INLINE void delfem2::WriterVtk::SetPoints(
+    const double *vtx_xyz,
+    size_t num_vtx,
+    unsigned int ndim) {
+  assert(ndim == 2 || ndim == 3);
+  vtx_xyz_ = vtx_xyz;
+  num_vtx_ = num_vtx;
+  ndim_ = ndim;
+}
+
+DFM2_INLINE void delfem2::WriterVtk::AddCells(
+    unsigned int vtk_elem_type,
+    const unsigned int *elem_vtx,
+    size_t num_elem) {
+  CellBlock block;
+  block.type = vtk_elem_type;
+  block.nnode = NumNodeVtkCell(vtk_elem_type);
+  assert(block.nnode != 0);
+  block.elem_vtx = elem_vtx;
+  block.num_elem = num_elem;
+  cells_.push_back(block);
+}
+
+DFM2_INLINE void delfem2::WriterVtk::AddPointData(
+    const std::string &name,
+    const double *val,
+    unsigned int ncomp) {
+  point_data_.push_back({name, val, ncomp});
+}
+
+DFM2_INLINE void delfem2::WriterVtk::AddCellData(
+    const std::string &name,
+    const double *val,
+    unsigned int ncomp) {
+  cell_data_.push_back({name, val, ncomp});
+}
+
+DFM2_INLINE size_t delfem2::WriterVtk::NumCell() const {
+  size_t ncell = 0;
+  for (const auto &block: cells_) { ncell += block.num_elem; }
+  return ncell;
+}
+
+DFM2_INLINE bool delfem2::WriterVtk::WriteLegacyBinary(
+    const std::filesystem::path &file_path,
+    const std::string &title) const {
+  namespace lcl = ::delfem2::msh_io_vtk;
+  std::ofstream fout(file_path, std::ios::binary);
+  if (fout.fail()) { return false; }
+  const size_t ncell = this->NumCell();
+  size_t size_cell = 0;
+  for (const auto &block: cells_) { size_cell += block.num_elem * (block.nnode + 1); }
+  std::vector<char> buff;
+  auto append_str = [&buff](const std::string &str) { buff.insert(buff.end(), str.begin(), str.end()); };
+  append_str("# vtk DataFile Version 3.0\n" + title + "\nBINARY\nDATASET UNSTRUCTURED_GRID\n");
+  append_str("POINTS " + std::to_string(num_vtx_) + " double\n");
+  buff.reserve(buff.size() + num_vtx_ * 24 + size_cell * 4 + ncell * 4);
+  for (size_t ip = 0; ip < num_vtx_; ++ip) {
+    for (unsigned int idim = 0; idim < 3; ++idim) {
+      lcl::AppendBigEndian<double>(buff, idim < ndim_ ? vtx_xyz_[ip * ndim_ + idim] : 0.0);
+    }
+  }
+  append_str("\nCELLS " + std::to_string(ncell) + " " + std::to_string(size_cell) + "\n");
+  for (const auto &block: cells_) {
+    for (size_t ie = 0; ie < block.num_elem; ++ie) {
+      lcl::AppendBigEndian<std::int32_t>(buff, static_cast<std::int32_t>(block.nnode));
+      for (unsigned int in = 0; in < block.nnode; ++in) {
+        lcl::AppendBigEndian<std::int32_t>(buff, static_cast<std::int32_t>(block.elem_vtx[ie * block.nnode + in]));
+      }
+    }
+  }
+  append_str("\nCELL_TYPES " + std::to_string(ncell) + "\n");
+  for (const auto &block: cells_) {
+    for (size_t ie = 0; ie < block.num_elem; ++ie) {
+      lcl::AppendBigEndian<std::int32_t>(buff, static_cast<std::int32_t>(block.type));
+    }
+  }
+  buff.push_back('\n');
+  if (!point_data_.empty()) {
+    append_str("POINT_DATA " + std::to_string(num_vtx_) + "\n");
+    for (const auto &data: point_data_) {
+      lcl::AppendLegacyData(buff, data.name, data.val, data.ncomp, num_vtx_);
+    }
+  }
+  if (!cell_data_.empty()) {
+    append_str("CELL_DATA " + std::to_string(ncell) + "\n");
+    for (const auto &data: cell_data_) {
+      lcl::AppendLegacyData(buff, data.name, data.val, data.ncomp, ncell);
+    }
+  }
+  fout.write(buff.data(), static_cast<std::streamsize>(buff.size()));
+  return !fout.fail();
+}
+
+DFM2_INLINE bool delfem2::WriterVtk::WriteVtu(
+    const std::filesystem::path &file_path) const {
+  namespace lcl = ::delfem2::msh_io_vtk;
+  std::ofstream fout(file_path, std::ios::binary);
+  if (fout.fail()) { return false; }
+  const size_t ncell = this->NumCell();
+  // arrays computed here. The others are written from the buffers of the caller
+  std::vector<double> xyz3;
+  std::vector<std::int64_t> cell_offset;
+  std::vector<std::uint8_t> cell_type;
+  cell_offset.reserve(ncell);
+  cell_type.reserve(ncell);
+  {
+    std::int64_t ofs = 0;
+    for (const auto &block: cells_) {
+      for (size_t ie = 0; ie < block.num_elem; ++ie) {
+        ofs += block.nnode;
+        cell_offset.push_back(ofs);
+        cell_type.push_back(static_cast<std::uint8_t>(block.type));
+      }
+    }
+  }
+  std::vector<std::vector<lcl::Segment>> arrays;
+  if (ndim_ == 3) {
+    arrays.push_back({{reinterpret_cast<const char *>(vtx_xyz_), num_vtx_ * 24}});
+  } else {
+    xyz3.resize(num_vtx_ * 3, 0.0);
+    for (size_t ip = 0; ip < num_vtx_; ++ip) {
+      for (unsigned int idim = 0; idim < ndim_; ++idim) { xyz3[ip * 3 + idim] = vtx_xyz_[ip * ndim_ + idim]; }
+    }
+    arrays.push_back({{reinterpret_cast<const char *>(xyz3.data()), num_vtx_ * 24}});
+  }
+  {
+    std::vector<lcl::Segment> connectivity;
+    for (const auto &block: cells_) {
+      connectivity.push_back({reinterpret_cast<const char *>(block.elem_vtx), block.num_elem * block.nnode * 4});
+    }
+    arrays.push_back(connectivity);
+  }
+  arrays.push_back({{reinterpret_cast<const char *>(cell_offset.data()), ncell * 8}});
+  arrays.push_back({{reinterpret_cast<const char *>(cell_type.data()), ncell}});
+  for (const auto &data: point_data_) {
+    arrays.push_back({{reinterpret_cast<const char *>(data.val), num_vtx_ * data.ncomp * 8}});
+  }
+  for (const auto &data: cell_data_) {
+    arrays.push_back({{reinterpret_cast<const char *>(data.val), ncell * data.ncomp * 8}});
+  }
+  std::vector<std::uint64_t> array_offset;
+  {
+    std::uint64_t ofs = 0;
+    for (const auto &array: arrays) {
+      array_offset.push_back(ofs);
+      ofs += 8;  // header of the array
+      for (const auto &seg: array) { ofs += seg.n; }
+    }
+  }
+  auto data_array = [&array_offset](
+      const std::string &type,
+      const std::string &name,
+      unsigned int ncomp,
+      unsigned int iarray) {
+    std::string str = "<DataArray type=\"" + type + "\"";
+    if (!name.empty()) { str += " Name=\"" + name + "\""; }
+    str += " NumberOfComponents=\"" + std::to_string(ncomp) + "\"";
+    return str + " format=\"appended\" offset=\"" + std::to_string(array_offset[iarray]) + "\"/>\n";
+  };
+  std::string xml = "<?xml version=\"1.0\"?>\n";
+  xml += "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"";
+  xml += lcl::IsLittleEndianMachine() ? "LittleEndian" : "BigEndian";
+  xml += "\" header_type=\"UInt64\">\n";
+  xml += "<UnstructuredGrid>\n";
+  xml += "<Piece NumberOfPoints=\"" + std::to_string(num_vtx_)
+      + "\" NumberOfCells=\"" + std::to_string(ncell) + "\">\n";
+  unsigned int iarray = 0;
+  xml += "<Points>\n" + data_array("Float64", "", 3, iarray++) + "</Points>\n";
+  xml += "<Cells>\n";
+  xml += data_array("UInt32", "connectivity", 1, iarray++);
+  xml += data_array("Int64", "offsets", 1, iarray++);
+  xml += data_array("UInt8", "types", 1, iarray++);
+  xml += "</Cells>\n";
+  xml += "<PointData>\n";
+  for (const auto &data: point_data_) { xml += data_array("Float64", data.name, data.ncomp, iarray++); }
+  xml += "</PointData>\n";
+  xml += "<CellData>\n";
+  for (const auto &data: cell_data_) { xml += data_array("Float64", data.name, data.ncomp, iarray++); }
+  xml += "</CellData>\n";
+  xml += "</Piece>\n</UnstructuredGrid>\n<AppendedData encoding=\"raw\">\n_";
+  fout.write(xml.data(), static_cast<std::streamsize>(xml.size()));
+  for (const auto &array: arrays) {
+    std::uint64_t nbyte = 0;
+    for (const auto &seg: array) { nbyte += seg.n; }
+    fout.write(reinterpret_cast<const char *>(&nbyte), 8);
+    for (const auto &seg: array) { fout.write(seg.p, static_cast<std::streamsize>(seg.n)); }
+  }
+  const std::string footer = "\n</AppendedData>\n</VTKFile>\n";
+  fout.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+  return !fout.fail();
+}
+
+DFM2_INLINE bool delfem2::WriterVtk::WritePvtu(
+    const std::filesystem::path &file_path,
+    unsigned int num_piece,
+    unsigned int num_thread) const {
+  namespace lcl = ::delfem2::msh_io_vtk;
+  if (num_piece == 0) { return false; }
+  const std::string stem = file_path.stem().string();
+  const std::filesystem::path dir = file_path.parent_path();
+  const size_t ncell = this->NumCell();
+  std::vector<char> is_ok(num_piece, 0);
+  auto func_piece = [&](unsigned int ipiece) {
+    const size_t ic0 = ncell * ipiece / num_piece;
+    const size_t ic1 = ncell * (ipiece + 1) / num_piece;
+    // gather the cells in [ic0, ic1) and the points referenced by them
+    std::vector<unsigned int> map_g2l(num_vtx_, UINT_MAX), map_l2g;
+    std::vector<std::vector<unsigned int>> piece_elem_vtx(cells_.size());
+    size_t jc0 = 0;  // index of the first cell of a block
+    for (unsigned int iblock = 0; iblock < cells_.size(); ++iblock) {
+      const CellBlock &block = cells_[iblock];
+      const size_t ie0 = std::clamp(ic0, jc0, jc0 + block.num_elem) - jc0;
+      const size_t ie1 = std::clamp(ic1, jc0, jc0 + block.num_elem) - jc0;
+      jc0 += block.num_elem;
+      for (size_t ie = ie0; ie < ie1; ++ie) {
+        for (unsigned int in = 0; in < block.nnode; ++in) {
+          const unsigned int ip = block.elem_vtx[ie * block.nnode + in];
+          if (map_g2l[ip] == UINT_MAX) {
+            map_g2l[ip] = static_cast<unsigned int>(map_l2g.size());
+            map_l2g.push_back(ip);
+          }
+          piece_elem_vtx[iblock].push_back(map_g2l[ip]);
+        }
+      }
+    }
+    std::vector<double> piece_xyz(map_l2g.size() * ndim_);
+    for (size_t jp = 0; jp < map_l2g.size(); ++jp) {
+      for (unsigned int idim = 0; idim < ndim_; ++idim) {
+        piece_xyz[jp * ndim_ + idim] = vtx_xyz_[map_l2g[jp] * ndim_ + idim];
+      }
+    }
+    std::vector<std::vector<double>> piece_point_data(point_data_.size());
+    WriterVtk piece;
+    piece.SetPoints(piece_xyz.data(), map_l2g.size(), ndim_);
+    for (unsigned int iblock = 0; iblock < cells_.size(); ++iblock) {
+      const size_t ne = piece_elem_vtx[iblock].size() / cells_[iblock].nnode;
+      if (ne == 0) { continue; }
+      piece.AddCells(cells_[iblock].type, piece_elem_vtx[iblock].data(), ne);
+    }
+    for (unsigned int idata = 0; idata < point_data_.size(); ++idata) {
+      const DataArray &data = point_data_[idata];
+      std::vector<double> &val = piece_point_data[idata];
+      val.resize(map_l2g.size() * data.ncomp);
+      for (size_t jp = 0; jp < map_l2g.size(); ++jp) {
+        for (unsigned int icomp = 0; icomp < data.ncomp; ++icomp) {
+          val[jp * data.ncomp + icomp] = data.val[map_l2g[jp] * data.ncomp + icomp];
+        }
+      }
+      piece.AddPointData(data.name, val.data(), data.ncomp);
+    }
+    for (const auto &data: cell_data_) {  // the cells of a piece are contiguous
+      piece.AddCellData(data.name, data.val + ic0 * data.ncomp, data.ncomp);
+    }
+    const std::string name_piece = stem + "_" + std::to_string(ipiece) + ".vtu";
+    is_ok[ipiece] = piece.WriteVtu(dir / name_piece) ? 1 : 0;
+  };
+  parallel_for_chunk(num_piece, 1, [&](size_t ipiece, size_t) {
+    func_piece(static_cast<unsigned int>(ipiece));
+  }, num_thread);
+  if (std::find(is_ok.begin(), is_ok.end(), 0) != is_ok.end()) { return false; }
+  std::ofstream fout(file_path);
+  if (fout.fail()) { return false; }
+  fout << "<?xml version=\"1.0\"?>\n";
+  fout << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"";
+  fout << (lcl::IsLittleEndianMachine() ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\">\n";
+  fout << "<PUnstructuredGrid GhostLevel=\"0\">\n";
+  fout << "<PPointData>\n";
+  for (const auto &data: point_data_) {
+    fout << "<PDataArray type=\"Float64\" Name=\"" << data.name
+         << "\" NumberOfComponents=\"" << data.ncomp << "\"/>\n";
+  }
+  fout << "</PPointData>\n";
+  fout << "<PCellData>\n";
+  for (const auto &data: cell_data_) {
+    fout << "<PDataArray type=\"Float64\" Name=\"" << data.name
+         << "\" NumberOfComponents=\"" << data.ncomp << "\"/>\n";
+  }
+  fout << "</PCellData>\n";
+  fout << "<PPoints>\n<PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n</PPoints>\n";
+  for (unsigned int ipiece = 0; ipiece < num_piece; ++ipiece) {
+    fout << "<Piece Source=\"" << stem << "_" << ipiece << ".vtu\"/>\n";
+  }
+  fout << "</PUnstructuredGrid>\n</VTKFile>\n";
+  return !fout.fail();
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file binary output of unstructured grid for VTK (legacy binary, VTU and partitioned PVTU)
+ * @details the values are written as raw bytes without formatting.
+ * The VTU file uses the appended raw encoding in the byte order of the machine,
+ * so the arrays are written directly from the buffers of the caller.
+ */
+
+#ifndef DFM2_MSH_IO_VTK_H
+#define DFM2_MSH_IO_VTK_H
+
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+/**
+ * @return number of nodes of a VTK cell type (e.g., 5: triangle, 10: tetrahedron).
+ * zero for the unsupported types
+ */
+DFM2_INLINE unsigned int NumNodeVtkCell(unsigned int vtk_elem_type);
+
+/**
+ * @brief writer of unstructured grid with multiple point and cell data arrays
+ * @details the arrays are referenced (not copied), so they need to be alive until the file is written.
+ * @code
+ * WriterVtk vtk;
+ * vtk.SetPoints(vtx_xyz.data(), vtx_xyz.size() / 3, 3);
+ * vtk.AddCells(10, tet_vtx.data(), tet_vtx.size() / 4);
+ * vtk.AddPointData("displacement", vtx_disp.data(), 3);
+ * vtk.AddCellData("stress", tet_stress.data(), 6);
+ * vtk.WriteVtu("result.vtu");
+ * @endcode
+ */
+class WriterVtk {
+ public:
+  /**
+   * @param ndim 2 or 3. The third coordinate is zero for 2D points
+   */
+  void SetPoints(
+      const double *vtx_xyz,
+      size_t num_vtx,
+      unsigned int ndim);
+
+  /**
+   * @brief add cells of a type. Cells of different types can be added by calling this multiple times
+   */
+  void AddCells(
+      unsigned int vtk_elem_type,
+      const unsigned int *elem_vtx,
+      size_t num_elem);
+
+  //! add an array of values with "ncomp" components per point
+  void AddPointData(
+      const std::string &name,
+      const double *val,
+      unsigned int ncomp);
+
+  //! add an array of values with "ncomp" components per cell in the order of "AddCells"
+  void AddCellData(
+      const std::string &name,
+      const double *val,
+      unsigned int ncomp);
+
+  [[nodiscard]] size_t NumCell() const;
+
+  /**
+   * @brief write in the legacy VTK format with binary (big endian) data
+   */
+  bool WriteLegacyBinary(
+      const std::filesystem::path &file_path,
+      const std::string &title = "delfem2") const;
+
+  /**
+   * @brief write in the VTK XML format with appended raw data
+   */
+  bool WriteVtu(const std::filesystem::path &file_path) const;
+
+  /**
+   * @brief split the cells into "num_piece" contiguous ranges and write them as VTU files in parallel
+   * @details the pieces are written as "<stem>_<i>.vtu" in the directory of the PVTU file
+   * @param num_thread number of threads. "0" means the number of hardware threads.
+   */
+  bool WritePvtu(
+      const std::filesystem::path &file_path,
+      unsigned int num_piece,
+      unsigned int num_thread = 0) const;
+
+ private:
+  struct CellBlock {
+    unsigned int type = 0;
+    unsigned int nnode = 0;
+    const unsigned int *elem_vtx = nullptr;
+    size_t num_elem = 0;
+  };
+  struct DataArray {
+    std::string name;
+    const double *val = nullptr;
+    unsigned int ncomp = 1;
+  };
+  const double *vtx_xyz_ = nullptr;
+  size_t num_vtx_ = 0;
+  unsigned int ndim_ = 3;
+  std::vector<CellBlock> cells_;
+  std::vector<DataArray> point_data_;
+  std::vector<DataArray> cell_data_;
+};
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/msh_io_vtk.cpp"
+#endif
+
+#endif // DFM2_MSH_IO_VTK_H
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/msh_reorder.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::msh_reorder {
+
+//! number of points processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 14;
+//! number of bits per axis for the key of the space filling curve
+constexpr unsigned int kNumBit = 21;
+
+//! insert two zero bits between each of the lower 21 bits
+DFM2_INLINE std::uint64_t ExpandBits3(std::uint64_t v) {
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8) & 0x100f00f00f00f00fULL;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2) & 0x1249249249249249ULL;
+  return v;
+}
+
+//! insert a zero bit between each of the lower 21 bits
+DFM2_INLINE std::uint64_t ExpandBits2(std::uint64_t v) {
+  v &= 0x1fffff;
+  v = (v | v << 16) & 0x0000ffff0000ffffULL;
+  v = (v | v << 8) & 0x00ff00ff00ff00ffULL;
+  v = (v | v << 4) & 0x0f0f0f0f0f0f0f0fULL;
+  v = (v | v << 2) & 0x3333333333333333ULL;
+  v = (v | v << 1) & 0x5555555555555555ULL;
+  return v;
+}
+
+template<unsigned int NDIM>
+DFM2_INLINE std::uint64_t MortonKey(const std::uint32_t q[NDIM]) {
+  static_assert(NDIM == 2 || NDIM == 3);
+  if constexpr (NDIM == 3) {
+    return (ExpandBits3(q[0]) << 2) | (ExpandBits3(q[1]) << 1) | ExpandBits3(q[2]);
+  } else {
+    return (ExpandBits2(q[0]) << 1) | ExpandBits2(q[1]);
+  }
+}
+
+/**
+ * J. Skilling, "Programming the Hilbert curve", AIP Conference Proceedings 707, 2004
+ */
+template<unsigned int NDIM>
+DFM2_INLINE std::uint64_t HilbertKey(const std::uint32_t q[NDIM]) {
+  std::uint32_t x[NDIM];
+  for (unsigned int i = 0; i < NDIM; ++i) { x[i] = q[i]; }
+  const std::uint32_t m = 1u << (kNumBit - 1);
+  for (std::uint32_t b = m; b > 1; b >>= 1) {  // inverse undo
+    const std::uint32_t p = b - 1;
+    for (unsigned int i = 0; i < NDIM; ++i) {
+      if (x[i] & b) {
+        x[0] ^= p;
+      } else {
+        const std::uint32_t t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+  for (unsigned int i = 1; i < NDIM; ++i) { x[i] ^= x[i - 1]; }  // gray encode
+  std::uint32_t t = 0;
+  for (std::uint32_t b = m; b > 1; b >>= 1) {
+    if (x[NDIM - 1] & b) { t ^= b - 1; }
+  }
+  for (unsigned int i = 0; i < NDIM; ++i) { x[i] ^= t; }
+  return MortonKey<NDIM>(x);  // the bits of the transposed index are interleaved
+}
+
+/**
+ * keys of the points along the space filling curve in the bounding cube
+ */
+template<unsigned int NDIM>
+void Key_SpaceFillingCurve(
+    std::vector<std::uint64_t> &key,
+    const double *xyz,
+    size_t num_point,
+    SPACE_FILLING_CURVE curve,
+    unsigned int num_thread) {
+  key.resize(num_point);
+  if (num_point == 0) { return; }
+  double bb_min[NDIM], bb_max[NDIM];
+  for (unsigned int idim = 0; idim < NDIM; ++idim) {
+    bb_min[idim] = bb_max[idim] = xyz[idim];
+  }
+  for (size_t ip = 0; ip < num_point; ++ip) {
+    for (unsigned int idim = 0; idim < NDIM; ++idim) {
+      bb_min[idim] = std::min(bb_min[idim], xyz[ip * NDIM + idim]);
+      bb_max[idim] = std::max(bb_max[idim], xyz[ip * NDIM + idim]);
+    }
+  }
+  double size = 0.0;
+  for (unsigned int idim = 0; idim < NDIM; ++idim) {
+    size = std::max(size, bb_max[idim] - bb_min[idim]);
+  }
+  const double scale = (size > 0.0) ? double((1u << kNumBit) - 1) / size : 0.0;
+  parallel_for_chunk(num_point, kNumChunk, [&](size_t ip0, size_t ip1) {
+    for (size_t ip = ip0; ip < ip1; ++ip) {
+      std::uint32_t q[NDIM];
+      for (unsigned int idim = 0; idim < NDIM; ++idim) {
+        q[idim] = static_cast<std::uint32_t>((xyz[ip * NDIM + idim] - bb_min[idim]) * scale);
+      }
+      key[ip] = (curve == SPACE_FILLING_CURVE::HILBERT) ? HilbertKey<NDIM>(q) : MortonKey<NDIM>(q);
+    }
+  }, num_thread);
+}
+
+//! hash of the integer for the reproducible random numbers (splitmix64)
+DFM2_INLINE std::uint64_t HashInteger(std::uint64_t v) {
+  v += 0x9e3779b97f4a7c15ULL;
+  v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  v = (v ^ (v >> 27)) * 0x94d049bb133111ebULL;
+  return v ^ (v >> 31);
+}
+
+/**
+ * stable LSD radix sort of the indexes by the 64-bit keys
+ */
+DFM2_INLINE void SortIndex_RadixKey64(
+    std::vector<unsigned int> &index,
+    std::vector<std::uint64_t> &key) {
+  const size_t n = key.size();
+  index.resize(n);
+  for (unsigned int i = 0; i < n; ++i) { index[i] = i; }
+  std::vector<unsigned int> index_tmp(n);
+  std::vector<std::uint64_t> key_tmp(n);
+  for (unsigned int ishift = 0; ishift < 64; ishift += 16) {
+    std::vector<unsigned int> count(0x10000 + 1, 0);
+    for (size_t i = 0; i < n; ++i) { count[((key[i] >> ishift) & 0xffff) + 1] += 1; }
+    if (*std::max_element(count.begin(), count.end()) == n) { continue; }  // the same digit for all
+    for (unsigned int i = 0; i < 0x10000; ++i) { count[i + 1] += count[i]; }
+    for (size_t i = 0; i < n; ++i) {
+      const unsigned int j = count[(key[i] >> ishift) & 0xffff]++;
+      key_tmp[j] = key[i];
+      index_tmp[j] = index[i];
+    }
+    key.swap(key_tmp);
+    index.swap(index_tmp);
+  }
+}
+
+/**
+ * biased randomized insertion order. The round of a point is put above the bits of the Hilbert key.
+ * In 3D, the lowest bits of the key are dropped to make room for the round.
+ */
+template<unsigned int NDIM>
+void Permutation_BRIO(
+    std::vector<unsigned int> &new2old,
+    const double *xyz,
+    size_t num_point,
+    unsigned int seed,
+    unsigned int num_thread) {
+  constexpr unsigned int kMaxRound = 20;
+  constexpr unsigned int kNumBitRound = 5;
+  constexpr unsigned int kNumBitKey = std::min(NDIM * kNumBit, 64 - kNumBitRound);
+  std::vector<std::uint64_t> key;
+  Key_SpaceFillingCurve<NDIM>(key, xyz, num_point, SPACE_FILLING_CURVE::HILBERT, num_thread);
+  const std::uint64_t salt = HashInteger(seed);
+  for (size_t ip = 0; ip < num_point; ++ip) {
+    // the point goes to the last round with probability 1/2, to the round before with 1/4, ...
+    std::uint64_t h = HashInteger(ip ^ salt);
+    unsigned int iround = 0;
+    while ((h & 1) == 0 && iround < kMaxRound) {
+      h >>= 1;
+      ++iround;
+    }
+    key[ip] = (key[ip] >> (NDIM * kNumBit - kNumBitKey)) | (std::uint64_t(kMaxRound - iround) << kNumBitKey);
+  }
+  SortIndex_RadixKey64(new2old, key);
+}
+
+// ------------------------
+// Forsyth's vertex cache optimization
+
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+DFM2_INLINE float VertexScore(
+    int icache,
+    unsigned int num_tri_active,
+    unsigned int cache_size) {
+  if (num_tri_active == 0) { return -1.f; }  // no triangle needs this vertex
+  float score = 0.f;
+  if (icache >= 0) {
+    if (icache < 3) {  // used by the last triangle
+      score = kLastTriScore;
+    } else {
+      const float s = 1.f - float(icache - 3) / float(cache_size - 3);
+      score = std::pow(s, kCacheDecayPower);
+    }
+  }
+  score += kValenceBoostScale * std::pow(float(num_tri_active), -kValenceBoostPower);
+  return score;
+}
+
+}  // namespace delfem2::msh_reorder
+
+// ------------------------------------------
+
+DFM2_INLINE void delfem2::Permutation_SpaceFillingCurve3(
+    std::vector<unsigned int> &new2old,
+    const double *xyz,
+    size_t num_point,
+    SPACE_FILLING_CURVE curve,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_reorder;
+  std::vector<std::uint64_t> key;
+  lcl::Key_SpaceFillingCurve<3>(key, xyz, num_point, curve, num_thread);
+  lcl::SortIndex_RadixKey64(new2old, key);
+}
+
+DFM2_INLINE void delfem2::Permutation_SpaceFillingCurve2(
+    std::vector<unsigned int> &new2old,
+    const double *xy,
+    size_t num_point,
+    SPACE_FILLING_CURVE curve,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_reorder;
+  std::vector<std::uint64_t> key;
+  lcl::Key_SpaceFillingCurve<2>(key, xy, num_point, curve, num_thread);
+  lcl::SortIndex_RadixKey64(new2old, key);
+}
+
+DFM2_INLINE void delfem2::Permutation_BRIO2(
+    std::vector<unsigned int> &new2old,
+    const double *xy,
+    size_t num_point,
+    unsigned int seed,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_reorder;
+  lcl::Permutation_BRIO<2>(new2old, xy, num_point, seed, num_thread);
+}
+
+DFM2_INLINE void delfem2::Permutation_BRIO3(
+    std::vector<unsigned int> &new2old,
+    const double *xyz,
+    size_t num_point,
+    unsigned int seed,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_reorder;
+  lcl::Permutation_BRIO<3>(new2old, xyz, num_point, seed, num_thread);
+}
+
+DFM2_INLINE void delfem2::Permutation_TriForsyth(
+    std::vector<unsigned int> &new2old,
+    const unsigned int *tri_vtx,
+    size_t num_tri,
+    size_t num_vtx,
+    unsigned int cache_size) {
+  namespace lcl = ::delfem2::msh_reorder;
+  assert(cache_size > 3);
+  // the triangles not yet added are stored at the front of each row
+  std::vector<unsigned int> elsup_ind, elsup;
+  JArray_ElSuP_MeshElem(
+      elsup_ind, elsup,
+      tri_vtx, num_tri, 3, num_vtx);
+  std::vector<unsigned int> vtx_ntri(num_vtx);  // number of the triangles not yet added
+  std::vector<int> vtx_icache(num_vtx, -1);
+  std::vector<float> vtx_score(num_vtx);
+  for (unsigned int iv = 0; iv < num_vtx; ++iv) {
+    vtx_ntri[iv] = elsup_ind[iv + 1] - elsup_ind[iv];
+    vtx_score[iv] = lcl::VertexScore(-1, vtx_ntri[iv], cache_size);
+  }
+  std::vector<float> tri_score(num_tri);
+  for (unsigned int it = 0; it < num_tri; ++it) {
+    tri_score[it] = vtx_score[tri_vtx[it * 3 + 0]] + vtx_score[tri_vtx[it * 3 + 1]] + vtx_score[tri_vtx[it * 3 + 2]];
+  }
+  std::vector<char> tri_added(num_tri, 0);
+  std::vector<unsigned int> cache, cache_new;
+  cache.reserve(cache_size + 3);
+  cache_new.reserve(cache_size + 3);
+  new2old.clear();
+  new2old.reserve(num_tri);
+  unsigned int itri_best = num_tri > 0 ? 0 : UINT_MAX;
+  unsigned int itri_cursor = 0;  // triangles before this are already added
+  while (new2old.size() < num_tri) {
+    if (itri_best == UINT_MAX) {  // no candidate in the cache
+      while (tri_added[itri_cursor]) { ++itri_cursor; }
+      itri_best = itri_cursor;
+    }
+    const unsigned int itri = itri_best;
+    new2old.push_back(itri);
+    tri_added[itri] = 1;
+    // the vertices of the added triangle come to the front of the cache
+    cache_new.assign(tri_vtx + itri * 3, tri_vtx + itri * 3 + 3);
+    for (unsigned int iv: cache) {
+      if (iv != cache_new[0] && iv != cache_new[1] && iv != cache_new[2]) { cache_new.push_back(iv); }
+    }
+    for (unsigned int inode = 0; inode < 3; ++inode) {
+      const unsigned int iv = tri_vtx[itri * 3 + inode];
+      unsigned int *row = elsup.data() + elsup_ind[iv];
+      std::swap(*std::find(row, row + vtx_ntri[iv], itri), row[vtx_ntri[iv] - 1]);
+      vtx_ntri[iv] -= 1;
+    }
+    // update the scores of the vertices in the cache and the vertices evicted from the cache
+    for (unsigned int icache = 0; icache < cache_new.size(); ++icache) {
+      const unsigned int iv = cache_new[icache];
+      vtx_icache[iv] = (icache < cache_size) ? static_cast<int>(icache) : -1;
+      vtx_score[iv] = lcl::VertexScore(vtx_icache[iv], vtx_ntri[iv], cache_size);
+    }
+    itri_best = UINT_MAX;
+    float score_best = -1.f;
+    for (unsigned int iv: cache_new) {
+      for (unsigned int i = elsup_ind[iv]; i < elsup_ind[iv] + vtx_ntri[iv]; ++i) {
+        const unsigned int jt = elsup[i];
+        tri_score[jt] = vtx_score[tri_vtx[jt * 3 + 0]] + vtx_score[tri_vtx[jt * 3 + 1]] + vtx_score[tri_vtx[jt * 3 + 2]];
+        if (tri_score[jt] > score_best) {
+          score_best = tri_score[jt];
+          itri_best = jt;
+        }
+      }
+    }
+    if (cache_new.size() > cache_size) { cache_new.resize(cache_size); }
+    cache.swap(cache_new);
+  }
+}
+
+DFM2_INLINE void delfem2::InversePermutation(
+    std::vector<unsigned int> &old2new,
+    const std::vector<unsigned int> &new2old) {
+  old2new.assign(new2old.size(), UINT_MAX);
+  for (unsigned int inew = 0; inew < new2old.size(); ++inew) {
+    assert(new2old[inew] < new2old.size() && old2new[new2old[inew]] == UINT_MAX);
+    old2new[new2old[inew]] = inew;
+  }
+}
+
+template<typename T>
+DFM2_INLINE void delfem2::PermuteValue(
+    std::vector<T> &val,
+    const std::vector<unsigned int> &new2old,
+    unsigned int ndim) {
+  assert(val.size() == new2old.size() * ndim);
+  std::vector<T> val_old;
+  val_old.swap(val);
+  val.resize(val_old.size());
+  for (unsigned int inew = 0; inew < new2old.size(); ++inew) {
+    const unsigned int iold = new2old[inew];
+    for (unsigned int idim = 0; idim < ndim; ++idim) {
+      val[inew * ndim + idim] = val_old[iold * ndim + idim];
+    }
+  }
+}
+#ifdef DFM2_STATIC_LIBRARY
+template void delfem2::PermuteValue(std::vector<double> &, const std::vector<unsigned int> &, unsigned int);
+template void delfem2::PermuteValue(std::vector<float> &, const std::vector<unsigned int> &, unsigned int);
+template void delfem2::PermuteValue(std::vector<int> &, const std::vector<unsigned int> &, unsigned int);
+template void delfem2::PermuteValue(std::vector<unsigned int> &, const std::vector<unsigned int> &, unsigned int);
+#endif
+
+DFM2_INLINE void delfem2::RenumberVertex_MeshElem(
+    std::vector<unsigned int> &elem_vtx,
+    const std::vector<unsigned int> &vtx_old2new) {
+  for (unsigned int &iv: elem_vtx) {
+    assert(iv < vtx_old2new.size());
+    iv = vtx_old2new[iv];
+  }
+}
+
+DFM2_INLINE void delfem2::Reorder_MeshElem3(
+    std::vector<unsigned int> &vtx_new2old,
+    std::vector<unsigned int> &elem_new2old,
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &elem_vtx,
+    unsigned int nnode_elem,
+    SPACE_FILLING_CURVE curve,
+    unsigned int num_thread) {
+  const size_t nvtx = vtx_xyz.size() / 3;
+  const size_t nelem = elem_vtx.size() / nnode_elem;
+  Permutation_SpaceFillingCurve3(
+      vtx_new2old,
+      vtx_xyz.data(), nvtx, curve, num_thread);
+  {
+    std::vector<unsigned int> vtx_old2new;
+    InversePermutation(vtx_old2new, vtx_new2old);
+    RenumberVertex_MeshElem(elem_vtx, vtx_old2new);
+  }
+  PermuteValue(vtx_xyz, vtx_new2old, 3);
+  if (nnode_elem == 3) {
+    Permutation_TriForsyth(
+        elem_new2old,
+        elem_vtx.data(), nelem, nvtx);
+  } else {
+    std::vector<double> elem_cntr(nelem * 3, 0.0);
+    for (unsigned int ielem = 0; ielem < nelem; ++ielem) {
+      for (unsigned int inode = 0; inode < nnode_elem; ++inode) {
+        const unsigned int iv = elem_vtx[ielem * nnode_elem + inode];
+        for (unsigned int idim = 0; idim < 3; ++idim) {
+          elem_cntr[ielem * 3 + idim] += vtx_xyz[iv * 3 + idim] / nnode_elem;
+        }
+      }
+    }
+    Permutation_SpaceFillingCurve3(
+        elem_new2old,
+        elem_cntr.data(), nelem, curve, num_thread);
+  }
+  PermuteValue(elem_vtx, elem_new2old, nnode_elem);
+}
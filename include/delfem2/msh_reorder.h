@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file reordering of vertices and elements of a mesh for the memory locality
+ * @details a reordering is represented by the permutation "new2old" (new index -> old index).
+ * The inverse permutation "old2new" maps the results computed on the reordered mesh back to the original order.
+ * @code
+ * std::vector<unsigned int> vtx_new2old, tri_new2old;
+ * Reorder_MeshElem3(vtx_new2old, tri_new2old, vtx_xyz, tri_vtx, 3);
+ * PermuteValue(vtx_uv, vtx_new2old, 2); // attached per-vertex array
+ * ...
+ * std::vector<unsigned int> vtx_old2new;
+ * InversePermutation(vtx_old2new, vtx_new2old);
+ * PermuteValue(vtx_disp, vtx_old2new, 3); // result in the original order
+ * @endcode
+ */
+
+#ifndef DFM2_MSH_REORDER_H
+#define DFM2_MSH_REORDER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+enum class SPACE_FILLING_CURVE {
+  MORTON,
+  HILBERT
+};
+
+/**
+ * @brief order of 3D points along a space filling curve
+ * @details the points are quantized with 21 bits per axis in the bounding cube.
+ * Points with the same key are kept in the original order.
+ * @param[out] new2old permutation (new index -> old index)
+ * @param num_thread number of threads to compute the keys. "0" means the number of hardware threads.
+ */
+DFM2_INLINE void Permutation_SpaceFillingCurve3(
+    std::vector<unsigned int> &new2old,
+    const double *xyz,
+    size_t num_point,
+    SPACE_FILLING_CURVE curve,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief order of 2D points along a space filling curve
+ * @details same as "Permutation_SpaceFillingCurve3" for the points "xy" with two values per point
+ */
+DFM2_INLINE void Permutation_SpaceFillingCurve2(
+    std::vector<unsigned int> &new2old,
+    const double *xy,
+    size_t num_point,
+    SPACE_FILLING_CURVE curve,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief biased randomized insertion order (BRIO) of 2D points for the incremental Delaunay triangulation
+ * @details the points are randomly split into rounds where each round has about twice as many points as the previous one.
+ * The points in a round are sorted along the Hilbert curve.
+ * The randomness keeps the expected cost of the insertion low, and the curve keeps the walk of the point location short.
+ * N. Amenta, S. Choi, and G. Rote, "Incremental constructions con BRIO", SoCG 2003
+ * @param seed seed of the random rounds. The order is reproducible for the same seed.
+ */
+DFM2_INLINE void Permutation_BRIO2(
+    std::vector<unsigned int> &new2old,
+    const double *xy,
+    size_t num_point,
+    unsigned int seed = 0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief biased randomized insertion order of 3D points for the incremental Delaunay tetrahedralization
+ * @details same as "Permutation_BRIO2". The points in a round are sorted along the Hilbert curve
+ * without the lowest 4 bits of the key used in "Permutation_SpaceFillingCurve3".
+ */
+DFM2_INLINE void Permutation_BRIO3(
+    std::vector<unsigned int> &new2old,
+    const double *xyz,
+    size_t num_point,
+    unsigned int seed = 0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief triangle order for the post-transform vertex cache (Forsyth's linear-speed optimization)
+ * @param[out] new2old permutation of triangles (new index -> old index)
+ * @param cache_size size of the simulated LRU vertex cache
+ */
+DFM2_INLINE void Permutation_TriForsyth(
+    std::vector<unsigned int> &new2old,
+    const unsigned int *tri_vtx,
+    size_t num_tri,
+    size_t num_vtx,
+    unsigned int cache_size = 32);
+
+DFM2_INLINE void InversePermutation(
+    std::vector<unsigned int> &old2new,
+    const std::vector<unsigned int> &new2old);
+
+/**
+ * @brief reorder an array with "ndim" values per entity as val_new[i] = val_old[new2old[i]].
+ * @details defined for "double", "float", "int" and "unsigned int".
+ * Passing "old2new" instead maps the values back to the original order.
+ */
+template<typename T>
+DFM2_INLINE void PermuteValue(
+    std::vector<T> &val,
+    const std::vector<unsigned int> &new2old,
+    unsigned int ndim);
+
+/**
+ * @brief replace the vertex indexes in the connectivity as elem_vtx[i] = old2new[elem_vtx[i]]
+ */
+DFM2_INLINE void RenumberVertex_MeshElem(
+    std::vector<unsigned int> &elem_vtx,
+    const std::vector<unsigned int> &vtx_old2new);
+
+/**
+ * @brief reorder vertices along a space filling curve and then reorder elements
+ * @details triangles are ordered for the vertex cache. The other elements are ordered by their centers along the curve.
+ * Per-vertex and per-element arrays attached to the mesh need to be reordered with "PermuteValue".
+ * @param[out] vtx_new2old permutation of vertices
+ * @param[out] elem_new2old permutation of elements
+ * @param[in,out] vtx_xyz coordinates of the vertices
+ * @param[in,out] elem_vtx connectivity of the elements
+ * @param nnode_elem number of nodes of an element (e.g., 3 for triangle, 4 for tetrahedron)
+ */
+DFM2_INLINE void Reorder_MeshElem3(
+    std::vector<unsigned int> &vtx_new2old,
+    std::vector<unsigned int> &elem_new2old,
+    std::vector<double> &vtx_xyz,
+    std::vector<unsigned int> &elem_vtx,
+    unsigned int nnode_elem,
+    SPACE_FILLING_CURVE curve = SPACE_FILLING_CURVE::HILBERT,
+    unsigned int num_thread = 0);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/msh_reorder.cpp"
+#endif
+
+#endif // DFM2_MSH_REORDER_H
@@ -14,6 +14,43 @@
 #include <climits>
 #include <algorithm>
 
+#include "delfem2/jagarray.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::msh_topology_uniform {
+
+//! minimum number of points or elements processed by a thread
+constexpr size_t kNumRowBlock = 1 << 12;
+
+/**
+ * build a jagged array whose rows are [0, num_row) by counting the values in the first pass and storing them in the second.
+ * "visit(irow0, irow1, func)" needs to call "func(irow, value)" for the values of the rows in [irow0, irow1)
+ * in the same order in both passes.
+ */
+template<typename VISIT>
+void JArray_CountAndFill(
+    std::vector<unsigned int> &index,
+    std::vector<unsigned int> &value,
+    size_t num_row,
+    VISIT &&visit,
+    unsigned int num_thread) {
+  const unsigned int nblock = num_block_for_thread(num_row, kNumRowBlock, num_thread);
+  index.assign(num_row + 1, 0);
+  parallel_for_block(num_row, nblock, [&](unsigned int, size_t ir0, size_t ir1) {
+    visit(ir0, ir1, [&](unsigned int ir, unsigned int) { index[ir + 1]++; });
+  });
+  for (size_t ir = 0; ir < num_row; ++ir) {
+    index[ir + 1] += index[ir];
+  }
+  value.resize(index[num_row]);
+  parallel_for_block(num_row, nblock, [&](unsigned int, size_t ir0, size_t ir1) {
+    std::vector<unsigned int> cursor(index.begin() + ir0, index.begin() + ir1);
+    visit(ir0, ir1, [&](unsigned int ir, unsigned int v) { value[cursor[ir - ir0]++] = v; });
+  });
+}
+
+}  // namespace delfem2::msh_topology_uniform
+
 // ---------------------------------------------
 
 DFM2_INLINE void delfem2::JArray_ElSuP_MeshElem(
@@ -23,7 +60,19 @@ DFM2_INLINE void delfem2::JArray_ElSuP_MeshElem(
     const unsigned int *elem_vtx_idx,
     size_t num_elem,
     unsigned int num_vtx_par_elem,
-    size_t num_vtx) {
+    size_t num_vtx,
+    unsigned int num_thread) {
+  if (num_thread != 1) {
+    // transpose of the connectivity whose rows have the same length
+    std::vector<unsigned int> elem_ind(num_elem + 1);
+    for (unsigned int ielem = 0; ielem < num_elem + 1; ++ielem) {
+      elem_ind[ielem] = ielem * num_vtx_par_elem;
+    }
+    JArray_Transpose(
+        elsup_ind, elsup,
+        elem_ind.data(), num_elem, elem_vtx_idx, num_vtx, num_thread);
+    return;
+  }
   elsup_ind.assign(num_vtx + 1, 0);
   for (unsigned int ielem = 0; ielem < num_elem; ielem++) {
     for (unsigned int inoel = 0; inoel < num_vtx_par_elem; inoel++) {
@@ -154,7 +203,9 @@ DFM2_INLINE void delfem2::ElSuEl_MeshElem(
     const std::vector<unsigned int> &elsup,
     const int num_face_par_elem,
     const int num_vtx_on_face,
-    const int (*vtx_on_elem_face)[4]) {
+    const int (*vtx_on_elem_face)[4],
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_topology_uniform;
   assert(!elsup_ind.empty());
   const std::size_t np = elsup_ind.size() - 1;
 
@@ -162,47 +213,50 @@ DFM2_INLINE void delfem2::ElSuEl_MeshElem(
       num_elem * num_face_par_elem,
       UINT_MAX);
 
-  std::vector<int> flg_point(np, 0);
-  std::vector<unsigned int> inpofa(num_vtx_on_face);
-  for (unsigned int iel = 0; iel < num_elem; iel++) {
-    for (int ifael = 0; ifael < num_face_par_elem; ifael++) {
-      for (int ipofa = 0; ipofa < num_vtx_on_face; ipofa++) {
-        int int0 = vtx_on_elem_face[ifael][ipofa];
-        const unsigned int ip = elem_vtx_idx[iel * nNoEl + int0];
-        assert(ip < np);
-        inpofa[ipofa] = ip;
-        flg_point[ip] = 1;
-      }
-      const unsigned int ipoin0 = inpofa[0];
-      bool iflg = false;
-      for (unsigned int ielsup = elsup_ind[ipoin0]; ielsup < elsup_ind[ipoin0 + 1]; ielsup++) {
-        const unsigned int jelem0 = elsup[ielsup];
-        if (jelem0 == iel) continue;
-        for (int jfael = 0; jfael < num_face_par_elem; jfael++) {
-          iflg = true;
-          for (int jpofa = 0; jpofa < num_vtx_on_face; jpofa++) {
-            int jnt0 = vtx_on_elem_face[jfael][jpofa];
-            const unsigned int jpoin0 = elem_vtx_idx[jelem0 * nNoEl + jnt0];
-            if (flg_point[jpoin0] == 0) {
-              iflg = false;
+  const unsigned int nblock = num_block_for_thread(num_elem, lcl::kNumRowBlock, num_thread);
+  parallel_for_block(num_elem, nblock, [&](unsigned int, size_t iel0, size_t iel1) {
+    std::vector<int> flg_point(np, 0);
+    std::vector<unsigned int> inpofa(num_vtx_on_face);
+    for (auto iel = static_cast<unsigned int>(iel0); iel < iel1; iel++) {
+      for (int ifael = 0; ifael < num_face_par_elem; ifael++) {
+        for (int ipofa = 0; ipofa < num_vtx_on_face; ipofa++) {
+          int int0 = vtx_on_elem_face[ifael][ipofa];
+          const unsigned int ip = elem_vtx_idx[iel * nNoEl + int0];
+          assert(ip < np);
+          inpofa[ipofa] = ip;
+          flg_point[ip] = 1;
+        }
+        const unsigned int ipoin0 = inpofa[0];
+        bool iflg = false;
+        for (unsigned int ielsup = elsup_ind[ipoin0]; ielsup < elsup_ind[ipoin0 + 1]; ielsup++) {
+          const unsigned int jelem0 = elsup[ielsup];
+          if (jelem0 == iel) continue;
+          for (int jfael = 0; jfael < num_face_par_elem; jfael++) {
+            iflg = true;
+            for (int jpofa = 0; jpofa < num_vtx_on_face; jpofa++) {
+              int jnt0 = vtx_on_elem_face[jfael][jpofa];
+              const unsigned int jpoin0 = elem_vtx_idx[jelem0 * nNoEl + jnt0];
+              if (flg_point[jpoin0] == 0) {
+                iflg = false;
+                break;
+              }
+            }
+            if (iflg) {
+              elsuel[iel * num_face_par_elem + ifael] = jelem0;
               break;
             }
           }
-          if (iflg) {
-            elsuel[iel * num_face_par_elem + ifael] = jelem0;
-            break;
-          }
+          if (iflg) break;
+        }
+        if (!iflg) {
+          elsuel[iel * num_face_par_elem + ifael] = UINT_MAX;
+        }
+        for (int ipofa = 0; ipofa < num_vtx_on_face; ipofa++) {
+          flg_point[inpofa[ipofa]] = 0;
         }
-        if (iflg) break;
-      }
-      if (!iflg) {
-        elsuel[iel * num_face_par_elem + ifael] = UINT_MAX;
-      }
-      for (int ipofa = 0; ipofa < num_vtx_on_face; ipofa++) {
-        flg_point[inpofa[ipofa]] = 0;
       }
     }
-  }
+  });
 }
 
 /*
@@ -228,19 +282,20 @@ DFM2_INLINE void delfem2::ElSuEl_MeshElem(
     const unsigned int *elem_vtx_idx,
     size_t num_elem,
     MESHELEM_TYPE type,
-    const size_t num_vtx) {
+    const size_t num_vtx,
+    unsigned int num_thread) {
   const int nNoEl = nNodeElem(type);
   std::vector<unsigned int> elsup_ind, elsup;
   JArray_ElSuP_MeshElem(
       elsup_ind, elsup,
-      elem_vtx_idx, num_elem, nNoEl, num_vtx);
+      elem_vtx_idx, num_elem, nNoEl, num_vtx, num_thread);
   const int nfael = nFaceElem(type);
   const int nnofa = nNodeElemFace(type, 0);
   ElSuEl_MeshElem(
       aElSuEl,
       elem_vtx_idx, num_elem, nNoEl,
       elsup_ind, elsup,
-      nfael, nnofa, noelElemFace(type));
+      nfael, nnofa, noelElemFace(type), num_thread);
   assert(aElSuEl.size() == num_elem * nfael);
 }
 
@@ -255,47 +310,27 @@ DFM2_INLINE void delfem2::JArrayPointSurPoint_MeshOneRingNeighborhood(
     const std::vector<unsigned int> &elsup_ind,
     const std::vector<unsigned int> &elsup,
     unsigned int num_vtx_par_elem,
-    size_t num_vtx) {
-  std::vector<unsigned int> aflg(num_vtx, UINT_MAX);
-  psup_ind.assign(num_vtx + 1, 0);
-  for (unsigned int ipoint = 0; ipoint < num_vtx; ipoint++) {
-    aflg[ipoint] = ipoint;
-    for (unsigned int ielsup = elsup_ind[ipoint]; ielsup < elsup_ind[ipoint + 1]; ielsup++) {
-      unsigned int jelem = elsup[ielsup];
-      for (unsigned int jnoel = 0; jnoel < num_vtx_par_elem; jnoel++) {
-        unsigned int jnode = elem_vtx[jelem * num_vtx_par_elem + jnoel];
-        if (aflg[jnode] != ipoint) {
-          aflg[jnode] = ipoint;
-          psup_ind[ipoint + 1]++;
-        }
-      }
-    }
-  }
-  for (unsigned int ipoint = 0; ipoint < num_vtx; ipoint++) {
-    psup_ind[ipoint + 1] += psup_ind[ipoint];
-  }
-  const unsigned int npsup = psup_ind[num_vtx];
-  psup.resize(npsup);
-  for (unsigned int ipoint = 0; ipoint < num_vtx; ipoint++) { aflg[ipoint] = UINT_MAX; }
-  for (unsigned int ipoint = 0; ipoint < num_vtx; ipoint++) {
-    aflg[ipoint] = ipoint;
-    for (unsigned int ielsup = elsup_ind[ipoint]; ielsup < elsup_ind[ipoint + 1]; ielsup++) {
-      unsigned int jelem = elsup[ielsup];
-      for (unsigned int jnoel = 0; jnoel < num_vtx_par_elem; jnoel++) {
-        unsigned int jnode = elem_vtx[jelem * num_vtx_par_elem + jnoel];
-        if (aflg[jnode] != ipoint) {
-          aflg[jnode] = ipoint;
-          const unsigned int ind = psup_ind[ipoint];
-          psup[ind] = jnode;
-          psup_ind[ipoint]++;
+    size_t num_vtx,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_topology_uniform;
+  // call func(ipoint, jnode) for each point "jnode" around "ipoint" in the order of the first appearance
+  auto visit_one_ring = [&](size_t ip0, size_t ip1, auto &&func) {
+    std::vector<unsigned int> aflg(num_vtx, UINT_MAX);
+    for (auto ipoint = static_cast<unsigned int>(ip0); ipoint < ip1; ipoint++) {
+      aflg[ipoint] = ipoint;
+      for (unsigned int ielsup = elsup_ind[ipoint]; ielsup < elsup_ind[ipoint + 1]; ielsup++) {
+        unsigned int jelem = elsup[ielsup];
+        for (unsigned int jnoel = 0; jnoel < num_vtx_par_elem; jnoel++) {
+          unsigned int jnode = elem_vtx[jelem * num_vtx_par_elem + jnoel];
+          if (aflg[jnode] != ipoint) {
+            aflg[jnode] = ipoint;
+            func(ipoint, jnode);
+          }
         }
       }
     }
-  }
-  for (int ipoint = (int) num_vtx; ipoint > 0; --ipoint) {
-    psup_ind[ipoint] = psup_ind[ipoint - 1];
-  }
-  psup_ind[0] = 0;
+  };
+  lcl::JArray_CountAndFill(psup_ind, psup, num_vtx, visit_one_ring, num_thread);
 }
 
 DFM2_INLINE void delfem2::JArray_PSuP_MeshElem(
@@ -305,14 +340,68 @@ DFM2_INLINE void delfem2::JArray_PSuP_MeshElem(
     const unsigned int *elem_vtx,
     size_t num_elm,
     unsigned int num_vtx_par_elem,
-    size_t num_vtx) {
+    size_t num_vtx,
+    unsigned int num_thread) {
   std::vector<unsigned int> elsup_ind, elsup;
   JArray_ElSuP_MeshElem(
       elsup_ind, elsup,
-      elem_vtx, num_elm, num_vtx_par_elem, num_vtx);
+      elem_vtx, num_elm, num_vtx_par_elem, num_vtx, num_thread);
   JArrayPointSurPoint_MeshOneRingNeighborhood(
       psup_ind, psup,
-      elem_vtx, elsup_ind, elsup, num_vtx_par_elem, num_vtx);
+      elem_vtx, elsup_ind, elsup, num_vtx_par_elem, num_vtx, num_thread);
+}
+
+DFM2_INLINE void delfem2::JArray_ElemColoring_MeshElem(
+    std::vector<unsigned int> &color_ind,
+    std::vector<unsigned int> &color_elem,
+    //
+    const unsigned int *elem_vtx,
+    size_t num_elm,
+    unsigned int num_vtx_par_elem,
+    size_t num_vtx) {
+  std::vector<unsigned int> elsup_ind, elsup;
+  JArray_ElSuP_MeshElem(
+      elsup_ind, elsup,
+      elem_vtx, num_elm, num_vtx_par_elem, num_vtx);
+  std::vector<unsigned int> elem_color(num_elm, UINT_MAX);
+  std::vector<unsigned int> color_flag; // color_flag[icolor] == ielem if the color is used around ielem
+  unsigned int num_color = 0;
+  for (unsigned int ielem = 0; ielem < num_elm; ++ielem) {
+    for (unsigned int inoel = 0; inoel < num_vtx_par_elem; ++inoel) {
+      const unsigned int ip = elem_vtx[ielem * num_vtx_par_elem + inoel];
+      for (unsigned int ielsup = elsup_ind[ip]; ielsup < elsup_ind[ip + 1]; ++ielsup) {
+        const unsigned int jcolor = elem_color[elsup[ielsup]];
+        if (jcolor == UINT_MAX) { continue; }
+        color_flag[jcolor] = ielem;
+      }
+    }
+    unsigned int icolor = 0;
+    for (; icolor < num_color; ++icolor) {
+      if (color_flag[icolor] != ielem) { break; }
+    }
+    if (icolor == num_color) {
+      num_color++;
+      color_flag.push_back(UINT_MAX);
+    }
+    elem_color[ielem] = icolor;
+  }
+  color_ind.assign(num_color + 1, 0);
+  for (unsigned int ielem = 0; ielem < num_elm; ++ielem) {
+    color_ind[elem_color[ielem] + 1] += 1;
+  }
+  for (unsigned int icolor = 0; icolor < num_color; ++icolor) {
+    color_ind[icolor + 1] += color_ind[icolor];
+  }
+  color_elem.resize(num_elm);
+  for (unsigned int ielem = 0; ielem < num_elm; ++ielem) {
+    const unsigned int icolor = elem_color[ielem];
+    color_elem[color_ind[icolor]] = ielem;
+    color_ind[icolor] += 1;
+  }
+  for (unsigned int icolor = num_color; icolor >= 1; --icolor) {
+    color_ind[icolor] = color_ind[icolor - 1];
+  }
+  color_ind[0] = 0;
 }
 
 DFM2_INLINE void delfem2::makeOneRingNeighborhood_TriFan(
@@ -366,11 +455,37 @@ DFM2_INLINE void delfem2::JArrayEdge_MeshElem(
     MESHELEM_TYPE elem_type,
     const std::vector<unsigned int> &elsup_ind,
     const std::vector<unsigned int> &elsup,
-    bool is_bidirectional) {
+    bool is_bidirectional,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_topology_uniform;
   const int neElm = mapMeshElemType2NEdgeElem[elem_type];
   const int nnoelElm = mapMeshElemType2NNodeElem[elem_type];
   const int (*aNoelEdge)[2] = noelElemEdge(elem_type);
   const std::size_t nPoint0 = elsup_ind.size() - 1;
+  if (num_thread != 1) {
+    // call func(ip, jp) for each edge in the order of the first appearance
+    auto visit_edge = [&](size_t ip0, size_t ip1, auto &&func) {
+      std::vector<unsigned int> aflg(nPoint0, UINT_MAX);
+      for (auto ip = static_cast<unsigned int>(ip0); ip < ip1; ++ip) {
+        for (unsigned int ielsup = elsup_ind[ip]; ielsup < elsup_ind[ip + 1]; ++ielsup) {
+          const unsigned int iq0 = elsup[ielsup];
+          for (int ie = 0; ie < neElm; ++ie) {
+            const unsigned int jp0 = elem_vtx[iq0 * nnoelElm + aNoelEdge[ie][0]];
+            const unsigned int jp1 = elem_vtx[iq0 * nnoelElm + aNoelEdge[ie][1]];
+            if (jp0 != ip && jp1 != ip) continue;
+            const unsigned int jp = (jp0 == ip) ? jp1 : jp0;
+            if (!is_bidirectional && jp <= ip) { continue; }
+            if (aflg[jp] == ip) { continue; }
+            aflg[jp] = ip;
+            func(ip, jp);
+          }
+        }
+      }
+    };
+    lcl::JArray_CountAndFill(edge_ind, edge, nPoint0, visit_edge, num_thread);
+    JArray_Sort(edge_ind, edge, num_thread);
+    return;
+  }
   edge_ind.resize(nPoint0 + 1);
   edge_ind[0] = 0;
   for (unsigned int ip = 0; ip < nPoint0; ++ip) {
@@ -58,6 +58,9 @@ DFM2_INLINE void FlipElement_Tri(
 
 /**
  * make elem surrounding point
+ * @details the elements in each row are sorted in ascending order
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ * The output is independent of the number of threads.
  */
 DFM2_INLINE void JArray_ElSuP_MeshElem(
     std::vector<unsigned int> &elsup_ind,
@@ -66,7 +69,8 @@ DFM2_INLINE void JArray_ElSuP_MeshElem(
     const unsigned int *elem_vtx_idx,
     size_t num_elem,
     unsigned int num_vtx_par_elem,
-    size_t num_vtx);
+    size_t num_vtx,
+    unsigned int num_thread = 1);
 
 /**
  * @brief make elem surrounding point for triangle mesh
@@ -93,6 +97,7 @@ DFM2_INLINE void JArray_ElSuP_MeshTri(
  * @param[in] num_face_par_elem number of neibouring elements
  * @param[in] num_vtx_on_face how many nodes are shared with a nighbouring element
  * @param vtx_on_elem_face
+ * @param num_thread number of threads. "0" means the number of hardware threads.
  */
 DFM2_INLINE void ElSuEl_MeshElem(
     std::vector<unsigned int> &elsuel,
@@ -103,7 +108,8 @@ DFM2_INLINE void ElSuEl_MeshElem(
     const std::vector<unsigned int> &elsup,
     const int num_face_par_elem,
     const int num_vtx_on_face,
-    const int (*vtx_on_elem_face)[4]);
+    const int (*vtx_on_elem_face)[4],
+    unsigned int num_thread = 1);
 
 /**
  * @brief compute adjacent element index for mesh element
@@ -112,19 +118,23 @@ DFM2_INLINE void ElSuEl_MeshElem(
  * @param[in] num_elem number of elements
  * @param[in] type type of element
  * @param[in] num_vtx number of points
+ * @param[in] num_thread number of threads. "0" means the number of hardware threads.
  */
 DFM2_INLINE void ElSuEl_MeshElem(
     std::vector<unsigned int> &aElSuEl,
     const unsigned int *elem_vtx_idx,
     size_t num_elem,
     delfem2::MESHELEM_TYPE type,
-    const size_t num_vtx);
+    const size_t num_vtx,
+    unsigned int num_thread = 1);
 
 /**
  * @brief make point surrounding point
  * @details psup -> edge bidirectional
  * edge unidir (ip0<ip1)
  * line (array of 2)
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ * The output is independent of the number of threads.
  */
 DFM2_INLINE void JArrayPointSurPoint_MeshOneRingNeighborhood(
     std::vector<unsigned int> &psup_ind,
@@ -134,11 +144,13 @@ DFM2_INLINE void JArrayPointSurPoint_MeshOneRingNeighborhood(
     const std::vector<unsigned int> &elsup_ind,
     const std::vector<unsigned int> &elsup,
     unsigned int num_vtx_par_elem,
-    size_t num_vtx);
+    size_t num_vtx,
+    unsigned int num_thread = 1);
 
 /**
  * @brief compute indexes of points surrounding a point as a jagged array
  * @param num_vtx_par_elem number of nodes in an element
+ * @param num_thread number of threads. "0" means the number of hardware threads.
  */
 DFM2_INLINE void JArray_PSuP_MeshElem(
     std::vector<unsigned int> &psup_ind,
@@ -147,6 +159,22 @@ DFM2_INLINE void JArray_PSuP_MeshElem(
     const unsigned int *elem_vtx,
     size_t num_elm,
     unsigned int num_vtx_par_elem,
+    size_t num_vtx,
+    unsigned int num_thread = 1);
+
+/**
+ * @brief greedy coloring of elements such that elements sharing a vertex have different colors.
+ * @details elements of the same color can be processed concurrently without write conflicts on vertices
+ * @param[out] color_ind  jagged array index. the number of colors is color_ind.size()-1
+ * @param[out] color_elem element indexes sorted by the color
+ */
+DFM2_INLINE void JArray_ElemColoring_MeshElem(
+    std::vector<unsigned int> &color_ind,
+    std::vector<unsigned int> &color_elem,
+    //
+    const unsigned int *elem_vtx,
+    size_t num_elm,
+    unsigned int num_vtx_par_elem,
     size_t num_vtx);
 
 DFM2_INLINE void makeOneRingNeighborhood_TriFan(
@@ -159,6 +187,11 @@ DFM2_INLINE void makeOneRingNeighborhood_TriFan(
     const std::vector<int> &elsup,
     int np);
 
+/**
+ * @brief edges of the mesh as a jagged array. The points in each row are sorted in ascending order
+ * @param is_bidirectional if false, only the edges from a point to the points with larger indexes are listed
+ * @param num_thread number of threads. "0" means the number of hardware threads.
+ */
 DFM2_INLINE void JArrayEdge_MeshElem(
     std::vector<unsigned int> &edge_ind,
     std::vector<unsigned int> &edge,
@@ -167,7 +200,8 @@ DFM2_INLINE void JArrayEdge_MeshElem(
     delfem2::MESHELEM_TYPE elem_type,
     const std::vector<unsigned int> &elsup_ind,
     const std::vector<unsigned int> &elsup,
-    bool is_bidirectional);
+    bool is_bidirectional,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE void MeshLine_JArrayEdge(
     std::vector<unsigned int> &line_vtx,
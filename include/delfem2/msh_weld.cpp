@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/msh_weld.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "delfem2/thread.h"
+
+namespace delfem2::msh_weld {
+
+//! number of points processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 14;
+
+DFM2_INLINE std::uint64_t HashCell(const std::int64_t c[3]) {
+  std::uint64_t h = static_cast<std::uint64_t>(c[0]) * 0x9E3779B97F4A7C15ULL;
+  h ^= static_cast<std::uint64_t>(c[1]) * 0xC2B2AE3D27D4EB4FULL;
+  h ^= static_cast<std::uint64_t>(c[2]) * 0x165667B19E3779F9ULL;
+  h ^= h >> 29;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 32;
+  return h;
+}
+
+/**
+ * run func(i) for all i in [0,n) in chunks
+ */
+template<typename FUNC>
+void ForEachPoint(size_t n, unsigned int num_thread, FUNC &&func) {
+  parallel_for_chunk(n, kNumChunk, [&func](size_t i0, size_t i1) {
+    for (size_t i = i0; i < i1; ++i) { func(i); }
+  }, num_thread);
+}
+
+}  // namespace delfem2::msh_weld
+
+// ----------------------------------
+
+DFM2_INLINE void delfem2::WeldPoints3(
+    std::vector<unsigned int> &map_old2new,
+    std::vector<double> &vtx_xyz_new,
+    const double *vtx_xyz,
+    size_t num_vtx,
+    double epsilon,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::msh_weld;
+  const bool is_exact = epsilon <= 0.0;
+  const double inv_eps = is_exact ? 0.0 : 1.0 / epsilon;
+  // integer coordinates of the cell. The bits of the coordinates are used for the exact match
+  std::vector<std::int64_t> vtx_cell(num_vtx * 3);
+  lcl::ForEachPoint(
+      num_vtx, num_thread,
+      [&](size_t ip) {
+        for (unsigned int idim = 0; idim < 3; ++idim) {
+          const double x = vtx_xyz[ip * 3 + idim];
+          if (is_exact) {
+            const double x0 = (x == 0.0) ? 0.0 : x;  // -0.0 and 0.0 are the same
+            std::memcpy(vtx_cell.data() + ip * 3 + idim, &x0, 8);
+          } else {
+            vtx_cell[ip * 3 + idim] = static_cast<std::int64_t>(std::floor(x * inv_eps));
+          }
+        }
+      });
+  // hash table as a jagged array. The points in a bucket are sorted in ascending order
+  size_t nbucket = 1;
+  while (nbucket < num_vtx) { nbucket *= 2; }
+  const std::uint64_t mask = nbucket - 1;
+  std::vector<unsigned int> vtx_bucket(num_vtx);
+  lcl::ForEachPoint(
+      num_vtx, num_thread,
+      [&](size_t ip) {
+        vtx_bucket[ip] = static_cast<unsigned int>(lcl::HashCell(vtx_cell.data() + ip * 3) & mask);
+      });
+  std::vector<unsigned int> bucket_ind(nbucket + 1, 0);
+  for (size_t ip = 0; ip < num_vtx; ++ip) { bucket_ind[vtx_bucket[ip] + 1]++; }
+  for (size_t ib = 0; ib < nbucket; ++ib) { bucket_ind[ib + 1] += bucket_ind[ib]; }
+  std::vector<unsigned int> bucket_vtx(num_vtx);
+  {
+    std::vector<unsigned int> aOfs(bucket_ind.begin(), bucket_ind.end() - 1);
+    for (size_t ip = 0; ip < num_vtx; ++ip) {
+      bucket_vtx[aOfs[vtx_bucket[ip]]++] = static_cast<unsigned int>(ip);
+    }
+  }
+  // the point with the smallest index within epsilon
+  std::vector<unsigned int> vtx_rep(num_vtx);
+  const double eps2 = epsilon * epsilon;
+  lcl::ForEachPoint(
+      num_vtx, num_thread,
+      [&](size_t ip) {
+        const std::int64_t *ci = vtx_cell.data() + ip * 3;
+        auto irep = static_cast<unsigned int>(ip);
+        const int nd = is_exact ? 0 : 1;
+        for (int dx = -nd; dx <= nd; ++dx) {
+          for (int dy = -nd; dy <= nd; ++dy) {
+            for (int dz = -nd; dz <= nd; ++dz) {
+              const std::int64_t cj[3] = {ci[0] + dx, ci[1] + dy, ci[2] + dz};
+              const std::uint64_t ib = lcl::HashCell(cj) & mask;
+              for (unsigned int jjp = bucket_ind[ib]; jjp < bucket_ind[ib + 1]; ++jjp) {
+                const unsigned int jp = bucket_vtx[jjp];
+                if (jp >= irep) { break; }  // ascending order
+                const std::int64_t *c = vtx_cell.data() + jp * 3;
+                if (c[0] != cj[0] || c[1] != cj[1] || c[2] != cj[2]) { continue; }
+                if (!is_exact) {
+                  const double d0 = vtx_xyz[ip * 3 + 0] - vtx_xyz[jp * 3 + 0];
+                  const double d1 = vtx_xyz[ip * 3 + 1] - vtx_xyz[jp * 3 + 1];
+                  const double d2 = vtx_xyz[ip * 3 + 2] - vtx_xyz[jp * 3 + 2];
+                  if (d0 * d0 + d1 * d1 + d2 * d2 > eps2) { continue; }
+                }
+                irep = jp;
+                break;
+              }
+            }
+          }
+        }
+        vtx_rep[ip] = irep;
+      });
+  // follow the merges. vtx_rep[ip] <= ip, so the representative of vtx_rep[ip] is already determined
+  map_old2new.resize(num_vtx);
+  unsigned int num_vtx_new = 0;
+  for (size_t ip = 0; ip < num_vtx; ++ip) {
+    const unsigned int jp = vtx_rep[ip];
+    if (jp == ip) {
+      map_old2new[ip] = num_vtx_new++;
+    } else {
+      vtx_rep[ip] = vtx_rep[jp];
+      map_old2new[ip] = map_old2new[jp];
+    }
+  }
+  vtx_xyz_new.resize(num_vtx_new * 3);
+  for (size_t ip = 0; ip < num_vtx; ++ip) {
+    if (vtx_rep[ip] != ip) { continue; }
+    const unsigned int jp = map_old2new[ip];
+    vtx_xyz_new[jp * 3 + 0] = vtx_xyz[ip * 3 + 0];
+    vtx_xyz_new[jp * 3 + 1] = vtx_xyz[ip * 3 + 1];
+    vtx_xyz_new[jp * 3 + 2] = vtx_xyz[ip * 3 + 2];
+  }
+}
+
+DFM2_INLINE void delfem2::WeldPoints_MeshElem3(
+    std::vector<double> &vtx_xyz_new,
+    std::vector<unsigned int> &elem_vtx_new,
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &elem_vtx,
+    double epsilon,
+    unsigned int num_thread) {
+  std::vector<unsigned int> map_old2new;
+  WeldPoints3(
+      map_old2new, vtx_xyz_new,
+      vtx_xyz.data(), vtx_xyz.size() / 3, epsilon, num_thread);
+  elem_vtx_new.resize(elem_vtx.size());
+  for (size_t i = 0; i < elem_vtx.size(); ++i) {
+    elem_vtx_new[i] = map_old2new[elem_vtx[i]];
+  }
+}
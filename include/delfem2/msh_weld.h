@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file welding coincident points (e.g., triangle soup from STL file) using spatial hashing
+ */
+
+#ifndef DFM2_MSH_WELD_H
+#define DFM2_MSH_WELD_H
+
+#include <vector>
+#include <cstddef>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+/**
+ * @brief merge the points closer than "epsilon"
+ * @details a point is merged into the point with the smallest index within "epsilon",
+ * and the merges are followed to the end (e.g., 2->1 and 1->0 merges the point 2 into 0).
+ * The result does not depend on the number of threads.
+ * @param[out] map_old2new index of the merged point for each input point
+ * @param[out] vtx_xyz_new coordinates of the merged points in the order of their smallest input index
+ * @param[in] epsilon tolerance of the distance. Zero means the exactly the same coordinates are merged.
+ * @param[in] num_thread number of threads. "0" means the number of hardware threads.
+ */
+DFM2_INLINE void WeldPoints3(
+    std::vector<unsigned int> &map_old2new,
+    std::vector<double> &vtx_xyz_new,
+    const double *vtx_xyz,
+    size_t num_vtx,
+    double epsilon,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief merge the points of a mesh closer than "epsilon" and re-index the elements
+ */
+DFM2_INLINE void WeldPoints_MeshElem3(
+    std::vector<double> &vtx_xyz_new,
+    std::vector<unsigned int> &elem_vtx_new,
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &elem_vtx,
+    double epsilon,
+    unsigned int num_thread = 0);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/msh_weld.cpp"
+#endif
+
+#endif // DFM2_MSH_WELD_H
@@ -10,8 +10,81 @@
 #include <vector>
 #include <cassert>
 #include <climits>
+#include <algorithm>
 
 #include "delfem2/msh_topology_uniform.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::mshsubdiv {
+
+//! number of elements or points processed by a task of the thread pool
+constexpr size_t kNumChunk = 1 << 12;
+
+/**
+ * same as "findEdge" but with the binary search, as the rows of the edges from "JArrayEdge_MeshElem" are sorted
+ */
+DFM2_INLINE unsigned int FindEdgeSorted(
+    unsigned int ip0,
+    unsigned int ip1,
+    const std::vector<unsigned int> &psup_ind,
+    const std::vector<unsigned int> &psup) {
+  if (ip0 > ip1) { std::swap(ip0, ip1); }
+  const auto begin = psup.begin() + psup_ind[ip0];
+  const auto end = psup.begin() + psup_ind[ip0 + 1];
+  const auto itr = std::lower_bound(begin, end, ip1);
+  if (itr == end || *itr != ip1) { return UINT_MAX; }
+  return static_cast<unsigned int>(itr - psup.begin());
+}
+
+/**
+ * set the rows of the stencil in parallel.
+ * func(irow, entries) appends the pairs of the column and the weight of the row. Duplicated columns are summed up.
+ */
+template<typename FUNC>
+void SetStencilRows(
+    SubdivisionStencil &stencil,
+    size_t num_row,
+    size_t num_col,
+    unsigned int num_thread,
+    FUNC &&func) {
+  const size_t nchunk = (num_row + kNumChunk - 1) / kNumChunk;
+  std::vector<std::vector<unsigned int> > chunk_vtx(nchunk);
+  std::vector<std::vector<double> > chunk_weight(nchunk);
+  stencil.num_vtx0 = num_col;
+  stencil.ind.assign(num_row + 1, 0);
+  parallel_for_chunk(num_row, kNumChunk, [&](size_t irow0, size_t irow1) {
+    const size_t ichunk = irow0 / kNumChunk;
+    std::vector<std::pair<unsigned int, double> > entries;
+    for (size_t irow = irow0; irow < irow1; ++irow) {
+      entries.clear();
+      func(static_cast<unsigned int>(irow), entries);
+      std::sort(entries.begin(), entries.end());
+      for (unsigned int i = 0; i < entries.size(); ++i) {
+        if (i == 0 || entries[i].first != entries[i - 1].first) {
+          chunk_vtx[ichunk].push_back(entries[i].first);
+          chunk_weight[ichunk].push_back(entries[i].second);
+          stencil.ind[irow + 1] += 1;
+        } else {
+          chunk_weight[ichunk].back() += entries[i].second;
+        }
+      }
+    }
+  }, num_thread);
+  for (size_t irow = 0; irow < num_row; ++irow) {
+    stencil.ind[irow + 1] += stencil.ind[irow];
+  }
+  stencil.vtx.resize(stencil.ind[num_row]);
+  stencil.weight.resize(stencil.ind[num_row]);
+  parallel_for_chunk(nchunk, kNumChunk, [&](size_t ichunk0, size_t ichunk1) {
+    for (size_t ichunk = ichunk0; ichunk < ichunk1; ++ichunk) {
+      const unsigned int ofs = stencil.ind[ichunk * kNumChunk];
+      std::copy(chunk_vtx[ichunk].begin(), chunk_vtx[ichunk].end(), stencil.vtx.begin() + ofs);
+      std::copy(chunk_weight[ichunk].begin(), chunk_weight[ichunk].end(), stencil.weight.begin() + ofs);
+    }
+  }, num_thread);
+}
+
+}  // namespace delfem2::mshsubdiv
 
 // ----------------------------------------------------
 
@@ -66,84 +139,79 @@ DFM2_INLINE void delfem2::SubdivTopo_MeshQuad(
     std::vector<unsigned int> &aEdgeFace0, // two points on the edge and two quads touching the edge
     const unsigned int *quad_vtxidx0,
     size_t num_quad0,
-    size_t num_vtx) {
+    size_t num_vtx,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
   const size_t nq0 = num_quad0;
   const auto np0 = static_cast<unsigned int>(num_vtx);
   std::vector<unsigned int> elsup_ind, elsup;
   JArray_ElSuP_MeshElem(
       elsup_ind, elsup,
       quad_vtxidx0, num_quad0, 4,
-      num_vtx);
+      num_vtx, num_thread);
   JArrayEdge_MeshElem(
       psup_ind, psup,
       quad_vtxidx0, MESHELEM_QUAD,
       elsup_ind, elsup,
-      false); // is_bidirectional = false
+      false, // is_bidirectional = false
+      num_thread);
   const auto ne0 = static_cast<unsigned int>(psup.size());
-  aEdgeFace0.resize(0);
-  aEdgeFace0.reserve(ne0 * 4);
-  for (unsigned int ip = 0; ip < num_vtx; ++ip) {
-    for (unsigned int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
-      const unsigned int ip1 = psup[ipsup];
-      aEdgeFace0.push_back(ip);
-      aEdgeFace0.push_back(ip1);
-      unsigned int iq0 = UINT_MAX, iq1 = UINT_MAX;
-      for (unsigned int ielsup = elsup_ind[ip]; ielsup < elsup_ind[ip + 1]; ++ielsup) {
-        const unsigned int jq0 = elsup[ielsup];
-        const unsigned int jp0 = quad_vtxidx0[jq0 * 4 + 0];
-        const unsigned int jp1 = quad_vtxidx0[jq0 * 4 + 1];
-        const unsigned int jp2 = quad_vtxidx0[jq0 * 4 + 2];
-        const unsigned int jp3 = quad_vtxidx0[jq0 * 4 + 3];
-        if ((jp0 != ip) && (jp1 != ip) && (jp2 != ip) && (jp3 != ip)) { continue; }
-        if ((jp0 != ip1) && (jp1 != ip1) && (jp2 != ip1) && (jp3 != ip1)) { continue; }
-        // ----------------------------
-        if (iq0 == UINT_MAX) { iq0 = jq0; }
-        else {
-          assert(iq1 == UINT_MAX);
-          iq1 = jq0;
+  aEdgeFace0.resize(ne0 * 4);
+  parallel_for_chunk(num_vtx, lcl::kNumChunk, [&](size_t ip_begin, size_t ip_end) {
+    for (auto ip = static_cast<unsigned int>(ip_begin); ip < ip_end; ++ip) {
+      for (unsigned int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
+        const unsigned int ip1 = psup[ipsup];
+        unsigned int iq0 = UINT_MAX, iq1 = UINT_MAX;
+        for (unsigned int ielsup = elsup_ind[ip]; ielsup < elsup_ind[ip + 1]; ++ielsup) {
+          const unsigned int jq0 = elsup[ielsup];
+          const unsigned int jp0 = quad_vtxidx0[jq0 * 4 + 0];
+          const unsigned int jp1 = quad_vtxidx0[jq0 * 4 + 1];
+          const unsigned int jp2 = quad_vtxidx0[jq0 * 4 + 2];
+          const unsigned int jp3 = quad_vtxidx0[jq0 * 4 + 3];
+          if ((jp0 != ip) && (jp1 != ip) && (jp2 != ip) && (jp3 != ip)) { continue; }
+          if ((jp0 != ip1) && (jp1 != ip1) && (jp2 != ip1) && (jp3 != ip1)) { continue; }
+          // ----------------------------
+          if (iq0 == UINT_MAX) { iq0 = jq0; }
+          else {
+            assert(iq1 == UINT_MAX);
+            iq1 = jq0;
+          }
         }
+        aEdgeFace0[ipsup * 4 + 0] = ip;
+        aEdgeFace0[ipsup * 4 + 1] = ip1;
+        aEdgeFace0[ipsup * 4 + 2] = iq0;
+        aEdgeFace0[ipsup * 4 + 3] = iq1;
       }
-      aEdgeFace0.push_back(iq0);
-      aEdgeFace0.push_back(iq1);
     }
-  }
-  quad_vtxidx1.resize(0);
-  quad_vtxidx1.reserve(num_quad0 * 4);
-  for (unsigned int iq = 0; iq < nq0; ++iq) {
-    const unsigned int ip0 = quad_vtxidx0[iq * 4 + 0];
-    const unsigned int ip1 = quad_vtxidx0[iq * 4 + 1];
-    const unsigned int ip2 = quad_vtxidx0[iq * 4 + 2];
-    const unsigned int ip3 = quad_vtxidx0[iq * 4 + 3];
-    const unsigned int ie01 = findEdge(ip0, ip1, psup_ind, psup);
-    assert(ie01 != UINT_MAX);
-    const unsigned int ie12 = findEdge(ip1, ip2, psup_ind, psup);
-    assert(ie12 != UINT_MAX);
-    const unsigned int ie23 = findEdge(ip2, ip3, psup_ind, psup);
-    assert(ie23 != UINT_MAX);
-    const unsigned int ie30 = findEdge(ip3, ip0, psup_ind, psup);
-    assert(ie30 != UINT_MAX);
-    const unsigned int ip01 = ie01 + np0;
-    const unsigned int ip12 = ie12 + np0;
-    const unsigned int ip23 = ie23 + np0;
-    const unsigned int ip30 = ie30 + np0;
-    const unsigned int ip0123 = iq + np0 + ne0;
-    quad_vtxidx1.push_back(ip0);
-    quad_vtxidx1.push_back(ip01);
-    quad_vtxidx1.push_back(ip0123);
-    quad_vtxidx1.push_back(ip30);
-    quad_vtxidx1.push_back(ip1);
-    quad_vtxidx1.push_back(ip12);
-    quad_vtxidx1.push_back(ip0123);
-    quad_vtxidx1.push_back(ip01);
-    quad_vtxidx1.push_back(ip2);
-    quad_vtxidx1.push_back(ip23);
-    quad_vtxidx1.push_back(ip0123);
-    quad_vtxidx1.push_back(ip12);
-    quad_vtxidx1.push_back(ip3);
-    quad_vtxidx1.push_back(ip30);
-    quad_vtxidx1.push_back(ip0123);
-    quad_vtxidx1.push_back(ip23);
-  }
+  }, num_thread);
+  quad_vtxidx1.resize(num_quad0 * 16);
+  parallel_for_chunk(nq0, lcl::kNumChunk, [&](size_t iq_begin, size_t iq_end) {
+    for (auto iq = static_cast<unsigned int>(iq_begin); iq < iq_end; ++iq) {
+      const unsigned int ip0 = quad_vtxidx0[iq * 4 + 0];
+      const unsigned int ip1 = quad_vtxidx0[iq * 4 + 1];
+      const unsigned int ip2 = quad_vtxidx0[iq * 4 + 2];
+      const unsigned int ip3 = quad_vtxidx0[iq * 4 + 3];
+      const unsigned int ie01 = lcl::FindEdgeSorted(ip0, ip1, psup_ind, psup);
+      assert(ie01 != UINT_MAX);
+      const unsigned int ie12 = lcl::FindEdgeSorted(ip1, ip2, psup_ind, psup);
+      assert(ie12 != UINT_MAX);
+      const unsigned int ie23 = lcl::FindEdgeSorted(ip2, ip3, psup_ind, psup);
+      assert(ie23 != UINT_MAX);
+      const unsigned int ie30 = lcl::FindEdgeSorted(ip3, ip0, psup_ind, psup);
+      assert(ie30 != UINT_MAX);
+      const unsigned int ip01 = ie01 + np0;
+      const unsigned int ip12 = ie12 + np0;
+      const unsigned int ip23 = ie23 + np0;
+      const unsigned int ip30 = ie30 + np0;
+      const unsigned int ip0123 = iq + np0 + ne0;
+      const unsigned int quad1[16] = {
+          ip0, ip01, ip0123, ip30,
+          ip1, ip12, ip0123, ip01,
+          ip2, ip23, ip0123, ip12,
+          ip3, ip30, ip0123, ip23};
+      std::copy(quad1, quad1 + 16, quad_vtxidx1.begin() + iq * 16);
+    }
+  }, num_thread);
 }
 
 
@@ -154,75 +222,56 @@ DFM2_INLINE void delfem2::SubdivTopo_MeshTet(
     std::vector<unsigned int> &psup,
     const unsigned int *aTet0,
     int nTet0,
-    unsigned int nPoint0) {
+    unsigned int nPoint0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
   const int nt0 = nTet0;
   std::vector<unsigned int> elsup_ind, elsup;
   JArray_ElSuP_MeshElem(
       elsup_ind, elsup,
       aTet0, nTet0, 4,
-      nPoint0);
+      nPoint0, num_thread);
   JArrayEdge_MeshElem(
       psup_ind, psup,
       aTet0, MESHELEM_TET, elsup_ind, elsup,
-      false);
-  aTet1.resize(0);
-  aTet1.reserve(nTet0 * 4);
-  for (int it = 0; it < nt0; ++it) {
-    unsigned int ip0 = aTet0[it * 4 + 0];
-    unsigned int ip1 = aTet0[it * 4 + 1];
-    unsigned int ip2 = aTet0[it * 4 + 2];
-    unsigned int ip3 = aTet0[it * 4 + 3];
-    const unsigned int ie01 = findEdge(ip0, ip1, psup_ind, psup);
-    assert(ie01 != UINT_MAX);
-    const unsigned int ie02 = findEdge(ip0, ip2, psup_ind, psup);
-    assert(ie02 != UINT_MAX);
-    const unsigned int ie03 = findEdge(ip0, ip3, psup_ind, psup);
-    assert(ie03 != UINT_MAX);
-    const unsigned int ie12 = findEdge(ip1, ip2, psup_ind, psup);
-    assert(ie12 != UINT_MAX);
-    const unsigned int ie13 = findEdge(ip1, ip3, psup_ind, psup);
-    assert(ie13 != UINT_MAX);
-    const unsigned int ie23 = findEdge(ip2, ip3, psup_ind, psup);
-    assert(ie23 != UINT_MAX);
-    unsigned int ip01 = ie01 + nPoint0;
-    unsigned int ip02 = ie02 + nPoint0;
-    unsigned int ip03 = ie03 + nPoint0;
-    unsigned int ip12 = ie12 + nPoint0;
-    unsigned int ip13 = ie13 + nPoint0;
-    unsigned int ip23 = ie23 + nPoint0;
-    aTet1.push_back(ip0);
-    aTet1.push_back(ip01);
-    aTet1.push_back(ip02);
-    aTet1.push_back(ip03);
-    aTet1.push_back(ip1);
-    aTet1.push_back(ip01);
-    aTet1.push_back(ip13);
-    aTet1.push_back(ip12);
-    aTet1.push_back(ip2);
-    aTet1.push_back(ip02);
-    aTet1.push_back(ip12);
-    aTet1.push_back(ip23);
-    aTet1.push_back(ip3);
-    aTet1.push_back(ip03);
-    aTet1.push_back(ip23);
-    aTet1.push_back(ip13);
-    aTet1.push_back(ip01);
-    aTet1.push_back(ip23);
-    aTet1.push_back(ip13);
-    aTet1.push_back(ip12);
-    aTet1.push_back(ip01);
-    aTet1.push_back(ip23);
-    aTet1.push_back(ip12);
-    aTet1.push_back(ip02);
-    aTet1.push_back(ip01);
-    aTet1.push_back(ip23);
-    aTet1.push_back(ip02);
-    aTet1.push_back(ip03);
-    aTet1.push_back(ip01);
-    aTet1.push_back(ip23);
-    aTet1.push_back(ip03);
-    aTet1.push_back(ip13);
-  }
+      false, num_thread);
+  aTet1.resize(nt0 * 32);
+  parallel_for_chunk(nt0, lcl::kNumChunk, [&](size_t it_begin, size_t it_end) {
+    for (auto it = static_cast<unsigned int>(it_begin); it < it_end; ++it) {
+      unsigned int ip0 = aTet0[it * 4 + 0];
+      unsigned int ip1 = aTet0[it * 4 + 1];
+      unsigned int ip2 = aTet0[it * 4 + 2];
+      unsigned int ip3 = aTet0[it * 4 + 3];
+      const unsigned int ie01 = lcl::FindEdgeSorted(ip0, ip1, psup_ind, psup);
+      assert(ie01 != UINT_MAX);
+      const unsigned int ie02 = lcl::FindEdgeSorted(ip0, ip2, psup_ind, psup);
+      assert(ie02 != UINT_MAX);
+      const unsigned int ie03 = lcl::FindEdgeSorted(ip0, ip3, psup_ind, psup);
+      assert(ie03 != UINT_MAX);
+      const unsigned int ie12 = lcl::FindEdgeSorted(ip1, ip2, psup_ind, psup);
+      assert(ie12 != UINT_MAX);
+      const unsigned int ie13 = lcl::FindEdgeSorted(ip1, ip3, psup_ind, psup);
+      assert(ie13 != UINT_MAX);
+      const unsigned int ie23 = lcl::FindEdgeSorted(ip2, ip3, psup_ind, psup);
+      assert(ie23 != UINT_MAX);
+      unsigned int ip01 = ie01 + nPoint0;
+      unsigned int ip02 = ie02 + nPoint0;
+      unsigned int ip03 = ie03 + nPoint0;
+      unsigned int ip12 = ie12 + nPoint0;
+      unsigned int ip13 = ie13 + nPoint0;
+      unsigned int ip23 = ie23 + nPoint0;
+      const unsigned int tet1[32] = {
+          ip0, ip01, ip02, ip03,
+          ip1, ip01, ip13, ip12,
+          ip2, ip02, ip12, ip23,
+          ip3, ip03, ip23, ip13,
+          ip01, ip23, ip13, ip12,
+          ip01, ip23, ip12, ip02,
+          ip01, ip23, ip02, ip03,
+          ip01, ip23, ip03, ip13};
+      std::copy(tet1, tet1 + 32, aTet1.begin() + it * 32);
+    }
+  }, num_thread);
 }
 
 /*
@@ -389,21 +438,25 @@ void delfem2::SubdivTopo_MeshHex(
     //
     const unsigned int *aHex0,
     size_t nHex0,
-    const size_t nHexPoint0) {
+    const size_t nHexPoint0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
   const auto nhp0 = static_cast<unsigned int>(nHexPoint0);
   std::vector<unsigned int> elsupIndHex0, elsupHex0;
   JArray_ElSuP_MeshElem(
       elsupIndHex0, elsupHex0,
-      aHex0, nHex0, 8, nhp0);
+      aHex0, nHex0, 8, nhp0, num_thread);
 
   //edge
   JArrayEdge_MeshElem(
       psupIndHex0, psupHex0,
       aHex0, MESHELEM_HEX, elsupIndHex0, elsupHex0,
-      false); // is_directional = false
+      false, // is_directional = false
+      num_thread);
 
   //face
-  aQuadHex0.clear();
+  // the face is owned by the hex with the smaller index, and numbered in the order of the owner hex.
+  std::vector<unsigned int> hex_face(nHex0 * 6); // face index of each face of hex
   {
     std::vector<unsigned int> aHexSuHex0;
     ElSuEl_MeshElem(
@@ -412,28 +465,52 @@ void delfem2::SubdivTopo_MeshHex(
         elsupIndHex0, elsupHex0,
         nFaceElem(MESHELEM_HEX),
         nNodeElemFace(MESHELEM_HEX, 0),
-        noelElemFace(MESHELEM_HEX));
-    for (unsigned int ih = 0; ih < (unsigned int) nHex0; ++ih) {
-      for (int ifh = 0; ifh < 6; ++ifh) {
-        unsigned int jh0 = aHexSuHex0[ih * 6 + ifh];
-        if (jh0 != UINT_MAX && ih > jh0) continue;
-        for (int inofa = 0; inofa < 4; ++inofa) {
-          int inoel0 = noelElemFace_Hex[ifh][inofa];
-          unsigned int igp0 = aHex0[ih * 8 + inoel0];
-          aQuadHex0.push_back(igp0);
-        }
+        noelElemFace(MESHELEM_HEX),
+        num_thread);
+    auto is_owner = [&aHexSuHex0](unsigned int ih, unsigned int ifh) {
+      const unsigned int jh0 = aHexSuHex0[ih * 6 + ifh];
+      return jh0 == UINT_MAX || ih < jh0;
+    };
+    std::vector<unsigned int> hex_ind_face(nHex0 + 1, 0);
+    for (unsigned int ih = 0; ih < nHex0; ++ih) {
+      unsigned int nface = 0;
+      for (unsigned int ifh = 0; ifh < 6; ++ifh) {
+        if (is_owner(ih, ifh)) { ++nface; }
       }
+      hex_ind_face[ih + 1] = hex_ind_face[ih] + nface;
     }
+    aQuadHex0.resize(hex_ind_face[nHex0] * 4);
+    parallel_for_chunk(nHex0, lcl::kNumChunk, [&](size_t ih_begin, size_t ih_end) {
+      for (auto ih = static_cast<unsigned int>(ih_begin); ih < ih_end; ++ih) {
+        unsigned int iface = hex_ind_face[ih];
+        for (unsigned int ifh = 0; ifh < 6; ++ifh) {
+          if (!is_owner(ih, ifh)) { continue; }
+          for (int inofa = 0; inofa < 4; ++inofa) {
+            int inoel0 = noelElemFace_Hex[ifh][inofa];
+            aQuadHex0[iface * 4 + inofa] = aHex0[ih * 8 + inoel0];
+          }
+          hex_face[ih * 6 + ifh] = iface;
+          ++iface;
+        }
+      }
+    }, num_thread);
+    parallel_for_chunk(nHex0, lcl::kNumChunk, [&](size_t ih_begin, size_t ih_end) {
+      for (auto ih = static_cast<unsigned int>(ih_begin); ih < ih_end; ++ih) {
+        for (unsigned int ifh = 0; ifh < 6; ++ifh) {
+          if (is_owner(ih, ifh)) { continue; }
+          const unsigned int jh0 = aHexSuHex0[ih * 6 + ifh];
+          for (unsigned int jfh = 0; jfh < 6; ++jfh) {
+            if (aHexSuHex0[jh0 * 6 + jfh] != ih) { continue; }
+            hex_face[ih * 6 + ifh] = hex_face[jh0 * 6 + jfh];
+            break;
+          }
+        }
+      }
+    }, num_thread);
   }
-  std::vector<unsigned int> elsupIndQuadHex0, elsupQuadHex0;
-  JArray_ElSuP_MeshElem(
-      elsupIndQuadHex0, elsupQuadHex0,
-      aQuadHex0.data(), aQuadHex0.size() / 4,
-      4, nhp0);
 
   const auto neh0 = static_cast<unsigned int>(psupHex0.size());
   const auto nfh0 = static_cast<unsigned int>(aQuadHex0.size() / 4);
-//  std::cout << nfh0 << " " << aQuadHex0.size() << std::endl;
 
   /*
   const int aNoelEdge[12][2] = {
@@ -453,126 +530,66 @@ void delfem2::SubdivTopo_MeshHex(
    */
 
   // making hex
-  aHex1.clear();
-  for (unsigned int ih = 0; ih < nHex0; ++ih) {
-    unsigned int ihc0 = aHex0[ih * 8 + 0];
-    unsigned int ihc1 = aHex0[ih * 8 + 1];
-    unsigned int ihc2 = aHex0[ih * 8 + 2];
-    unsigned int ihc3 = aHex0[ih * 8 + 3];
-    unsigned int ihc4 = aHex0[ih * 8 + 4];
-    unsigned int ihc5 = aHex0[ih * 8 + 5];
-    unsigned int ihc6 = aHex0[ih * 8 + 6];
-    unsigned int ihc7 = aHex0[ih * 8 + 7];
-    const unsigned int ihc01 = findEdge(ihc0, ihc1, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc01 >= nhp0 && ihc01 < nhp0 + neh0);
-    const unsigned int ihc12 = findEdge(ihc1, ihc2, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc12 >= nhp0 && ihc12 < nhp0 + neh0);
-    const unsigned int ihc23 = findEdge(ihc2, ihc3, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc23 >= nhp0 && ihc23 < nhp0 + neh0);
-    const unsigned int ihc30 = findEdge(ihc3, ihc0, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc30 >= nhp0 && ihc30 < nhp0 + neh0);
-    const unsigned int ihc45 = findEdge(ihc4, ihc5, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc45 >= nhp0 && ihc45 < nhp0 + neh0);
-    const unsigned int ihc56 = findEdge(ihc5, ihc6, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc56 >= nhp0 && ihc56 < nhp0 + neh0);
-    const unsigned int ihc67 = findEdge(ihc6, ihc7, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc67 >= nhp0 && ihc67 < nhp0 + neh0);
-    const unsigned int ihc74 = findEdge(ihc7, ihc4, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc74 >= nhp0 && ihc74 < nhp0 + neh0);
-    const unsigned int ihc04 = findEdge(ihc0, ihc4, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc04 >= nhp0 && ihc04 < nhp0 + neh0);
-    const unsigned int ihc15 = findEdge(ihc1, ihc5, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc15 >= nhp0 && ihc15 < nhp0 + neh0);
-    const unsigned int ihc26 = findEdge(ihc2, ihc6, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc26 >= nhp0 && ihc26 < nhp0 + neh0);
-    const unsigned int ihc37 = findEdge(ihc3, ihc7, psupIndHex0, psupHex0) + nhp0;
-    assert(ihc37 >= nhp0 && ihc37 < nhp0 + neh0);
-    unsigned int ihc0473 = findFace(ihc0, ihc4, ihc7, ihc3, aQuadHex0, elsupIndQuadHex0, elsupQuadHex0) + nhp0 + neh0;
-    assert(ihc0473 >= nhp0 + neh0 && ihc0473 < nhp0 + neh0 + nfh0);
-    unsigned int ihc1265 = findFace(ihc1, ihc2, ihc6, ihc5, aQuadHex0, elsupIndQuadHex0, elsupQuadHex0) + nhp0 + neh0;
-    assert(ihc1265 >= nhp0 + neh0 && ihc1265 < nhp0 + neh0 + nfh0);
-    unsigned int ihc0154 = findFace(ihc0, ihc1, ihc5, ihc4, aQuadHex0, elsupIndQuadHex0, elsupQuadHex0) + nhp0 + neh0;
-    assert(ihc0154 >= nhp0 + neh0 && ihc0154 < nhp0 + neh0 + nfh0);
-    unsigned int ihc3762 = findFace(ihc3, ihc7, ihc6, ihc2, aQuadHex0, elsupIndQuadHex0, elsupQuadHex0) + nhp0 + neh0;
-    assert(ihc3762 >= nhp0 + neh0 && ihc3762 < nhp0 + neh0 + nfh0);
-    unsigned int ihc0321 = findFace(ihc0, ihc3, ihc2, ihc1, aQuadHex0, elsupIndQuadHex0, elsupQuadHex0) + nhp0 + neh0;
-    assert(ihc0321 >= nhp0 + neh0 && ihc0321 < nhp0 + neh0 + nfh0);
-    unsigned int ihc4567 = findFace(ihc4, ihc5, ihc6, ihc7, aQuadHex0, elsupIndQuadHex0, elsupQuadHex0) + nhp0 + neh0;
-    assert(ihc4567 >= nhp0 + neh0 && ihc4567 < nhp0 + neh0 + nfh0);
-    unsigned int ihc01234567 = ih + nhp0 + neh0 + nfh0;
-    //0
-    aHex1.push_back(ihc0);
-    aHex1.push_back(ihc01);
-    aHex1.push_back(ihc0321);
-    aHex1.push_back(ihc30);
-    aHex1.push_back(ihc04);
-    aHex1.push_back(ihc0154);
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc0473);
-    //1
-    aHex1.push_back(ihc01);
-    aHex1.push_back(ihc1);
-    aHex1.push_back(ihc12);
-    aHex1.push_back(ihc0321);
-    aHex1.push_back(ihc0154);
-    aHex1.push_back(ihc15);
-    aHex1.push_back(ihc1265);
-    aHex1.push_back(ihc01234567);
-    //2
-    aHex1.push_back(ihc0321);
-    aHex1.push_back(ihc12);
-    aHex1.push_back(ihc2);
-    aHex1.push_back(ihc23);
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc1265);
-    aHex1.push_back(ihc26);
-    aHex1.push_back(ihc3762);
-    //3
-    aHex1.push_back(ihc30);
-    aHex1.push_back(ihc0321);
-    aHex1.push_back(ihc23);
-    aHex1.push_back(ihc3);
-    aHex1.push_back(ihc0473);
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc3762);
-    aHex1.push_back(ihc37);
-    //4
-    aHex1.push_back(ihc04);
-    aHex1.push_back(ihc0154);
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc0473);
-    aHex1.push_back(ihc4);
-    aHex1.push_back(ihc45);
-    aHex1.push_back(ihc4567);
-    aHex1.push_back(ihc74);
-    //5
-    aHex1.push_back(ihc0154);
-    aHex1.push_back(ihc15);
-    aHex1.push_back(ihc1265);
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc45);
-    aHex1.push_back(ihc5);
-    aHex1.push_back(ihc56);
-    aHex1.push_back(ihc4567);
-    //6
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc1265);
-    aHex1.push_back(ihc26);
-    aHex1.push_back(ihc3762);
-    aHex1.push_back(ihc4567);
-    aHex1.push_back(ihc56);
-    aHex1.push_back(ihc6);
-    aHex1.push_back(ihc67);
-    //7
-    aHex1.push_back(ihc0473);
-    aHex1.push_back(ihc01234567);
-    aHex1.push_back(ihc3762);
-    aHex1.push_back(ihc37);
-    aHex1.push_back(ihc74);
-    aHex1.push_back(ihc4567);
-    aHex1.push_back(ihc67);
-    aHex1.push_back(ihc7);
-  }
+  aHex1.resize(nHex0 * 64);
+  parallel_for_chunk(nHex0, lcl::kNumChunk, [&](size_t ih_begin, size_t ih_end) {
+    for (auto ih = static_cast<unsigned int>(ih_begin); ih < ih_end; ++ih) {
+      unsigned int ihc0 = aHex0[ih * 8 + 0];
+      unsigned int ihc1 = aHex0[ih * 8 + 1];
+      unsigned int ihc2 = aHex0[ih * 8 + 2];
+      unsigned int ihc3 = aHex0[ih * 8 + 3];
+      unsigned int ihc4 = aHex0[ih * 8 + 4];
+      unsigned int ihc5 = aHex0[ih * 8 + 5];
+      unsigned int ihc6 = aHex0[ih * 8 + 6];
+      unsigned int ihc7 = aHex0[ih * 8 + 7];
+      const unsigned int ihc01 = lcl::FindEdgeSorted(ihc0, ihc1, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc01 >= nhp0 && ihc01 < nhp0 + neh0);
+      const unsigned int ihc12 = lcl::FindEdgeSorted(ihc1, ihc2, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc12 >= nhp0 && ihc12 < nhp0 + neh0);
+      const unsigned int ihc23 = lcl::FindEdgeSorted(ihc2, ihc3, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc23 >= nhp0 && ihc23 < nhp0 + neh0);
+      const unsigned int ihc30 = lcl::FindEdgeSorted(ihc3, ihc0, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc30 >= nhp0 && ihc30 < nhp0 + neh0);
+      const unsigned int ihc45 = lcl::FindEdgeSorted(ihc4, ihc5, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc45 >= nhp0 && ihc45 < nhp0 + neh0);
+      const unsigned int ihc56 = lcl::FindEdgeSorted(ihc5, ihc6, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc56 >= nhp0 && ihc56 < nhp0 + neh0);
+      const unsigned int ihc67 = lcl::FindEdgeSorted(ihc6, ihc7, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc67 >= nhp0 && ihc67 < nhp0 + neh0);
+      const unsigned int ihc74 = lcl::FindEdgeSorted(ihc7, ihc4, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc74 >= nhp0 && ihc74 < nhp0 + neh0);
+      const unsigned int ihc04 = lcl::FindEdgeSorted(ihc0, ihc4, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc04 >= nhp0 && ihc04 < nhp0 + neh0);
+      const unsigned int ihc15 = lcl::FindEdgeSorted(ihc1, ihc5, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc15 >= nhp0 && ihc15 < nhp0 + neh0);
+      const unsigned int ihc26 = lcl::FindEdgeSorted(ihc2, ihc6, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc26 >= nhp0 && ihc26 < nhp0 + neh0);
+      const unsigned int ihc37 = lcl::FindEdgeSorted(ihc3, ihc7, psupIndHex0, psupHex0) + nhp0;
+      assert(ihc37 >= nhp0 && ihc37 < nhp0 + neh0);
+      const unsigned int ihc0473 = hex_face[ih * 6 + 0] + nhp0 + neh0;
+      assert(ihc0473 >= nhp0 + neh0 && ihc0473 < nhp0 + neh0 + nfh0);
+      const unsigned int ihc1265 = hex_face[ih * 6 + 1] + nhp0 + neh0;
+      assert(ihc1265 >= nhp0 + neh0 && ihc1265 < nhp0 + neh0 + nfh0);
+      const unsigned int ihc0154 = hex_face[ih * 6 + 2] + nhp0 + neh0;
+      assert(ihc0154 >= nhp0 + neh0 && ihc0154 < nhp0 + neh0 + nfh0);
+      const unsigned int ihc3762 = hex_face[ih * 6 + 3] + nhp0 + neh0;
+      assert(ihc3762 >= nhp0 + neh0 && ihc3762 < nhp0 + neh0 + nfh0);
+      const unsigned int ihc0321 = hex_face[ih * 6 + 4] + nhp0 + neh0;
+      assert(ihc0321 >= nhp0 + neh0 && ihc0321 < nhp0 + neh0 + nfh0);
+      const unsigned int ihc4567 = hex_face[ih * 6 + 5] + nhp0 + neh0;
+      assert(ihc4567 >= nhp0 + neh0 && ihc4567 < nhp0 + neh0 + nfh0);
+      const unsigned int ihc01234567 = ih + nhp0 + neh0 + nfh0;
+      const unsigned int hex1[64] = {
+          ihc0, ihc01, ihc0321, ihc30, ihc04, ihc0154, ihc01234567, ihc0473, // 0
+          ihc01, ihc1, ihc12, ihc0321, ihc0154, ihc15, ihc1265, ihc01234567, // 1
+          ihc0321, ihc12, ihc2, ihc23, ihc01234567, ihc1265, ihc26, ihc3762, // 2
+          ihc30, ihc0321, ihc23, ihc3, ihc0473, ihc01234567, ihc3762, ihc37, // 3
+          ihc04, ihc0154, ihc01234567, ihc0473, ihc4, ihc45, ihc4567, ihc74, // 4
+          ihc0154, ihc15, ihc1265, ihc01234567, ihc45, ihc5, ihc56, ihc4567, // 5
+          ihc01234567, ihc1265, ihc26, ihc3762, ihc4567, ihc56, ihc6, ihc67, // 6
+          ihc0473, ihc01234567, ihc3762, ihc37, ihc74, ihc4567, ihc67, ihc7}; // 7
+      std::copy(hex1, hex1 + 64, aHex1.begin() + ih * 64);
+    }
+  }, num_thread);
 }
 
 // TODO: make this handle open surface (average face & edge independently)
@@ -586,98 +603,100 @@ void delfem2::SubdivisionPoints_QuadCatmullClark(
     const unsigned int *quad_vtx0,
     size_t num_quad0,
     const double *vtx_xyz0,
-    size_t num_vtx0) {
+    size_t num_vtx0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
   const std::size_t nv0 = num_vtx0;
   const std::size_t ne0 = psupQuad0.size();
   const size_t nq0 = num_quad0;
   assert(aEdgeFace0.size() == ne0 * 4);
   const std::size_t nv1 = nv0 + ne0 + nq0;
   vtx_xyz1.resize(nv1 * 3);
-  std::vector<unsigned int> aNFace(nv0, 0); // number of faces touching vertex
-  for (unsigned int iv = 0; iv < nv0; ++iv) {
-    vtx_xyz1[iv * 3 + 0] = 0;
-    vtx_xyz1[iv * 3 + 1] = 0;
-    vtx_xyz1[iv * 3 + 2] = 0;
-  }
-  for (unsigned int iq = 0; iq < nq0; ++iq) { // face
-    const unsigned int iv0 = quad_vtx0[iq * 4 + 0];
-    const unsigned int iv1 = quad_vtx0[iq * 4 + 1];
-    const unsigned int iv2 = quad_vtx0[iq * 4 + 2];
-    const unsigned int iv3 = quad_vtx0[iq * 4 + 3];
-    const double p0x = (vtx_xyz0[iv0 * 3 + 0] + vtx_xyz0[iv1 * 3 + 0] + vtx_xyz0[iv2 * 3 + 0] + vtx_xyz0[iv3 * 3 + 0]) * 0.25;
-    const double p0y = (vtx_xyz0[iv0 * 3 + 1] + vtx_xyz0[iv1 * 3 + 1] + vtx_xyz0[iv2 * 3 + 1] + vtx_xyz0[iv3 * 3 + 1]) * 0.25;
-    const double p0z = (vtx_xyz0[iv0 * 3 + 2] + vtx_xyz0[iv1 * 3 + 2] + vtx_xyz0[iv2 * 3 + 2] + vtx_xyz0[iv3 * 3 + 2]) * 0.25;
-    vtx_xyz1[(nv0 + ne0 + iq) * 3 + 0] = p0x;
-    vtx_xyz1[(nv0 + ne0 + iq) * 3 + 1] = p0y;
-    vtx_xyz1[(nv0 + ne0 + iq) * 3 + 2] = p0z;
-    const unsigned int aIV[4] = {iv0, iv1, iv2, iv3};
-    for (unsigned int jv0 : aIV) {
-      vtx_xyz1[jv0 * 3 + 0] += p0x;
-      vtx_xyz1[jv0 * 3 + 1] += p0y;
-      vtx_xyz1[jv0 * 3 + 2] += p0z;
-      aNFace[jv0] += 1;
+  // the points are gathered (not scattered) in each pass so that the passes run in parallel
+  parallel_for_chunk(nq0, lcl::kNumChunk, [&](size_t iq_begin, size_t iq_end) {  // face
+    for (size_t iq = iq_begin; iq < iq_end; ++iq) {
+      const unsigned int *aIV = quad_vtx0 + iq * 4;
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        vtx_xyz1[(nv0 + ne0 + iq) * 3 + idim] = (
+            vtx_xyz0[aIV[0] * 3 + idim] + vtx_xyz0[aIV[1] * 3 + idim] +
+                vtx_xyz0[aIV[2] * 3 + idim] + vtx_xyz0[aIV[3] * 3 + idim]) * 0.25;
+      }
     }
-  }
-  for (unsigned int ie = 0; ie < ne0; ++ie) { // edge
-    const unsigned int iv0 = aEdgeFace0[ie * 4 + 0];
-    const unsigned int iv1 = aEdgeFace0[ie * 4 + 1];
-    const unsigned int iq0 = aEdgeFace0[ie * 4 + 2];
-    const unsigned int iq1 = aEdgeFace0[ie * 4 + 3];
-    if (iq1 != UINT_MAX) {
-      const size_t iv1e = nv0 + ie;
-      assert(iv1e < nv1);
-      const size_t iv1q0 = nv0 + ne0 + iq0;
-      assert(iv1q0 < nv1);
-      const size_t iv1q1 = nv0 + ne0 + iq1;
-      assert(iv1q1 < nv1);
-      vtx_xyz1[iv1e * 3 + 0] =
-          (vtx_xyz0[iv0 * 3 + 0] + vtx_xyz0[iv1 * 3 + 0] + vtx_xyz1[iv1q0 * 3 + 0] + vtx_xyz1[iv1q1 * 3 + 0]) * 0.25;
-      vtx_xyz1[iv1e * 3 + 1] =
-          (vtx_xyz0[iv0 * 3 + 1] + vtx_xyz0[iv1 * 3 + 1] + vtx_xyz1[iv1q0 * 3 + 1] + vtx_xyz1[iv1q1 * 3 + 1]) * 0.25;
-      vtx_xyz1[iv1e * 3 + 2] =
-          (vtx_xyz0[iv0 * 3 + 2] + vtx_xyz0[iv1 * 3 + 2] + vtx_xyz1[iv1q0 * 3 + 2] + vtx_xyz1[iv1q1 * 3 + 2]) * 0.25;
-    } else {
+  }, num_thread);
+  parallel_for_chunk(ne0, lcl::kNumChunk, [&](size_t ie_begin, size_t ie_end) {  // edge
+    for (size_t ie = ie_begin; ie < ie_end; ++ie) {
+      const unsigned int iv0 = aEdgeFace0[ie * 4 + 0];
+      const unsigned int iv1 = aEdgeFace0[ie * 4 + 1];
+      const unsigned int iq0 = aEdgeFace0[ie * 4 + 2];
+      const unsigned int iq1 = aEdgeFace0[ie * 4 + 3];
       const size_t iv1e = nv0 + ie;
-      assert(iv1e < nv1);
-      const size_t iv1q0 = nv0 + ne0 + iq0;
-      assert(iv1q0 < nv1);
-      vtx_xyz1[iv1e * 3 + 0] = (vtx_xyz0[iv0 * 3 + 0] + vtx_xyz0[iv1 * 3 + 0]) * 0.5;
-      vtx_xyz1[iv1e * 3 + 1] = (vtx_xyz0[iv0 * 3 + 1] + vtx_xyz0[iv1 * 3 + 1]) * 0.5;
-      vtx_xyz1[iv1e * 3 + 2] = (vtx_xyz0[iv0 * 3 + 2] + vtx_xyz0[iv1 * 3 + 2]) * 0.5;
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        if (iq1 == UINT_MAX) {
+          vtx_xyz1[iv1e * 3 + idim] = (vtx_xyz0[iv0 * 3 + idim] + vtx_xyz0[iv1 * 3 + idim]) * 0.5;
+          continue;
+        }
+        vtx_xyz1[iv1e * 3 + idim] = (
+            vtx_xyz0[iv0 * 3 + idim] + vtx_xyz0[iv1 * 3 + idim] +
+                vtx_xyz1[(nv0 + ne0 + iq0) * 3 + idim] + vtx_xyz1[(nv0 + ne0 + iq1) * 3 + idim]) * 0.25;
+      }
     }
-    vtx_xyz1[iv0 * 3 + 0] += vtx_xyz0[iv0 * 3 + 0] + vtx_xyz0[iv1 * 3 + 0];
-    vtx_xyz1[iv0 * 3 + 1] += vtx_xyz0[iv0 * 3 + 1] + vtx_xyz0[iv1 * 3 + 1];
-    vtx_xyz1[iv0 * 3 + 2] += vtx_xyz0[iv0 * 3 + 2] + vtx_xyz0[iv1 * 3 + 2];
-    vtx_xyz1[iv1 * 3 + 0] += vtx_xyz0[iv0 * 3 + 0] + vtx_xyz0[iv1 * 3 + 0];
-    vtx_xyz1[iv1 * 3 + 1] += vtx_xyz0[iv0 * 3 + 1] + vtx_xyz0[iv1 * 3 + 1];
-    vtx_xyz1[iv1 * 3 + 2] += vtx_xyz0[iv0 * 3 + 2] + vtx_xyz0[iv1 * 3 + 2];
-  }
-  for (unsigned int iv = 0; iv < nv0; ++iv) {
-    const unsigned int nf = aNFace[iv]; // number of faces touching this vertex
-    if (nf == 0) { continue; }
-    // add face
-    const double tmp0 = 1.0 / (nf * nf);
-    vtx_xyz1[iv * 3 + 0] *= tmp0;
-    vtx_xyz1[iv * 3 + 1] *= tmp0;
-    vtx_xyz1[iv * 3 + 2] *= tmp0;
-    // add vertex
-    const double tmp1 = (nf - 3.0) / (nf);
-    vtx_xyz1[iv * 3 + 0] += tmp1 * vtx_xyz0[iv * 3 + 0];
-    vtx_xyz1[iv * 3 + 1] += tmp1 * vtx_xyz0[iv * 3 + 1];
-    vtx_xyz1[iv * 3 + 2] += tmp1 * vtx_xyz0[iv * 3 + 2];
-  }
-  for (unsigned int ie = 0; ie < ne0; ++ie) { // edge
-    const unsigned int iv0 = aEdgeFace0[ie * 4 + 0];
-    const unsigned int iv1 = aEdgeFace0[ie * 4 + 1];
-    const unsigned int ie1 = aEdgeFace0[ie * 4 + 3];
-    if (ie1 != UINT_MAX) { continue; }
-    vtx_xyz1[iv0 * 3 + 0] = vtx_xyz0[iv0 * 3 + 0];
-    vtx_xyz1[iv0 * 3 + 1] = vtx_xyz0[iv0 * 3 + 1];
-    vtx_xyz1[iv0 * 3 + 2] = vtx_xyz0[iv0 * 3 + 2];
-    vtx_xyz1[iv1 * 3 + 0] = vtx_xyz0[iv1 * 3 + 0];
-    vtx_xyz1[iv1 * 3 + 1] = vtx_xyz0[iv1 * 3 + 1];
-    vtx_xyz1[iv1 * 3 + 2] = vtx_xyz0[iv1 * 3 + 2];
+  }, num_thread);
+  std::vector<unsigned int> elsup_ind, elsup; // quads around vertex
+  JArray_ElSuP_MeshElem(
+      elsup_ind, elsup,
+      quad_vtx0, nq0, 4, nv0, num_thread);
+  std::vector<unsigned int> edsup_ind, edsup; // edges around vertex
+  {
+    std::vector<unsigned int> edge_vtx(ne0 * 2);
+    for (unsigned int ie = 0; ie < ne0; ++ie) {
+      edge_vtx[ie * 2 + 0] = aEdgeFace0[ie * 4 + 0];
+      edge_vtx[ie * 2 + 1] = aEdgeFace0[ie * 4 + 1];
+    }
+    JArray_ElSuP_MeshElem(
+        edsup_ind, edsup,
+        edge_vtx.data(), ne0, 2, nv0, num_thread);
   }
+  parallel_for_chunk(nv0, lcl::kNumChunk, [&](size_t iv_begin, size_t iv_end) {  // vertex
+    for (size_t iv = iv_begin; iv < iv_end; ++iv) {
+      double *p1 = vtx_xyz1.data() + iv * 3;
+      const unsigned int nf = elsup_ind[iv + 1] - elsup_ind[iv]; // number of faces touching this vertex
+      if (nf == 0) {
+        p1[0] = p1[1] = p1[2] = 0.0;
+        continue;
+      }
+      bool is_boundary = false;
+      for (unsigned int iedsup = edsup_ind[iv]; iedsup < edsup_ind[iv + 1]; ++iedsup) {
+        is_boundary = is_boundary || aEdgeFace0[edsup[iedsup] * 4 + 3] == UINT_MAX;
+      }
+      if (is_boundary) { // the vertex on the boundary is fixed
+        p1[0] = vtx_xyz0[iv * 3 + 0];
+        p1[1] = vtx_xyz0[iv * 3 + 1];
+        p1[2] = vtx_xyz0[iv * 3 + 2];
+        continue;
+      }
+      double sum[3] = {0., 0., 0.};
+      for (unsigned int ielsup = elsup_ind[iv]; ielsup < elsup_ind[iv + 1]; ++ielsup) { // add face
+        const double *pq = vtx_xyz1.data() + (nv0 + ne0 + elsup[ielsup]) * 3;
+        sum[0] += pq[0];
+        sum[1] += pq[1];
+        sum[2] += pq[2];
+      }
+      for (unsigned int iedsup = edsup_ind[iv]; iedsup < edsup_ind[iv + 1]; ++iedsup) { // add edge
+        const unsigned int ie = edsup[iedsup];
+        const unsigned int iv0 = aEdgeFace0[ie * 4 + 0];
+        const unsigned int iv1 = aEdgeFace0[ie * 4 + 1];
+        sum[0] += vtx_xyz0[iv0 * 3 + 0] + vtx_xyz0[iv1 * 3 + 0];
+        sum[1] += vtx_xyz0[iv0 * 3 + 1] + vtx_xyz0[iv1 * 3 + 1];
+        sum[2] += vtx_xyz0[iv0 * 3 + 2] + vtx_xyz0[iv1 * 3 + 2];
+      }
+      // add vertex
+      const double tmp0 = 1.0 / (nf * nf);
+      const double tmp1 = (nf - 3.0) / (nf);
+      p1[0] = sum[0] * tmp0 + tmp1 * vtx_xyz0[iv * 3 + 0];
+      p1[1] = sum[1] * tmp0 + tmp1 * vtx_xyz0[iv * 3 + 1];
+      p1[2] = sum[2] * tmp0 + tmp1 * vtx_xyz0[iv * 3 + 2];
+    }
+  }, num_thread);
 }
 
 void delfem2::SubdivPoints3_MeshQuad(
@@ -726,54 +745,258 @@ void delfem2::SubdivisionPoints_Hex(
     const unsigned int *aHex0,
     unsigned int nHex0,
     const double *aXYZ0,
-    unsigned int nXYZ0) {
+    unsigned int nXYZ0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
   const unsigned int nv0 = nXYZ0;
   const std::size_t ne0 = psupHex0.size();
   const std::size_t nq0 = aQuadHex0.size() / 4;
   const unsigned int nh0 = nHex0;
   aXYZ1.resize((nv0 + ne0 + nq0 + nh0) * 3);
-  for (unsigned int iv = 0; iv < nv0; ++iv) {
-    aXYZ1[iv * 3 + 0] = aXYZ0[iv * 3 + 0];
-    aXYZ1[iv * 3 + 1] = aXYZ0[iv * 3 + 1];
-    aXYZ1[iv * 3 + 2] = aXYZ0[iv * 3 + 2];
+  parallel_for_chunk(nv0, lcl::kNumChunk, [&](size_t iv_begin, size_t iv_end) {
+    for (auto iv = static_cast<unsigned int>(iv_begin); iv < iv_end; ++iv) {
+      aXYZ1[iv * 3 + 0] = aXYZ0[iv * 3 + 0];
+      aXYZ1[iv * 3 + 1] = aXYZ0[iv * 3 + 1];
+      aXYZ1[iv * 3 + 2] = aXYZ0[iv * 3 + 2];
+    }
+  }, num_thread);
+  parallel_for_chunk(nv0, lcl::kNumChunk, [&](size_t iv_begin, size_t iv_end) {
+    for (auto iv = static_cast<unsigned int>(iv_begin); iv < iv_end; ++iv) {
+      for (unsigned int ipsup = psupIndHex0[iv]; ipsup < psupIndHex0[iv + 1]; ++ipsup) {
+        unsigned int jv = psupHex0[ipsup];
+        aXYZ1[(nv0 + ipsup) * 3 + 0] = (aXYZ0[iv * 3 + 0] + aXYZ0[jv * 3 + 0]) * 0.5;
+        aXYZ1[(nv0 + ipsup) * 3 + 1] = (aXYZ0[iv * 3 + 1] + aXYZ0[jv * 3 + 1]) * 0.5;
+        aXYZ1[(nv0 + ipsup) * 3 + 2] = (aXYZ0[iv * 3 + 2] + aXYZ0[jv * 3 + 2]) * 0.5;
+      }
+    }
+  }, num_thread);
+  parallel_for_chunk(nq0, lcl::kNumChunk, [&](size_t iq_begin, size_t iq_end) {
+    for (auto iq = static_cast<unsigned int>(iq_begin); iq < iq_end; ++iq) {
+      const unsigned int iv0 = aQuadHex0[iq * 4 + 0];
+      const unsigned int iv1 = aQuadHex0[iq * 4 + 1];
+      const unsigned int iv2 = aQuadHex0[iq * 4 + 2];
+      const unsigned int iv3 = aQuadHex0[iq * 4 + 3];
+      aXYZ1[(nv0 + ne0 + iq) * 3 + 0] =
+          (aXYZ0[iv0 * 3 + 0] + aXYZ0[iv1 * 3 + 0] + aXYZ0[iv2 * 3 + 0] + aXYZ0[iv3 * 3 + 0]) * 0.25;
+      aXYZ1[(nv0 + ne0 + iq) * 3 + 1] =
+          (aXYZ0[iv0 * 3 + 1] + aXYZ0[iv1 * 3 + 1] + aXYZ0[iv2 * 3 + 1] + aXYZ0[iv3 * 3 + 1]) * 0.25;
+      aXYZ1[(nv0 + ne0 + iq) * 3 + 2] =
+          (aXYZ0[iv0 * 3 + 2] + aXYZ0[iv1 * 3 + 2] + aXYZ0[iv2 * 3 + 2] + aXYZ0[iv3 * 3 + 2]) * 0.25;
+    }
+  }, num_thread);
+  parallel_for_chunk(nh0, lcl::kNumChunk, [&](size_t ih_begin, size_t ih_end) {
+    for (auto ih = static_cast<unsigned int>(ih_begin); ih < ih_end; ++ih) {
+      const unsigned int iv0 = aHex0[ih * 8 + 0];
+      const unsigned int iv1 = aHex0[ih * 8 + 1];
+      const unsigned int iv2 = aHex0[ih * 8 + 2];
+      const unsigned int iv3 = aHex0[ih * 8 + 3];
+      const unsigned int iv4 = aHex0[ih * 8 + 4];
+      const unsigned int iv5 = aHex0[ih * 8 + 5];
+      const unsigned int iv6 = aHex0[ih * 8 + 6];
+      const unsigned int iv7 = aHex0[ih * 8 + 7];
+      aXYZ1[(nv0 + ne0 + nq0 + ih) * 3 + 0] =
+          (aXYZ0[iv0 * 3 + 0] + aXYZ0[iv1 * 3 + 0] + aXYZ0[iv2 * 3 + 0] + aXYZ0[iv3 * 3 + 0] + aXYZ0[iv4 * 3 + 0]
+              + aXYZ0[iv5 * 3 + 0] + aXYZ0[iv6 * 3 + 0] + aXYZ0[iv7 * 3 + 0]) * 0.125;
+      aXYZ1[(nv0 + ne0 + nq0 + ih) * 3 + 1] =
+          (aXYZ0[iv0 * 3 + 1] + aXYZ0[iv1 * 3 + 1] + aXYZ0[iv2 * 3 + 1] + aXYZ0[iv3 * 3 + 1] + aXYZ0[iv4 * 3 + 1]
+              + aXYZ0[iv5 * 3 + 1] + aXYZ0[iv6 * 3 + 1] + aXYZ0[iv7 * 3 + 1]) * 0.125;
+      aXYZ1[(nv0 + ne0 + nq0 + ih) * 3 + 2] =
+          (aXYZ0[iv0 * 3 + 2] + aXYZ0[iv1 * 3 + 2] + aXYZ0[iv2 * 3 + 2] + aXYZ0[iv3 * 3 + 2] + aXYZ0[iv4 * 3 + 2]
+              + aXYZ0[iv5 * 3 + 2] + aXYZ0[iv6 * 3 + 2] + aXYZ0[iv7 * 3 + 2]) * 0.125;
+    }
+  }, num_thread);
+}
+
+// ----------------------------------------------------
+// subdivision stencil
+
+DFM2_INLINE void delfem2::SubdivisionStencil_QuadCatmullClark(
+    SubdivisionStencil &stencil,
+    const std::vector<unsigned int> &aEdgeFace0,
+    const std::vector<unsigned int> &psupQuad0,
+    const unsigned int *quad_vtx0,
+    size_t num_quad0,
+    size_t num_vtx0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
+  const size_t nv0 = num_vtx0;
+  const size_t ne0 = psupQuad0.size();
+  const size_t nq0 = num_quad0;
+  assert(aEdgeFace0.size() == ne0 * 4);
+  std::vector<unsigned int> elsup_ind, elsup; // quads around vertex
+  JArray_ElSuP_MeshElem(
+      elsup_ind, elsup,
+      quad_vtx0, nq0, 4, nv0, num_thread);
+  std::vector<unsigned int> edsup_ind, edsup; // edges around vertex
+  {
+    std::vector<unsigned int> edge_vtx(ne0 * 2);
+    for (unsigned int ie = 0; ie < ne0; ++ie) {
+      edge_vtx[ie * 2 + 0] = aEdgeFace0[ie * 4 + 0];
+      edge_vtx[ie * 2 + 1] = aEdgeFace0[ie * 4 + 1];
+    }
+    JArray_ElSuP_MeshElem(
+        edsup_ind, edsup,
+        edge_vtx.data(), ne0, 2, nv0, num_thread);
   }
+  lcl::SetStencilRows(
+      stencil, nv0 + ne0 + nq0, nv0, num_thread,
+      [&](unsigned int iv1, std::vector<std::pair<unsigned int, double> > &entries) {
+        if (iv1 < nv0) { // vertex
+          const unsigned int nf = elsup_ind[iv1 + 1] - elsup_ind[iv1];
+          if (nf == 0) { return; }
+          for (unsigned int iedsup = edsup_ind[iv1]; iedsup < edsup_ind[iv1 + 1]; ++iedsup) {
+            if (aEdgeFace0[edsup[iedsup] * 4 + 3] != UINT_MAX) { continue; }
+            entries.emplace_back(iv1, 1.0); // the vertex on the boundary is fixed
+            return;
+          }
+          const double tmp0 = 1.0 / (nf * nf);
+          for (unsigned int ielsup = elsup_ind[iv1]; ielsup < elsup_ind[iv1 + 1]; ++ielsup) {
+            const unsigned int iq = elsup[ielsup];
+            for (unsigned int inoq = 0; inoq < 4; ++inoq) {
+              entries.emplace_back(quad_vtx0[iq * 4 + inoq], 0.25 * tmp0);
+            }
+          }
+          for (unsigned int iedsup = edsup_ind[iv1]; iedsup < edsup_ind[iv1 + 1]; ++iedsup) {
+            const unsigned int ie = edsup[iedsup];
+            entries.emplace_back(aEdgeFace0[ie * 4 + 0], tmp0);
+            entries.emplace_back(aEdgeFace0[ie * 4 + 1], tmp0);
+          }
+          entries.emplace_back(iv1, (nf - 3.0) / nf);
+        } else if (iv1 < nv0 + ne0) { // edge
+          const unsigned int ie = iv1 - static_cast<unsigned int>(nv0);
+          const unsigned int iq0 = aEdgeFace0[ie * 4 + 2];
+          const unsigned int iq1 = aEdgeFace0[ie * 4 + 3];
+          if (iq1 == UINT_MAX) {
+            entries.emplace_back(aEdgeFace0[ie * 4 + 0], 0.5);
+            entries.emplace_back(aEdgeFace0[ie * 4 + 1], 0.5);
+            return;
+          }
+          entries.emplace_back(aEdgeFace0[ie * 4 + 0], 0.25);
+          entries.emplace_back(aEdgeFace0[ie * 4 + 1], 0.25);
+          for (unsigned int inoq = 0; inoq < 4; ++inoq) {
+            entries.emplace_back(quad_vtx0[iq0 * 4 + inoq], 0.0625);
+            entries.emplace_back(quad_vtx0[iq1 * 4 + inoq], 0.0625);
+          }
+        } else { // face
+          const unsigned int iq = iv1 - static_cast<unsigned int>(nv0 + ne0);
+          for (unsigned int inoq = 0; inoq < 4; ++inoq) {
+            entries.emplace_back(quad_vtx0[iq * 4 + inoq], 0.25);
+          }
+        }
+      });
+}
+
+DFM2_INLINE void delfem2::SubdivisionStencil_Hex(
+    SubdivisionStencil &stencil,
+    const std::vector<unsigned int> &psupIndHex0,
+    const std::vector<unsigned int> &psupHex0,
+    const std::vector<unsigned int> &aQuadHex0,
+    const unsigned int *aHex0,
+    size_t nHex0,
+    size_t nXYZ0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
+  const size_t nv0 = nXYZ0;
+  const size_t ne0 = psupHex0.size();
+  const size_t nq0 = aQuadHex0.size() / 4;
+  std::vector<unsigned int> edge_vtx0(ne0); // smaller end point of the edge
   for (unsigned int iv = 0; iv < nv0; ++iv) {
     for (unsigned int ipsup = psupIndHex0[iv]; ipsup < psupIndHex0[iv + 1]; ++ipsup) {
-      unsigned int jv = psupHex0[ipsup];
-      aXYZ1[(nv0 + ipsup) * 3 + 0] = (aXYZ0[iv * 3 + 0] + aXYZ0[jv * 3 + 0]) * 0.5;
-      aXYZ1[(nv0 + ipsup) * 3 + 1] = (aXYZ0[iv * 3 + 1] + aXYZ0[jv * 3 + 1]) * 0.5;
-      aXYZ1[(nv0 + ipsup) * 3 + 2] = (aXYZ0[iv * 3 + 2] + aXYZ0[jv * 3 + 2]) * 0.5;
+      edge_vtx0[ipsup] = iv;
     }
   }
-  for (unsigned int iq = 0; iq < nq0; ++iq) {
-    const unsigned int iv0 = aQuadHex0[iq * 4 + 0];
-    const unsigned int iv1 = aQuadHex0[iq * 4 + 1];
-    const unsigned int iv2 = aQuadHex0[iq * 4 + 2];
-    const unsigned int iv3 = aQuadHex0[iq * 4 + 3];
-    aXYZ1[(nv0 + ne0 + iq) * 3 + 0] =
-        (aXYZ0[iv0 * 3 + 0] + aXYZ0[iv1 * 3 + 0] + aXYZ0[iv2 * 3 + 0] + aXYZ0[iv3 * 3 + 0]) * 0.25;
-    aXYZ1[(nv0 + ne0 + iq) * 3 + 1] =
-        (aXYZ0[iv0 * 3 + 1] + aXYZ0[iv1 * 3 + 1] + aXYZ0[iv2 * 3 + 1] + aXYZ0[iv3 * 3 + 1]) * 0.25;
-    aXYZ1[(nv0 + ne0 + iq) * 3 + 2] =
-        (aXYZ0[iv0 * 3 + 2] + aXYZ0[iv1 * 3 + 2] + aXYZ0[iv2 * 3 + 2] + aXYZ0[iv3 * 3 + 2]) * 0.25;
-  }
-  for (unsigned int ih = 0; ih < nh0; ++ih) {
-    const unsigned int iv0 = aHex0[ih * 8 + 0];
-    const unsigned int iv1 = aHex0[ih * 8 + 1];
-    const unsigned int iv2 = aHex0[ih * 8 + 2];
-    const unsigned int iv3 = aHex0[ih * 8 + 3];
-    const unsigned int iv4 = aHex0[ih * 8 + 4];
-    const unsigned int iv5 = aHex0[ih * 8 + 5];
-    const unsigned int iv6 = aHex0[ih * 8 + 6];
-    const unsigned int iv7 = aHex0[ih * 8 + 7];
-    aXYZ1[(nv0 + ne0 + nq0 + ih) * 3 + 0] =
-        (aXYZ0[iv0 * 3 + 0] + aXYZ0[iv1 * 3 + 0] + aXYZ0[iv2 * 3 + 0] + aXYZ0[iv3 * 3 + 0] + aXYZ0[iv4 * 3 + 0]
-            + aXYZ0[iv5 * 3 + 0] + aXYZ0[iv6 * 3 + 0] + aXYZ0[iv7 * 3 + 0]) * 0.125;
-    aXYZ1[(nv0 + ne0 + nq0 + ih) * 3 + 1] =
-        (aXYZ0[iv0 * 3 + 1] + aXYZ0[iv1 * 3 + 1] + aXYZ0[iv2 * 3 + 1] + aXYZ0[iv3 * 3 + 1] + aXYZ0[iv4 * 3 + 1]
-            + aXYZ0[iv5 * 3 + 1] + aXYZ0[iv6 * 3 + 1] + aXYZ0[iv7 * 3 + 1]) * 0.125;
-    aXYZ1[(nv0 + ne0 + nq0 + ih) * 3 + 2] =
-        (aXYZ0[iv0 * 3 + 2] + aXYZ0[iv1 * 3 + 2] + aXYZ0[iv2 * 3 + 2] + aXYZ0[iv3 * 3 + 2] + aXYZ0[iv4 * 3 + 2]
-            + aXYZ0[iv5 * 3 + 2] + aXYZ0[iv6 * 3 + 2] + aXYZ0[iv7 * 3 + 2]) * 0.125;
+  lcl::SetStencilRows(
+      stencil, nv0 + ne0 + nq0 + nHex0, nv0, num_thread,
+      [&](unsigned int iv1, std::vector<std::pair<unsigned int, double> > &entries) {
+        if (iv1 < nv0) { // vertex
+          entries.emplace_back(iv1, 1.0);
+        } else if (iv1 < nv0 + ne0) { // edge
+          const unsigned int ie = iv1 - static_cast<unsigned int>(nv0);
+          entries.emplace_back(edge_vtx0[ie], 0.5);
+          entries.emplace_back(psupHex0[ie], 0.5);
+        } else if (iv1 < nv0 + ne0 + nq0) { // face
+          const unsigned int iq = iv1 - static_cast<unsigned int>(nv0 + ne0);
+          for (unsigned int inoq = 0; inoq < 4; ++inoq) {
+            entries.emplace_back(aQuadHex0[iq * 4 + inoq], 0.25);
+          }
+        } else { // hex
+          const unsigned int ih = iv1 - static_cast<unsigned int>(nv0 + ne0 + nq0);
+          for (unsigned int inoh = 0; inoh < 8; ++inoh) {
+            entries.emplace_back(aHex0[ih * 8 + inoh], 0.125);
+          }
+        }
+      });
+}
+
+DFM2_INLINE void delfem2::SubdivisionStencil_Tet(
+    SubdivisionStencil &stencil,
+    const std::vector<unsigned int> &psup_ind,
+    const std::vector<unsigned int> &psup,
+    size_t num_vtx0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
+  const size_t nv0 = num_vtx0;
+  const size_t ne0 = psup.size();
+  std::vector<unsigned int> edge_vtx0(ne0); // smaller end point of the edge
+  for (unsigned int iv = 0; iv < nv0; ++iv) {
+    for (unsigned int ipsup = psup_ind[iv]; ipsup < psup_ind[iv + 1]; ++ipsup) {
+      edge_vtx0[ipsup] = iv;
+    }
   }
+  lcl::SetStencilRows(
+      stencil, nv0 + ne0, nv0, num_thread,
+      [&](unsigned int iv1, std::vector<std::pair<unsigned int, double> > &entries) {
+        if (iv1 < nv0) { // vertex
+          entries.emplace_back(iv1, 1.0);
+          return;
+        }
+        const unsigned int ie = iv1 - static_cast<unsigned int>(nv0);
+        entries.emplace_back(edge_vtx0[ie], 0.5);
+        entries.emplace_back(psup[ie], 0.5);
+      });
+}
+
+DFM2_INLINE void delfem2::SubdivisionStencil_Compose(
+    SubdivisionStencil &stencil,
+    const SubdivisionStencil &stencil1,
+    const SubdivisionStencil &stencil0,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
+  assert(stencil1.num_vtx0 + 1 == stencil0.ind.size());
+  SubdivisionStencil tmp; // "stencil" may be the same object as the inputs
+  lcl::SetStencilRows(
+      tmp, stencil1.ind.size() - 1, stencil0.num_vtx0, num_thread,
+      [&](unsigned int iv2, std::vector<std::pair<unsigned int, double> > &entries) {
+        for (unsigned int i1 = stencil1.ind[iv2]; i1 < stencil1.ind[iv2 + 1]; ++i1) {
+          const unsigned int iv1 = stencil1.vtx[i1];
+          const double w1 = stencil1.weight[i1];
+          for (unsigned int i0 = stencil0.ind[iv1]; i0 < stencil0.ind[iv1 + 1]; ++i0) {
+            entries.emplace_back(stencil0.vtx[i0], w1 * stencil0.weight[i0]);
+          }
+        }
+      });
+  stencil = std::move(tmp);
+}
+
+DFM2_INLINE void delfem2::SubdivisionPoints_Stencil(
+    std::vector<double> &vtx_xyz1,
+    const SubdivisionStencil &stencil,
+    const double *vtx_xyz0,
+    unsigned int ndim,
+    unsigned int num_thread) {
+  namespace lcl = ::delfem2::mshsubdiv;
+  const size_t nv1 = stencil.ind.size() - 1;
+  vtx_xyz1.assign(nv1 * ndim, 0.0);
+  parallel_for_chunk(nv1, lcl::kNumChunk, [&](size_t iv_begin, size_t iv_end) {
+    for (size_t iv1 = iv_begin; iv1 < iv_end; ++iv1) {
+      double *p1 = vtx_xyz1.data() + iv1 * ndim;
+      for (unsigned int i = stencil.ind[iv1]; i < stencil.ind[iv1 + 1]; ++i) {
+        const double *p0 = vtx_xyz0 + stencil.vtx[i] * ndim;
+        const double w = stencil.weight[i];
+        for (unsigned int idim = 0; idim < ndim; ++idim) {
+          p1[idim] += w * p0[idim];
+        }
+      }
+    }
+  }, num_thread);
 }
@@ -31,6 +31,7 @@ namespace delfem2 {
  * @details new points is in the order of [old points], [edge points], [face points]
  * @param quad_vtxidx1 (out) new connectivity
  * @param aEdgeFace0 (out) two end points on a edge and two quads touching the edge
+ * @param num_thread number of threads. "0" means the number of hardware threads. The result is independent of it.
  */
 DFM2_INLINE void SubdivTopo_MeshQuad(
     std::vector<unsigned int> &quad_vtxidx1,
@@ -39,7 +40,8 @@ DFM2_INLINE void SubdivTopo_MeshQuad(
     std::vector<unsigned int> &aEdgeFace0,
     const unsigned int *aQuad0,
     size_t nQuad0,
-    size_t nPoint0);
+    size_t nPoint0,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE void SubdivTopo_MeshHex(
     std::vector<unsigned int> &aHex1,
@@ -48,7 +50,8 @@ DFM2_INLINE void SubdivTopo_MeshHex(
     std::vector<unsigned int> &aQuadHex0,
     const unsigned int *aHex0,
     size_t nHex0,
-    size_t nhp0);
+    size_t nhp0,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE void SubdivTopo_MeshTet(
     std::vector<unsigned int> &aTet1,
@@ -56,7 +59,8 @@ DFM2_INLINE void SubdivTopo_MeshTet(
     std::vector<unsigned int> &psup,
     const unsigned int *aTet0,
     int nTet0,
-    unsigned int nPoint0);
+    unsigned int nPoint0,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE unsigned int findEdge(
     unsigned int ip0,
@@ -73,6 +77,10 @@ DFM2_INLINE int findFace(
     const std::vector<unsigned int> &elsup_ind,
     const std::vector<unsigned int> &elsup);
 
+/**
+ * @brief points of the Catmull-Clark subdivision in the order of the old points, the edges and the faces
+ * @details the face, edge and vertex points are computed in this order, each of them in parallel
+ */
 DFM2_INLINE void SubdivisionPoints_QuadCatmullClark(
     std::vector<double> &vtx_xyz1,
     //
@@ -83,7 +91,8 @@ DFM2_INLINE void SubdivisionPoints_QuadCatmullClark(
     const unsigned int *quad_vtx0,
     size_t num_quad0,
     const double *vtx_xyz0,
-    size_t num_vtx0);
+    size_t num_vtx0,
+    unsigned int num_thread = 1);
 
 DFM2_INLINE void SubdivPoints3_MeshQuad(
     std::vector<double> &vtx_xyz1,
@@ -101,7 +110,79 @@ DFM2_INLINE void SubdivisionPoints_Hex(
     const unsigned int *aHex0,
     unsigned int nHex0,
     const double *aXYZ0,
-    unsigned int nXYZ0);
+    unsigned int nXYZ0,
+    unsigned int num_thread = 1);
+
+// -----------------------------------------------
+
+/**
+ * @brief subdivision as a sparse matrix (CSR) from the old points to the new points
+ * @details the coordinate of the new point "i" is the sum of "weight[j] * (old point vtx[j])" for ind[i] <= j < ind[i+1].
+ * As the stencil only depends on the topology, it can be reused for animated meshes.
+ */
+struct SubdivisionStencil {
+  std::vector<unsigned int> ind;
+  std::vector<unsigned int> vtx;
+  std::vector<double> weight;
+  size_t num_vtx0 = 0; // number of the old points
+};
+
+/**
+ * @brief stencil of "SubdivisionPoints_QuadCatmullClark"
+ * @param aEdgeFace0 "aEdgeFace0" from "SubdivTopo_MeshQuad"
+ * @param psupQuad0 "psup" from "SubdivTopo_MeshQuad"
+ */
+DFM2_INLINE void SubdivisionStencil_QuadCatmullClark(
+    SubdivisionStencil &stencil,
+    const std::vector<unsigned int> &aEdgeFace0,
+    const std::vector<unsigned int> &psupQuad0,
+    const unsigned int *quad_vtx0,
+    size_t num_quad0,
+    size_t num_vtx0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief stencil of "SubdivisionPoints_Hex"
+ */
+DFM2_INLINE void SubdivisionStencil_Hex(
+    SubdivisionStencil &stencil,
+    const std::vector<unsigned int> &psupIndHex0,
+    const std::vector<unsigned int> &psupHex0,
+    const std::vector<unsigned int> &aQuadHex0,
+    const unsigned int *aHex0,
+    size_t nHex0,
+    size_t nXYZ0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief stencil for the points of "SubdivTopo_MeshTet" (old points and the middle points of the edges)
+ */
+DFM2_INLINE void SubdivisionStencil_Tet(
+    SubdivisionStencil &stencil,
+    const std::vector<unsigned int> &psup_ind,
+    const std::vector<unsigned int> &psup,
+    size_t num_vtx0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief stencil of two levels of subdivision (stencil0 then stencil1) as the product of the matrices
+ */
+DFM2_INLINE void SubdivisionStencil_Compose(
+    SubdivisionStencil &stencil,
+    const SubdivisionStencil &stencil1,
+    const SubdivisionStencil &stencil0,
+    unsigned int num_thread = 0);
+
+/**
+ * @brief compute the new points with the stencil (sparse matrix-vector product)
+ * @param ndim number of values per point (e.g., 3 for the coordinate)
+ */
+DFM2_INLINE void SubdivisionPoints_Stencil(
+    std::vector<double> &vtx_xyz1,
+    const SubdivisionStencil &stencil,
+    const double *vtx_xyz0,
+    unsigned int ndim,
+    unsigned int num_thread = 0);
 
 } // end namespace delfem2
 
@@ -6,12 +6,10 @@
 
 namespace delfem2::opengl{
 
-void Draw_Wire(const delfem2::AdaptiveDistanceField3::CNode &n) {
+void Draw_Wire(const double cent_[3], double hw_) {
   ::glLineWidth(1);
   ::glColor3d(0, 0, 0);
   ::glBegin(GL_LINES);
-  double hw_ = n.hw_;
-  double cent_[3] = {n.cent_[0], n.cent_[1], n.cent_[2]};
   ::glVertex3d(cent_[0] - hw_, cent_[1] - hw_, cent_[2] - hw_);
   ::glVertex3d(cent_[0] + hw_, cent_[1] - hw_, cent_[2] - hw_);
 
@@ -52,21 +50,25 @@ void Draw_Wire(const delfem2::AdaptiveDistanceField3::CNode &n) {
 }
 
 void DrawThisAndChild_Wire(
-    const delfem2::AdaptiveDistanceField3::CNode &n,
+    unsigned int ino,
+    const double cent_[3],
+    double hw_,
     const std::vector<delfem2::AdaptiveDistanceField3::CNode> &aNo) {
-  //      std::cout << "ichild " << ichilds_[0] << " " << ichilds_[1] << " " << ichilds_[2] << " " << ichilds_[3] << std::endl;
-  if (n.ichilds_[0] == -1) {
-    Draw_Wire(n);
+  if (aNo[ino].ichild_ == UINT_MAX) {
+    Draw_Wire(cent_, hw_);
     return;
   }
-  DrawThisAndChild_Wire(aNo[n.ichilds_[0]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[1]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[2]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[3]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[4]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[5]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[6]], aNo);
-  DrawThisAndChild_Wire(aNo[n.ichilds_[7]], aNo);
+  for (unsigned int ichild = 0; ichild < 8; ++ichild) { // children are in the Morton order
+    const double cent_child[3] = {
+        cent_[0] + hw_ * ((ichild & 1) ? +0.5 : -0.5),
+        cent_[1] + hw_ * ((ichild & 2) ? +0.5 : -0.5),
+        cent_[2] + hw_ * ((ichild & 4) ? +0.5 : -0.5)};
+    DrawThisAndChild_Wire(aNo[ino].ichild_ + ichild, cent_child, hw_ * 0.5, aNo);
+  }
+}
+
+void DrawThisAndChild_Wire(const delfem2::AdaptiveDistanceField3 &adf) {
+  DrawThisAndChild_Wire(0, adf.cent_, adf.hw_, adf.aNode);
 }
 
 }
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/pbd_cloth.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/thread.h"
+
+namespace delfem2::pbd_cloth {
+
+//! number of vertices processed by a task of the thread pool
+constexpr unsigned int kNumVtxChunk = 1024;
+
+DFM2_INLINE double Distance3(const double *p0, const double *p1) {
+  return std::sqrt(
+      (p0[0] - p1[0]) * (p0[0] - p1[0]) +
+      (p0[1] - p1[1]) * (p0[1] - p1[1]) +
+      (p0[2] - p1[2]) * (p0[2] - p1[2]));
+}
+
+}  // namespace delfem2::pbd_cloth
+
+DFM2_INLINE void delfem2::ClothXPBD_Substep::Initialize(
+    const std::vector<double> &aXYZ0,
+    const std::vector<unsigned int> &aTri,
+    const std::vector<unsigned int> &aQuad,
+    double compliance_stretch,
+    double compliance_bend) {
+  namespace lcl = ::delfem2::pbd_cloth;
+  const size_t np = aXYZ0.size() / 3;
+  std::vector<unsigned int> psup_ind, psup;
+  JArray_PSuP_MeshElem(
+      psup_ind, psup,
+      aTri.data(), aTri.size() / 3, 3, np);
+  const size_t nquad = aQuad.size() / 4;
+  vtx_cns_ind_.assign(np + 1, 0);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    vtx_cns_ind_[ip + 1] = psup_ind[ip + 1] - psup_ind[ip];
+  }
+  for (unsigned int iq = 0; iq < nquad; ++iq) {
+    vtx_cns_ind_[aQuad[iq * 4 + 0] + 1] += 1;
+    vtx_cns_ind_[aQuad[iq * 4 + 1] + 1] += 1;
+  }
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    vtx_cns_ind_[ip + 1] += vtx_cns_ind_[ip];
+  }
+  const unsigned int ncns = vtx_cns_ind_[np];
+  vtx_cns_vtx_.resize(ncns);
+  vtx_cns_len_.resize(ncns);
+  vtx_cns_cmp_.resize(ncns);
+  std::vector<unsigned int> icns_cur(vtx_cns_ind_.begin(), vtx_cns_ind_.end() - 1);
+  auto add_cns = [&](unsigned int ip, unsigned int jp, double cmp) {
+    const unsigned int icns = icns_cur[ip];
+    vtx_cns_vtx_[icns] = jp;
+    vtx_cns_len_[icns] = lcl::Distance3(aXYZ0.data() + ip * 3, aXYZ0.data() + jp * 3);
+    vtx_cns_cmp_[icns] = cmp;
+    icns_cur[ip] += 1;
+  };
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    for (unsigned int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
+      add_cns(ip, psup[ipsup], compliance_stretch);
+    }
+  }
+  for (unsigned int iq = 0; iq < nquad; ++iq) {
+    const unsigned int ip0 = aQuad[iq * 4 + 0];
+    const unsigned int ip1 = aQuad[iq * 4 + 1];
+    add_cns(ip0, ip1, compliance_bend);
+    add_cns(ip1, ip0, compliance_bend);
+  }
+}
+
+DFM2_INLINE void delfem2::ClothXPBD_Substep::StepTime(
+    std::vector<double> &aXYZ,
+    std::vector<double> &aUVW,
+    const std::vector<int> &aBCFlag,
+    double dt,
+    unsigned int nsubstep,
+    const double gravity[3],
+    double mass_point) {
+  const size_t np = aXYZ.size() / 3;
+  assert(aUVW.size() == np * 3);
+  assert(aBCFlag.size() == np);
+  assert(vtx_cns_ind_.size() == np + 1);
+  if (nsubstep == 0) { return; }
+  const double dts = dt / nsubstep;
+  const double inv_mass = 1.0 / mass_point;
+  // prediction of the first substep
+  aXYZ_prev_ = aXYZ;
+  aXYZ_pred_.resize(np * 3);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    for (unsigned int idim = 0; idim < 3; ++idim) {
+      const unsigned int i = ip * 3 + idim;
+      if (aBCFlag[ip] != 0) {
+        aXYZ_pred_[i] = aXYZ[i];
+        continue;
+      }
+      aUVW[i] += dts * gravity[idim];
+      aXYZ_pred_[i] = aXYZ[i] + dts * aUVW[i];
+    }
+  }
+  for (unsigned int isubstep = 0; isubstep < nsubstep; ++isubstep) {
+    const bool is_last = (isubstep + 1 == nsubstep);
+    // fused pass: constraint projection, velocity update and prediction for the next substep
+    auto func_vtx = [&](unsigned int ip) {
+      double *xo = aXYZ.data() + ip * 3;
+      const double *xp = aXYZ_pred_.data() + ip * 3;
+      if (aBCFlag[ip] != 0) {
+        xo[0] = xp[0];
+        xo[1] = xp[1];
+        xo[2] = xp[2];
+        return;
+      }
+      double dx[3] = {0, 0, 0};
+      const unsigned int icns0 = vtx_cns_ind_[ip];
+      const unsigned int icns1 = vtx_cns_ind_[ip + 1];
+      for (unsigned int icns = icns0; icns < icns1; ++icns) {
+        const unsigned int jp = vtx_cns_vtx_[icns];
+        const double *xq = aXYZ_pred_.data() + jp * 3;
+        const double d[3] = {xp[0] - xq[0], xp[1] - xq[1], xp[2] - xq[2]};
+        const double len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        if (len < 1.0e-20) { continue; }
+        const double wj = (aBCFlag[jp] != 0) ? 0.0 : inv_mass;
+        const double alpha = vtx_cns_cmp_[icns] / (dts * dts);
+        const double s = -inv_mass * (len - vtx_cns_len_[icns]) / ((inv_mass + wj + alpha) * len);
+        dx[0] += s * d[0];
+        dx[1] += s * d[1];
+        dx[2] += s * d[2];
+      }
+      const double r = (icns1 > icns0) ? relaxation / (icns1 - icns0) : 0.0;
+      double *xv = aXYZ_prev_.data() + ip * 3;
+      double *v = aUVW.data() + ip * 3;
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        const double x1 = xp[idim] + r * dx[idim];
+        v[idim] = (x1 - xv[idim]) / dts;
+        xv[idim] = x1;
+        xo[idim] = is_last ? x1 : x1 + dts * (v[idim] + dts * gravity[idim]);
+      }
+      if (!is_last) {
+        v[0] += dts * gravity[0];
+        v[1] += dts * gravity[1];
+        v[2] += dts * gravity[2];
+      }
+    };
+    parallel_for_chunk(np, pbd_cloth::kNumVtxChunk, [&](size_t ip0, size_t ip1) {
+      for (auto ip = static_cast<unsigned int>(ip0); ip < ip1; ++ip) { func_vtx(ip); }
+    }, num_thread);
+    if (!is_last) { aXYZ.swap(aXYZ_pred_); }
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file explicit cloth time integrator with substepped XPBD for fast preview
+ * @details "Small Steps in Physics Simulation" (Macklin et al. 2019) : one Jacobi iteration per substep.
+ */
+
+#ifndef DFM2_PBD_CLOTH_H
+#define DFM2_PBD_CLOTH_H
+
+#include <vector>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+/**
+ * @brief cloth simulation with substepped XPBD using the same (aTri, aQuad) model as "StepTime_InternalDynamics"
+ * @details Stretching is modeled by distance constraints on triangle edges, and bending by the distance constraint
+ * between the two opposite vertices of the quads (aQuad[iq*4+0], aQuad[iq*4+1]).
+ * The constraints are stored per vertex (gather formulation) so that a substep is a single pass
+ * over vertices which projects the constraints (Jacobi-style), updates the velocity and predicts the position
+ * for the next substep. There is no write conflict, so the pass is parallel and the result is independent of
+ * the number of threads.
+ */
+class ClothXPBD_Substep {
+ public:
+  /**
+   * @param[in] aXYZ0 rest shape
+   * @param[in] aTri triangle index
+   * @param[in] aQuad index of 4 vertices required for bending
+   * @param[in] compliance_stretch inverse of the stiffness for stretching (0 for inextensible)
+   * @param[in] compliance_bend inverse of the stiffness for bending
+   */
+  void Initialize(
+      const std::vector<double> &aXYZ0,
+      const std::vector<unsigned int> &aTri,
+      const std::vector<unsigned int> &aQuad,
+      double compliance_stretch,
+      double compliance_bend);
+
+  /**
+   * @param[in,out] aXYZ deformed vertex positions
+   * @param[in,out] aUVW vertex velocity
+   * @param[in] aBCFlag boundary condition flag for each point (0:free else:fixed)
+   * @param[in] dt size of time step (frame)
+   * @param[in] nsubstep number of substeps in a time step
+   * @param[in] gravity gravitational acceleration
+   * @param[in] mass_point mass of a point
+   */
+  void StepTime(
+      std::vector<double> &aXYZ,
+      std::vector<double> &aUVW,
+      const std::vector<int> &aBCFlag,
+      double dt,
+      unsigned int nsubstep,
+      const double gravity[3],
+      double mass_point);
+
+ public:
+  //! scaling of the averaged Jacobi correction. Typically in the range of [1,2)
+  double relaxation = 1.0;
+  //! number of threads. "0" means the number of hardware threads. "1" runs serially.
+  unsigned int num_thread = 0;
+
+ private:
+  std::vector<unsigned int> vtx_cns_ind_;  // jagged array index of constraints around a vertex
+  std::vector<unsigned int> vtx_cns_vtx_;  // the other vertex of the constraint
+  std::vector<double> vtx_cns_len_;  // rest length
+  std::vector<double> vtx_cns_cmp_;  // compliance
+  std::vector<double> aXYZ_pred_, aXYZ_prev_;
+};
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/pbd_cloth.cpp"
+#endif
+
+#endif // DFM2_PBD_CLOTH_H
@@ -12,6 +12,8 @@
 #include <vector>
 #include <cassert>
 #include <algorithm>
+#include <cmath>
+#include <climits>
 
 // ----------------------------------------
 
@@ -28,6 +30,97 @@ DFM2_INLINE double delfem2::myStod(const std::string& str){
   return d;
 }
 
+DFM2_INLINE const char* delfem2::ParseNumber_Double(
+    double& val,
+    const char* begin,
+    const char* end) {
+  // exact powers of ten in double precision
+  static constexpr double kPow10[23] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char* p = begin;
+  while (p < end && (*p == ' ' || *p == '\t')) { ++p; }
+  bool is_negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    is_negative = (*p == '-');
+    ++p;
+  }
+  unsigned long long mantissa = 0;
+  int ndigit = 0;  // number of significant digits stored in mantissa
+  int exp10 = 0;
+  bool is_digit_found = false;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+    is_digit_found = true;
+    if (ndigit < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa != 0) { ndigit++; }
+    } else {
+      exp10++;
+    }
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+      is_digit_found = true;
+      if (ndigit < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa != 0) { ndigit++; }
+        exp10--;
+      }
+    }
+  }
+  if (!is_digit_found) { return begin; }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    long long e = 0;
+    const char* q = ParseNumber_Int(e, p + 1, end);
+    if (q != p + 1) {
+      exp10 += static_cast<int>(std::clamp<long long>(e, -100000, 100000));
+      p = q;
+    }
+  }
+  double v = static_cast<double>(mantissa);
+  if (mantissa < (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+    v = (exp10 < 0) ? v / kPow10[-exp10] : v * kPow10[exp10];
+  } else if (mantissa != 0 && exp10 < -290) {
+    // scale in two steps so that 10^exp10 does not underflow for denormal results
+    v *= std::pow(10.0, exp10 + 290);
+    v *= 1e-290;
+  } else if (mantissa != 0) {
+    v *= std::pow(10.0, exp10);
+  }
+  val = is_negative ? -v : v;
+  return p;
+}
+
+DFM2_INLINE const char* delfem2::ParseNumber_Int(
+    long long& val,
+    const char* begin,
+    const char* end) {
+  const char* p = begin;
+  while (p < end && (*p == ' ' || *p == '\t')) { ++p; }
+  bool is_negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    is_negative = (*p == '-');
+    ++p;
+  }
+  if (p == end || *p < '0' || *p > '9') { return begin; }
+  // accumulate in unsigned and saturate, as a long digit run overflows
+  const unsigned long long vmax = is_negative
+      ? static_cast<unsigned long long>(LLONG_MAX) + 1
+      : static_cast<unsigned long long>(LLONG_MAX);
+  unsigned long long v = 0;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+    const auto d = static_cast<unsigned int>(*p - '0');
+    v = (v > (vmax - d) / 10) ? vmax : v * 10 + d;
+  }
+  if (!is_negative) {
+    val = static_cast<long long>(v);
+  } else {
+    val = (v == vmax) ? LLONG_MIN : -static_cast<long long>(v);
+  }
+  return p;
+}
+
 
 
 // -----------------------------------------------------------
@@ -24,6 +24,28 @@ namespace delfem2 {
 DFM2_INLINE int myStoi(const std::string& str);
 DFM2_INLINE double myStod(const std::string& str);
 
+/**
+ * @brief locale-independent parsing of a floating point number in [begin, end) after skipping spaces and tabs
+ * @details the result is correctly rounded if the significand has less than 16 digits and
+ * the magnitude of the decimal exponent is less than 23. Otherwise, the relative error is within a few ulps.
+ * @param[out] val parsed value
+ * @return pointer to the character after the number. "begin" if no number is found
+ */
+DFM2_INLINE const char* ParseNumber_Double(
+    double& val,
+    const char* begin,
+    const char* end);
+
+/**
+ * @brief locale-independent parsing of an integer in [begin, end) after skipping spaces and tabs
+ * @details the value is saturated to the range of "long long"
+ * @return pointer to the character after the number. "begin" if no number is found
+ */
+DFM2_INLINE const char* ParseNumber_Int(
+    long long& val,
+    const char* begin,
+    const char* end);
+
 // --------------------
 // command related
 
@@ -8,11 +8,15 @@
 #ifndef DFM2_THREAD_H
 #define DFM2_THREAD_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <future>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include "delfem2/dfm2_inline.h"
 
@@ -78,6 +82,61 @@ inline void parallel_for(
   for (auto &f: futures) f.get();
 }
 
+/**
+ * @brief call func(ibegin, iend) for the contiguous ranges of [0, num) with "chunk" items in parallel
+ * @details the ranges are processed in serial if "target_concurrency" is 1 or there is only one range.
+ * No more threads than the ranges are launched.
+ */
+template<typename Func>
+inline void parallel_for_chunk(
+    size_t num,
+    size_t chunk,
+    Func &&func,
+    unsigned int target_concurrency = 0) {
+  const size_t nchunk = (num + chunk - 1) / chunk;
+  auto func_chunk = [&func, num, chunk](size_t ichunk) {
+    func(ichunk * chunk, std::min(num, (ichunk + 1) * chunk));
+  };
+  const size_t nthread = std::min<size_t>(
+      nchunk,
+      (target_concurrency == 0) ? std::thread::hardware_concurrency() : target_concurrency);
+  if (nthread <= 1) {
+    for (size_t ichunk = 0; ichunk < nchunk; ++ichunk) { func_chunk(ichunk); }
+  } else {
+    parallel_for(nchunk, func_chunk, static_cast<unsigned int>(nthread));
+  }
+}
+
+/**
+ * @brief number of the blocks to split "num" items for the threads, such that each block has at least "min_block" items
+ */
+inline unsigned int num_block_for_thread(
+    size_t num,
+    size_t min_block,
+    unsigned int target_concurrency = 0) {
+  const size_t nthread = (target_concurrency == 0) ? std::thread::hardware_concurrency() : target_concurrency;
+  const size_t nblock = std::min(std::max<size_t>(nthread, 1), (num + min_block - 1) / min_block);
+  return static_cast<unsigned int>(std::max<size_t>(nblock, 1));
+}
+
+/**
+ * @brief split [0, num) into "nblock" contiguous ranges and call func(iblock, ibegin, iend) for each of them in parallel
+ * @details a range is processed by one thread, so it can have its own work space indexed by "iblock"
+ */
+template<typename Func>
+inline void parallel_for_block(
+    size_t num,
+    unsigned int nblock,
+    Func &&func) {
+  if (nblock <= 1) {
+    func(0u, size_t(0), num);
+    return;
+  }
+  parallel_for(nblock, [&func, num, nblock](unsigned int ib) {
+    func(ib, num * ib / nblock, num * (ib + 1) / nblock);
+  }, nblock);
+}
+
 }
 
 #endif /* DFM2_THREAD_H */
\ No newline at end of file
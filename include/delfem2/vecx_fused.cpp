@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "delfem2/vecx_fused.h"
+
+#include <vector>
+#include <algorithm>
+
+#include "delfem2/thread.h"
+
+namespace delfem2::vecx_fused {
+
+//! number of entries of a chunk. This is independent of the number of threads for the reproducibility
+constexpr size_t kNumChunk = 4096;
+
+/**
+ * run func(i0,i1,ichunk) over the chunks, then add up the "ndot" partial sums of the chunks in order
+ */
+template<unsigned int ndot, typename FUNC>
+void ReduceChunks(
+    double dot[ndot],
+    size_t n,
+    unsigned int num_thread,
+    FUNC &&func) {
+  const size_t nchunk = (n + kNumChunk - 1) / kNumChunk;
+  std::vector<double> aPartial(nchunk * ndot, 0.0);
+  parallel_for_chunk(n, kNumChunk, [&](size_t i0, size_t i1) {
+    func(i0, i1, aPartial.data() + (i0 / kNumChunk) * ndot);
+  }, num_thread);
+  for (unsigned int idot = 0; idot < ndot; ++idot) { dot[idot] = 0.0; }
+  for (size_t ichunk = 0; ichunk < nchunk; ++ichunk) {
+    for (unsigned int idot = 0; idot < ndot; ++idot) { dot[idot] += aPartial[ichunk * ndot + idot]; }
+  }
+}
+
+}  // namespace delfem2::vecx_fused
+
+// ----------------------------------
+
+DFM2_INLINE double delfem2::DotX_Parallel(
+    const double *va,
+    const double *vb,
+    size_t n,
+    unsigned int num_thread) {
+  double dot[1];
+  vecx_fused::ReduceChunks<1>(
+      dot, n, num_thread,
+      [va, vb](size_t i0, size_t i1, double *d) {
+        double s = 0.0;
+        for (size_t i = i0; i < i1; ++i) { s += va[i] * vb[i]; }
+        d[0] = s;
+      });
+  return dot[0];
+}
+
+DFM2_INLINE void delfem2::PipelinedCG_Dot(
+    double dot[3],
+    double *m,
+    const double *r,
+    const double *u,
+    const double *w,
+    size_t n,
+    unsigned int num_thread) {
+  vecx_fused::ReduceChunks<3>(
+      dot, n, num_thread,
+      [=](size_t i0, size_t i1, double *d) {
+        double ru = 0.0, wu = 0.0, rr = 0.0;
+        for (size_t i = i0; i < i1; ++i) {
+          ru += r[i] * u[i];
+          wu += w[i] * u[i];
+          rr += r[i] * r[i];
+          m[i] = w[i];
+        }
+        d[0] = ru;
+        d[1] = wu;
+        d[2] = rr;
+      });
+}
+
+DFM2_INLINE void delfem2::PipelinedCG_Update(
+    double dot[3],
+    double *x,
+    double *r,
+    double *u,
+    double *w,
+    double *m,
+    double *z,
+    double *q,
+    double *s,
+    double *p,
+    const double *nv,
+    double alpha,
+    double beta,
+    size_t n,
+    unsigned int num_thread) {
+  vecx_fused::ReduceChunks<3>(
+      dot, n, num_thread,
+      [=](size_t i0, size_t i1, double *d) {
+        double ru = 0.0, wu = 0.0, rr = 0.0;
+        for (size_t i = i0; i < i1; ++i) {
+          z[i] = nv[i] + beta * z[i];
+          q[i] = m[i] + beta * q[i];
+          s[i] = w[i] + beta * s[i];
+          p[i] = u[i] + beta * p[i];
+          x[i] += alpha * p[i];
+          r[i] -= alpha * s[i];
+          u[i] -= alpha * q[i];
+          w[i] -= alpha * z[i];
+          ru += r[i] * u[i];
+          wu += w[i] * u[i];
+          rr += r[i] * r[i];
+          m[i] = w[i];
+        }
+        d[0] = ru;
+        d[1] = wu;
+        d[2] = rr;
+      });
+}
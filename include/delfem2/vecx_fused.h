@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file fused and multi-threaded vector kernels for the Krylov solvers
+ * @details vectors are split into fixed-size chunks and the partial sums of the chunks are added in order,
+ * so the results of the reductions do not depend on the number of threads.
+ */
+
+#ifndef DFM2_VECX_FUSED_H
+#define DFM2_VECX_FUSED_H
+
+#include <cstddef>
+
+#include "delfem2/dfm2_inline.h"
+
+namespace delfem2 {
+
+/**
+ * @brief inner product computed with multiple threads
+ * @param num_thread number of threads. "0" means the number of hardware threads. "1" runs serially.
+ */
+DFM2_INLINE double DotX_Parallel(
+    const double *va,
+    const double *vb,
+    size_t n,
+    unsigned int num_thread);
+
+/**
+ * @brief initial reductions of the pipelined CG. dot[0]=({r},{u}), dot[1]=({w},{u}), dot[2]=({r},{r})
+ * @details {m} is overwritten by {w} for the preconditioner in the next step
+ */
+DFM2_INLINE void PipelinedCG_Dot(
+    double dot[3],
+    double *m,
+    const double *r,
+    const double *u,
+    const double *w,
+    size_t n,
+    unsigned int num_thread);
+
+/**
+ * @brief all the vector updates of an iteration of the pipelined CG and the reductions for the next iteration
+ * @details
+ * {z} = {n} + beta{z}, {q} = {m} + beta{q}, {s} = {w} + beta{s}, {p} = {u} + beta{p},
+ * {x} += alpha{p}, {r} -= alpha{s}, {u} -= alpha{q}, {w} -= alpha{z}, then
+ * dot[0]=({r},{u}), dot[1]=({w},{u}), dot[2]=({r},{r}) and {m}={w}.
+ */
+DFM2_INLINE void PipelinedCG_Update(
+    double dot[3],
+    double *x,
+    double *r,
+    double *u,
+    double *w,
+    double *m,
+    double *z,
+    double *q,
+    double *s,
+    double *p,
+    const double *nv,
+    double alpha,
+    double beta,
+    size_t n,
+    unsigned int num_thread);
+
+} // namespace delfem2
+
+#ifndef DFM2_STATIC_LIBRARY
+#  include "delfem2/vecx_fused.cpp"
+#endif
+
+#endif // DFM2_VECX_FUSED_H
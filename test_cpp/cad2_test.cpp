@@ -5,12 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <string>
 
 #include "gtest/gtest.h"
 
 #include "delfem2/cad2.h"
 #include "delfem2/cad2_io_svg.h"
+#include "delfem2/cad2_mesher.h"
 
 namespace dfm2 = delfem2;
 
@@ -52,3 +54,112 @@ TEST(cad,read_svg) {
   }
 }
 
+
+TEST(cad,meshing_multithread) {
+  for (const std::string name: {"/ltshirt.svg", "/lraglan.svg", "/shape2.svg"}) {
+    dfm2::CCad2D cad;
+    dfm2::ReadSVG_Cad2D(cad, std::string(PATH_INPUT_DIR) + name, 1.0);
+    const dfm2::CBoundingBox2<double> bb = cad.BB();
+    dfm2::CMesher_Cad2D mesher0;
+    mesher0.edge_length = std::max(bb.x_max - bb.x_min, bb.y_max - bb.y_min) * 0.02;
+    dfm2::CMeshDynTri2D dmsh0;
+    mesher0.Meshing(dmsh0, cad);
+    dmsh0.Check();
+    EXPECT_EQ(mesher0.aFlgTri.size(), dmsh0.aETri.size());
+    EXPECT_EQ(mesher0.aFlgPnt.size(), dmsh0.aVec2.size());
+    EXPECT_GT(dmsh0.aVec2.size(), mesher0.nvtx + mesher0.edge_point.size());
+    for (unsigned int ifc = 0; ifc < cad.topo.faces.size(); ++ifc) {
+      EXPECT_NE(std::count(mesher0.aFlgTri.begin(), mesher0.aFlgTri.end(), ifc), 0);
+    }
+    // the mesh does not depend on the number of threads
+    dfm2::CMesher_Cad2D mesher1;
+    mesher1.edge_length = mesher0.edge_length;
+    dfm2::CMeshDynTri2D dmsh1;
+    mesher1.Meshing(dmsh1, cad, 3);
+    ASSERT_EQ(dmsh0.aVec2.size(), dmsh1.aVec2.size());
+    ASSERT_EQ(dmsh0.aETri.size(), dmsh1.aETri.size());
+    for (unsigned int ip = 0; ip < dmsh0.aVec2.size(); ++ip) {
+      EXPECT_EQ(dmsh0.aVec2[ip].x, dmsh1.aVec2[ip].x);
+      EXPECT_EQ(dmsh0.aVec2[ip].y, dmsh1.aVec2[ip].y);
+    }
+    for (unsigned int it = 0; it < dmsh0.aETri.size(); ++it) {
+      for (unsigned int inotri = 0; inotri < 3; ++inotri) {
+        EXPECT_EQ(dmsh0.aETri[it].v[inotri], dmsh1.aETri[it].v[inotri]);
+        EXPECT_EQ(dmsh0.aETri[it].s2[inotri], dmsh1.aETri[it].s2[inotri]);
+      }
+    }
+    EXPECT_EQ(mesher0.aFlgTri, mesher1.aFlgTri);
+    EXPECT_EQ(mesher0.aFlgPnt, mesher1.aFlgPnt);
+  }
+}
+
+TEST(cad,remeshing) {
+  dfm2::CCad2D cad;
+  dfm2::ReadSVG_Cad2D(cad, std::string(PATH_INPUT_DIR) + "/ltshirt.svg", 1.0);
+  const dfm2::CBoundingBox2<double> bb = cad.BB();
+  const double len = std::max(bb.x_max - bb.x_min, bb.y_max - bb.y_min);
+  dfm2::CMesher_Cad2D mesher;
+  mesher.edge_length = len * 0.02;
+  dfm2::CMeshDynTri2D dmsh;
+  mesher.Meshing(dmsh, cad);
+  const unsigned int ivtx = 0;
+  const std::vector<unsigned int> aIdFace = cad.topo.FindFaceIndexes_IncludeVeretx(ivtx);
+  ASSERT_FALSE(aIdFace.empty());
+  for (unsigned int itr = 0; itr < 2; ++itr) {
+    // small move is handled with the deformation, and the large move with the meshing
+    const double d = (itr == 0) ? len * 0.002 : len * 0.05;
+    dfm2::CCad2D cad1 = cad;
+    cad1.aVtx[ivtx].pos.p[0] += d;
+    cad1.aVtx[ivtx].pos.p[1] += d;
+    cad1.CopyVertexPositionsToEdges();
+    for (bool is_deform: {true, false}) {
+      dfm2::CMesher_Cad2D mesher1 = mesher;
+      dfm2::CMeshDynTri2D dmsh1 = dmsh;
+      std::vector<unsigned int> new2old;
+      mesher1.Remeshing(new2old, dmsh1, cad1, {ivtx}, {}, is_deform);
+      dmsh1.Check();
+      ASSERT_EQ(new2old.size(), dmsh1.aVec2.size());
+      ASSERT_EQ(mesher1.aFlgPnt.size(), dmsh1.aVec2.size());
+      ASSERT_EQ(mesher1.aFlgTri.size(), dmsh1.aETri.size());
+      unsigned int nmoved = 0;
+      for (unsigned int ip = 0; ip < new2old.size(); ++ip) {
+        const unsigned int jp = new2old[ip];
+        if (jp == UINT_MAX) { continue; }
+        ASSERT_LT(jp, dmsh.aVec2.size());
+        EXPECT_EQ(mesher1.aFlgPnt[ip], mesher.aFlgPnt[jp]);
+        const unsigned int iflg = mesher.aFlgPnt[jp];
+        const unsigned int ifc = iflg - cad.nVtx() - cad.nEdge();
+        const bool is_face_edited = iflg >= cad.nVtx() + cad.nEdge()
+          && std::find(aIdFace.begin(), aIdFace.end(), ifc) != aIdFace.end();
+        if (is_face_edited || ip == ivtx) {
+          nmoved += 1;
+          continue;
+        }
+        if (iflg < cad.nVtx() + cad.nEdge() && iflg >= cad.nVtx()) { continue; } // edge touching the vertex
+        EXPECT_EQ(dmsh1.aVec2[ip].x, dmsh.aVec2[jp].x);
+        EXPECT_EQ(dmsh1.aVec2[ip].y, dmsh.aVec2[jp].y);
+      }
+      if (itr == 0 && is_deform) { EXPECT_GT(nmoved, 1); } // the points inside the faces are carried over
+      if (is_deform) { continue; }
+      // meshing only the edited faces gives the same mesh as meshing all the faces
+      dfm2::CMesher_Cad2D mesher2;
+      mesher2.edge_length = mesher.edge_length;
+      dfm2::CMeshDynTri2D dmsh2;
+      mesher2.Meshing(dmsh2, cad1);
+      ASSERT_EQ(dmsh1.aVec2.size(), dmsh2.aVec2.size());
+      ASSERT_EQ(dmsh1.aETri.size(), dmsh2.aETri.size());
+      for (unsigned int ip = 0; ip < dmsh1.aVec2.size(); ++ip) {
+        EXPECT_EQ(dmsh1.aVec2[ip].x, dmsh2.aVec2[ip].x);
+        EXPECT_EQ(dmsh1.aVec2[ip].y, dmsh2.aVec2[ip].y);
+      }
+      for (unsigned int it = 0; it < dmsh1.aETri.size(); ++it) {
+        for (unsigned int inotri = 0; inotri < 3; ++inotri) {
+          EXPECT_EQ(dmsh1.aETri[it].v[inotri], dmsh2.aETri[it].v[inotri]);
+          EXPECT_EQ(dmsh1.aETri[it].s2[inotri], dmsh2.aETri[it].s2[inotri]);
+        }
+      }
+      EXPECT_EQ(mesher1.aFlgTri, mesher2.aFlgTri);
+      EXPECT_EQ(mesher1.aFlgPnt, mesher2.aFlgPnt);
+    }
+  }
+}
@@ -147,3 +147,52 @@ TEST(def_arap, arap) {
 }
 
 
+TEST(def_arap, reuse_preconditioner) {
+  std::vector<double> aXYZ0;
+  std::vector<unsigned int> aTri;
+  dfm2::MeshTri3D_Cube(aXYZ0, aTri, 10);
+  const size_t np = aXYZ0.size() / 3;
+  double zmin = aXYZ0[2], zmax = aXYZ0[2];
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    zmin = std::min(zmin, aXYZ0[ip * 3 + 2]);
+    zmax = std::max(zmax, aXYZ0[ip * 3 + 2]);
+  }
+  std::vector<int> aBCFlag(np * 3, 0);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    if (aXYZ0[ip * 3 + 2] > zmin + 1.0e-5 && aXYZ0[ip * 3 + 2] < zmax - 1.0e-5) { continue; }
+    aBCFlag[ip * 3 + 0] = aBCFlag[ip * 3 + 1] = aBCFlag[ip * 3 + 2] = 1;
+  }
+  std::vector<double> aXYZ1[2];
+  for (unsigned int iprec = 0; iprec < 2; ++iprec) {
+    dfm2::Deformer_Arap deformer;
+    deformer.Init(aXYZ0, aTri, iprec == 1);
+    aXYZ1[iprec] = aXYZ0;
+    std::vector<double> aQuat1(np * 4);
+    for (unsigned int ip = 0; ip < np; ++ip) { dfm2::Quat_Identity(aQuat1.data() + ip * 4); }
+    unsigned long long num_linear_iteration = 0;
+    for (unsigned int iframe = 0; iframe < 20; ++iframe) {  // quasi-static deformation
+      for (unsigned int ip = 0; ip < np; ++ip) {  // move the top face
+        if (aXYZ0[ip * 3 + 2] < zmax - 1.0e-5) { continue; }
+        aXYZ1[iprec][ip * 3 + 0] = aXYZ0[ip * 3 + 0] + 0.01 * (iframe + 1);
+      }
+      for (unsigned int itr = 0; itr < 2; ++itr) {
+        deformer.Deform(aXYZ1[iprec], aQuat1, aXYZ0, aBCFlag);
+        num_linear_iteration += std::min<size_t>(deformer.convergence_history.size() - 1, 300);
+        dfm2::UpdateQuaternions_Svd(aQuat1, aXYZ0, aXYZ1[iprec], deformer.psup_ind, deformer.psup);
+      }
+      EXPECT_LT(deformer.convergence_history.size(), 300);
+    }
+    if (iprec == 0) { continue; }
+    const auto &stat = deformer.PreconditionerStatistics();
+    EXPECT_EQ(stat.num_update, 40);
+    EXPECT_EQ(stat.num_linear_solve, 40);
+    EXPECT_EQ(stat.num_linear_iteration, num_linear_iteration);
+    EXPECT_LT(stat.num_factorization, stat.num_update);
+    EXPECT_EQ(stat.num_factorization,
+              1 + stat.num_factorization_by_iteration + stat.num_factorization_by_change + stat.num_factorization_by_age);
+  }
+  // the stale factorization does not change the solution
+  for (unsigned int i = 0; i < np * 3; ++i) {
+    EXPECT_NEAR(aXYZ1[0][i], aXYZ1[1][i], 1.0e-5);
+  }
+}
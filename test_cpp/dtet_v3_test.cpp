@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/dtet_v3.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+// check the connectivity, the orientation and the local Delaunay property, and return the total volume
+double CheckDelaunayTet(
+    const std::vector<dfm2::CDynPointTet> &aPo3D,
+    const std::vector<dfm2::CDynTet> &aSTet) {
+  double volume = 0.0;
+  for (unsigned int it = 0; it < aSTet.size(); ++it) {
+    const dfm2::CDynTet &tet = aSTet[it];
+    EXPECT_TRUE(tet.isActive());
+    const dfm2::CVec3d &p0 = aPo3D[tet.v[0]].p;
+    const dfm2::CVec3d &p1 = aPo3D[tet.v[1]].p;
+    const dfm2::CVec3d &p2 = aPo3D[tet.v[2]].p;
+    const dfm2::CVec3d &p3 = aPo3D[tet.v[3]].p;
+    EXPECT_EQ(dfm2::Orient3D(p0, p1, p2, p3), 1);
+    volume += dfm2::Volume_Tet(p0, p1, p2, p3);
+    for (unsigned int ifc = 0; ifc < 4; ++ifc) {
+      const unsigned int jt = tet.s[ifc];
+      if (jt == UINT_MAX) { continue; }
+      EXPECT_LT(jt, aSTet.size());
+      const int irel = dfm2::GetRelationshipTet(tet.v, aSTet[jt].v);
+      EXPECT_TRUE(irel >= 0 && irel < 12);
+      const unsigned int jfc = dfm2::tetRel[irel][ifc];
+      EXPECT_EQ(aSTet[jt].s[jfc], it);
+      EXPECT_LE(dfm2::InSphere(p0, p1, p2, p3, aPo3D[aSTet[jt].v[jfc]].p), 0);
+    }
+  }
+  for (unsigned int ip = 0; ip < aPo3D.size(); ++ip) {
+    const unsigned int it = aPo3D[ip].e;
+    if (it == UINT_MAX) { continue; }
+    EXPECT_EQ(aSTet[it].v[aPo3D[ip].poel], ip);
+  }
+  return volume;
+}
+
+}
+
+TEST(dtet_v3, predicates) {
+  const dfm2::CVec3d p0(0, 0, 0), p1(1, 0, 0), p2(0, 1, 0), p3(0, 0, 1);
+  EXPECT_EQ(dfm2::Orient3D(p0, p1, p2, p3), 1);
+  EXPECT_EQ(dfm2::Orient3D(p0, p2, p1, p3), -1);
+  EXPECT_EQ(dfm2::Orient3D(p0, p1, p2, dfm2::CVec3d(0.3, 0.7, 0.0)), 0);
+  EXPECT_EQ(dfm2::InSphere(p0, p1, p2, p3, dfm2::CVec3d(0.25, 0.25, 0.25)), 1);
+  EXPECT_EQ(dfm2::InSphere(p0, p1, p2, p3, dfm2::CVec3d(2, 2, 2)), -1);
+  EXPECT_EQ(dfm2::InSphere(p0, p1, p2, p3, dfm2::CVec3d(1, 1, 1)), 0); // corners of a cube are co-spherical
+  {  // tiny perturbation is distinguished
+    const double eps = std::ldexp(1.0, -50);
+    EXPECT_EQ(dfm2::Orient3D(p0, p1, p2, dfm2::CVec3d(0.3, 0.7, eps)), 1);
+    EXPECT_EQ(dfm2::InSphere(p0, p1, p2, p3, dfm2::CVec3d(1, 1, 1 - eps)), 1);
+    EXPECT_EQ(dfm2::InSphere(p0, p1, p2, p3, dfm2::CVec3d(1, 1, 1 + eps)), -1);
+  }
+  {  // the near-degenerate configuration with the translated points
+    const dfm2::CVec3d q0(0.1, 0.2, 0.3), q1(1.1, 0.2, 0.3), q2(0.1, 1.2, 0.3), q3(0.1, 0.2, 1.3);
+    const dfm2::CVec3d q4 = (q1 + q2) * 0.5;
+    EXPECT_EQ(dfm2::Orient3D(q0, q1, q2, q4), dfm2::Orient3D(q0, q2, q4, q1));
+    EXPECT_EQ(dfm2::Orient3D(q0, q1, q2, q3), 1);
+  }
+}
+
+TEST(dtet_v3, delaunay_random_points) {
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(0, 1);
+  for (unsigned int itr = 0; itr < 3; ++itr) {
+    std::vector<double> xyz = {
+        0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0,
+        0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1};
+    const unsigned int np = 1000 + itr * 1000;
+    for (unsigned int ip = 0; ip < np; ++ip) {
+      xyz.push_back(dist(rndeng));
+      xyz.push_back(dist(rndeng));
+      xyz.push_back(dist(rndeng));
+    }
+    std::vector<dfm2::CDynPointTet> aPo3D;
+    std::vector<dfm2::CDynTet> aSTet;
+    std::vector<dfm2::CVec3d> aCent;
+    dfm2::MeshingTetDelaunay(aPo3D, aSTet, aCent, xyz.data(), xyz.size() / 3);
+    EXPECT_EQ(aPo3D.size(), xyz.size() / 3);
+    EXPECT_EQ(aCent.size(), aSTet.size());
+    for (const auto &po: aPo3D) { EXPECT_NE(po.e, UINT_MAX); }
+    EXPECT_NEAR(CheckDelaunayTet(aPo3D, aSTet), 1.0, 1.0e-10);
+  }
+}
+
+TEST(dtet_v3, delaunay_grid_points) {
+  // every cube of the grid has eight co-spherical points
+  std::vector<double> xyz;
+  const unsigned int n = 6;
+  for (unsigned int i = 0; i < n; ++i) {
+    for (unsigned int j = 0; j < n; ++j) {
+      for (unsigned int k = 0; k < n; ++k) {
+        xyz.insert(xyz.end(), {i * 0.125, j * 0.125, k * 0.125});
+      }
+    }
+  }
+  xyz.insert(xyz.end(), {0.25, 0.375, 0.5}); // coincident point is skipped
+  std::vector<dfm2::CDynPointTet> aPo3D;
+  std::vector<dfm2::CDynTet> aSTet;
+  std::vector<dfm2::CVec3d> aCent;
+  dfm2::MeshingTetDelaunay(aPo3D, aSTet, aCent, xyz.data(), xyz.size() / 3);
+  unsigned int nskip = 0;
+  for (const auto &po: aPo3D) { nskip += (po.e == UINT_MAX) ? 1 : 0; }
+  EXPECT_EQ(nskip, 1);
+  const double len = 0.125 * (n - 1);
+  EXPECT_NEAR(CheckDelaunayTet(aPo3D, aSTet), len * len * len, 1.0e-10);
+}
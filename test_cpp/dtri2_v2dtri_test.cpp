@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/dtri2_v2dtri.h"
+
+namespace dfm2 = delfem2;
+
+TEST(dtri2_v2dtri, delaunay_random_points) {
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(0, 1);
+  std::vector<dfm2::CVec2d> aVec2(30000);
+  for (auto &p: aVec2) { p = dfm2::CVec2d(dist(rndeng), dist(rndeng) * 0.5); }
+  const size_t np = aVec2.size();
+  std::vector<dfm2::CDynPntSur> aPo2D;
+  std::vector<dfm2::CDynTri> aTri;
+  dfm2::Meshing_Initialize(aPo2D, aTri, aVec2);
+  dfm2::AssertDTri(aTri);
+  dfm2::AssertMeshDTri(aPo2D, aTri);
+  for (unsigned int ip = 0; ip < np; ++ip) { EXPECT_NE(aPo2D[ip].e, UINT_MAX); }
+  EXPECT_EQ(aTri.size(), np * 2 + 1); // the convex hull is the super triangle
+  unsigned int nfail = 0;
+  for (unsigned int itri = 0; itri < aTri.size(); ++itri) {
+    for (unsigned int ied = 0; ied < 3; ++ied) {
+      const unsigned int jtri = aTri[itri].s2[ied];
+      if (jtri == UINT_MAX) { continue; }
+      const unsigned int jno = dfm2::FindAdjEdgeIndex(aTri[itri], ied, aTri);
+      const int res = dfm2::DetDelaunay(
+          aVec2[aTri[itri].v[0]], aVec2[aTri[itri].v[1]], aVec2[aTri[itri].v[2]],
+          aVec2[aTri[jtri].v[jno]]);
+      if (res == 0) { nfail += 1; }
+    }
+  }
+  EXPECT_EQ(nfail, 0);
+}
+
+TEST(dtri2_v2dtri, refine) {
+  std::vector<std::vector<double> > aaXY = {
+      {0, 0, 1, 0, 1, 1, 0, 1},
+      {0.3, 0.3, 0.3, 0.6, 0.6, 0.6, 0.6, 0.3}};
+  dfm2::CMeshDynTri2D dmesh;
+  dmesh.meshing_loops(aaXY, 0.05);
+  dmesh.Check();
+  auto area = [&dmesh]() {
+    double a = 0.0;
+    for (const auto &tri: dmesh.aETri) {
+      a += dfm2::Area_Tri2(dmesh.aVec2[tri.v[0]], dmesh.aVec2[tri.v[1]], dmesh.aVec2[tri.v[2]]);
+    }
+    return a;
+  };
+  EXPECT_NEAR(area(), 1.0 - 0.09, 1.0e-10);
+  const size_t np0 = dmesh.nPoint();
+  dfm2::CCmdRefineMesh cmd;
+  dmesh.RefinementPlan_EdgeLongerThan_InsideCircle(cmd, 0.03, 0.8, 0.8, 0.15);
+  dmesh.Check();
+  EXPECT_GT(dmesh.nPoint(), np0);
+  EXPECT_NEAR(area(), 1.0 - 0.09, 1.0e-10);
+}
+
+TEST(dtri2_v2dtri, meshing_inside) {
+  class CInputTriangulation_Gradation : public dfm2::CInputTriangulation {
+   public:
+    [[nodiscard]] double edgeLengthRatio(double px, [[maybe_unused]] double py) const override {
+      return 1.0 + 2.0 * px;
+    }
+  } density;
+  for (double elen: {0.05, 0.01}) {
+    std::vector<std::vector<double> > aaXY = {{0, 0, 1, 0, 1, 1, 0, 1}};
+    std::vector<dfm2::CDynPntSur> aPo2D;
+    std::vector<dfm2::CDynTri> aTri;
+    std::vector<dfm2::CVec2d> aVec2;
+    dfm2::GenMesh(aPo2D, aTri, aVec2, aaXY, elen, 0.0); // boundary only
+    const size_t np0 = aVec2.size();
+    std::vector<unsigned int> aFlagPnt(np0, 0), aFlagTri(aTri.size(), 3);
+    dfm2::MeshingInside(aPo2D, aTri, aVec2, aFlagPnt, aFlagTri, np0, 0, elen, density);
+    dfm2::AssertDTri(aTri);
+    dfm2::AssertMeshDTri(aPo2D, aTri);
+    EXPECT_EQ(aFlagTri.size(), aTri.size());
+    EXPECT_EQ(aFlagPnt.size(), aVec2.size());
+    for (unsigned int flg: aFlagTri) { EXPECT_EQ(flg, 3); }
+    double area = 0.0, area_ratio_max = 0.0;
+    for (const auto &tri: aTri) {
+      const double a = dfm2::Area_Tri2(aVec2[tri.v[0]], aVec2[tri.v[1]], aVec2[tri.v[2]]);
+      EXPECT_GT(a, 0.0);
+      area += a;
+      const double px = (aVec2[tri.v[0]].x + aVec2[tri.v[1]].x + aVec2[tri.v[2]].x) / 3.0;
+      const double len = elen * density.edgeLengthRatio(px, 0.0);
+      area_ratio_max = std::max(area_ratio_max, a / (len * len));
+    }
+    EXPECT_NEAR(area, 1.0, 1.0e-10);
+    EXPECT_LT(area_ratio_max, 1.5);
+    EXPECT_GT(aVec2.size(), np0 * 2);
+  }
+}
+
+TEST(dtri2_v2dtri, meshing_inside_density) {
+  // pin the density of the mesh such that the change of the refinement shows up
+  std::vector<std::vector<double> > aaXY = {
+      {0, 0, 1, 0, 1, 1, 0, 1},
+      {0.3, 0.3, 0.3, 0.6, 0.6, 0.6, 0.6, 0.3}};
+  const std::tuple<double, size_t, double> aElenNpAreaMax[2] = {
+      {0.05, 394, 0.9594},
+      {0.02, 2306, 0.9397}};
+  for (const auto &[elen, np, area_max]: aElenNpAreaMax) {
+    std::vector<dfm2::CDynPntSur> aPo2D;
+    std::vector<dfm2::CDynTri> aTri;
+    std::vector<dfm2::CVec2d> aVec2;
+    dfm2::GenMesh(aPo2D, aTri, aVec2, aaXY, elen, elen);
+    double area_ratio_max = 0.0;
+    for (const auto &tri: aTri) {
+      const double a = dfm2::Area_Tri2(aVec2[tri.v[0]], aVec2[tri.v[1]], aVec2[tri.v[2]]);
+      area_ratio_max = std::max(area_ratio_max, a / (elen * elen));
+    }
+    EXPECT_EQ(aVec2.size(), np);
+    EXPECT_NEAR(area_ratio_max, area_max, 1.0e-3);
+  }
+}
+
+TEST(dtri2_v2dtri, add_point_constrained_edge) {
+  // two squares side by side. the edge between the left face (flag 0) and the right face (flag 1) is constrained
+  const std::vector<double> aXY = {0, 0, 1, 0, 2, 0, 0, 1, 1, 1, 2, 1};
+  const std::vector<unsigned int> aTri = {0, 1, 4, 0, 4, 3, 1, 2, 5, 1, 5, 4};
+  for (const bool is_constrained: {false, true}) {
+    dfm2::CMeshDynTri2D dmesh;
+    dmesh.Initialize(aXY.data(), 6, aTri.data(), 4);
+    std::vector<unsigned int> aFlagTri = {0, 0, 1, 1};
+    const unsigned int ip = 6;
+    dmesh.aVec2.emplace_back(1.7, 0.6);
+    dmesh.aEPo.resize(7);
+    dfm2::AddPointsMesh(
+        dmesh.aVec2, dmesh.aEPo, dmesh.aETri,
+        ip, 1.0e-10, 0, is_constrained ? aFlagTri.data() : nullptr);  // the walk starts from the left face
+    ASSERT_NE(dmesh.aEPo[ip].e, UINT_MAX);
+    EXPECT_EQ(dmesh.aETri.size(), 6);
+    dmesh.Check();
+    // the point is inserted in the triangle of the right face
+    for (unsigned int itri = 0; itri < dmesh.aETri.size(); ++itri) {
+      const auto &v = dmesh.aETri[itri].v;
+      if (v[0] != ip && v[1] != ip && v[2] != ip) { continue; }
+      EXPECT_TRUE(itri == 2 || itri >= 4);
+      for (unsigned int ino = 0; ino < 3; ++ino) {
+        EXPECT_TRUE(v[ino] == ip || v[ino] == 1 || v[ino] == 2 || v[ino] == 5);
+      }
+    }
+  }
+}
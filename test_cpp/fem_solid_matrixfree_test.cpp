@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/ls_block_sparse.h" // this is necessary for merge operation in fem-related headers
+#include "delfem2/fem_solidlinear.h"
+#include "delfem2/fem_solid_matrixfree.h"
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/jagarray.h"
+#include "delfem2/view_vectorx.h"
+#include "delfem2/lsitrsol.h"
+#include "delfem2/vecxitrsol.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+void MakeRandomTetMesh(
+    std::vector<double> &aXYZ,
+    std::vector<unsigned int> &aTet,
+    unsigned int ndiv,
+    std::mt19937 &rndeng) {
+  const unsigned int m = ndiv + 1;
+  aXYZ.resize(m * m * m * 3);
+  for (unsigned int i = 0; i < m; ++i) {
+    for (unsigned int j = 0; j < m; ++j) {
+      for (unsigned int k = 0; k < m; ++k) {
+        const unsigned int ip = (i * m + j) * m + k;
+        aXYZ[ip * 3 + 0] = i;
+        aXYZ[ip * 3 + 1] = j;
+        aXYZ[ip * 3 + 2] = k;
+      }
+    }
+  }
+  aTet.clear();
+  for (unsigned int i = 0; i < ndiv; ++i) {
+    for (unsigned int j = 0; j < ndiv; ++j) {
+      for (unsigned int k = 0; k < ndiv; ++k) {
+        const unsigned int aIP[8] = {
+            ((i + 0) * m + (j + 0)) * m + (k + 0),
+            ((i + 1) * m + (j + 0)) * m + (k + 0),
+            ((i + 1) * m + (j + 1)) * m + (k + 0),
+            ((i + 0) * m + (j + 1)) * m + (k + 0),
+            ((i + 0) * m + (j + 0)) * m + (k + 1),
+            ((i + 1) * m + (j + 0)) * m + (k + 1),
+            ((i + 1) * m + (j + 1)) * m + (k + 1),
+            ((i + 0) * m + (j + 1)) * m + (k + 1)};
+        const unsigned int aTetHex[6][4] = { // six tetrahedra sharing the diagonal 0-6
+            {0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+            {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+        for (const auto &tet: aTetHex) {
+          for (unsigned int ino: tet) { aTet.push_back(aIP[ino]); }
+        }
+      }
+    }
+  }
+  std::uniform_real_distribution<double> dist(-0.1, 0.1);
+  for (auto &v: aXYZ) { v += dist(rndeng); }
+}
+
+}
+
+TEST(fem_solid_matrixfree, coloring) {
+  std::mt19937 rndeng(std::random_device{}());
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTet;
+  MakeRandomTetMesh(aXYZ, aTet, 4, rndeng);
+  std::vector<unsigned int> color_ind, color_elem;
+  dfm2::JArray_ElemColoring_MeshElem(
+      color_ind, color_elem,
+      aTet.data(), aTet.size() / 4, 4, aXYZ.size() / 3);
+  EXPECT_EQ(color_elem.size(), aTet.size() / 4);
+  for (unsigned int icolor = 0; icolor < color_ind.size() - 1; ++icolor) {
+    std::vector<int> aFlg(aXYZ.size() / 3, 0);
+    for (unsigned int ice = color_ind[icolor]; ice < color_ind[icolor + 1]; ++ice) {
+      const unsigned int itet = color_elem[ice];
+      for (unsigned int ino = 0; ino < 4; ++ino) {
+        const unsigned int ip = aTet[itet * 4 + ino];
+        EXPECT_EQ(aFlg[ip], 0);
+        aFlg[ip] = 1;
+      }
+    }
+  }
+}
+
+TEST(fem_solid_matrixfree, matvec) {
+  std::mt19937 rndeng(std::random_device{}());
+  std::uniform_real_distribution<double> dist01(0., 1.);
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTet;
+  MakeRandomTetMesh(aXYZ, aTet, 5, rndeng);
+  const size_t np = aXYZ.size() / 3;
+  const double myu = 1.0 + dist01(rndeng);
+  const double lambda = dist01(rndeng);
+  // assembled matrix
+  dfm2::CMatrixSparse<double> mat_A;
+  {
+    std::vector<unsigned int> psup_ind, psup;
+    dfm2::JArray_PSuP_MeshElem(
+        psup_ind, psup,
+        aTet.data(), aTet.size() / 4, 4, np);
+    dfm2::JArray_Sort(psup_ind, psup);
+    mat_A.Initialize(np, 3, true);
+    mat_A.SetPattern(
+        psup_ind.data(), psup_ind.size(),
+        psup.data(), psup.size());
+    mat_A.setZero();
+    std::vector<double> vec_b(np * 3, 0.0), aDisp(np * 3, 0.0);
+    const double g[3] = {0, 0, 0};
+    dfm2::MergeLinSys_SolidLinear_Static_MeshTet3D(
+        mat_A, vec_b.data(),
+        myu, lambda, 1.0, g,
+        aXYZ.data(), np, aTet.data(), aTet.size() / 4, aDisp.data());
+  }
+  std::vector<int> aBCFlag(np * 3, 0);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    if (aXYZ[ip * 3 + 2] > 0.5) { continue; }
+    aBCFlag[ip * 3 + 0] = 1;
+    aBCFlag[ip * 3 + 1] = 1;
+    aBCFlag[ip * 3 + 2] = 1;
+  }
+  mat_A.SetFixedBC(aBCFlag.data());
+  // matrix-free operator
+  dfm2::MatrixFreeSolid_MeshTet3D mat_B;
+  mat_B.num_thread = 2;
+  mat_B.Initialize(aXYZ.data(), np, aTet.data(), aTet.size() / 4);
+  mat_B.SetMaterial_LinearIsotropic(myu, lambda);
+  mat_B.SetFixedBC(aBCFlag.data());
+  //
+  std::vector<double> x(np * 3), y0(np * 3), y1(np * 3);
+  for (unsigned int i = 0; i < np * 3; ++i) {
+    x[i] = dist01(rndeng);
+    y0[i] = y1[i] = dist01(rndeng);
+  }
+  mat_A.MatVec(y0.data(), 0.7, x.data(), 0.3);
+  mat_B.MatVec(y1.data(), 0.7, x.data(), 0.3);
+  for (unsigned int i = 0; i < np * 3; ++i) {
+    EXPECT_NEAR(y0[i], y1[i], 1.0e-10);
+  }
+  { // block diagonal
+    std::vector<double> aDia;
+    mat_B.BlockDiagonal(aDia);
+    for (unsigned int i = 0; i < np * 9; ++i) {
+      EXPECT_NEAR(aDia[i], mat_A.val_dia_[i], 1.0e-10);
+    }
+  }
+  { // the tangent of the linear material gives the same result
+    double A[3][3][3][3];
+    for (unsigned int a = 0; a < 3; ++a) {
+      for (unsigned int b = 0; b < 3; ++b) {
+        for (unsigned int c = 0; c < 3; ++c) {
+          for (unsigned int d = 0; d < 3; ++d) {
+            A[a][b][c][d] = lambda * double(a == b && c == d)
+                + myu * double(a == c && b == d) + myu * double(a == d && b == c);
+          }
+        }
+      }
+    }
+    mat_B.SetTangent(0, A);
+    std::vector<double> y2(np * 3, 0.0);
+    mat_B.MatVec(y2.data(), 1.0, x.data(), 0.0);
+    mat_A.MatVec(y0.data(), 1.0, x.data(), 0.0);
+    for (unsigned int i = 0; i < np * 3; ++i) {
+      EXPECT_NEAR(y0[i], y2[i], 1.0e-10);
+    }
+  }
+}
+
+TEST(fem_solid_matrixfree, solve_pcg) {
+  std::mt19937 rndeng(std::random_device{}());
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTet;
+  MakeRandomTetMesh(aXYZ, aTet, 6, rndeng);
+  const size_t np = aXYZ.size() / 3;
+  std::vector<int> aBCFlag(np * 3, 0);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    if (aXYZ[ip * 3 + 2] > 0.5) { continue; }
+    aBCFlag[ip * 3 + 0] = 1;
+    aBCFlag[ip * 3 + 1] = 1;
+    aBCFlag[ip * 3 + 2] = 1;
+  }
+  dfm2::MatrixFreeSolid_MeshTet3D mat;
+  mat.num_thread = 2;
+  mat.Initialize(aXYZ.data(), np, aTet.data(), aTet.size() / 4);
+  mat.SetMaterial_LinearIsotropic(1.0, 0.5);
+  mat.SetFixedBC(aBCFlag.data());
+  std::vector<double> aDia;
+  mat.BlockDiagonal(aDia);
+  std::vector<double> vec_b(np * 3, 0.0);
+  for (unsigned int ip = 0; ip < np; ++ip) { vec_b[ip * 3 + 0] = 0.01; }
+  dfm2::setRHS_Zero(vec_b, aBCFlag, 0);
+  std::vector<double> tmp0(np * 3), tmp1(np * 3);
+  std::vector<unsigned int> aNumItr;
+  for (unsigned int iprec = 0; iprec < 2; ++iprec) {
+    std::vector<double> vec_r = vec_b, vec_x(np * 3);
+    std::vector<double> conv;
+    if (iprec == 0) {
+      dfm2::PreconditionerBlockJacobi3 prec;
+      prec.Initialize(aDia);
+      conv = dfm2::Solve_PCG(
+          dfm2::ViewAsVectorXd(vec_r), dfm2::ViewAsVectorXd(vec_x),
+          dfm2::ViewAsVectorXd(tmp0), dfm2::ViewAsVectorXd(tmp1),
+          1.0e-8, 1000, mat, prec);
+    } else {
+      dfm2::PreconditionerChebyshev<dfm2::MatrixFreeSolid_MeshTet3D> prec;
+      prec.Initialize(mat, aDia, 3);
+      conv = dfm2::Solve_PCG(
+          dfm2::ViewAsVectorXd(vec_r), dfm2::ViewAsVectorXd(vec_x),
+          dfm2::ViewAsVectorXd(tmp0), dfm2::ViewAsVectorXd(tmp1),
+          1.0e-8, 1000, mat, prec);
+    }
+    aNumItr.push_back(static_cast<unsigned int>(conv.size()));
+    EXPECT_LT(conv.size(), 1000);
+    // check the residual
+    std::vector<double> r = vec_b;
+    mat.MatVec(r.data(), -1.0, vec_x.data(), 1.0);
+    EXPECT_LT(std::sqrt(dfm2::Dot(r, r)), 1.0e-7 * std::sqrt(dfm2::Dot(vec_b, vec_b)));
+  }
+  EXPECT_LT(aNumItr[1], aNumItr[0]);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+#include <filesystem>
+#include <cmath>
+#include <fstream>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/file_frame_sequence.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+/**
+ * a grid waving in time
+ */
+void WavingGrid(
+    std::vector<double> &vtx_xyz,
+    unsigned int ndiv,
+    double time) {
+  vtx_xyz.resize((ndiv + 1) * (ndiv + 1) * 3);
+  for (unsigned int i = 0; i <= ndiv; ++i) {
+    for (unsigned int j = 0; j <= ndiv; ++j) {
+      const unsigned int ip = i * (ndiv + 1) + j;
+      const double x = double(i) / ndiv;
+      const double y = double(j) / ndiv;
+      vtx_xyz[ip * 3 + 0] = x;
+      vtx_xyz[ip * 3 + 1] = y;
+      vtx_xyz[ip * 3 + 2] = 0.1 * std::sin(6.0 * x + 3.0 * time) * y;
+    }
+  }
+}
+
+}
+
+TEST(file_frame_sequence, write_read) {
+  const unsigned int ndiv = 30;
+  std::vector<unsigned int> tri_vtx;
+  for (unsigned int i = 0; i < ndiv; ++i) {
+    for (unsigned int j = 0; j < ndiv; ++j) {
+      const unsigned int i0 = i * (ndiv + 1) + j;
+      tri_vtx.insert(tri_vtx.end(), {i0, i0 + ndiv + 1, i0 + 1, i0 + 1, i0 + ndiv + 1, i0 + ndiv + 2});
+    }
+  }
+  const unsigned int np = (ndiv + 1) * (ndiv + 1);
+  const unsigned int nframe = 50;
+  const double quantum = 1.0e-5;
+  const double dt = 0.01;
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "dfm2_file_frame_sequence_test.bin";
+  {
+    dfm2::WriterFrameSequence writer;
+    EXPECT_TRUE(writer.Open(path, np, 3, tri_vtx, 3, quantum, 8));
+    std::vector<double> vtx_xyz;
+    for (unsigned int iframe = 0; iframe < nframe; ++iframe) {
+      WavingGrid(vtx_xyz, ndiv, iframe * dt);
+      writer.AddFrame(vtx_xyz.data(), iframe * dt);
+    }
+    EXPECT_TRUE(writer.Close());
+  }
+  // much smaller than the raw coordinates
+  EXPECT_LT(std::filesystem::file_size(path), nframe * np * 3 * sizeof(double) / 3);
+  dfm2::ReaderFrameSequence reader;
+  EXPECT_TRUE(reader.Open(path));
+  EXPECT_EQ(reader.NumFrame(), nframe);
+  EXPECT_EQ(reader.NumVertex(), np);
+  EXPECT_EQ(reader.NumNodeElement(), 3);
+  EXPECT_EQ(reader.ElementVertex(), tri_vtx);
+  std::mt19937 rndeng(0);
+  std::uniform_int_distribution<unsigned int> dist(0, nframe - 1);
+  std::vector<unsigned int> aIFrame;
+  for (unsigned int iframe = 0; iframe < nframe; ++iframe) { aIFrame.push_back(iframe); }  // in order
+  for (unsigned int itr = 0; itr < 30; ++itr) { aIFrame.push_back(dist(rndeng)); }  // random access
+  for (unsigned int iframe: aIFrame) {
+    std::vector<double> vtx_xyz0, vtx_xyz1;
+    WavingGrid(vtx_xyz0, ndiv, iframe * dt);
+    EXPECT_TRUE(reader.ReadFrame(vtx_xyz1, iframe));
+    EXPECT_DOUBLE_EQ(reader.Time(iframe), iframe * dt);
+    ASSERT_EQ(vtx_xyz0.size(), vtx_xyz1.size());
+    for (unsigned int i = 0; i < vtx_xyz0.size(); ++i) {
+      EXPECT_LE(std::fabs(vtx_xyz0[i] - vtx_xyz1[i]), quantum * 0.5 * (1.0 + 1.0e-6));
+    }
+  }
+  std::vector<double> tmp;
+  EXPECT_FALSE(reader.ReadFrame(tmp, nframe));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);  // the frame table is truncated
+  EXPECT_FALSE(reader.Open(path));
+  std::filesystem::remove(path);
+}
+
+TEST(file_frame_sequence, broken_header) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "dfm2_file_frame_sequence_test_header.bin";
+  const unsigned int ndiv = 4;
+  const unsigned int np = (ndiv + 1) * (ndiv + 1);
+  {
+    dfm2::WriterFrameSequence writer;
+    EXPECT_TRUE(writer.Open(path, np, 3, {}, 3, 1.0e-5, 8));
+    std::vector<double> vtx_xyz;
+    for (unsigned int iframe = 0; iframe < 3; ++iframe) {
+      WavingGrid(vtx_xyz, ndiv, iframe * 0.01);
+      writer.AddFrame(vtx_xyz.data(), iframe * 0.01);
+    }
+    EXPECT_TRUE(writer.Close());
+  }
+  auto write_num_vtx = [&path](std::uint64_t num_vtx) {
+    std::fstream fio(path, std::ios::in | std::ios::out | std::ios::binary);
+    fio.seekp(16);  // magic, version, ndim
+    fio.write(reinterpret_cast<const char *>(&num_vtx), 8);
+  };
+  dfm2::ReaderFrameSequence reader;
+  EXPECT_TRUE(reader.Open(path));
+  write_num_vtx(np * 1000);  // more values than the bytes of a frame
+  EXPECT_FALSE(reader.Open(path));
+  write_num_vtx(UINT64_MAX / 2);  // the number of values overflows
+  EXPECT_FALSE(reader.Open(path));
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/file_snapshot.h"
+#include "delfem2/srch_bvh.h"
+#include "delfem2/ls_block_sparse.h"
+
+namespace dfm2 = delfem2;
+
+TEST(file_snapshot, lz) {
+  std::mt19937 rndeng(0);
+  std::uniform_int_distribution<int> dist(0, 31);
+  for (size_t n: {0, 1, 3, 4, 5, 100, 70000, 300000}) {
+    std::vector<char> src(n);
+    for (size_t i = 0; i < n; ++i) {  // repetitive data with a small alphabet
+      src[i] = (i > 100 && dist(rndeng) != 0) ? src[i - 100] : static_cast<char>(dist(rndeng) % 4);
+    }
+    std::vector<char> cmp;
+    dfm2::Compress_Lz(cmp, src.data(), src.size());
+    if (n > 1000) { EXPECT_LT(cmp.size(), n / 2); }
+    std::vector<char> dst(n);
+    EXPECT_TRUE(dfm2::Decompress_Lz(dst.data(), dst.size(), cmp.data(), cmp.size()));
+    EXPECT_EQ(src, dst);
+    if (n > 0) {
+      EXPECT_FALSE(dfm2::Decompress_Lz(dst.data(), dst.size() - 1, cmp.data(), cmp.size()));
+    }
+  }
+}
+
+TEST(file_snapshot, write_read) {
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  const unsigned int np = 300000;  // 1M dofs
+  std::vector<double> vtx_xyz(np * 3), vtx_velo(np * 3, 0.0);
+  std::vector<float> vtx_mass(np);
+  for (auto &v: vtx_xyz) { v = dist(rndeng); }
+  for (unsigned int ip = 0; ip < np; ip += 7) { vtx_velo[ip * 3 + 1] = dist(rndeng); }
+  for (auto &v: vtx_mass) { v = 1.f; }
+  std::vector<dfm2::CNodeBVH2> bvh_nodes(5);
+  for (unsigned int i = 0; i < bvh_nodes.size(); ++i) {
+    bvh_nodes[i].iparent = i;
+    bvh_nodes[i].ichild[0] = i + 1;
+    bvh_nodes[i].ichild[1] = i + 2;
+  }
+  dfm2::CMatrixSparse<double> mat;
+  {
+    const std::vector<unsigned int> psup_ind = {0, 1, 3, 4}, psup = {1, 0, 2, 1};
+    mat.Initialize(3, 3, true);
+    mat.SetPattern(psup_ind.data(), psup_ind.size(), psup.data(), psup.size());
+    for (auto &v: mat.val_crs_) { v = dist(rndeng); }
+    for (auto &v: mat.val_dia_) { v = dist(rndeng); }
+  }
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_file_snapshot_test.bin";
+  {
+    dfm2::WriterSnapshot snap;
+    snap.Add("vtx_xyz", vtx_xyz);
+    snap.Add("vtx_velo", vtx_velo, true);
+    snap.Add("vtx_mass", vtx_mass, true);
+    snap.Add("bvh_nodes", bvh_nodes);
+    snap.Add("mat_row_ptr", mat.row_ptr_);
+    snap.Add("mat_col_ind", mat.col_ind_);
+    snap.Add("mat_val_crs", mat.val_crs_);
+    snap.Add("mat_val_dia", mat.val_dia_);
+    EXPECT_TRUE(snap.Write(path, 2));
+  }
+  {
+    dfm2::ReaderSnapshot snap;
+    EXPECT_TRUE(snap.Open(path));
+    EXPECT_EQ(snap.Arrays().size(), 8);
+    EXPECT_TRUE(snap.Verify());
+    // compression
+    EXPECT_LT(snap.Find("vtx_velo")->size_stored, vtx_velo.size() * sizeof(double) / 4);
+    EXPECT_LT(snap.Find("vtx_mass")->size_stored, vtx_mass.size() * sizeof(float) / 10);
+    size_t n;
+    const double *p = snap.View<double>("vtx_xyz", n);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 64, 0);
+    EXPECT_EQ(std::vector<double>(p, p + n), vtx_xyz);
+    EXPECT_EQ(snap.View<float>("vtx_xyz", n), nullptr);  // type mismatch
+    EXPECT_EQ(snap.View<double>("hoge", n), nullptr);
+    std::vector<double> vtx_velo1;
+    std::vector<float> vtx_mass1;
+    EXPECT_TRUE(snap.Read(vtx_velo1, "vtx_velo"));
+    EXPECT_TRUE(snap.Read(vtx_mass1, "vtx_mass"));
+    EXPECT_EQ(vtx_velo1, vtx_velo);
+    EXPECT_EQ(vtx_mass1, vtx_mass);
+    const dfm2::CNodeBVH2 *nodes = snap.View<dfm2::CNodeBVH2>("bvh_nodes", n);
+    ASSERT_EQ(n, bvh_nodes.size());
+    for (unsigned int i = 0; i < n; ++i) {
+      EXPECT_EQ(nodes[i].iparent, bvh_nodes[i].iparent);
+      EXPECT_EQ(nodes[i].ichild[1], bvh_nodes[i].ichild[1]);
+    }
+    std::vector<unsigned int> row_ptr, col_ind;
+    std::vector<double> val_crs;
+    EXPECT_TRUE(snap.Read(row_ptr, "mat_row_ptr"));
+    EXPECT_TRUE(snap.Read(col_ind, "mat_col_ind"));
+    EXPECT_TRUE(snap.Read(val_crs, "mat_val_crs"));
+    EXPECT_EQ(row_ptr, mat.row_ptr_);
+    EXPECT_EQ(col_ind, mat.col_ind_);
+    EXPECT_EQ(val_crs, mat.val_crs_);
+  }
+  {  // corrupt a byte of the data
+    const size_t ofs = [&path]() {
+      dfm2::ReaderSnapshot snap;
+      snap.Open(path);
+      return snap.Find("vtx_xyz")->offset + 10;
+    }();
+    std::fstream fio(path, std::ios::in | std::ios::out | std::ios::binary);
+    fio.seekp(static_cast<std::streamoff>(ofs));
+    fio.put('x');
+  }
+  {
+    dfm2::ReaderSnapshot snap;
+    EXPECT_TRUE(snap.Open(path));
+    EXPECT_FALSE(snap.Verify("vtx_xyz"));
+    EXPECT_TRUE(snap.Verify("vtx_velo"));
+    std::vector<double> vtx_xyz1;
+    EXPECT_FALSE(snap.Read(vtx_xyz1, "vtx_xyz"));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(file_snapshot, broken_header) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_file_snapshot_test_header.bin";
+  {
+    dfm2::WriterSnapshot snap;
+    snap.Add("val", std::vector<double>(100, 1.0));
+    EXPECT_TRUE(snap.Write(path));
+  }
+  {  // the size of the directory wraps around the end of the file
+    std::fstream fio(path, std::ios::in | std::ios::out | std::ios::binary);
+    const std::uint64_t ofs_dir = 8, size_dir = UINT64_MAX - 4;
+    fio.seekp(24);
+    fio.write(reinterpret_cast<const char *>(&ofs_dir), 8);
+    fio.write(reinterpret_cast<const char *>(&size_dir), 8);
+  }
+  {
+    dfm2::ReaderSnapshot snap;
+    EXPECT_FALSE(snap.Open(path));
+  }
+  std::filesystem::resize_file(path, 20);  // truncated header
+  {
+    dfm2::ReaderSnapshot snap;
+    EXPECT_FALSE(snap.Open(path));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(file_snapshot, broken_directory) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_file_snapshot_test_dir.bin";
+  // overwrite the number of values of the array "val" and fix the checksum of the directory
+  auto write_num_value = [&path](bool is_compress, std::uint64_t num_value) {
+    {
+      dfm2::WriterSnapshot snap;
+      snap.Add("val", std::vector<double>(100, 1.0), is_compress);
+      EXPECT_TRUE(snap.Write(path));
+    }
+    std::fstream fio(path, std::ios::in | std::ios::out | std::ios::binary);
+    std::uint64_t ofs_dir, size_dir;
+    fio.seekg(24);
+    fio.read(reinterpret_cast<char *>(&ofs_dir), 8);
+    fio.read(reinterpret_cast<char *>(&size_dir), 8);
+    std::vector<char> dir(size_dir);
+    fio.seekg(static_cast<std::streamoff>(ofs_dir));
+    fio.read(dir.data(), static_cast<std::streamsize>(size_dir));
+    std::memcpy(dir.data() + 4 + 3 + 4 * 3, &num_value, 8);  // name length, name, type, size_value, is_compressed
+    std::uint64_t checksum = 14695981039346656037ULL;  // FNV-1a
+    for (char c: dir) { checksum = (checksum ^ static_cast<unsigned char>(c)) * 1099511628211ULL; }
+    fio.seekp(static_cast<std::streamoff>(ofs_dir));
+    fio.write(dir.data(), static_cast<std::streamsize>(size_dir));
+    fio.seekp(40);
+    fio.write(reinterpret_cast<const char *>(&checksum), 8);
+  };
+  for (bool is_compress: {false, true}) {
+    write_num_value(is_compress, 100);  // untouched
+    {
+      dfm2::ReaderSnapshot snap;
+      EXPECT_TRUE(snap.Open(path));
+      size_t n;
+      EXPECT_NE(snap.View<double>("val", n), nullptr);
+      EXPECT_EQ(n, 100);
+    }
+    write_num_value(is_compress, 1ULL << 40);  // larger than the stored bytes
+    {
+      dfm2::ReaderSnapshot snap;
+      EXPECT_FALSE(snap.Open(path));
+    }
+    write_num_value(is_compress, UINT64_MAX / 4);  // the number of bytes overflows
+    {
+      dfm2::ReaderSnapshot snap;
+      EXPECT_FALSE(snap.Open(path));
+    }
+  }
+  std::filesystem::remove(path);
+}
@@ -5,11 +5,17 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+
 #include "gtest/gtest.h"
 
 #include "delfem2/msh_topology_uniform.h"
 #include "delfem2/mshmisc.h"
 #include "delfem2/gridvoxel.h"
+#include "delfem2/gridvoxel_sparse.h"
+#include "delfem2/msh_primitive.h"
 
 #ifndef M_PI
 #  define M_PI 3.14159265359
@@ -63,3 +69,250 @@ TEST(gridvoxel, to_quad) {
   EXPECT_EQ(aXYZ0a.size(), 16 * 3);
   EXPECT_EQ(aQuad0a.size(), 14 * 4);
 }
+
+namespace {
+
+// random blob of voxels. "dense" is in the index "iz*ny*nx+iy*nx+ix" used in "Grid3Voxel_Dilation" etc.
+void MakeVoxelBlob(
+    dfm2::CGrid3<int> &dense,
+    dfm2::CGrid3Sparse<int> &sparse,
+    unsigned int nx, unsigned int ny, unsigned int nz,
+    unsigned int seed) {
+  std::mt19937 rndeng(seed);
+  std::uniform_real_distribution<double> dist(0, 1);
+  dense.Initialize(nx, ny, nz, 0);
+  sparse.Initialize(nx, ny, nz, 0);
+  for (unsigned int iz = 0; iz < nz; ++iz) {
+    for (unsigned int iy = 0; iy < ny; ++iy) {
+      for (unsigned int ix = 0; ix < nx; ++ix) {
+        const double x = (ix + 0.5) / nx - 0.4, y = (iy + 0.5) / ny - 0.5, z = (iz + 0.5) / nz - 0.6;
+        const double r = std::sqrt(x * x + y * y + z * z);
+        if (r > 0.35 + 0.05 * dist(rndeng) || (r > 0.2 && dist(rndeng) < 0.1)) { continue; }
+        dense.aVal[iz * ny * nx + iy * nx + ix] = 1;
+        sparse.Set(ix, iy, iz, 1);
+      }
+    }
+  }
+}
+
+}
+
+TEST(gridvoxel, sparse_morphology) {
+  const unsigned int nx = 37, ny = 29, nz = 45;
+  dfm2::CGrid3<int> dense;
+  dfm2::CGrid3Sparse<int> sparse;
+  MakeVoxelBlob(dense, sparse, nx, ny, nz, 0);
+  EXPECT_LT(sparse.NumBrick(), sparse.brick_index.size());
+  for (unsigned int itr = 0; itr < 6; ++itr) {
+    dfm2::CGrid3Sparse<int> sparse1 = sparse;
+    if (itr % 3 == 2) {
+      dfm2::Grid3Voxel_Erosion(dense);
+      dfm2::Grid3VoxelSparse_Erosion(sparse, 1);
+      dfm2::Grid3VoxelSparse_Erosion(sparse1, 3);
+    } else {
+      dfm2::Grid3Voxel_Dilation(dense);
+      dfm2::Grid3VoxelSparse_Dilation(sparse, 1);
+      dfm2::Grid3VoxelSparse_Dilation(sparse1, 3);
+    }
+    EXPECT_EQ(sparse.brick_index, sparse1.brick_index);
+    EXPECT_EQ(sparse.brick_val, sparse1.brick_val);
+    for (unsigned int iz = 0; iz < nz; ++iz) {
+      for (unsigned int iy = 0; iy < ny; ++iy) {
+        for (unsigned int ix = 0; ix < nx; ++ix) {
+          EXPECT_EQ(sparse.Get(ix, iy, iz), dense.aVal[iz * ny * nx + iy * nx + ix]);
+        }
+      }
+    }
+  }
+  std::vector<unsigned int> aIndVox;
+  dfm2::Grid3Sparse_ActiveVoxels(aIndVox, sparse);
+  EXPECT_EQ(aIndVox.size(), std::count(dense.aVal.begin(), dense.aVal.end(), 1));
+  {  // conversion to the dense grid and back
+    dfm2::CGrid3<int> dense1;
+    dfm2::Grid3Sparse_ToDense(dense1, sparse);
+    dfm2::CGrid3Sparse<int> sparse2;
+    dfm2::Grid3Sparse_FromDense(sparse2, dense1, 0);
+    std::vector<unsigned int> aIndVox2;
+    dfm2::Grid3Sparse_ActiveVoxels(aIndVox2, sparse2);
+    EXPECT_EQ(aIndVox.size(), aIndVox2.size());
+    for (unsigned int ivox: aIndVox2) {
+      unsigned int iv[3];
+      sparse2.CoordVoxel(iv, ivox);
+      EXPECT_EQ(sparse.Get(iv[0], iv[1], iv[2]), 1);
+    }
+  }
+}
+
+TEST(gridvoxel, sparse_geodesic_linseg) {
+  const unsigned int nx = 37, ny = 29, nz = 45;
+  dfm2::CGrid3<int> dense;
+  dfm2::CGrid3Sparse<int> sparse;
+  MakeVoxelBlob(dense, sparse, nx, ny, nz, 1);
+  const unsigned int iv0[3] = {nx / 2, ny / 2, nz / 2};
+  ASSERT_EQ(sparse.Get(iv0[0], iv0[1], iv0[2]), 1);
+  {
+    std::vector<double> aDist0, aDist1;
+    dfm2::VoxelGeodesic(
+        aDist0, {{iv0[2] * ny * nx + iv0[1] * nx + iv0[0], 0.0}}, 0.1, dense);
+    dfm2::VoxelGeodesic_Sparse(
+        aDist1, {{sparse.IndexVoxel(iv0[0], iv0[1], iv0[2]), 0.0}}, 0.1, sparse);
+    for (unsigned int iz = 0; iz < nz; ++iz) {
+      for (unsigned int iy = 0; iy < ny; ++iy) {
+        for (unsigned int ix = 0; ix < nx; ++ix) {
+          const unsigned int ivox = sparse.IndexVoxel(ix, iy, iz);
+          const double d1 = (ivox == UINT_MAX) ? -1.0 : aDist1[ivox];
+          EXPECT_DOUBLE_EQ(aDist0[iz * ny * nx + iy * nx + ix], d1);
+        }
+      }
+    }
+  }
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(-5, 50);
+  unsigned int nhit = 0;
+  for (unsigned int itr = 0; itr < 100; ++itr) {
+    const dfm2::CVec3d ps(dist(rndeng), dist(rndeng), dist(rndeng));
+    const dfm2::CVec3d pe(dist(rndeng), dist(rndeng), dist(rndeng));
+    std::vector<unsigned int> aIndVox0, aIndVox1;
+    dfm2::Intersection_VoxelGrid_LinSeg(aIndVox0, dense, ps, pe);
+    dfm2::Intersection_VoxelGridSparse_LinSeg(aIndVox1, sparse, ps, pe);
+    std::vector<unsigned int> aIndVox2; // non-empty voxels in the sparse index
+    for (unsigned int ivox0: aIndVox0) {
+      if (dense.aVal[ivox0] == 0) { continue; }
+      const unsigned int iz = ivox0 / (ny * nx), iy = (ivox0 / nx) % ny, ix = ivox0 % nx;
+      aIndVox2.push_back(sparse.IndexVoxel(ix, iy, iz));
+    }
+    EXPECT_EQ(aIndVox1, aIndVox2);
+    nhit += aIndVox1.empty() ? 0 : 1;
+  }
+  EXPECT_GT(nhit, 10);
+}
+
+TEST(gridvoxel, sparse_to_mesh) {
+  const unsigned int nx = 37, ny = 29, nz = 45;
+  dfm2::CGrid3<int> dense;
+  dfm2::CGrid3Sparse<int> sparse;
+  MakeVoxelBlob(dense, sparse, nx, ny, nz, 2);
+  std::vector<unsigned int> aIndVox;
+  dfm2::Grid3Sparse_ActiveVoxels(aIndVox, sparse);
+  std::vector<double> aXYZ0;
+  std::vector<unsigned int> aHex0;
+  dfm2::MeshHex3D_VoxelGridSparse(aXYZ0, aHex0, sparse, 1);
+  ASSERT_EQ(aHex0.size(), aIndVox.size() * 8);
+  {
+    std::vector<double> aXYZ1;
+    std::vector<unsigned int> aHex1;
+    dfm2::MeshHex3D_VoxelGridSparse(aXYZ1, aHex1, sparse, 3);
+    EXPECT_EQ(aXYZ0, aXYZ1);
+    EXPECT_EQ(aHex0, aHex1);
+  }
+  for (unsigned int ihex = 0; ihex < aIndVox.size(); ++ihex) {
+    unsigned int iv[3];
+    sparse.CoordVoxel(iv, aIndVox[ihex]);
+    const double *p0 = aXYZ0.data() + aHex0[ihex * 8 + 0] * 3;
+    const double *p6 = aXYZ0.data() + aHex0[ihex * 8 + 6] * 3;
+    EXPECT_EQ(p0[0], iv[0]);
+    EXPECT_EQ(p0[1], iv[1]);
+    EXPECT_EQ(p0[2], iv[2]);
+    EXPECT_EQ(p6[0], iv[0] + 1);
+    EXPECT_EQ(p6[1], iv[1] + 1);
+    EXPECT_EQ(p6[2], iv[2] + 1);
+  }
+  {  // same points as the dense mesh without the unreferenced points
+    dfm2::CGrid3<int> dense1;
+    dfm2::Grid3Sparse_ToDense(dense1, sparse);
+    std::vector<double> aXYZ1;
+    std::vector<int> aHex1;
+    dfm2::MeshHex3D_VoxelGrid(aXYZ1, aHex1, nx, ny, nz, dense1.aVal);
+    EXPECT_EQ(aHex1.size(), aHex0.size());
+    std::vector<int> aFlg(aXYZ1.size() / 3, 0);
+    for (int ip: aHex1) { aFlg[ip] = 1; }
+    EXPECT_EQ(std::count(aFlg.begin(), aFlg.end(), 1), aXYZ0.size() / 3);
+  }
+  std::vector<double> aXYZ2;
+  std::vector<unsigned int> aTet;
+  dfm2::MeshTet3D_VoxelGridSparse(aXYZ2, aTet, sparse);
+  EXPECT_EQ(aXYZ0, aXYZ2);
+  ASSERT_EQ(aTet.size(), aIndVox.size() * 24);
+  double vol = 0.0;
+  for (unsigned int it = 0; it < aTet.size() / 4; ++it) {
+    const dfm2::CVec3d p0(aXYZ2.data() + aTet[it * 4 + 0] * 3);
+    const dfm2::CVec3d p1(aXYZ2.data() + aTet[it * 4 + 1] * 3);
+    const dfm2::CVec3d p2(aXYZ2.data() + aTet[it * 4 + 2] * 3);
+    const dfm2::CVec3d p3(aXYZ2.data() + aTet[it * 4 + 3] * 3);
+    vol += std::fabs((p1 - p0).dot((p2 - p0).cross(p3 - p0))) / 6.0;
+  }
+  EXPECT_NEAR(vol, static_cast<double>(aIndVox.size()), 1.0e-8);
+}
+
+TEST(gridvoxel, voxelize_meshtri_cube) {
+  // the vertices are at the centers of the voxels, so the rays pass through the edges and the vertices
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTri;
+  dfm2::MeshTri3D_Cube(aXYZ, aTri, 8);
+  for (double &x: aXYZ) { x = x * 8 + 6.5; } // [2.5, 10.5]^3
+  const unsigned int n = 13;
+  for (unsigned int num_thread: {1, 3}) {
+    for (bool is_fill_inside: {true, false}) {
+      dfm2::CGrid3<int> grid;
+      grid.Initialize(n, n, n, 0);
+      dfm2::Grid3Voxel_MeshTri3D(
+          grid,
+          aXYZ.data(), aXYZ.size() / 3, aTri.data(), aTri.size() / 3,
+          is_fill_inside, num_thread);
+      for (unsigned int ix = 0; ix < n; ++ix) {
+        for (unsigned int iy = 0; iy < n; ++iy) {
+          for (unsigned int iz = 0; iz < n; ++iz) {
+            const bool is_in = ix >= 2 && ix <= 10 && iy >= 2 && iy <= 10 && iz >= 2 && iz <= 10;
+            const bool is_surf = is_in && (ix == 2 || ix == 10 || iy == 2 || iy == 10 || iz == 2 || iz == 10);
+            const int val = grid.aVal[ix * n * n + iy * n + iz];
+            EXPECT_EQ(val, (is_fill_inside ? is_in : is_surf) ? 1 : 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(gridvoxel, voxelize_meshtri_sphere) {
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTri;
+  const double rad = 0.4;
+  dfm2::MeshTri3D_Sphere(aXYZ, aTri, rad, 32, 32);
+  for (unsigned int ip = 0; ip < aXYZ.size() / 3; ++ip) { aXYZ[ip * 3 + 0] += 0.01; } // off the lattice
+  const unsigned int nx = 50, ny = 45, nz = 55;
+  const double h = 0.02;
+  dfm2::CGrid3<int> grid;
+  grid.Initialize(nx, ny, nz, 0);
+  grid.am = dfm2::CMat4d::Translation({-0.5, -0.45, -0.55}) * dfm2::CMat4d::AffineScale(h);
+  dfm2::Grid3Voxel_MeshTri3D(grid, aXYZ.data(), aXYZ.size() / 3, aTri.data(), aTri.size() / 3, true, 1);
+  {
+    dfm2::CGrid3<int> grid1 = grid;
+    dfm2::Grid3Voxel_MeshTri3D(grid1, aXYZ.data(), aXYZ.size() / 3, aTri.data(), aTri.size() / 3, true, 3);
+    EXPECT_EQ(grid.aVal, grid1.aVal);
+  }
+  dfm2::CGrid3<int> surf = grid;
+  dfm2::Grid3Voxel_MeshTri3D(surf, aXYZ.data(), aXYZ.size() / 3, aTri.data(), aTri.size() / 3, false, 3);
+  const double rad_in = rad * std::cos(M_PI / 32) * std::cos(M_PI / 32); // inscribed by the polyhedron
+  unsigned int nsurf = 0;
+  for (unsigned int ix = 0; ix < nx; ++ix) {
+    for (unsigned int iy = 0; iy < ny; ++iy) {
+      for (unsigned int iz = 0; iz < nz; ++iz) {
+        const unsigned int ivox = ix * ny * nz + iy * nz + iz;
+        const double c[3] = {(ix + 0.5) * h - 0.5 - 0.01, (iy + 0.5) * h - 0.45, (iz + 0.5) * h - 0.55};
+        const double r = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        if (r < rad_in - 1.0e-10) { EXPECT_EQ(grid.aVal[ivox], 1); }
+        if (r > rad + h) { EXPECT_EQ(grid.aVal[ivox], 0); }
+        if (r < rad_in - h || r > rad + h) { EXPECT_EQ(surf.aVal[ivox], 0); }
+        if (surf.aVal[ivox] == 1) { EXPECT_EQ(grid.aVal[ivox], 1); }
+        nsurf += surf.aVal[ivox];
+      }
+    }
+  }
+  EXPECT_GT(nsurf, 1000);
+  for (unsigned int ip = 0; ip < aXYZ.size() / 3; ++ip) { // voxels containing the vertices are on the surface
+    const int ix = static_cast<int>(std::floor((aXYZ[ip * 3 + 0] + 0.5) / h));
+    const int iy = static_cast<int>(std::floor((aXYZ[ip * 3 + 1] + 0.45) / h));
+    const int iz = static_cast<int>(std::floor((aXYZ[ip * 3 + 2] + 0.55) / h));
+    EXPECT_EQ(surf.aVal[ix * ny * nz + iy * nz + iz], 1);
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <random>
+#include <cstring>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/isrf_adf.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+class CSphere : public dfm2::Input_AdaptiveDistanceField3 {
+ public:
+  [[nodiscard]] double sdf(double x, double y, double z) const override {
+    return 0.7 - std::sqrt(x * x + y * y + z * z);
+  }
+};
+
+}
+
+TEST(isrf_adf, sphere) {
+  double bb[6] = {-1, 1, -1, 1, -1, 1};
+  dfm2::AdaptiveDistanceField3 adf;
+  adf.SetUp(CSphere(), bb);
+  EXPECT_GT(adf.aNode.size(), 1000);
+  {  // the tree is independent of the number of threads
+    dfm2::AdaptiveDistanceField3 adf1;
+    adf1.SetUp(CSphere(), bb, 3);
+    ASSERT_EQ(adf.aNode.size(), adf1.aNode.size());
+    for (unsigned int ino = 0; ino < adf.aNode.size(); ++ino) {
+      EXPECT_EQ(adf.aNode[ino].ichild_, adf1.aNode[ino].ichild_);
+      EXPECT_EQ(std::memcmp(adf.aNode[ino].dists_, adf1.aNode[ino].dists_, sizeof(float) * 8), 0);
+    }
+  }
+  // children are stored in blocks of eight
+  for (const auto &no: adf.aNode) {
+    if (no.ichild_ == UINT_MAX) { continue; }
+    EXPECT_EQ((no.ichild_ - 1) % 8, 0);
+  }
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist_01(0, 1);
+  const unsigned int np = 1000;
+  std::vector<double> xyz;
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    // points near the surface
+    const double r = 0.6 + 0.2 * dist_01(rndeng);
+    const double theta = std::acos(2 * dist_01(rndeng) - 1);
+    const double phi = 2 * M_PI * dist_01(rndeng);
+    xyz.push_back(r * std::sin(theta) * std::cos(phi));
+    xyz.push_back(r * std::sin(theta) * std::sin(phi));
+    xyz.push_back(r * std::cos(theta));
+  }
+  std::vector<double> dist(np), nrm(np * 3);
+  adf.Projections(dist.data(), nrm.data(), xyz.data(), np);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    const double *p = xyz.data() + ip * 3;
+    const double r = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    EXPECT_NEAR(dist[ip], 0.7 - r, 1.5e-2); // tolerance of the subdivision
+    EXPECT_GT((nrm[ip * 3 + 0] * p[0] + nrm[ip * 3 + 1] * p[1] + nrm[ip * 3 + 2] * p[2]) / r, 0.99);
+    double n0[3];
+    const double d0 = adf.Projection(p[0], p[1], p[2], n0);
+    EXPECT_EQ(d0, dist[ip]);
+    EXPECT_EQ(n0[0], nrm[ip * 3 + 0]);
+  }
+  {  // iso-surface is on the sphere
+    std::vector<double> tri_xyz;
+    adf.BuildIsoSurface_MarchingCube(tri_xyz);
+    EXPECT_GT(tri_xyz.size(), 9 * 100);
+    for (unsigned int i = 0; i < tri_xyz.size() / 3; ++i) {
+      const double *p = tri_xyz.data() + i * 3;
+      EXPECT_NEAR(std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]), 0.7, 2.0e-3);
+    }
+  }
+}
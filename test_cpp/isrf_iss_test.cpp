@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/isrf_iss.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+// sphere refined toward its surface
+class CSphereAdaptive : public dfm2::CInput_IsosurfaceStuffing {
+ public:
+  [[nodiscard]] double SignedDistance(double x, double y, double z) const override {
+    return 0.8 - std::sqrt(x * x + y * y + z * z);
+  }
+  void Level(
+      int &ilevel_vol, int &ilevel_srf, int &nlayer, double &sdf,
+      double px, double py, double pz) const override {
+    sdf = this->SignedDistance(px, py, pz);
+    ilevel_vol = -1;
+    ilevel_srf = 2;
+    nlayer = 2;
+  }
+};
+
+}
+
+TEST(isrf_iss, parallel) {
+  const double center[3] = {0, 0, 0};
+  std::vector<double> vtx_xyz0;
+  std::vector<unsigned int> tet_vtx0;
+  std::vector<int> vtx_onsurf0;
+  dfm2::IsoSurfaceStuffing(
+      vtx_xyz0, tet_vtx0, vtx_onsurf0,
+      CSphereAdaptive(), 0.2, 2.0, center);
+  ASSERT_GT(tet_vtx0.size() / 4, 1000);
+  double volume = 0.0;
+  for (unsigned int it = 0; it < tet_vtx0.size() / 4; ++it) {
+    const double *p0 = vtx_xyz0.data() + tet_vtx0[it * 4 + 0] * 3;
+    const double *p1 = vtx_xyz0.data() + tet_vtx0[it * 4 + 1] * 3;
+    const double *p2 = vtx_xyz0.data() + tet_vtx0[it * 4 + 2] * 3;
+    const double *p3 = vtx_xyz0.data() + tet_vtx0[it * 4 + 3] * 3;
+    const double a[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    const double b[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    const double c[3] = {p3[0] - p0[0], p3[1] - p0[1], p3[2] - p0[2]};
+    const double v = (a[0] * (b[1] * c[2] - b[2] * c[1])
+        + a[1] * (b[2] * c[0] - b[0] * c[2])
+        + a[2] * (b[0] * c[1] - b[1] * c[0])) / 6.0;
+    EXPECT_GT(v, 0.0);
+    volume += v;
+  }
+  const double volume_sphere = 4.0 / 3.0 * M_PI * 0.8 * 0.8 * 0.8;
+  EXPECT_NEAR(volume, volume_sphere, volume_sphere * 0.05);
+  // the output is independent of the number of threads
+  for (unsigned int num_thread: {0, 3}) {
+    std::vector<double> vtx_xyz1;
+    std::vector<unsigned int> tet_vtx1;
+    std::vector<int> vtx_onsurf1;
+    dfm2::IsoSurfaceStuffing(
+        vtx_xyz1, tet_vtx1, vtx_onsurf1,
+        CSphereAdaptive(), 0.2, 2.0, center, num_thread);
+    EXPECT_EQ(vtx_xyz0, vtx_xyz1);
+    EXPECT_EQ(tet_vtx0, tet_vtx1);
+    EXPECT_EQ(vtx_onsurf0, vtx_onsurf1);
+  }
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <map>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/isrf_marchingcube.h"
+#include "delfem2/isrf_adf.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+// check that the mesh is closed and consistently oriented, and return the enclosed volume
+double CheckClosedMesh(
+    const std::vector<double> &vtx_xyz,
+    const std::vector<unsigned int> &tri_vtx) {
+  std::map<std::pair<unsigned int, unsigned int>, unsigned int> edge_count;
+  double volume = 0.0;
+  for (unsigned int it = 0; it < tri_vtx.size() / 3; ++it) {
+    for (unsigned int i = 0; i < 3; ++i) {
+      edge_count[{tri_vtx[it * 3 + i], tri_vtx[it * 3 + (i + 1) % 3]}] += 1;
+    }
+    const double *p0 = vtx_xyz.data() + tri_vtx[it * 3 + 0] * 3;
+    const double *p1 = vtx_xyz.data() + tri_vtx[it * 3 + 1] * 3;
+    const double *p2 = vtx_xyz.data() + tri_vtx[it * 3 + 2] * 3;
+    volume += (p0[0] * (p1[1] * p2[2] - p1[2] * p2[1])
+        + p0[1] * (p1[2] * p2[0] - p1[0] * p2[2])
+        + p0[2] * (p1[0] * p2[1] - p1[1] * p2[0])) / 6.0;
+  }
+  for (const auto &ec: edge_count) {
+    EXPECT_EQ(ec.second, 1);
+    const auto itr = edge_count.find({ec.first.second, ec.first.first});
+    EXPECT_TRUE(itr != edge_count.end());
+  }
+  // Euler characteristic of a sphere
+  const size_t ne = edge_count.size() / 2;
+  EXPECT_EQ(vtx_xyz.size() / 3 + tri_vtx.size() / 3, ne + 2);
+  return volume;
+}
+
+}
+
+TEST(isrf_marchingcube, grid_sphere) {
+  const unsigned int np = 33;
+  const double org[3] = {-1, -1, -1};
+  const double elen = 2.0 / (np - 1);
+  std::vector<double> grid_val(np * np * np);
+  for (unsigned int ix = 0; ix < np; ++ix) {
+    for (unsigned int iy = 0; iy < np; ++iy) {
+      for (unsigned int iz = 0; iz < np; ++iz) {
+        const double x = org[0] + elen * ix, y = org[1] + elen * iy, z = org[2] + elen * iz;
+        grid_val[(ix * np + iy) * np + iz] = 0.7 - std::sqrt(x * x + y * y + z * z);
+      }
+    }
+  }
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  dfm2::MeshTri3D_MarchingCube_Grid(
+      vtx_xyz, tri_vtx,
+      grid_val.data(), np, np, np, 0.0, org, elen, 1);
+  EXPECT_GT(tri_vtx.size() / 3, 1000);
+  for (unsigned int ip = 0; ip < vtx_xyz.size() / 3; ++ip) {
+    const double *p = vtx_xyz.data() + ip * 3;
+    EXPECT_NEAR(std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]), 0.7, 1.0e-2);
+  }
+  const double volume = CheckClosedMesh(vtx_xyz, tri_vtx);
+  EXPECT_NEAR(volume, 4. / 3. * M_PI * 0.7 * 0.7 * 0.7, 2.0e-2); // outward normal
+  for (unsigned int num_thread: {0, 3}) {
+    std::vector<double> vtx_xyz1;
+    std::vector<unsigned int> tri_vtx1;
+    dfm2::MeshTri3D_MarchingCube_Grid(
+        vtx_xyz1, tri_vtx1,
+        grid_val.data(), np, np, np, 0.0, org, elen, num_thread);
+    EXPECT_EQ(vtx_xyz, vtx_xyz1);
+    EXPECT_EQ(tri_vtx, tri_vtx1);
+  }
+}
+
+TEST(isrf_marchingcube, voxel) {
+  dfm2::CGrid3<int> grid;
+  grid.Initialize(3, 3, 3, 0);
+  grid.Set(1, 1, 1, 1);
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  dfm2::MeshTri3D_MarchingCube_VoxelGrid(vtx_xyz, tri_vtx, grid, 0.5);
+  EXPECT_EQ(vtx_xyz.size() / 3, 6);
+  EXPECT_EQ(tri_vtx.size() / 3, 8);
+  EXPECT_NEAR(CheckClosedMesh(vtx_xyz, tri_vtx), 1.0 / 6.0, 1.0e-10); // octahedron
+  for (unsigned int ip = 0; ip < vtx_xyz.size() / 3; ++ip) {
+    const double *p = vtx_xyz.data() + ip * 3;
+    EXPECT_NEAR(std::fabs(p[0] - 1.5) + std::fabs(p[1] - 1.5) + std::fabs(p[2] - 1.5), 0.5, 1.0e-10);
+  }
+}
+
+TEST(isrf_marchingcube, adf) {
+  class CSphere : public dfm2::Input_AdaptiveDistanceField3 {
+   public:
+    [[nodiscard]] double sdf(double x, double y, double z) const override {
+      return 0.7 - std::sqrt(x * x + y * y + z * z);
+    }
+  };
+  double bb[6] = {-1, 1, -1, 1, -1, 1};
+  dfm2::AdaptiveDistanceField3 adf;
+  adf.SetUp(CSphere(), bb);
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  adf.BuildIsoSurface_MarchingCube(vtx_xyz, tri_vtx);
+  std::vector<double> tri_xyz;
+  adf.BuildIsoSurface_MarchingCube(tri_xyz);
+  EXPECT_EQ(tri_xyz.size(), tri_vtx.size() * 3);
+  EXPECT_LT(vtx_xyz.size() * 4, tri_xyz.size()); // vertices are shared
+  {
+    std::vector<double> vtx_xyz1;
+    std::vector<unsigned int> tri_vtx1;
+    adf.BuildIsoSurface_MarchingCube(vtx_xyz1, tri_vtx1, 1);
+    EXPECT_EQ(vtx_xyz, vtx_xyz1);
+    EXPECT_EQ(tri_vtx, tri_vtx1);
+  }
+}
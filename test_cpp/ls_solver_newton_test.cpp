@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/ls_solver_block_sparse_newton.h"
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/jagarray.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+/**
+ * energy of a backward-Euler time step of a mass-spring net
+ * W = sum_i m/(2h^2)|x_i - x_i^*|^2 + sum_e k/2 (|x_e0-x_e1| - L_e)^2
+ */
+class MassSpringStep {
+ public:
+  MassSpringStep(unsigned int ndiv, double dt) : dt_(dt) {
+    const unsigned int m = ndiv + 1;
+    for (unsigned int ix = 0; ix < m; ++ix) {
+      for (unsigned int iy = 0; iy < m; ++iy) {
+        aXYZ0.insert(aXYZ0.end(), {double(ix) / ndiv, double(iy) / ndiv, 0.0});
+      }
+    }
+    for (unsigned int ix = 0; ix < ndiv; ++ix) {
+      for (unsigned int iy = 0; iy < ndiv; ++iy) {
+        const unsigned int i00 = ix * m + iy, i10 = (ix + 1) * m + iy;
+        const unsigned int i01 = ix * m + iy + 1, i11 = (ix + 1) * m + iy + 1;
+        aTri.insert(aTri.end(), {i00, i10, i01, i11, i01, i10});
+      }
+    }
+    std::vector<unsigned int> psup_ind, psup;
+    dfm2::JArray_PSuP_MeshElem(
+        psup_ind, psup,
+        aTri.data(), aTri.size() / 3, 3, aXYZ0.size() / 3);
+    for (unsigned int ip = 0; ip < psup_ind.size() - 1; ++ip) {
+      for (unsigned int ipsup = psup_ind[ip]; ipsup < psup_ind[ip + 1]; ++ipsup) {
+        if (psup[ipsup] < ip) { continue; }
+        aLine.insert(aLine.end(), {ip, psup[ipsup]});
+      }
+    }
+    // prediction of the free fall from the rest
+    aXYZ_pred = aXYZ0;
+    for (unsigned int ip = 0; ip < aXYZ0.size() / 3; ++ip) { aXYZ_pred[ip * 3 + 2] -= dt * dt * 10.0; }
+  }
+
+  [[nodiscard]] double Energy(const double *x) const {
+    double w = 0.0;
+    for (unsigned int i = 0; i < aXYZ0.size(); ++i) {
+      w += 0.5 * mass / (dt_ * dt_) * (x[i] - aXYZ_pred[i]) * (x[i] - aXYZ_pred[i]);
+    }
+    for (unsigned int il = 0; il < aLine.size() / 2; ++il) {
+      const unsigned int ip0 = aLine[il * 2 + 0], ip1 = aLine[il * 2 + 1];
+      const double l = Length(x, ip0, ip1);
+      const double L = Length(aXYZ0.data(), ip0, ip1);
+      w += 0.5 * stiffness * (l - L) * (l - L);
+    }
+    return w;
+  }
+
+  double Assemble(
+      dfm2::CMatrixSparse<double> &hessian,
+      double *gradient,
+      const double *x,
+      std::vector<unsigned int> &merge_buffer) const {
+    const double mh = mass / (dt_ * dt_);
+    for (unsigned int i = 0; i < aXYZ0.size(); ++i) {
+      gradient[i] += mh * (x[i] - aXYZ_pred[i]);
+    }
+    hessian.AddDia(mh);
+    for (unsigned int il = 0; il < aLine.size() / 2; ++il) {
+      const unsigned int aIP[2] = {aLine[il * 2 + 0], aLine[il * 2 + 1]};
+      const double l = Length(x, aIP[0], aIP[1]);
+      const double L = Length(aXYZ0.data(), aIP[0], aIP[1]);
+      double v[3];
+      for (unsigned int i = 0; i < 3; ++i) { v[i] = x[aIP[0] * 3 + i] - x[aIP[1] * 3 + i]; }
+      double emat[2][2][3][3];
+      for (unsigned int i = 0; i < 3; ++i) {
+        gradient[aIP[0] * 3 + i] += stiffness * (l - L) * v[i] / l;
+        gradient[aIP[1] * 3 + i] -= stiffness * (l - L) * v[i] / l;
+        for (unsigned int j = 0; j < 3; ++j) {
+          const double k = stiffness * L / (l * l * l) * v[i] * v[j]
+              + stiffness * (l - L) / l * double(i == j);
+          emat[0][0][i][j] = emat[1][1][i][j] = +k;
+          emat[0][1][i][j] = emat[1][0][i][j] = -k;
+        }
+      }
+      dfm2::Merge<2, 2, 3, 3, double>(hessian, aIP, aIP, emat, merge_buffer);
+    }
+    return Energy(x);
+  }
+
+  static double Length(const double *x, unsigned int ip0, unsigned int ip1) {
+    const double *p0 = x + ip0 * 3, *p1 = x + ip1 * 3;
+    return std::sqrt(
+        (p0[0] - p1[0]) * (p0[0] - p1[0]) + (p0[1] - p1[1]) * (p0[1] - p1[1]) + (p0[2] - p1[2]) * (p0[2] - p1[2]));
+  }
+
+ public:
+  std::vector<double> aXYZ0, aXYZ_pred;
+  std::vector<unsigned int> aTri, aLine;
+  double mass = 1.0e-3;
+  double stiffness = 100.0;
+  double dt_;
+};
+
+}
+
+TEST(ls_solver_newton, mass_spring) {
+  const unsigned int ndiv = 16;
+  const MassSpringStep problem(ndiv, 0.2);
+  const size_t np = problem.aXYZ0.size() / 3;
+  std::vector<unsigned int> psup_ind, psup;
+  dfm2::JArray_PSuP_MeshElem(
+      psup_ind, psup,
+      problem.aTri.data(), problem.aTri.size() / 3, 3, np);
+  dfm2::JArray_Sort(psup_ind, psup);
+  std::vector<unsigned int> aNumLinItr;
+  std::vector<double> aXYZ[2];
+  for (auto forcing: {
+      dfm2::NewtonSolver_BlockSparse::FORCING_TERM::CONSTANT,
+      dfm2::NewtonSolver_BlockSparse::FORCING_TERM::EISENSTAT_WALKER}) {
+    dfm2::NewtonSolver_BlockSparse solver;
+    solver.Initialize(np, 3, psup_ind, psup);
+    for (unsigned int iy = 0; iy < ndiv + 1; ++iy) {  // fix the edge at x=0
+      solver.dof_bcflag[iy * 3 + 0] = 1;
+      solver.dof_bcflag[iy * 3 + 1] = 1;
+      solver.dof_bcflag[iy * 3 + 2] = 1;
+    }
+    solver.forcing_type = forcing;
+    if (forcing == dfm2::NewtonSolver_BlockSparse::FORCING_TERM::CONSTANT) {
+      solver.forcing_term_max = 1.0e-8;
+    }
+    unsigned int ncallback = 0;
+    solver.callback = [&ncallback](const dfm2::NewtonSolverIterationInfo &info) {
+      EXPECT_EQ(info.iteration, ncallback);
+      EXPECT_GE(info.time_assemble, 0.0);
+      ncallback++;
+    };
+    std::vector<double> x = problem.aXYZ0;
+    std::vector<unsigned int> merge_buffer;
+    const bool is_converged = solver.Solve(
+        x,
+        [&problem](const double *x0) { return problem.Energy(x0); },
+        [&problem, &merge_buffer](dfm2::CMatrixSparse<double> &hessian, double *gradient, const double *x0) {
+          return problem.Assemble(hessian, gradient, x0, merge_buffer);
+        });
+    EXPECT_TRUE(is_converged);
+    EXPECT_EQ(ncallback, solver.history.size());
+    EXPECT_GT(solver.history.size(), 2);
+    unsigned int nlinitr = 0;
+    for (const auto &info: solver.history) {
+      EXPECT_LE(info.energy_new, info.energy);  // the energy decreases monotonically
+      EXPECT_LE(info.linear_residual_ratio, info.forcing_term * 1.000001);
+      nlinitr += info.num_linear_iteration;
+    }
+    aNumLinItr.push_back(nlinitr);
+    for (unsigned int iy = 0; iy < ndiv + 1; ++iy) {  // fixed points do not move
+      EXPECT_EQ(x[iy * 3 + 2], 0.0);
+    }
+    EXPECT_LT(x[(np - 1) * 3 + 2], -0.1);  // the free end falls
+    aXYZ[aXYZ[0].empty() ? 0 : 1] = x;
+  }
+  for (unsigned int i = 0; i < np * 3; ++i) {
+    EXPECT_NEAR(aXYZ[0][i], aXYZ[1][i], 1.0e-6);
+  }
+  // inexact Newton needs less linear iterations in total
+  EXPECT_LT(aNumLinItr[1], aNumLinItr[0]);
+}
+
+TEST(ls_solver_newton, mass_spring_cg) {
+  const unsigned int ndiv = 8;
+  const MassSpringStep problem(ndiv, 0.2);
+  const size_t np = problem.aXYZ0.size() / 3;
+  std::vector<unsigned int> psup_ind, psup;
+  dfm2::JArray_PSuP_MeshElem(
+      psup_ind, psup,
+      problem.aTri.data(), problem.aTri.size() / 3, 3, np);
+  dfm2::JArray_Sort(psup_ind, psup);
+  for (unsigned int max_linear_iteration: {1000u, 3u}) {
+    dfm2::NewtonSolver_BlockSparse solver;
+    solver.Initialize(np, 3, psup_ind, psup);
+    for (unsigned int iy = 0; iy < ndiv + 1; ++iy) {  // fix the edge at x=0
+      solver.dof_bcflag[iy * 3 + 0] = 1;
+      solver.dof_bcflag[iy * 3 + 1] = 1;
+      solver.dof_bcflag[iy * 3 + 2] = 1;
+    }
+    solver.use_preconditioner = false;
+    solver.forcing_type = dfm2::NewtonSolver_BlockSparse::FORCING_TERM::CONSTANT;
+    solver.forcing_term_max = 1.0e-8;
+    solver.max_iteration = 5;
+    solver.max_linear_iteration = max_linear_iteration;
+    std::vector<double> x = problem.aXYZ0;
+    std::vector<unsigned int> merge_buffer;
+    solver.Solve(
+        x,
+        [&problem](const double *x0) { return problem.Energy(x0); },
+        [&problem, &merge_buffer](dfm2::CMatrixSparse<double> &hessian, double *gradient, const double *x0) {
+          return problem.Assemble(hessian, gradient, x0, merge_buffer);
+        });
+    ASSERT_FALSE(solver.history.empty());
+    unsigned int nlinitr_max = 0;
+    for (const auto &info: solver.history) {
+      EXPECT_GE(info.num_linear_iteration, 1u);
+      EXPECT_LE(info.num_linear_iteration, max_linear_iteration);
+      EXPECT_GT(info.linear_residual_ratio, 0.0);
+      if (info.num_linear_iteration < max_linear_iteration) {  // the linear solver converged
+        EXPECT_LT(info.linear_residual_ratio, info.forcing_term);
+      } else {
+        EXPECT_GT(info.linear_residual_ratio, info.forcing_term);
+      }
+      nlinitr_max = std::max(nlinitr_max, info.num_linear_iteration);
+    }
+    EXPECT_GT(nlinitr_max, 2u);
+  }
+}
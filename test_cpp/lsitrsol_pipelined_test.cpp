@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/lsitrsol_pipelined.h"
+#include "delfem2/vecx_fused.h"
+#include "delfem2/ls_block_sparse.h"
+#include "delfem2/ls_ilu_block_sparse.h"
+#include "delfem2/view_vectorx.h"
+#include "delfem2/lsitrsol.h"
+#include "delfem2/vecxitrsol.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+/**
+ * 5-point laplacian on a (ndiv x ndiv) grid plus a small random diagonal
+ */
+void MakeMatrixPoisson2D(
+    dfm2::CMatrixSparse<double> &mat,
+    unsigned int ndiv,
+    std::mt19937 &rndeng) {
+  const unsigned int np = ndiv * ndiv;
+  std::vector<unsigned int> psup_ind(np + 1, 0), psup;
+  for (unsigned int ix = 0; ix < ndiv; ++ix) {
+    for (unsigned int iy = 0; iy < ndiv; ++iy) {
+      const unsigned int ip = ix * ndiv + iy;
+      if (ix > 0) { psup.push_back(ip - ndiv); }
+      if (iy > 0) { psup.push_back(ip - 1); }
+      if (iy < ndiv - 1) { psup.push_back(ip + 1); }
+      if (ix < ndiv - 1) { psup.push_back(ip + ndiv); }
+      psup_ind[ip + 1] = static_cast<unsigned int>(psup.size());
+    }
+  }
+  mat.Initialize(np, 1, true);
+  mat.SetPattern(psup_ind.data(), psup_ind.size(), psup.data(), psup.size());
+  std::uniform_real_distribution<double> dist(0.0, 1.0e-3);
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    mat.val_dia_[ip] = 4.0 + dist(rndeng);
+  }
+  for (auto &v: mat.val_crs_) { v = -1.0; }
+}
+
+}
+
+TEST(lsitrsol_pipelined, dot) {
+  std::mt19937 rndeng(std::random_device{}());
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (unsigned int n: {0u, 1u, 100u, 4096u, 100000u}) {
+    std::vector<double> a(n), b(n);
+    for (unsigned int i = 0; i < n; ++i) {
+      a[i] = dist(rndeng);
+      b[i] = dist(rndeng);
+    }
+    const double d0 = dfm2::DotX(a.data(), b.data(), n);
+    const double d1 = dfm2::DotX_Parallel(a.data(), b.data(), n, 1);
+    const double d2 = dfm2::DotX_Parallel(a.data(), b.data(), n, 3);
+    EXPECT_NEAR(d0, d1, 1.0e-10);
+    EXPECT_EQ(d1, d2);  // reproducible regardless of the number of threads
+  }
+}
+
+TEST(lsitrsol_pipelined, poisson) {
+  std::mt19937 rndeng(std::random_device{}());
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  dfm2::CMatrixSparse<double> mat;
+  MakeMatrixPoisson2D(mat, 100, rndeng);
+  const size_t n = mat.nrowblk_;
+  std::vector<double> vec_b(n);
+  for (auto &v: vec_b) { v = dist(rndeng); }
+  dfm2::CPreconditionerILU<double> ilu;
+  ilu.Initialize_ILUk(mat, 0);
+  ilu.CopyValue(mat);
+  ilu.Decompose();
+  // reference
+  std::vector<double> x0(n);
+  std::vector<double> conv0;
+  {
+    std::vector<double> r = vec_b, tmp0(n), tmp1(n);
+    conv0 = dfm2::Solve_PCG(
+        dfm2::ViewAsVectorXd(r), dfm2::ViewAsVectorXd(x0),
+        dfm2::ViewAsVectorXd(tmp0), dfm2::ViewAsVectorXd(tmp1),
+        1.0e-10, 1000, mat, ilu);
+  }
+  std::vector<double> x1, x2;
+  std::vector<double> conv1;
+  {
+    std::vector<double> r = vec_b;
+    conv1 = dfm2::Solve_PCG_Pipelined(
+        r, x1, 1.0e-10, 1000, mat, ilu, 1);
+  }
+  {
+    std::vector<double> r = vec_b;
+    dfm2::Solve_PCG_Pipelined(
+        r, x2, 1.0e-10, 1000, mat, ilu, 3);
+  }
+  EXPECT_LT(conv1.size(), 1000);
+  // the pipelined CG is mathematically identical to the standard one
+  EXPECT_NEAR(static_cast<double>(conv1.size()), static_cast<double>(conv0.size()), 3);
+  // true residual
+  std::vector<double> r = vec_b;
+  mat.MatVec(r.data(), -1.0, x1.data(), 1.0);
+  EXPECT_LT(std::sqrt(dfm2::Dot(r, r)), 1.0e-8 * std::sqrt(dfm2::Dot(vec_b, vec_b)));
+  for (unsigned int i = 0; i < n; ++i) {
+    EXPECT_NEAR(x0[i], x1[i], 1.0e-7);
+    EXPECT_EQ(x1[i], x2[i]);
+  }
+}
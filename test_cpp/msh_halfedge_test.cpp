@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/msh_halfedge.h"
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/msh_normal.h"
+#include "delfem2/msh_primitive.h"
+#include "delfem2/jagarray.h"
+#include "delfem2/mshmisc.h"
+
+namespace dfm2 = delfem2;
+
+TEST(msh_halfedge, adjacency) {
+  for (unsigned int imesh = 0; imesh < 2; ++imesh) {
+    std::vector<double> vtx_xyz;
+    std::vector<unsigned int> tri_vtx;
+    if (imesh == 0) {
+      dfm2::MeshTri3D_Sphere(vtx_xyz, tri_vtx, 1.0, 32, 32);
+    } else {
+      dfm2::MeshTri3D_CylinderOpen(vtx_xyz, tri_vtx, 1.0, 2.0, 32, 8);  // with boundary
+    }
+    const size_t np = vtx_xyz.size() / 3;
+    const size_t ntri = tri_vtx.size() / 3;
+    dfm2::HalfEdgeMeshTri mesh;
+    mesh.Initialize(tri_vtx.data(), ntri, np, 3);
+    for (unsigned int ihe = 0; ihe < mesh.NumHalfEdge(); ++ihe) {
+      const unsigned int jhe = mesh.Twin(ihe);
+      if (jhe == UINT_MAX) { continue; }
+      EXPECT_EQ(mesh.Twin(jhe), ihe);
+      EXPECT_EQ(mesh.Origin(jhe), mesh.Target(ihe));
+      EXPECT_EQ(mesh.Origin(mesh.Next(ihe)), mesh.Target(ihe));
+    }
+    {  // elem surrounding elem
+      std::vector<unsigned int> elsuel0, elsuel1;
+      dfm2::ElSuEl_MeshElem(elsuel0, tri_vtx.data(), ntri, dfm2::MESHELEM_TRI, np);
+      dfm2::ElSuEl_HalfEdgeMeshTri(elsuel1, mesh);
+      EXPECT_EQ(elsuel0, elsuel1);
+    }
+    {  // point surrounding point
+      std::vector<unsigned int> psup_ind0, psup0, psup_ind1, psup1;
+      dfm2::JArray_PSuP_MeshElem(psup_ind0, psup0, tri_vtx.data(), ntri, 3, np);
+      dfm2::JArray_PSuP_HalfEdgeMeshTri(psup_ind1, psup1, mesh, 3);
+      EXPECT_EQ(psup_ind0, psup_ind1);
+      dfm2::JArray_Sort(psup_ind0, psup0);
+      dfm2::JArray_Sort(psup_ind1, psup1);
+      EXPECT_EQ(psup0, psup1);
+    }
+    {  // normal
+      std::vector<double> vtx_nrm0(np * 3), vtx_nrm1(np * 3);
+      dfm2::Normal_MeshTri3D(vtx_nrm0.data(), vtx_xyz.data(), np, tri_vtx.data(), ntri);
+      dfm2::Normal_HalfEdgeMeshTri3(vtx_nrm1.data(), vtx_xyz.data(), mesh, 3);
+      for (unsigned int i = 0; i < np * 3; ++i) {
+        EXPECT_NEAR(vtx_nrm0[i], vtx_nrm1[i], 1.0e-10);
+      }
+    }
+    {  // smoothing
+      std::vector<int> tri_vtx_int(tri_vtx.begin(), tri_vtx.end());
+      std::vector<unsigned int> elsup_ind, elsup;
+      dfm2::JArray_ElSuP_MeshElem(elsup_ind, elsup, tri_vtx.data(), ntri, 3, np);
+      std::vector<double> vtx_xyz0 = vtx_xyz, vtx_xyz1 = vtx_xyz;
+      dfm2::LaplacianSmoothing(
+          vtx_xyz0, tri_vtx_int,
+          std::vector<int>(elsup_ind.begin(), elsup_ind.end()),
+          std::vector<int>(elsup.begin(), elsup.end()));
+      dfm2::LaplacianSmoothing_HalfEdgeMeshTri3(vtx_xyz1, mesh);
+      for (unsigned int i = 0; i < np * 3; ++i) {
+        EXPECT_NEAR(vtx_xyz0[i], vtx_xyz1[i], 1.0e-10);
+      }
+    }
+  }
+}
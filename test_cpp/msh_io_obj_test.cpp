@@ -5,6 +5,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fstream>
+#include <random>
+#include <climits>
+
 #include "gtest/gtest.h"
 
 #include "delfem2/mshmisc.h"
@@ -26,3 +30,80 @@ TEST(mshio, load_obj) {
       std::filesystem::path(PATH_INPUT_DIR) / "bunny_1k.obj");
   EXPECT_EQ(aTri.size(), 1000 * 3);
 }
+
+TEST(mshio, read_obj_parallel) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_read_obj_parallel.obj";
+  {
+    std::ofstream fout(path, std::ios::binary);
+    fout << "# " << std::string(1000, 'x') << "\n";  // a line longer than 256 bytes
+    fout << "v 0 0 0\r\n";
+    fout << "v 1.5 -2.25e1 +3E-2\n";
+    fout << "v\t1 1 0   " << std::string(500, ' ') << "\n";
+    fout << "vt 0.5 0.25\n";
+    fout << "vn 0 0 1\n";
+    fout << "g group0\n";
+    fout << "f 1/1/1 2/1/1 3/1/1\n";
+    fout << "f -3//-1 -2//-1 -1//-1\n";
+    fout << "f 1 2 3 1\n";
+  }
+  std::vector<double> vtx_xyz, vtx_tex, vtx_nrm;
+  std::vector<unsigned int> elem_vtx_index, elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm;
+  EXPECT_TRUE(dfm2::Read_WavefrontObj_Parallel(
+      vtx_xyz, vtx_tex, vtx_nrm,
+      elem_vtx_index, elem_vtx_xyz, elem_vtx_tex, elem_vtx_nrm,
+      path));
+  EXPECT_EQ(vtx_xyz, std::vector<double>({0, 0, 0, 1.5, -22.5, 0.03, 1, 1, 0}));
+  EXPECT_EQ(vtx_tex, std::vector<double>({0.5, 0.25}));
+  EXPECT_EQ(vtx_nrm, std::vector<double>({0, 0, 1}));
+  EXPECT_EQ(elem_vtx_index, std::vector<unsigned int>({0, 3, 6, 10}));
+  EXPECT_EQ(elem_vtx_xyz, std::vector<unsigned int>({0, 1, 2, 0, 1, 2, 0, 1, 2, 0}));
+  EXPECT_EQ(elem_vtx_tex[0], 0);
+  EXPECT_EQ(elem_vtx_tex[3], UINT_MAX);
+  EXPECT_EQ(elem_vtx_nrm[3], 0);
+  EXPECT_EQ(elem_vtx_nrm[6], UINT_MAX);
+  std::vector<double> aXYZ;
+  std::vector<unsigned int> aTri;
+  dfm2::Read_Obj(aXYZ, aTri, path);
+  EXPECT_EQ(aTri.size(), 9);
+  std::filesystem::remove(path);
+}
+
+TEST(mshio, read_obj_parallel_large) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_read_obj_parallel_large.obj";
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  const unsigned int ntri = 100000;
+  std::vector<double> aXYZ0;
+  {  // large enough to be split into several chunks. Faces use negative indices
+    std::ofstream fout(path, std::ios::binary);
+    fout.precision(17);
+    for (unsigned int itri = 0; itri < ntri; ++itri) {
+      for (unsigned int i = 0; i < 3; ++i) {
+        const double x = dist(rndeng), y = dist(rndeng), z = dist(rndeng);
+        aXYZ0.insert(aXYZ0.end(), {x, y, z});
+        fout << "v " << x << " " << y << " " << z << "\n";
+      }
+      fout << "f -3 -2 -1\n";
+    }
+  }
+  std::vector<double> vtx_xyz[2], vtx_tex, vtx_nrm;
+  std::vector<unsigned int> elem_vtx_index[2], elem_vtx_xyz[2], elem_vtx_tex, elem_vtx_nrm;
+  for (unsigned int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(dfm2::Read_WavefrontObj_Parallel(
+        vtx_xyz[i], vtx_tex, vtx_nrm,
+        elem_vtx_index[i], elem_vtx_xyz[i], elem_vtx_tex, elem_vtx_nrm,
+        path, i == 0 ? 1 : 4));
+  }
+  EXPECT_EQ(vtx_xyz[0], vtx_xyz[1]);
+  EXPECT_EQ(elem_vtx_index[0], elem_vtx_index[1]);
+  EXPECT_EQ(elem_vtx_xyz[0], elem_vtx_xyz[1]);
+  ASSERT_EQ(vtx_xyz[0].size(), aXYZ0.size());
+  for (unsigned int i = 0; i < aXYZ0.size(); ++i) {
+    EXPECT_NEAR(vtx_xyz[0][i], aXYZ0[i], 1.0e-15);
+  }
+  ASSERT_EQ(elem_vtx_xyz[0].size(), ntri * 3);
+  for (unsigned int i = 0; i < ntri * 3; ++i) {
+    EXPECT_EQ(elem_vtx_xyz[0][i], i);
+  }
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+#include <filesystem>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/msh_io_ply.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+/**
+ * the values are identical for the binary formats. The ascii format may differ in the last digit
+ */
+void CompareValues(
+    const std::vector<double> &a,
+    const std::vector<double> &b,
+    dfm2::PLY_FORMAT format) {
+  ASSERT_EQ(a.size(), b.size());
+  const double tol = (format == dfm2::PLY_FORMAT::ASCII) ? 1.0e-14 : 0.0;
+  for (unsigned int i = 0; i < a.size(); ++i) {
+    EXPECT_NEAR(a[i], b[i], tol);
+  }
+}
+
+}
+
+TEST(msh_io_ply, read_ascii) {
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  dfm2::Read_Ply(
+      vtx_xyz, tri_vtx,
+      std::filesystem::path(PATH_INPUT_DIR) / "bunny_1k.ply");
+  EXPECT_EQ(vtx_xyz.size(), 502 * 3);
+  EXPECT_EQ(tri_vtx.size(), 1000 * 3);
+  for (unsigned int iv: tri_vtx) { EXPECT_LT(iv, 502); }
+  //
+  dfm2::ReaderPly ply;
+  EXPECT_TRUE(ply.Open(std::filesystem::path(PATH_INPUT_DIR) / "bunny_1k.ply"));
+  EXPECT_EQ(ply.Format(), dfm2::PLY_FORMAT::ASCII);
+  EXPECT_TRUE(ply.HasProperty("vertex", "x"));
+  EXPECT_FALSE(ply.HasProperty("vertex", "nx"));
+  std::vector<float> vtx_xyz_f;
+  EXPECT_TRUE(ply.ReadProperties(vtx_xyz_f, "vertex", {"x", "y", "z"}));
+  EXPECT_EQ(vtx_xyz_f.size(), vtx_xyz.size());
+  for (unsigned int i = 0; i < vtx_xyz.size(); ++i) {
+    EXPECT_FLOAT_EQ(vtx_xyz_f[i], static_cast<float>(vtx_xyz[i]));
+  }
+  std::vector<double> dummy;
+  EXPECT_FALSE(ply.ReadProperties(dummy, "vertex", {"x", "nx"}));
+  EXPECT_FALSE(ply.ReadProperties(dummy, "edge", {"x"}));
+}
+
+TEST(msh_io_ply, write_read) {
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  const unsigned int np = 100;
+  std::vector<double> vtx_xyz(np * 3);
+  std::vector<float> vtx_nrm(np * 3), vtx_confidence(np);
+  std::vector<unsigned char> vtx_rgb(np * 3);
+  for (auto &v: vtx_xyz) { v = dist(rndeng); }
+  for (auto &v: vtx_nrm) { v = static_cast<float>(dist(rndeng)); }
+  for (auto &v: vtx_confidence) { v = static_cast<float>(dist(rndeng)); }
+  for (unsigned int i = 0; i < np * 3; ++i) { vtx_rgb[i] = static_cast<unsigned char>(i % 256); }
+  // a triangle and a quad
+  const std::vector<unsigned int> elem_vtx_index = {0, 3, 7};
+  const std::vector<unsigned int> elem_vtx = {0, 1, 2, 3, 4, 5, 99};
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_msh_io_ply_test.ply";
+  for (auto format: {
+      dfm2::PLY_FORMAT::ASCII,
+      dfm2::PLY_FORMAT::BINARY_LITTLE_ENDIAN,
+      dfm2::PLY_FORMAT::BINARY_BIG_ENDIAN}) {
+    {
+      dfm2::WriterPly ply;
+      ply.comments.emplace_back("test");
+      ply.AddElement("vertex", np);
+      ply.AddProperty("x", dfm2::PLY_TYPE::FLOAT64, vtx_xyz.data() + 0, 3);
+      ply.AddProperty("y", dfm2::PLY_TYPE::FLOAT64, vtx_xyz.data() + 1, 3);
+      ply.AddProperty("z", dfm2::PLY_TYPE::FLOAT64, vtx_xyz.data() + 2, 3);
+      ply.AddProperty("nx", dfm2::PLY_TYPE::FLOAT32, vtx_nrm.data() + 0, 3);
+      ply.AddProperty("ny", dfm2::PLY_TYPE::FLOAT32, vtx_nrm.data() + 1, 3);
+      ply.AddProperty("nz", dfm2::PLY_TYPE::FLOAT32, vtx_nrm.data() + 2, 3);
+      ply.AddProperty("red", dfm2::PLY_TYPE::UINT8, vtx_rgb.data() + 0, 3);
+      ply.AddProperty("green", dfm2::PLY_TYPE::UINT8, vtx_rgb.data() + 1, 3);
+      ply.AddProperty("blue", dfm2::PLY_TYPE::UINT8, vtx_rgb.data() + 2, 3);
+      ply.AddProperty("confidence", dfm2::PLY_TYPE::FLOAT32, vtx_confidence.data(), 1);
+      ply.AddElement("face", elem_vtx_index.size() - 1);
+      ply.AddPropertyList(
+          "vertex_indices", dfm2::PLY_TYPE::UINT8, dfm2::PLY_TYPE::INT32,
+          elem_vtx_index.data(), elem_vtx.data());
+      EXPECT_TRUE(ply.Write(path, format));
+    }
+    dfm2::ReaderPly ply;
+    EXPECT_TRUE(ply.Open(path));
+    EXPECT_EQ(ply.Format(), format);
+    EXPECT_EQ(ply.comments.size(), 1);
+    EXPECT_EQ(ply.Elements().size(), 2);
+    std::vector<double> vtx_xyz1;
+    EXPECT_TRUE(ply.ReadProperties(vtx_xyz1, "vertex", {"x", "y", "z"}));
+    CompareValues(vtx_xyz1, vtx_xyz, format);
+    std::vector<float> vtx_nrm1, vtx_confidence1;
+    EXPECT_TRUE(ply.ReadProperties(vtx_nrm1, "vertex", {"nx", "ny", "nz"}));
+    EXPECT_EQ(vtx_nrm1, vtx_nrm);
+    EXPECT_TRUE(ply.ReadProperties(vtx_confidence1, "vertex", {"confidence"}));
+    EXPECT_EQ(vtx_confidence1, vtx_confidence);
+    std::vector<unsigned char> vtx_rgb1;
+    EXPECT_TRUE(ply.ReadProperties(vtx_rgb1, "vertex", {"red", "green", "blue"}));
+    EXPECT_EQ(vtx_rgb1, vtx_rgb);
+    std::vector<unsigned int> elem_vtx_index1, elem_vtx1;
+    EXPECT_TRUE(ply.ReadPropertyList(elem_vtx_index1, elem_vtx1, "face", "vertex_indices"));
+    EXPECT_EQ(elem_vtx_index1, elem_vtx_index);
+    EXPECT_EQ(elem_vtx1, elem_vtx);
+    // the quad is split into two triangles
+    std::vector<double> vtx_xyz2;
+    std::vector<unsigned int> tri_vtx2;
+    dfm2::Read_Ply(vtx_xyz2, tri_vtx2, path);
+    CompareValues(vtx_xyz2, vtx_xyz, format);
+    EXPECT_EQ(tri_vtx2, std::vector<unsigned int>({0, 1, 2, 3, 4, 5, 3, 5, 99}));
+    // the list of the last face is truncated
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_FALSE(dfm2::ReaderPly().Open(path));
+  }
+  {  // triangle mesh
+    const std::vector<unsigned int> tri_vtx = {0, 1, 2, 2, 3, 4};
+    EXPECT_TRUE(dfm2::Write_Ply(path, vtx_xyz, tri_vtx, dfm2::PLY_FORMAT::BINARY_LITTLE_ENDIAN));
+    std::vector<double> vtx_xyz2;
+    std::vector<unsigned int> tri_vtx2;
+    dfm2::Read_Ply(vtx_xyz2, tri_vtx2, path);
+    EXPECT_EQ(vtx_xyz2, vtx_xyz);
+    EXPECT_EQ(tri_vtx2, tri_vtx);
+  }
+  std::filesystem::remove(path);
+}
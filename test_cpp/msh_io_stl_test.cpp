@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/msh_io_stl.h"
+#include "delfem2/msh_io_misc.h"
+#include "delfem2/msh_weld.h"
+#include "delfem2/msh_primitive.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+/**
+ * the coordinates of the corners of the triangles are the same (up to the float precision)
+ */
+void CompareTriangles(
+    const std::vector<double> &vtx_xyz0,
+    const std::vector<unsigned int> &tri_vtx0,
+    const std::vector<double> &vtx_xyz1,
+    const std::vector<unsigned int> &tri_vtx1) {
+  ASSERT_EQ(tri_vtx0.size(), tri_vtx1.size());
+  for (unsigned int i = 0; i < tri_vtx0.size(); ++i) {
+    for (unsigned int idim = 0; idim < 3; ++idim) {
+      EXPECT_NEAR(vtx_xyz0[tri_vtx0[i] * 3 + idim], vtx_xyz1[tri_vtx1[i] * 3 + idim], 1.0e-6);
+    }
+  }
+}
+
+}
+
+TEST(msh_io_stl, weld) {
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  dfm2::MeshTri3D_Cube(vtx_xyz, tri_vtx, 20);
+  // triangle soup with a small noise
+  std::mt19937 rndeng(0);
+  std::uniform_real_distribution<double> dist(-1.0e-7, 1.0e-7);
+  std::vector<double> soup_xyz;
+  for (unsigned int iv: tri_vtx) {
+    for (unsigned int idim = 0; idim < 3; ++idim) {
+      soup_xyz.push_back(vtx_xyz[iv * 3 + idim] + dist(rndeng));
+    }
+  }
+  std::vector<unsigned int> map0, map1;
+  std::vector<double> xyz0, xyz1;
+  dfm2::WeldPoints3(map0, xyz0, soup_xyz.data(), soup_xyz.size() / 3, 1.0e-5, 1);
+  dfm2::WeldPoints3(map1, xyz1, soup_xyz.data(), soup_xyz.size() / 3, 1.0e-5, 4);
+  EXPECT_EQ(xyz0.size(), vtx_xyz.size());
+  EXPECT_EQ(map0, map1);  // independent of the number of threads
+  EXPECT_EQ(xyz0, xyz1);
+  CompareTriangles(vtx_xyz, tri_vtx, xyz0, map0);
+  // nothing is welded if the points do not coincide exactly
+  dfm2::WeldPoints3(map0, xyz0, soup_xyz.data(), soup_xyz.size() / 3, 0.0, 2);
+  EXPECT_EQ(xyz0.size(), soup_xyz.size());
+}
+
+TEST(msh_io_stl, write_read) {
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  dfm2::MeshTri3D_Cube(vtx_xyz, tri_vtx, 10);
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_msh_io_stl_test.stl";
+  {  // binary
+    EXPECT_TRUE(dfm2::Write_STL_Binary(path, vtx_xyz, tri_vtx));
+    std::vector<double> vtx_xyz1;
+    std::vector<unsigned int> tri_vtx1;
+    EXPECT_TRUE(dfm2::Read_STL(vtx_xyz1, tri_vtx1, path));
+    EXPECT_EQ(vtx_xyz1.size(), vtx_xyz.size());
+    CompareTriangles(vtx_xyz, tri_vtx, vtx_xyz1, tri_vtx1);
+  }
+  {  // ascii
+    dfm2::Write_STL(path.string(), vtx_xyz, std::vector<int>(tri_vtx.begin(), tri_vtx.end()));
+    std::vector<double> vtx_xyz1;
+    std::vector<unsigned int> tri_vtx1;
+    EXPECT_TRUE(dfm2::Read_STL(vtx_xyz1, tri_vtx1, path, 1.0e-5));
+    EXPECT_EQ(vtx_xyz1.size(), vtx_xyz.size());
+    CompareTriangles(vtx_xyz, tri_vtx, vtx_xyz1, tri_vtx1);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(msh_io_stl, detect_format) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "dfm2_msh_io_stl_test_format.stl";
+  auto write_file = [&path](const std::string &str) {
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(str.data(), static_cast<std::streamsize>(str.size()));
+  };
+  std::vector<double> tri_xyz;
+  {  // the name of the solid contains "vertex"
+    write_file(
+        "solid vertex 1 2 3\n"
+        "facet normal 0 0 1\n outer loop\n"
+        "  vertex 0 0 0\n  vertex 1 0 0\n  vertex 0 1 0\n"
+        " endloop\nendfacet\n"
+        "endsolid vertex 1 2 3\n");
+    EXPECT_TRUE(dfm2::Read_STL_TriangleSoup(tri_xyz, path));
+    const std::vector<double> tri_xyz0 = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+    EXPECT_EQ(tri_xyz, tri_xyz0);
+  }
+  {  // ascii without any triangle
+    write_file("solid empty\nendsolid empty\n");
+    EXPECT_FALSE(dfm2::Read_STL_TriangleSoup(tri_xyz, path));
+  }
+  {  // neither binary nor ascii
+    write_file("this is not a STL file\n");
+    EXPECT_FALSE(dfm2::Read_STL_TriangleSoup(tri_xyz, path));
+  }
+  {  // binary with a comment starting with "solid" and trailing bytes
+    std::vector<double> vtx_xyz;
+    std::vector<unsigned int> tri_vtx;
+    dfm2::MeshTri3D_Cube(vtx_xyz, tri_vtx, 2);
+    EXPECT_TRUE(dfm2::Write_STL_Binary(path, vtx_xyz, tri_vtx));
+    std::string buff;
+    {
+      std::ifstream fin(path, std::ios::binary);
+      buff.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    }
+    buff.replace(0, 6, "solid ");
+    write_file(buff + std::string(7, '\0'));
+    EXPECT_TRUE(dfm2::Read_STL_TriangleSoup(tri_xyz, path));
+    EXPECT_EQ(tri_xyz.size(), tri_vtx.size() * 3);
+    write_file(buff.substr(0, buff.size() - 10)); // truncated
+    EXPECT_FALSE(dfm2::Read_STL_TriangleSoup(tri_xyz, path));
+  }
+  {  // binary without any triangle
+    EXPECT_TRUE(dfm2::Write_STL_Binary(path, {}, {}));
+    EXPECT_FALSE(dfm2::Read_STL_TriangleSoup(tri_xyz, path));
+  }
+  std::filesystem::remove(path);
+}
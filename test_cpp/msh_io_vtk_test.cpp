@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/msh_io_vtk.h"
+#include "delfem2/msh_primitive.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+std::string LoadFileAsString(const std::filesystem::path &path) {
+  std::ifstream fin(path, std::ios::binary);
+  std::ostringstream oss;
+  oss << fin.rdbuf();
+  return oss.str();
+}
+
+/**
+ * value of the XML attribute "name" in the first tag after "pos"
+ */
+size_t AttributeValue(
+    const std::string &str,
+    const std::string &name,
+    size_t pos = 0) {
+  const size_t i0 = str.find(name + "=\"", pos) + name.size() + 2;
+  return std::stoul(str.substr(i0, str.find('"', i0) - i0));
+}
+
+}
+
+TEST(msh_io_vtk, vtu) {
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tri_vtx;
+  dfm2::MeshTri3D_Cube(vtx_xyz, tri_vtx, 8);
+  const size_t np = vtx_xyz.size() / 3;
+  const size_t ntri = tri_vtx.size() / 3;
+  std::vector<double> vtx_val(np), tri_val(ntri * 6);
+  for (unsigned int ip = 0; ip < np; ++ip) { vtx_val[ip] = vtx_xyz[ip * 3 + 0] * 2.0; }
+  for (unsigned int i = 0; i < tri_val.size(); ++i) { tri_val[i] = i * 0.5; }
+  dfm2::WriterVtk vtk;
+  vtk.SetPoints(vtx_xyz.data(), np, 3);
+  vtk.AddCells(5, tri_vtx.data(), ntri);
+  vtk.AddPointData("value", vtx_val.data(), 1);
+  vtk.AddPointData("position", vtx_xyz.data(), 3);
+  vtk.AddCellData("stress", tri_val.data(), 6);
+  const std::filesystem::path dir = std::filesystem::temp_directory_path();
+  {  // VTU
+    EXPECT_TRUE(vtk.WriteVtu(dir / "dfm2_msh_io_vtk_test.vtu"));
+    const std::string str = LoadFileAsString(dir / "dfm2_msh_io_vtk_test.vtu");
+    EXPECT_EQ(AttributeValue(str, "NumberOfPoints"), np);
+    EXPECT_EQ(AttributeValue(str, "NumberOfCells"), ntri);
+    const size_t ofs_data = str.find("encoding=\"raw\">\n_") + 17;
+    // point data "value" is the fifth array
+    size_t pos = str.find("Name=\"value\"");
+    const char *p = str.data() + ofs_data + AttributeValue(str, "offset", pos);
+    std::uint64_t nbyte;
+    std::memcpy(&nbyte, p, 8);
+    EXPECT_EQ(nbyte, np * 8);
+    std::vector<double> val(np);
+    std::memcpy(val.data(), p + 8, np * 8);
+    EXPECT_EQ(val, vtx_val);
+    // connectivity
+    pos = str.find("Name=\"connectivity\"");
+    p = str.data() + ofs_data + AttributeValue(str, "offset", pos);
+    std::memcpy(&nbyte, p, 8);
+    EXPECT_EQ(nbyte, tri_vtx.size() * 4);
+    std::vector<unsigned int> conn(tri_vtx.size());
+    std::memcpy(conn.data(), p + 8, tri_vtx.size() * 4);
+    EXPECT_EQ(conn, tri_vtx);
+    std::filesystem::remove(dir / "dfm2_msh_io_vtk_test.vtu");
+  }
+  {  // legacy binary
+    EXPECT_TRUE(vtk.WriteLegacyBinary(dir / "dfm2_msh_io_vtk_test.vtk"));
+    const std::string str = LoadFileAsString(dir / "dfm2_msh_io_vtk_test.vtk");
+    const std::string key = "POINTS " + std::to_string(np) + " double\n";
+    const char *p = str.data() + str.find(key) + key.size();
+    for (unsigned int i = 0; i < np * 3; ++i) {
+      char bytes[8];
+      std::memcpy(bytes, p + i * 8, 8);
+      std::reverse(bytes, bytes + 8);  // big endian
+      double v;
+      std::memcpy(&v, bytes, 8);
+      EXPECT_EQ(v, vtx_xyz[i]);
+    }
+    EXPECT_NE(str.find("CELL_TYPES " + std::to_string(ntri)), std::string::npos);
+    EXPECT_NE(str.find("SCALARS value double 1"), std::string::npos);
+    EXPECT_NE(str.find("VECTORS position double"), std::string::npos);
+    EXPECT_NE(str.find("stress 6 " + std::to_string(ntri) + " double"), std::string::npos);
+    std::filesystem::remove(dir / "dfm2_msh_io_vtk_test.vtk");
+  }
+  {  // PVTU
+    EXPECT_TRUE(vtk.WritePvtu(dir / "dfm2_msh_io_vtk_test.pvtu", 3, 2));
+    const std::string str = LoadFileAsString(dir / "dfm2_msh_io_vtk_test.pvtu");
+    size_t ncell = 0;
+    for (unsigned int ipiece = 0; ipiece < 3; ++ipiece) {
+      const std::string name = "dfm2_msh_io_vtk_test_" + std::to_string(ipiece) + ".vtu";
+      EXPECT_NE(str.find(name), std::string::npos);
+      const std::string str_piece = LoadFileAsString(dir / name);
+      EXPECT_GT(AttributeValue(str_piece, "NumberOfPoints"), 0);
+      EXPECT_LT(AttributeValue(str_piece, "NumberOfPoints"), np);
+      ncell += AttributeValue(str_piece, "NumberOfCells");
+      std::filesystem::remove(dir / name);
+    }
+    EXPECT_EQ(ncell, ntri);
+    std::filesystem::remove(dir / "dfm2_msh_io_vtk_test.pvtu");
+  }
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/msh_reorder.h"
+#include "delfem2/msh_primitive.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+double LengthPolyline3(
+    const std::vector<double> &xyz,
+    const std::vector<unsigned int> &order) {
+  double len = 0.0;
+  for (unsigned int i = 0; i + 1 < order.size(); ++i) {
+    const double *p0 = xyz.data() + order[i] * 3;
+    const double *p1 = xyz.data() + order[i + 1] * 3;
+    len += std::sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) + (p1[1] - p0[1]) * (p1[1] - p0[1]) + (p1[2] - p0[2]) * (p1[2] - p0[2]));
+  }
+  return len;
+}
+
+/**
+ * average cache miss ratio (number of vertex transforms per triangle) with a FIFO cache
+ */
+double ACMR(
+    const std::vector<unsigned int> &tri_vtx,
+    unsigned int cache_size) {
+  std::vector<unsigned int> cache;
+  unsigned int nmiss = 0;
+  for (unsigned int iv: tri_vtx) {
+    if (std::find(cache.begin(), cache.end(), iv) != cache.end()) { continue; }
+    nmiss += 1;
+    cache.insert(cache.begin(), iv);
+    if (cache.size() > cache_size) { cache.pop_back(); }
+  }
+  return double(nmiss) / double(tri_vtx.size() / 3);
+}
+
+}
+
+TEST(msh_reorder, space_filling_curve) {
+  std::vector<double> xyz;
+  for (unsigned int i = 0; i < 16 * 16 * 16; ++i) {
+    xyz.push_back(i % 16);
+    xyz.push_back((i / 16) % 16);
+    xyz.push_back(i / 256);
+  }
+  std::vector<unsigned int> order_rand(xyz.size() / 3);
+  for (unsigned int i = 0; i < order_rand.size(); ++i) { order_rand[i] = i; }
+  std::shuffle(order_rand.begin(), order_rand.end(), std::mt19937(0));
+  dfm2::PermuteValue(xyz, order_rand, 3);
+  std::vector<unsigned int> order_morton, order_hilbert, order_hilbert1;
+  dfm2::Permutation_SpaceFillingCurve3(order_morton, xyz.data(), xyz.size() / 3, dfm2::SPACE_FILLING_CURVE::MORTON);
+  dfm2::Permutation_SpaceFillingCurve3(order_hilbert, xyz.data(), xyz.size() / 3, dfm2::SPACE_FILLING_CURVE::HILBERT, 1);
+  dfm2::Permutation_SpaceFillingCurve3(order_hilbert1, xyz.data(), xyz.size() / 3, dfm2::SPACE_FILLING_CURVE::HILBERT, 3);
+  EXPECT_EQ(order_hilbert, order_hilbert1);
+  std::vector<unsigned int> order_identity(order_rand.size());
+  for (unsigned int i = 0; i < order_identity.size(); ++i) { order_identity[i] = i; }
+  const double len_rand = LengthPolyline3(xyz, order_identity);
+  const double len_morton = LengthPolyline3(xyz, order_morton);
+  const double len_hilbert = LengthPolyline3(xyz, order_hilbert);
+  EXPECT_LT(len_morton, len_rand * 0.2);
+  EXPECT_LT(len_hilbert, len_morton);
+  { // permutation
+    std::vector<unsigned int> old2new;
+    dfm2::InversePermutation(old2new, order_hilbert);
+    std::vector<unsigned int> tmp = order_identity;
+    dfm2::PermuteValue(tmp, order_hilbert, 1);
+    EXPECT_EQ(tmp, order_hilbert);
+    dfm2::PermuteValue(tmp, old2new, 1);
+    EXPECT_EQ(tmp, order_identity);
+  }
+}
+
+TEST(msh_reorder, brio2) {
+  std::vector<double> xy;
+  for (unsigned int i = 0; i < 64 * 64; ++i) {
+    xy.push_back(i % 64);
+    xy.push_back(i / 64);
+  }
+  std::vector<unsigned int> order_hilbert;
+  dfm2::Permutation_SpaceFillingCurve2(order_hilbert, xy.data(), xy.size() / 2, dfm2::SPACE_FILLING_CURVE::HILBERT);
+  for (unsigned int i = 0; i + 1 < order_hilbert.size(); ++i) { // consecutive points are neighbours on the grid
+    const unsigned int ip0 = order_hilbert[i], ip1 = order_hilbert[i + 1];
+    EXPECT_EQ(std::fabs(xy[ip0 * 2 + 0] - xy[ip1 * 2 + 0]) + std::fabs(xy[ip0 * 2 + 1] - xy[ip1 * 2 + 1]), 1.0);
+  }
+  std::vector<unsigned int> order_brio, order_brio1;
+  dfm2::Permutation_BRIO2(order_brio, xy.data(), xy.size() / 2, 0, 1);
+  dfm2::Permutation_BRIO2(order_brio1, xy.data(), xy.size() / 2, 0, 3);
+  EXPECT_EQ(order_brio, order_brio1);
+  std::vector<unsigned int> old2new;
+  dfm2::InversePermutation(old2new, order_brio);  // asserts the permutation
+  // the last round has about half of the points and they are sorted along the curve
+  const size_t np = order_brio.size();
+  unsigned int nbreak = 0;
+  for (size_t i = np / 2 + 100; i + 1 < np; ++i) {
+    const unsigned int ip0 = order_brio[i], ip1 = order_brio[i + 1];
+    const double d = std::fabs(xy[ip0 * 2 + 0] - xy[ip1 * 2 + 0]) + std::fabs(xy[ip0 * 2 + 1] - xy[ip1 * 2 + 1]);
+    if (d > 8) { nbreak += 1; }
+  }
+  EXPECT_LT(nbreak, 8);
+}
+
+TEST(msh_reorder, mesh) {
+  std::vector<double> vtx_xyz0;
+  std::vector<unsigned int> tri_vtx0;
+  dfm2::MeshTri3D_Sphere(vtx_xyz0, tri_vtx0, 1.0, 64, 64);
+  const size_t np = vtx_xyz0.size() / 3;
+  const size_t ntri = tri_vtx0.size() / 3;
+  {  // shuffle the triangles and the vertices as a mesh loaded from an unordered file
+    std::mt19937 rndeng(0);
+    std::vector<unsigned int> tri_new2old(ntri), vtx_new2old(np), vtx_old2new;
+    for (unsigned int i = 0; i < ntri; ++i) { tri_new2old[i] = i; }
+    for (unsigned int i = 0; i < np; ++i) { vtx_new2old[i] = i; }
+    std::shuffle(tri_new2old.begin(), tri_new2old.end(), rndeng);
+    std::shuffle(vtx_new2old.begin(), vtx_new2old.end(), rndeng);
+    dfm2::PermuteValue(tri_vtx0, tri_new2old, 3);
+    dfm2::InversePermutation(vtx_old2new, vtx_new2old);
+    dfm2::RenumberVertex_MeshElem(tri_vtx0, vtx_old2new);
+    dfm2::PermuteValue(vtx_xyz0, vtx_new2old, 3);
+  }
+  std::vector<double> vtx_xyz1 = vtx_xyz0;
+  std::vector<unsigned int> tri_vtx1 = tri_vtx0;
+  std::vector<unsigned int> vtx_new2old, tri_new2old;
+  dfm2::Reorder_MeshElem3(vtx_new2old, tri_new2old, vtx_xyz1, tri_vtx1, 3);
+  ASSERT_EQ(vtx_new2old.size(), np);
+  ASSERT_EQ(tri_new2old.size(), ntri);
+  for (unsigned int it = 0; it < ntri; ++it) {
+    for (unsigned int inode = 0; inode < 3; ++inode) {
+      const unsigned int iv1 = tri_vtx1[it * 3 + inode];
+      const unsigned int iv0 = tri_vtx0[tri_new2old[it] * 3 + inode];
+      EXPECT_EQ(vtx_new2old[iv1], iv0);
+      EXPECT_EQ(vtx_xyz1[iv1 * 3 + 0], vtx_xyz0[iv0 * 3 + 0]);
+    }
+  }
+  EXPECT_GT(ACMR(tri_vtx0, 32), 2.0);
+  EXPECT_LT(ACMR(tri_vtx1, 32), 0.8);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/msh_topology_uniform.h"
+#include "delfem2/jagarray.h"
+#include "delfem2/isrf_iss.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+class CSphere : public dfm2::CInput_IsosurfaceStuffing {
+ public:
+  [[nodiscard]] double SignedDistance(double x, double y, double z) const override {
+    return 0.8 - std::sqrt(x * x + y * y + z * z);
+  }
+};
+
+}
+
+TEST(msh_topology_uniform, parallel_tet) {
+  std::vector<double> vtx_xyz;
+  std::vector<unsigned int> tet_vtx;
+  {
+    std::vector<int> vtx_on_surface;
+    const double center[3] = {0, 0, 0};
+    dfm2::IsoSurfaceStuffing(
+        vtx_xyz, tet_vtx, vtx_on_surface,
+        CSphere(), 0.05, 2.0, center);
+  }
+  const size_t np = vtx_xyz.size() / 3;
+  const size_t ntet = tet_vtx.size() / 4;
+  ASSERT_GT(ntet, 10000);
+  // elem surrounding point
+  std::vector<unsigned int> elsup_ind0, elsup0;
+  dfm2::JArray_ElSuP_MeshElem(elsup_ind0, elsup0, tet_vtx.data(), ntet, 4, np);
+  for (unsigned int num_thread: {0, 2, 3}) {
+    std::vector<unsigned int> elsup_ind1, elsup1;
+    dfm2::JArray_ElSuP_MeshElem(elsup_ind1, elsup1, tet_vtx.data(), ntet, 4, np, num_thread);
+    EXPECT_EQ(elsup_ind0, elsup_ind1);
+    EXPECT_EQ(elsup0, elsup1);
+  }
+  // point surrounding point
+  std::vector<unsigned int> psup_ind0, psup0;
+  dfm2::JArray_PSuP_MeshElem(psup_ind0, psup0, tet_vtx.data(), ntet, 4, np);
+  {
+    std::vector<unsigned int> psup_ind1, psup1;
+    dfm2::JArray_PSuP_MeshElem(psup_ind1, psup1, tet_vtx.data(), ntet, 4, np, 3);
+    EXPECT_EQ(psup_ind0, psup_ind1);
+    EXPECT_EQ(psup0, psup1);
+    // sort
+    dfm2::JArray_Sort(psup_ind0, psup0);
+    dfm2::JArray_Sort(psup_ind1, psup1, 3);
+    EXPECT_EQ(psup0, psup1);
+    // diagonal
+    std::vector<unsigned int> psup_ind2, psup2, psup_ind3, psup3;
+    dfm2::JArray_AddDiagonal(
+        psup_ind2, psup2,
+        psup_ind0.data(), psup_ind0.size(), psup0.data(), psup0.size());
+    dfm2::JArray_AddDiagonal(
+        psup_ind3, psup3,
+        psup_ind0.data(), psup_ind0.size(), psup0.data(), psup0.size(), 3);
+    EXPECT_EQ(psup_ind2, psup_ind3);
+    EXPECT_EQ(psup2, psup3);
+    EXPECT_EQ(psup2.size(), psup0.size() + np);
+  }
+  // elem surrounding elem
+  {
+    std::vector<unsigned int> elsuel0, elsuel1;
+    dfm2::ElSuEl_MeshElem(elsuel0, tet_vtx.data(), ntet, dfm2::MESHELEM_TET, np);
+    dfm2::ElSuEl_MeshElem(elsuel1, tet_vtx.data(), ntet, dfm2::MESHELEM_TET, np, 3);
+    EXPECT_EQ(elsuel0, elsuel1);
+  }
+  // edge
+  for (bool is_bidirectional: {true, false}) {
+    std::vector<unsigned int> edge_ind0, edge0, edge_ind1, edge1;
+    dfm2::JArrayEdge_MeshElem(
+        edge_ind0, edge0,
+        tet_vtx.data(), dfm2::MESHELEM_TET, elsup_ind0, elsup0, is_bidirectional);
+    dfm2::JArrayEdge_MeshElem(
+        edge_ind1, edge1,
+        tet_vtx.data(), dfm2::MESHELEM_TET, elsup_ind0, elsup0, is_bidirectional, 3);
+    EXPECT_EQ(edge_ind0, edge_ind1);
+    EXPECT_EQ(edge0, edge1);
+    if (is_bidirectional) { EXPECT_EQ(edge0, psup0); }
+  }
+}
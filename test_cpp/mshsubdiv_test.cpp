@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/mshsubdiv.h"
+#include "delfem2/msh_primitive.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+double MaxDiff(
+    const std::vector<double> &a,
+    const std::vector<double> &b) {
+  EXPECT_EQ(a.size(), b.size());
+  double d = 0.0;
+  for (unsigned int i = 0; i < a.size() && i < b.size(); ++i) {
+    d = std::max(d, std::fabs(a[i] - b[i]));
+  }
+  return d;
+}
+
+}
+
+TEST(mshsubdiv, quad_catmull_clark) {
+  for (unsigned int itr = 0; itr < 2; ++itr) {
+    std::vector<double> vtx_xyz0;
+    std::vector<unsigned int> quad_vtx0;
+    if (itr == 0) { // closed surface
+      const double bbmin[3] = {-1, -1, -1};
+      const double bbmax[3] = {+1, +1, +1};
+      dfm2::MeshQuad3_CubeVox(vtx_xyz0, quad_vtx0, bbmin, bbmax);
+    } else { // open surface
+      std::vector<double> vtx_xy0;
+      dfm2::MeshQuad2D_Grid(vtx_xy0, quad_vtx0, 8, 5);
+      for (unsigned int ip = 0; ip < vtx_xy0.size() / 2; ++ip) {
+        const double x = vtx_xy0[ip * 2 + 0], y = vtx_xy0[ip * 2 + 1];
+        vtx_xyz0.insert(vtx_xyz0.end(), {x, y, std::sin(x + 0.3 * y)});
+      }
+    }
+    dfm2::SubdivisionStencil stencil_all;
+    std::vector<double> vtx_xyz_all = vtx_xyz0;
+    for (unsigned int ilevel = 0; ilevel < 3; ++ilevel) {
+      const size_t nq0 = quad_vtx0.size() / 4;
+      const size_t nv0 = vtx_xyz0.size() / 3;
+      std::vector<unsigned int> quad_vtx1, psup_ind, psup, edge_face;
+      dfm2::SubdivTopo_MeshQuad(
+          quad_vtx1, psup_ind, psup, edge_face,
+          quad_vtx0.data(), nq0, nv0);
+      {  // multi-threaded topology is the same
+        std::vector<unsigned int> quad_vtx2, psup_ind2, psup2, edge_face2;
+        dfm2::SubdivTopo_MeshQuad(
+            quad_vtx2, psup_ind2, psup2, edge_face2,
+            quad_vtx0.data(), nq0, nv0, 3);
+        EXPECT_EQ(quad_vtx1, quad_vtx2);
+        EXPECT_EQ(psup_ind, psup_ind2);
+        EXPECT_EQ(psup, psup2);
+        EXPECT_EQ(edge_face, edge_face2);
+      }
+      std::vector<double> vtx_xyz1;
+      dfm2::SubdivisionPoints_QuadCatmullClark(
+          vtx_xyz1,
+          quad_vtx1, edge_face, psup_ind, psup,
+          quad_vtx0.data(), nq0, vtx_xyz0.data(), nv0);
+      {  // multi-threaded points are the same
+        std::vector<double> vtx_xyz2;
+        dfm2::SubdivisionPoints_QuadCatmullClark(
+            vtx_xyz2,
+            quad_vtx1, edge_face, psup_ind, psup,
+            quad_vtx0.data(), nq0, vtx_xyz0.data(), nv0, 3);
+        EXPECT_EQ(vtx_xyz1, vtx_xyz2);
+      }
+      dfm2::SubdivisionStencil stencil;
+      dfm2::SubdivisionStencil_QuadCatmullClark(
+          stencil,
+          edge_face, psup, quad_vtx0.data(), nq0, nv0, 3);
+      std::vector<double> vtx_xyz2;
+      dfm2::SubdivisionPoints_Stencil(vtx_xyz2, stencil, vtx_xyz0.data(), 3, 3);
+      EXPECT_LT(MaxDiff(vtx_xyz1, vtx_xyz2), 1.0e-12);
+      // multi-level stencil
+      if (ilevel == 0) {
+        stencil_all = stencil;
+      } else {
+        dfm2::SubdivisionStencil_Compose(stencil_all, stencil, stencil_all, 3);
+      }
+      quad_vtx0 = quad_vtx1;
+      vtx_xyz0 = vtx_xyz1;
+    }
+    std::vector<double> vtx_xyz3;
+    dfm2::SubdivisionPoints_Stencil(vtx_xyz3, stencil_all, vtx_xyz_all.data(), 3);
+    EXPECT_LT(MaxDiff(vtx_xyz0, vtx_xyz3), 1.0e-12);
+  }
+}
+
+TEST(mshsubdiv, hex) {
+  std::vector<double> vtx_xyz0;
+  std::vector<unsigned int> hex_vtx0;
+  dfm2::MeshHex3_Grid(vtx_xyz0, hex_vtx0, 5, 4, 3, 0.2);
+  for (unsigned int ilevel = 0; ilevel < 2; ++ilevel) {
+    const size_t nh0 = hex_vtx0.size() / 8;
+    const size_t nv0 = vtx_xyz0.size() / 3;
+    std::vector<unsigned int> hex_vtx1, psup_ind, psup, quad_vtx;
+    dfm2::SubdivTopo_MeshHex(
+        hex_vtx1, psup_ind, psup, quad_vtx,
+        hex_vtx0.data(), nh0, nv0);
+    {
+      std::vector<unsigned int> hex_vtx2, psup_ind2, psup2, quad_vtx2;
+      dfm2::SubdivTopo_MeshHex(
+          hex_vtx2, psup_ind2, psup2, quad_vtx2,
+          hex_vtx0.data(), nh0, nv0, 3);
+      EXPECT_EQ(hex_vtx1, hex_vtx2);
+      EXPECT_EQ(psup, psup2);
+      EXPECT_EQ(quad_vtx, quad_vtx2);
+    }
+    std::vector<double> vtx_xyz1;
+    dfm2::SubdivisionPoints_Hex(
+        vtx_xyz1,
+        psup_ind, psup, quad_vtx,
+        hex_vtx0.data(), nh0, vtx_xyz0.data(), nv0);
+    {
+      std::vector<double> vtx_xyz2;
+      dfm2::SubdivisionPoints_Hex(
+          vtx_xyz2,
+          psup_ind, psup, quad_vtx,
+          hex_vtx0.data(), nh0, vtx_xyz0.data(), nv0, 3);
+      EXPECT_EQ(vtx_xyz1, vtx_xyz2);
+      dfm2::SubdivisionStencil stencil;
+      dfm2::SubdivisionStencil_Hex(
+          stencil,
+          psup_ind, psup, quad_vtx, hex_vtx0.data(), nh0, nv0);
+      dfm2::SubdivisionPoints_Stencil(vtx_xyz2, stencil, vtx_xyz0.data(), 3);
+      EXPECT_LT(MaxDiff(vtx_xyz1, vtx_xyz2), 1.0e-12);
+    }
+    // volume of each hex is 1/8 of the original one
+    for (unsigned int ih = 0; ih < hex_vtx1.size() / 8; ++ih) {
+      const double *p0 = vtx_xyz1.data() + hex_vtx1[ih * 8 + 0] * 3;
+      const double *p6 = vtx_xyz1.data() + hex_vtx1[ih * 8 + 6] * 3;
+      const double elen = 0.2 / (2 << ilevel);
+      EXPECT_NEAR(std::fabs((p6[0] - p0[0]) * (p6[1] - p0[1]) * (p6[2] - p0[2])), elen * elen * elen, 1.0e-12);
+    }
+    hex_vtx0 = hex_vtx1;
+    vtx_xyz0 = vtx_xyz1;
+  }
+}
+
+TEST(mshsubdiv, tet) {
+  std::vector<double> vtx_xyz0;
+  std::vector<unsigned int> tet_vtx0;
+  {
+    std::vector<unsigned int> hex_vtx;
+    dfm2::MeshHex3_Grid(vtx_xyz0, hex_vtx, 4, 3, 3, 0.2);
+    // split a hex into six tets around the diagonal 0-6
+    const unsigned int aNoelTet[6][4] = {
+        {0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+        {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+    for (unsigned int ih = 0; ih < hex_vtx.size() / 8; ++ih) {
+      for (const auto &noel : aNoelTet) {
+        for (unsigned int ino : noel) { tet_vtx0.push_back(hex_vtx[ih * 8 + ino]); }
+      }
+    }
+  }
+  const size_t nv0 = vtx_xyz0.size() / 3;
+  const auto nt0 = static_cast<int>(tet_vtx0.size() / 4);
+  std::vector<unsigned int> tet_vtx1, psup_ind, psup;
+  dfm2::SubdivTopo_MeshTet(tet_vtx1, psup_ind, psup, tet_vtx0.data(), nt0, nv0);
+  {
+    std::vector<unsigned int> tet_vtx2, psup_ind2, psup2;
+    dfm2::SubdivTopo_MeshTet(tet_vtx2, psup_ind2, psup2, tet_vtx0.data(), nt0, nv0, 3);
+    EXPECT_EQ(tet_vtx1, tet_vtx2);
+    EXPECT_EQ(psup, psup2);
+  }
+  dfm2::SubdivisionStencil stencil;
+  dfm2::SubdivisionStencil_Tet(stencil, psup_ind, psup, nv0);
+  std::vector<double> vtx_xyz1;
+  dfm2::SubdivisionPoints_Stencil(vtx_xyz1, stencil, vtx_xyz0.data(), 3);
+  // total volume is preserved
+  auto volume = [](const std::vector<double> &xyz, const std::vector<unsigned int> &tet) {
+    double v = 0.0;
+    for (unsigned int it = 0; it < tet.size() / 4; ++it) {
+      const double *p0 = xyz.data() + tet[it * 4 + 0] * 3;
+      const double *p1 = xyz.data() + tet[it * 4 + 1] * 3;
+      const double *p2 = xyz.data() + tet[it * 4 + 2] * 3;
+      const double *p3 = xyz.data() + tet[it * 4 + 3] * 3;
+      const double a[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      const double b[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      const double c[3] = {p3[0] - p0[0], p3[1] - p0[1], p3[2] - p0[2]};
+      v += std::fabs(a[0] * (b[1] * c[2] - b[2] * c[1])
+                         + a[1] * (b[2] * c[0] - b[0] * c[2])
+                         + a[2] * (b[0] * c[1] - b[1] * c[0])) / 6.0;
+    }
+    return v;
+  };
+  EXPECT_NEAR(volume(vtx_xyz0, tet_vtx0), volume(vtx_xyz1, tet_vtx1), 1.0e-12);
+}
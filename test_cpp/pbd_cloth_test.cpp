@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2019 Nobuyuki Umetani
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h" // need to be defiend in the beginning
+//
+#include "delfem2/pbd_cloth.h"
+
+namespace dfm2 = delfem2;
+
+namespace {
+
+void MakeSquareCloth(
+    std::vector<double> &aXYZ0,
+    std::vector<unsigned int> &aTri,
+    std::vector<unsigned int> &aQuad,
+    unsigned int ndiv,
+    double cloth_size) {
+  const double elem_length = cloth_size / ndiv;
+  aXYZ0.clear();
+  for (unsigned int ix = 0; ix < ndiv + 1; ix++) {
+    for (unsigned int iy = 0; iy < ndiv + 1; iy++) {
+      aXYZ0.push_back(ix * elem_length);
+      aXYZ0.push_back(iy * elem_length);
+      aXYZ0.push_back(0.0);
+    }
+  }
+  aTri.clear();
+  aQuad.clear();
+  for (unsigned int ix = 0; ix < ndiv; ix++) {
+    for (unsigned int iy = 0; iy < ndiv; iy++) {
+      const unsigned int i00 = (ix + 0) * (ndiv + 1) + (iy + 0);
+      const unsigned int i10 = (ix + 1) * (ndiv + 1) + (iy + 0);
+      const unsigned int i01 = (ix + 0) * (ndiv + 1) + (iy + 1);
+      const unsigned int i11 = (ix + 1) * (ndiv + 1) + (iy + 1);
+      aTri.insert(aTri.end(), {i00, i10, i01, i11, i01, i10});
+      aQuad.insert(aQuad.end(), {i00, i11, i10, i01});
+    }
+  }
+}
+
+}
+
+TEST(pbd_cloth, xpbd_substep) {
+  std::vector<double> aXYZ0;
+  std::vector<unsigned int> aTri, aQuad;
+  const unsigned int ndiv = 40;
+  MakeSquareCloth(aXYZ0, aTri, aQuad, ndiv, 1.0);
+  const size_t np = aXYZ0.size() / 3;
+  std::vector<int> aBCFlag(np, 0);
+  for (unsigned int iy = 0; iy < ndiv + 1; ++iy) { aBCFlag[iy] = 1; }
+  const double gravity[3] = {0, 0, -10};
+  std::vector<double> aXYZ[2];
+  for (unsigned int ithread = 0; ithread < 2; ++ithread) {
+    dfm2::ClothXPBD_Substep cloth;
+    cloth.num_thread = ithread + 1;
+    cloth.Initialize(aXYZ0, aTri, aQuad, 0.0, 1.0e-2);
+    aXYZ[ithread] = aXYZ0;
+    std::vector<double> aUVW(np * 3, 0.0);
+    for (unsigned int itr = 0; itr < 20; ++itr) {
+      cloth.StepTime(
+          aXYZ[ithread], aUVW, aBCFlag,
+          0.01, 20, gravity, 1.0e-3);
+    }
+  }
+  // the result does not depend on the number of threads
+  for (unsigned int i = 0; i < np * 3; ++i) {
+    EXPECT_EQ(aXYZ[0][i], aXYZ[1][i]);
+  }
+  const std::vector<double> &aXYZ1 = aXYZ[0];
+  for (unsigned int ip = 0; ip < np; ++ip) {
+    if (aBCFlag[ip] == 0) { continue; }
+    EXPECT_EQ(aXYZ1[ip * 3 + 0], aXYZ0[ip * 3 + 0]);
+    EXPECT_EQ(aXYZ1[ip * 3 + 1], aXYZ0[ip * 3 + 1]);
+    EXPECT_EQ(aXYZ1[ip * 3 + 2], aXYZ0[ip * 3 + 2]);
+  }
+  EXPECT_LT(aXYZ1[(np - 1) * 3 + 2], -0.1);  // the free end falls
+  double max_strain = 0.0;
+  for (unsigned int itri = 0; itri < aTri.size() / 3; ++itri) {
+    for (unsigned int iedge = 0; iedge < 3; ++iedge) {
+      const unsigned int ip0 = aTri[itri * 3 + iedge];
+      const unsigned int ip1 = aTri[itri * 3 + (iedge + 1) % 3];
+      double l0 = 0.0, l1 = 0.0;
+      for (unsigned int idim = 0; idim < 3; ++idim) {
+        l0 += (aXYZ0[ip0 * 3 + idim] - aXYZ0[ip1 * 3 + idim]) * (aXYZ0[ip0 * 3 + idim] - aXYZ0[ip1 * 3 + idim]);
+        l1 += (aXYZ1[ip0 * 3 + idim] - aXYZ1[ip1 * 3 + idim]) * (aXYZ1[ip0 * 3 + idim] - aXYZ1[ip1 * 3 + idim]);
+      }
+      max_strain = std::max(max_strain, std::fabs(std::sqrt(l1 / l0) - 1.0));
+    }
+  }
+  EXPECT_LT(max_strain, 0.1);
+}
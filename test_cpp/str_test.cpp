@@ -5,6 +5,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cstring>
+#include <cmath>
+#include <climits>
+
 #include "gtest/gtest.h"
 #include "delfem2/str.h"
 #include "delfem2/mshmisc.h"
@@ -78,4 +82,38 @@ TEST(str,split){
   EXPECT_EQ(aToken.size(), 2);
   EXPECT_EQ(aToken[0],"chr");
   EXPECT_EQ(aToken[1],"80");
-}
\ No newline at end of file
+}
+TEST(str,parse_number_double){
+  const char* aStr[] = {
+      "-1.5", "3.25e2", "1e22", "1.7976931348623157e308",
+      "1.5e-310", "4.9406564584124654e-324", "2.2250738585072014e-308",
+      "1234567890123456789012e-330"};
+  for (const char* str : aStr) {
+    const char* end = str + std::strlen(str);
+    double v = 0.;
+    const char* p = dfm2::ParseNumber_Double(v, str, end);
+    EXPECT_EQ(p, end);
+    const double v0 = std::strtod(str, nullptr);
+    EXPECT_NE(v, 0.) << str;
+    EXPECT_NEAR(v, v0, std::abs(v0) * 1.0e-14 + 1.0e-323) << str;
+  }
+}
+
+TEST(str,parse_number_int){
+  const std::pair<const char*, long long> aStrVal[] = {
+      {"0", 0}, {"-12", -12}, {"+7", 7},
+      {"9223372036854775807", LLONG_MAX},
+      {"-9223372036854775808", LLONG_MIN},
+      {"123456789012345678901234567890", LLONG_MAX},
+      {"-123456789012345678901234567890", LLONG_MIN}};
+  for (const auto& sv : aStrVal) {
+    const char* end = sv.first + std::strlen(sv.first);
+    long long v = 0;
+    EXPECT_EQ(dfm2::ParseNumber_Int(v, sv.first, end), end);
+    EXPECT_EQ(v, sv.second) << sv.first;
+  }
+  double d = 0.;
+  const char* str = "1e99999999999999999999";
+  EXPECT_EQ(dfm2::ParseNumber_Double(d, str, str + std::strlen(str)), str + std::strlen(str));
+  EXPECT_TRUE(std::isinf(d));
+}